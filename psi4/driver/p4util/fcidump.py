@@ -33,7 +33,7 @@ import numpy as np
 
 from psi4.driver import psifiles as psif
 from psi4.driver.p4util.testing import compare_integers, compare_values, compare_recursive
-from psi4.driver.procrouting.proc_util import check_iwl_file_from_scf_type
+from psi4.driver.procrouting.proc_util import check_iwl_file_from_scf_type, scf_type_of
 
 from psi4 import core
 from .exceptions import ValidationError, TestComparisonError
@@ -112,7 +112,7 @@ def fcidump(wfn, fname='INTDUMP', oe_ints=None):
         intdump.write(header)
 
     # Get an IntegralTransform object
-    check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), wfn)
+    check_iwl_file_from_scf_type(scf_type_of(wfn), wfn)
     spaces = [core.MOSpace.all()]
     trans_type = core.IntegralTransform.TransformationType.Restricted
     if not wfn.same_a_b_orbs():
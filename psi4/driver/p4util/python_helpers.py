@@ -355,7 +355,7 @@ def _core_jk_build(orbital_basis, aux=None, jk_type=None, do_wK=None, memory=Non
         core.set_global_option("SCF_TYPE", jk_type)
 
     if aux is None:
-        if core.get_global_option("SCF_TYPE") == "DF":
+        if core.get_global_option("SCF_TYPE") in ["DF", "AUTO", "COSX"]:
             aux = core.BasisSet.build(orbital_basis.molecule(), "DF_BASIS_SCF", core.get_option("SCF", "DF_BASIS_SCF"),
                                       "JKFIT", orbital_basis.name(), orbital_basis.has_puream())
         else:
@@ -147,6 +147,7 @@ class EmpiricalDispersion(object):
 
         if self.engine == 'libdisp':
             self.disp = core.Dispersion.build(self.dashlevel, **resolved['dashparams'])
+            self.disp.set_cutoff(core.get_option('SCF', 'DFT_DISPERSION_CUTOFF'))
 
     def print_out(self):
         """Format dispersion parameters of `self` for output file."""
@@ -283,7 +284,8 @@ class EmpiricalDispersion(object):
     def compute_hessian(self, molecule: 'psi4.core.Molecule',
                         wfn: 'psi4.core.Wavefunction' = None) -> 'psi4.core.Matrix':
         """Compute dispersion Hessian based on engine, dispersion level, and parameters in `self`.
-        Uses finite difference, as no dispersion engine has analytic second derivatives.
+        Analytic for the libdisp engine; other engines use finite differences of gradients,
+        as they have no analytic second derivatives.
 
         Parameters
         ----------
@@ -298,6 +300,12 @@ class EmpiricalDispersion(object):
             (3*nat, 3*nat) dispersion Hessian [Eh/a0/a0].
 
         """
+        if self.engine == 'libdisp':
+            H = self.disp.compute_hessian(molecule)
+            if wfn is not None:
+                wfn.set_variable('DISPERSION CORRECTION HESSIAN', H)
+            return H
+
         optstash = p4util.OptionsState(['PRINT'], ['PARENT_SYMMETRY'])
         core.set_global_option('PRINT', 0)
 
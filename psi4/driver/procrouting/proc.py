@@ -1026,6 +1026,49 @@ def build_disp_functor(name, restricted, **kwargs):
         return superfunc, None
 
 
+def _read_checkpoint_guess(scf_wfn, read_filename):
+    """Sets the occupied orbitals of the binary SCF checkpoint as the guess of `scf_wfn`.
+
+    The checkpoint is only consulted when checkpointing is enabled through
+    SCF_CHECKPOINT_FREQ. It is used only if it is newer than the orbital file
+    `read_filename` (file 180), and if it was written with the same point group and
+    the same basis set (name and shell structure) as `scf_wfn`, so that the orbitals
+    can be used without projection. Only the occupied columns of the orbitals are
+    read from disk.
+
+    Returns
+    -------
+    bool
+        Whether a guess was read from the checkpoint.
+    """
+    if core.get_option('SCF', 'SCF_CHECKPOINT_FREQ') <= 0:
+        return False
+    chk_filename = scf_wfn.checkpoint_filename()
+    if not os.path.isfile(chk_filename):
+        return False
+    if os.path.isfile(read_filename) and os.path.getmtime(read_filename) > os.path.getmtime(chk_filename):
+        return False
+
+    chk = core.CheckpointReader(chk_filename)
+    if not chk.compatible(scf_wfn):
+        core.print_out("  Checkpoint %s does not match the basis set or point group, ignoring it.\n\n" % chk_filename)
+        return False
+
+    iteration = chk.integer("iteration")
+    core.print_out("  Reading orbitals from checkpoint %s (%s), no projection.\n\n" %
+                   (chk_filename, "converged" if iteration < 0 else "iteration %d" % iteration))
+    nalphapi = chk.dimension("nalphapi")
+    nbetapi = chk.dimension("nbetapi")
+    scf_wfn.guess_Ca(chk.matrix_columns("Ca", nalphapi))
+    scf_wfn.guess_Cb(chk.matrix_columns("Cb", nbetapi))
+
+    if (bool(chk.integer("same_a_b_orbs")) != scf_wfn.same_a_b_orbs() or nalphapi.sum() != scf_wfn.nalpha()
+            or nbetapi.sum() != scf_wfn.nbeta()):
+        scf_wfn.reset_occ_ = True
+
+    return True
+
+
 def scf_wavefunction_factory(name, ref_wfn, reference, **kwargs):
     """Builds the correct (R/U/RO/CU HF/KS) wavefunction from the
     provided information, sets relevant auxiliary basis sets on it,
@@ -1035,8 +1078,18 @@ def scf_wavefunction_factory(name, ref_wfn, reference, **kwargs):
     # Figure out functional and dispersion
     superfunc, _disp_functor = build_disp_functor(name, restricted=(reference in ["RKS", "RHF"]), **kwargs)
 
-    # Build the wavefunction
+    # Resolve SCF_TYPE AUTO for this wavefunction only, the option itself stays AUTO
     core.prepare_options_for_module("SCF")
+    scf_type = core.get_global_option("SCF_TYPE")
+    if scf_type == "AUTO":
+        auto_aux = core.BasisSet.build(ref_wfn.molecule(), "DF_BASIS_SCF",
+                                       core.get_option("SCF", "DF_BASIS_SCF"),
+                                       "JKFIT", core.get_global_option('BASIS'),
+                                       puream=ref_wfn.basisset().has_puream())
+        auto_memory = (core.get_memory() / 8) * core.get_global_option("SCF_MEM_SAFETY_FACTOR")
+        scf_type = core.JK.select_type(ref_wfn.basisset(), auto_aux, superfunc.is_x_lrc(), int(auto_memory))
+
+    # Build the wavefunction
     if reference in ["RHF", "RKS"]:
         wfn = core.RHF(ref_wfn, superfunc)
     elif reference == "ROHF":
@@ -1051,9 +1104,11 @@ def scf_wavefunction_factory(name, ref_wfn, reference, **kwargs):
     if _disp_functor and _disp_functor.engine != 'nl':
         wfn._disp_functor = _disp_functor
 
+    wfn.set_scf_type(scf_type)
+
     # Set the DF basis sets
-    if (("DF" in core.get_global_option("SCF_TYPE")) or
-            (core.get_option("SCF", "DF_SCF_GUESS") and (core.get_global_option("SCF_TYPE") == "DIRECT"))):
+    if (("DF" in scf_type) or (scf_type == "COSX") or
+            (core.get_option("SCF", "DF_SCF_GUESS") and (scf_type == "DIRECT"))):
         aux_basis = core.BasisSet.build(wfn.molecule(), "DF_BASIS_SCF",
                                         core.get_option("SCF", "DF_BASIS_SCF"),
                                         "JKFIT", core.get_global_option('BASIS'),
@@ -1170,7 +1225,8 @@ def scf_helper(name, post_scf=True, **kwargs):
             guessbasis = cast
         core.set_global_option('BASIS', guessbasis)
 
-        castdf = 'DF' in core.get_global_option('SCF_TYPE')
+        # AUTO has not picked an algorithm yet; a density-fitted guess suits any of its choices
+        castdf = 'DF' in core.get_global_option('SCF_TYPE') or core.get_global_option('SCF_TYPE') == 'AUTO'
 
         if core.has_option_changed('SCF', 'DF_BASIS_GUESS'):
             castdf = core.get_option('SCF', 'DF_BASIS_GUESS')
@@ -1299,7 +1355,10 @@ def scf_helper(name, post_scf=True, **kwargs):
     # we can use os.path.isfile to query whether the file exists before attempting to read
     read_filename = scf_wfn.get_scratch_filename(180) + '.npy'
 
-    if (core.get_option('SCF', 'GUESS') == 'READ') and os.path.isfile(read_filename):
+    if (core.get_option('SCF', 'GUESS') == 'READ') and _read_checkpoint_guess(scf_wfn, read_filename):
+        pass
+
+    elif (core.get_option('SCF', 'GUESS') == 'READ') and os.path.isfile(read_filename):
         old_wfn = core.Wavefunction.from_file(read_filename)
         Ca_occ = old_wfn.Ca_subset("SO", "OCC")
         Cb_occ = old_wfn.Cb_subset("SO", "OCC")
@@ -1371,7 +1430,9 @@ def scf_helper(name, post_scf=True, **kwargs):
             raise ValidationError("""Error: 3-layer QM/MM/PCM not implemented.\n""")
         pcmsolver_parsed_fname = core.get_local_option('PCM', 'PCMSOLVER_PARSED_FNAME')
         pcm_print_level = core.get_option('SCF', "PRINT")
-        scf_wfn.set_PCM(core.PCM(pcmsolver_parsed_fname, pcm_print_level, scf_wfn.basisset()))
+        pcm = core.PCM(pcmsolver_parsed_fname, pcm_print_level, scf_wfn.basisset())
+        pcm.set_screening_threshold(core.get_option('PCM', 'PCM_INTS_SCREENING'))
+        scf_wfn.set_PCM(pcm)
         core.print_out("""  PCM does not make use of molecular symmetry: """
                        """further calculations in C1 point group.\n""")
         use_c1 = True
@@ -1442,6 +1503,10 @@ def scf_helper(name, post_scf=True, **kwargs):
         scf_wfn.to_file(write_filename)
         extras.register_numpy_file(write_filename)
 
+    # The converged state supersedes any mid-iteration checkpoint and, unlike file 180, survives the job
+    if core.get_option('SCF', 'SCF_CHECKPOINT_FREQ') > 0:
+        core.CheckpointWriter(scf_wfn).write(scf_wfn.checkpoint_filename())
+
     if do_timer:
         core.tstop()
 
@@ -1503,7 +1568,7 @@ def run_dct(name, **kwargs):
 
     else:
         # Ensure IWL files have been written for non DF-DCT
-        proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+        proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
         dct_wfn = core.dct(ref_wfn)
 
     return dct_wfn
@@ -1962,7 +2027,7 @@ def run_occ(name, **kwargs):
         ref_wfn = scf_helper(name, **kwargs)  # C1 certified
 
     # Ensure IWL files have been written
-    proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+    proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
 
     if core.get_option('SCF', 'REFERENCE') == 'ROHF':
         ref_wfn.semicanonicalize()
@@ -2033,7 +2098,7 @@ def run_occ_gradient(name, **kwargs):
         ref_wfn = scf_helper(name, **kwargs)  # C1 certified
 
     # Ensure IWL files have been written
-    proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+    proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
 
     if core.get_option('SCF', 'REFERENCE') == 'ROHF':
         ref_wfn.semicanonicalize()
@@ -2178,7 +2243,8 @@ def run_scf_gradient(name, **kwargs):
         disp_grad = ref_wfn._disp_functor.compute_gradient(ref_wfn.molecule(), ref_wfn)
         ref_wfn.set_variable("-D Gradient", disp_grad)
 
-    grad = core.scfgrad(ref_wfn)
+    with proc_util.resolved_scf_type(ref_wfn):
+        grad = core.scfgrad(ref_wfn)
 
     if ref_wfn.basisset().has_ECP():
         core.print_out("\n\n  ==> Adding ECP gradient terms (computed numerically) <==\n")
@@ -2246,7 +2312,8 @@ def run_scf_hessian(name, **kwargs):
         disp_hess = ref_wfn._disp_functor.compute_hessian(ref_wfn.molecule(), ref_wfn)
         ref_wfn.set_variable("-D Hessian", disp_hess)
 
-    H = core.scfhess(ref_wfn)
+    with proc_util.resolved_scf_type(ref_wfn):
+        H = core.scfhess(ref_wfn)
     ref_wfn.set_hessian(H)
 
     # Clearly, add some logic when the reach of this fn expands
@@ -2285,6 +2352,7 @@ def run_dfmp2_gradient(name, **kwargs):
     if not core.has_global_option_changed('SCF_TYPE'):
         core.set_global_option('SCF_TYPE', 'DF')
         core.print_out("""    SCF Algorithm Type (re)set to DF.\n""")
+    proc_util.pin_auto_scf_type(kwargs.get('ref_wfn', None), 'DF')
 
     if "DF" not in core.get_global_option('SCF_TYPE'):
         raise ValidationError('DF-MP2 gradients need DF-SCF reference.')
@@ -2406,7 +2474,7 @@ def run_ccenergy(name, **kwargs):
         ref_wfn.set_basisset("DF_BASIS_CC", aux_basis)
 
     # Ensure IWL files have been written
-    proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+    proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
 
     # Obtain semicanonical orbitals
     if (core.get_option('SCF', 'REFERENCE') == 'ROHF') and \
@@ -2514,7 +2582,7 @@ def run_bccd(name, **kwargs):
         ref_wfn.semicanonicalize()
 
     # Ensure IWL files have been written
-    proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+    proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
 
     core.set_local_option('CCTRANSORT', 'DELETE_TEI', 'false')
 
@@ -2815,6 +2883,7 @@ def run_dfmp2_property(name, **kwargs):
     if not core.has_global_option_changed('SCF_TYPE'):
         core.set_global_option('SCF_TYPE', 'DF')  # local set insufficient b/c SCF option read in DFMP2
         core.print_out("""    SCF Algorithm Type (re)set to DF.\n""")
+    proc_util.pin_auto_scf_type(kwargs.get('ref_wfn', None), 'DF')
 
     if not 'DF' in core.get_global_option('SCF_TYPE'):
         raise ValidationError('DF-MP2 properties need DF-SCF reference.')
@@ -3056,7 +3125,7 @@ def run_adc(name, **kwargs):
         ref_wfn = scf_helper(name, **kwargs)
 
     # Ensure IWL files have been written
-    proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+    proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
 
     return core.adc(ref_wfn)
 
@@ -3137,7 +3206,7 @@ def run_detci(name, **kwargs):
         ref_wfn = scf_helper(name, **kwargs)  # C1 certified
 
     # Ensure IWL files have been written
-    proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+    proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
 
     ciwfn = core.detci(ref_wfn)
 
@@ -3332,6 +3401,9 @@ def run_dfep2(name, **kwargs):
         if core.variable("EP2 IONIZATION POTENTIAL") == 0.0:
             core.set_variable("CURRENT ENERGY", ea_vals[0])
 
+    for k in ["EP2 ITERATIONS", "EP2 STREAMED ITERATIONS"]:
+        core.set_variable(k, dfep2_wfn.variable(k))
+
     core.print_out("  EP2 has completed successfully!\n\n")
 
     core.tstop()
@@ -3353,7 +3425,7 @@ def run_dmrgscf(name, **kwargs):
         ref_wfn = scf_helper(name, **kwargs)
 
     # Ensure IWL files have been written
-    proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+    proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
 
     if 'CASPT2' in name.upper():
         core.set_local_option("DMRG", "DMRG_CASPT2_CALC", True)
@@ -3383,7 +3455,7 @@ def run_dmrgci(name, **kwargs):
         ref_wfn = scf_helper(name, **kwargs)
 
     # Ensure IWL files have been written
-    proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+    proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
 
     core.set_local_option('DMRG', 'DMRG_SCF_MAX_ITER', 1)
 
@@ -3458,6 +3530,8 @@ def run_sapt(name, **kwargs):
 
     # raise Exception("")
 
+    # ref_wfn only carries the molecule here, so AUTO cannot be taken from its SCF
+    proc_util.pin_auto_scf_type(None, 'DF')
     ri = core.get_global_option('SCF_TYPE')
     df_ints_io = core.get_option('SCF', 'DF_INTS_IO')
     # inquire if above at all applies to dfmp2
@@ -3621,6 +3695,8 @@ def run_sapt_ct(name, **kwargs):
     if core.get_option('SCF', 'REFERENCE') != 'RHF':
         raise ValidationError('SAPT requires requires \"reference rhf\".')
 
+    # ref_wfn only carries the molecule here, so AUTO cannot be taken from its SCF
+    proc_util.pin_auto_scf_type(None, 'DF')
     ri = core.get_global_option('SCF_TYPE')
     df_ints_io = core.get_option('SCF', 'DF_INTS_IO')
     # inquire if above at all applies to dfmp2
@@ -3981,7 +4057,7 @@ def run_fnodfcc(name, **kwargs):
         if type_val == 'CD':
             core.set_local_option('FNOCC', 'DF_BASIS_CC', 'CHOLESKY')
             # Alter default algorithm
-            if not core.has_global_option_changed('SCF_TYPE'):
+            if not core.has_global_option_changed('SCF_TYPE') or core.get_global_option('SCF_TYPE') == 'AUTO':
                 optstash.add_option(['SCF_TYPE'])
                 core.set_global_option('SCF_TYPE', 'CD')
                 core.print_out("""    SCF Algorithm Type (re)set to CD.\n""")
@@ -4136,7 +4212,7 @@ def run_fnocc(name, **kwargs):
 
     if core.get_option('FNOCC', 'USE_DF_INTS') == False:
         # Ensure IWL files have been written
-        proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+        proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
     else:
         core.print_out("  Constructing Basis Sets for FNOCC...\n\n")
         scf_aux_basis = core.BasisSet.build(ref_wfn.molecule(), "DF_BASIS_SCF",
@@ -4239,7 +4315,7 @@ def run_cepa(name, **kwargs):
 
     if core.get_option('FNOCC', 'USE_DF_INTS') == False:
         # Ensure IWL files have been written
-        proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+        proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
     else:
         core.print_out("  Constructing Basis Sets for FISAPT...\n\n")
         scf_aux_basis = core.BasisSet.build(ref_wfn.molecule(), "DF_BASIS_SCF",
@@ -4301,6 +4377,7 @@ def run_detcas(name, **kwargs):
         # No real reason to do a conventional guess
         if not core.has_global_option_changed('SCF_TYPE'):
             core.set_global_option('SCF_TYPE', 'DF')
+        proc_util.pin_auto_scf_type(None, 'DF')
 
         # If RHF get MP2 NO's
         # Why doesnt this work for conv?
@@ -4344,7 +4421,7 @@ def run_detcas(name, **kwargs):
             core.set_global_option('SCF_TYPE', 'PK')
 
         # Ensure IWL files have been written
-        proc_util.check_iwl_file_from_scf_type(core.get_global_option('SCF_TYPE'), ref_wfn)
+        proc_util.check_iwl_file_from_scf_type(proc_util.scf_type_of(ref_wfn), ref_wfn)
     else:
         raise ValidationError("Run DETCAS: MCSCF_TYPE %s not understood." % str(core.get_option('DETCI', 'MCSCF_TYPE')))
 
@@ -26,6 +26,8 @@
 # @END LICENSE
 #
 
+import contextlib
+
 import numpy as np
 
 from psi4 import core
@@ -90,13 +92,50 @@ def oeprop_validator(prop_list):
             raise ValidationError("OEProp: Feature '%s' is not recognized. %s" % (prop, alternatives))
 
 
+@contextlib.contextmanager
+def resolved_scf_type(wfn):
+    """
+    While active, SCF_TYPE AUTO reads as the algorithm the SCF of *wfn* ran
+    with, so that derivative codes reuse the same kind of integrals.
+    """
+    with p4util.OptionsStateCM(['SCF_TYPE']):
+        if core.get_global_option('SCF_TYPE') == 'AUTO' and hasattr(wfn, 'scf_type'):
+            core.set_global_option('SCF_TYPE', wfn.scf_type())
+        yield
+
+
+def scf_type_of(wfn):
+    """
+    Returns SCF_TYPE, with AUTO replaced by the algorithm the SCF of *wfn* ran
+    with when *wfn* knows it.
+    """
+    scf_type = core.get_global_option('SCF_TYPE')
+    if scf_type == 'AUTO' and hasattr(wfn, 'scf_type'):
+        scf_type = wfn.scf_type()
+    return scf_type
+
+
+def pin_auto_scf_type(wfn, fallback):
+    """
+    Replaces SCF_TYPE AUTO by the algorithm the SCF of *wfn* ran with, or by
+    *fallback* if no SCF has run yet, for methods that branch on SCF_TYPE
+    before or after their reference. The caller must stash SCF_TYPE.
+    """
+    if core.get_global_option('SCF_TYPE') == 'AUTO':
+        scf_type = scf_type_of(wfn)
+        if scf_type == 'AUTO':
+            scf_type = fallback
+        core.set_global_option('SCF_TYPE', scf_type)
+        core.print_out("""    SCF Algorithm Type AUTO set to %s.\n""" % scf_type)
+
+
 def check_iwl_file_from_scf_type(scf_type, wfn):
     """
     Ensures that a IWL file has been written based on input SCF type.
     """
 
-
-    if scf_type in ['DF', 'DISK_DF', 'MEM_DF', 'CD', 'PK', 'DIRECT']:
+    # AUTO resolves to one of DF, PK or DIRECT, none of which writes the IWL file
+    if scf_type in ['AUTO', 'DF', 'DISK_DF', 'MEM_DF', 'CD', 'PK', 'DIRECT']:
         mints = core.MintsHelper(wfn.basisset())
         if core.get_global_option("RELATIVISTIC") in ["X2C", "DKH"]:
             rel_bas = core.BasisSet.build(wfn.molecule(), "BASIS_RELATIVISTIC",
@@ -113,7 +152,7 @@ def check_non_symmetric_jk_density(name):
     Ensure non-symmetric density matrices are supported for the selected JK routine.
     """
     scf_type = core.get_global_option('SCF_TYPE')
-    supp_jk_type = ['DF', 'DISK_DF', 'MEM_DF', 'CD', 'PK', 'DIRECT', 'OUT_OF_CORE']
+    supp_jk_type = ['DF', 'DISK_DF', 'MEM_DF', 'CD', 'COSX', 'PK', 'DIRECT', 'OUT_OF_CORE']
     supp_string = ', '.join(supp_jk_type[:-1]) + ', or ' + supp_jk_type[-1] + '.'
 
     if scf_type not in supp_jk_type:
@@ -128,7 +167,7 @@ def check_disk_df(name, optstash):
     if not core.has_global_option_changed('SCF_TYPE'):
         core.set_global_option('SCF_TYPE', 'DISK_DF')
         core.print_out("""    Method '%s' requires SCF_TYPE = DISK_DF, setting.\n""" % name)
-    elif core.get_global_option('SCF_TYPE') == "DF":
+    elif core.get_global_option('SCF_TYPE') in ["DF", "AUTO"]:
         core.set_global_option('SCF_TYPE', 'DISK_DF')
         core.print_out("""    Method '%s' requires SCF_TYPE = DISK_DF, setting.\n""" % name)
     else:
@@ -120,67 +120,26 @@ def df_fdds_dispersion(primary, auxiliary, cache, leg_points=10, leg_lambda=0.3,
     # Nuke the densities
     del D
 
-    metric = fdds_obj.metric()
-    metric_inv = fdds_obj.metric_inv()
-
     # Integrate
     core.print_out("\n   => Time Integration <= \n\n")
 
-    val_pack = ("Omega", "Weight", "Disp20,u", "Disp20", "time [s]")
-    core.print_out("% 12s % 12s % 14s % 14s % 10s\n" % val_pack)
-    # print("% 12s % 12s % 14s % 14s % 10s" % val_pack)
+    val_pack = ("Omega", "Weight", "Disp20,u", "Disp20")
+    core.print_out("% 12s % 12s % 14s % 14s\n" % val_pack)
+    # print("% 12s % 12s % 14s % 14s" % val_pack)
     start_time = time.time()
 
-    total_uc = 0
-    total_c = 0
-
-    for point, weight in zip(*np.polynomial.legendre.leggauss(leg_points)):
-
-        omega = leg_lambda * (1.0 - point) / (1.0 + point)
-        lambda_scale = ((2.0 * leg_lambda) / (point + 1.0)**2)
-
-        # Monomer A
-        X_A = fdds_obj.form_unc_amplitude("A", omega)
-
-        # Coupled A
-        X_A_coupled = X_A.clone()
-        XSW_A = core.triplet(X_A, metric_inv, W_A, False, False, False)
+    points, weights = np.polynomial.legendre.leggauss(leg_points)
+    omegas = leg_lambda * (1.0 - points) / (1.0 + points)
+    lambda_scales = ((2.0 * leg_lambda) / (points + 1.0)**2)
 
-        amplitude_inv = metric.clone()
-        amplitude_inv.axpy(1.0, XSW_A)
-        nremoved = 0
-        amplitude = amplitude_inv.pseudoinverse(1.e-13, nremoved)
-        amplitude.transpose_this()  # Why is this coming out transposed?
-        X_A_coupled.axpy(-1.0, core.triplet(XSW_A, amplitude, X_A, False, False, False))
-        del XSW_A, amplitude
+    # All frequencies are handed over at once so the (Q|ia) integrals are streamed once per batch
+    values_uc, values_c = fdds_obj.dispersion_integrands(W_A, W_B, omegas.tolist())
+    fdds_time = time.time() - start_time
 
-        X_B = fdds_obj.form_unc_amplitude("B", omega)
-        # print(np.linalg.norm(X_B))
-
-        # Coupled B
-        X_B_coupled = X_B.clone()
-        XSW_B = core.triplet(X_B, metric_inv, W_B, False, False, False)
-
-        amplitude_inv = metric.clone()
-        amplitude_inv.axpy(1.0, XSW_B)
-        amplitude = amplitude_inv.pseudoinverse(1.e-13, nremoved)
-        amplitude.transpose_this()  # Why is this coming out transposed?
-        X_B_coupled.axpy(-1.0, core.triplet(XSW_B, amplitude, X_B, False, False, False))
-        del XSW_B, amplitude
-
-        # Make sure the results are symmetrized
-        for tensor in [X_A, X_B, X_A_coupled, X_B_coupled]:
-            tensor.add(tensor.transpose())
-            tensor.scale(0.5)
-
-        # Combine
-        tmp_uc = core.triplet(metric_inv, X_A, metric_inv, False, False, False)
-        value_uc = tmp_uc.vector_dot(X_B)
-        del tmp_uc
+    total_uc = 0
+    total_c = 0
 
-        tmp_c = core.triplet(metric_inv, X_A_coupled, metric_inv, False, False, False)
-        value_c = tmp_c.vector_dot(X_B_coupled)
-        del tmp_c
+    for omega, weight, lambda_scale, value_uc, value_c in zip(omegas, weights, lambda_scales, values_uc, values_c):
 
         # Tally
         total_uc += value_uc * weight * lambda_scale
@@ -189,16 +148,17 @@ def df_fdds_dispersion(primary, auxiliary, cache, leg_points=10, leg_lambda=0.3,
         if do_print:
             tmp_disp_unc = value_uc * weight * lambda_scale
             tmp_disp = value_c * weight * lambda_scale
-            fdds_time = time.time() - start_time
 
-            val_pack = (omega, weight, tmp_disp_unc, tmp_disp, fdds_time)
-            core.print_out("% 12.3e % 12.3e % 14.3e % 14.3e %10d\n" % val_pack)
-            # print("% 12.3e % 12.3e % 14.3e % 14.3e %10d" % val_pack)
+            val_pack = (omega, weight, tmp_disp_unc, tmp_disp)
+            core.print_out("% 12.3e % 12.3e % 14.3e % 14.3e\n" % val_pack)
+            # print("% 12.3e % 12.3e % 14.3e % 14.3e" % val_pack)
 
     Disp20_uc = -1.0 / (2.0 * np.pi) * total_uc
     Disp20_c = -1.0 / (2.0 * np.pi) * total_c
 
     core.print_out("\n")
+    if do_print:
+        core.print_out("   Time Integration: %10.3f [s]\n\n" % fdds_time)
     core.print_out(print_sapt_var("Disp20,u", Disp20_uc, short=True) + "\n")
     core.print_out(print_sapt_var("Disp20", Disp20_c, short=True) + "\n")
 
@@ -60,19 +60,22 @@ def scf_compute_energy(self):
     returns the SCF energy computed by finalize_energy().
 
     """
-    if core.get_option('SCF', 'DF_SCF_GUESS') and (core.get_global_option('SCF_TYPE') == 'DIRECT'):
+    if core.get_option('SCF', 'DF_SCF_GUESS') and (self.scf_type() == 'DIRECT'):
         # speed up DIRECT algorithm (recomputes full (non-DF) integrals
         #   each iter) by first converging via fast DF iterations, then
         #   fully converging in fewer slow DIRECT iterations. aka Andy trick 2.0
         core.print_out("  Starting with a DF guess...\n\n")
         with p4util.OptionsStateCM(['SCF_TYPE']):
             core.set_global_option('SCF_TYPE', 'DF')
+            self.set_scf_type('DF')
             self.initialize()
             try:
                 self.iterations()
             except SCFConvergenceError:
                 self.finalize()
                 raise SCFConvergenceError("""SCF DF preiterations""", self.iteration_, self, 0, 0)
+            finally:
+                self.set_scf_type('DIRECT')
         core.print_out("\n  DF guess converged.\n\n")
 
         # reset the DIIS & JK objects in prep for DIRECT
@@ -103,6 +106,7 @@ def scf_compute_energy(self):
 def _build_jk(wfn, memory):
     jk = core.JK.build(wfn.get_basisset("ORBITAL"),
                        aux=wfn.get_basisset("DF_BASIS_SCF"),
+                       jk_type=wfn.scf_type(),
                        do_wK=wfn.functional().is_x_lrc(),
                        memory=memory)
     return jk
@@ -238,7 +242,7 @@ def scf_initialize(self):
 
 def scf_iterate(self, e_conv=None, d_conv=None):
 
-    is_dfjk = core.get_global_option('SCF_TYPE').endswith('DF')
+    is_dfjk = self.scf_type().endswith('DF')
     verbose = core.get_option('SCF', "PRINT")
     reference = core.get_option('SCF', "REFERENCE")
 
@@ -251,6 +255,7 @@ def scf_iterate(self, e_conv=None, d_conv=None):
     frac_enabled = _validate_frac()
     efp_enabled = hasattr(self.molecule(), 'EFP')
     diis_rms = core.get_option('SCF', 'DIIS_RMS_ERROR')
+    checkpoint_freq = core.get_option('SCF', 'SCF_CHECKPOINT_FREQ')
 
     if self.iteration_ < 2:
         core.print_out("  ==> Iterations <==\n\n")
@@ -445,6 +450,10 @@ def scf_iterate(self, e_conv=None, d_conv=None):
             ("DF-" if is_dfjk else "", reference, "SAD" if
              ((self.iteration_ == 0) and self.sad_) else self.iteration_, SCFE, Ediff, Dnorm, '/'.join(status)))
 
+        # Write a restart checkpoint of the current orbitals
+        if checkpoint_freq > 0 and self.iteration_ > 0 and (self.iteration_ % checkpoint_freq == 0):
+            core.CheckpointWriter(self).write(self.checkpoint_filename(), SCFE, self.iteration_)
+
         # if a an excited MOM is requested but not started, don't stop yet
         if self.MOM_excited_ and not self.MOM_performed_:
             continue
@@ -579,7 +588,7 @@ def scf_finalize_energy(self):
     if core.get_option('SCF', 'PRINT') > 0:
         self.print_orbitals()
 
-    is_dfjk = core.get_global_option('SCF_TYPE').endswith('DF')
+    is_dfjk = self.scf_type().endswith('DF')
     core.print_out("  @%s%s Final Energy: %20.14f" % ('DF-' if is_dfjk else '', reference, energy))
     # if (perturb_h_) {
     #     core.print_out(" with %f %f %f perturbation" %
@@ -695,6 +704,14 @@ def scf_print_energies(self):
     self.set_variable('SCF ITERATIONS', self.iteration_)
 
 
+def scf_checkpoint_filename(self):
+    """Returns the name of the binary restart checkpoint written when SCF_CHECKPOINT_FREQ is set."""
+    filename = core.get_option('SCF', 'SCF_CHECKPOINT_FILE')
+    if not filename:
+        filename = core.get_writer_file_prefix(self.molecule().name()) + ".chk"
+    return filename
+
+
 def scf_print_preiterations(self):
     ct = self.molecule().point_group().char_table()
 
@@ -722,6 +739,7 @@ core.HF.compute_energy = scf_compute_energy
 core.HF.finalize_energy = scf_finalize_energy
 core.HF.print_energies = scf_print_energies
 core.HF.print_preiterations = scf_print_preiterations
+core.HF.checkpoint_filename = scf_checkpoint_filename
 
 
 def _converged(e_delta, d_rms, e_conv=None, d_conv=None):
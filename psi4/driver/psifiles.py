@@ -52,6 +52,7 @@ PSIF_PSIMRCC_INTEGRALS      =   50  #
 PSIF_PSIMRCC_RESTART        =   51  # 
 PSIF_MCSCF                  =   52  # 
 PSIF_TPDM_HALFTRANS         =   53  # 
+PSIF_SO_TEI_RUNS            =   54  # scratch file for sorted runs while writing sorted-format SO integrals
 PSIF_DETCAS                 =   60  # 
 PSIF_LIBTRANS_DPD           =   61  # libtrans: All transformed integrals in DPD format are sent here by default
 PSIF_LIBTRANS_A_HT          =   62  # libtrans: Alpha half-transformed integrals in DPD format
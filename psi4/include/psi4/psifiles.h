@@ -79,6 +79,7 @@
 /* MCSCF files */
 #define PSIF_MCSCF               52   /*-  -*/
 #define PSIF_TPDM_HALFTRANS      53   /*-  -*/
+#define PSIF_SO_TEI_RUNS         54   /*- scratch file for sorted runs while writing sorted-format SO integrals -*/
 #define PSIF_DETCAS              60   /*-  -*/
 // The integral files used by libtrans
 #define PSIF_LIBTRANS_DPD        61   /*- libtrans: All transformed integrals in DPD format are sent here by default -*/
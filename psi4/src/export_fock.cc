@@ -55,6 +55,11 @@ void export_fock(py::module &m) {
                     [](std::shared_ptr<BasisSet> basis, std::shared_ptr<BasisSet> aux, bool do_wK, size_t doubles) {
                         return JK::build_JK(basis, aux, Process::environment.options, do_wK, doubles);
                     })
+        .def_static("select_type",
+                    [](std::shared_ptr<BasisSet> basis, std::shared_ptr<BasisSet> aux, bool do_wK, size_t doubles) {
+                        return JK::select_JK_type(basis, aux, Process::environment.options, do_wK, doubles);
+                    },
+                    "Returns the SCF_TYPE predicted to be fastest for this basis and memory (in doubles)")
         .def("name", &JK::name)
         .def("memory_estimate", &JK::memory_estimate)
         .def("initialize", &JK::initialize)
@@ -88,7 +93,7 @@ void export_fock(py::module &m) {
         .def("print_header", &JK::print_header, "docstring");
 
     py::class_<MemDFJK, std::shared_ptr<MemDFJK>, JK>(m, "MemDFJK", "docstring")
-        .def("dfh", &MemDFJK::dfh, "Return the DFHelper object.");
+        .def("dfh", &MemDFJK::dfh, "Return the DFHelper object, not available with local fitting.");
 
     py::class_<LaplaceDenominator, std::shared_ptr<LaplaceDenominator>>(m, "LaplaceDenominator", "docstring")
         .def(py::init<std::shared_ptr<Vector>, std::shared_ptr<Vector>, double>())
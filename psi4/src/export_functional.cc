@@ -291,6 +291,9 @@ void export_functional(py::module &m) {
         .def("s8", &Dispersion::get_s8, "docstring")
         .def("a1", &Dispersion::get_a1, "docstring")
         .def("a2", &Dispersion::get_a2, "docstring")
+        .def("cutoff", &Dispersion::cutoff, "Neighbor cutoff [bohr] of the pair list, zero if all pairs are kept.")
+        .def("set_cutoff", &Dispersion::set_cutoff,
+             "Sets the neighbor cutoff [bohr] of the pair list (zero disables it).")
         .def("print_out", &Dispersion::py_print, "docstring");
 
     py::class_<sapt::FDDS_Dispersion, std::shared_ptr<sapt::FDDS_Dispersion>>(m, "FDDS_Dispersion", "docstring")
@@ -302,5 +305,13 @@ void export_functional(py::module &m) {
         .def("project_densities", &sapt::FDDS_Dispersion::project_densities,
              "Projects a density from the primary AO to auxiliary AO space.")
         .def("form_unc_amplitude", &sapt::FDDS_Dispersion::form_unc_amplitude,
-             "Forms the uncoupled amplitudes for either monomer.");
+             "Forms the uncoupled amplitudes for either monomer.")
+        .def("form_unc_amplitudes", &sapt::FDDS_Dispersion::form_unc_amplitudes, "monomer"_a, "omegas"_a,
+             "doubles"_a = 0,
+             "Forms the uncoupled amplitudes of several frequencies for either monomer within a memory "
+             "budget in doubles (zero for 80% of the memory setting).")
+        .def("form_coupled_amplitude", &sapt::FDDS_Dispersion::form_coupled_amplitude,
+             "Forms the coupled amplitude from an uncoupled amplitude and a monomer kernel.")
+        .def("dispersion_integrands", &sapt::FDDS_Dispersion::dispersion_integrands,
+             "Computes the uncoupled and coupled dispersion integrands at each frequency.");
 }
@@ -60,6 +60,7 @@
 #include "psi4/libmints/kinetic.h"
 #include "psi4/libmints/factory.h"
 #include "psi4/libmints/writer.h"
+#include "psi4/libmints/checkpoint.h"
 #include "psi4/libmints/corrtab.h"
 #include "psi4/libmints/electricfield.h"
 #include "psi4/libmints/tracelessquadrupole.h"
@@ -1410,6 +1411,7 @@ void export_mints(py::module& m) {
     typedef std::shared_ptr<BasisSet> (BasisSet::*ptrversion)(const std::shared_ptr<BasisSet>&) const;
     typedef int (BasisSet::*ncore_no_args)() const;
     typedef int (BasisSet::*ncore_one_arg)(const std::string&) const;
+    typedef std::vector<SharedMatrix> (BasisSet::*phi_batch_matrix)(SharedMatrix, int, double, int) const;
 
     py::class_<BasisSet, std::shared_ptr<BasisSet>>(m, "BasisSet", "Contains basis set information", py::dynamic_attr())
         .def(py::init<const std::string&, std::shared_ptr<Molecule>,
@@ -1471,6 +1473,12 @@ void export_mints(py::module& m) {
         .def("max_function_per_shell", &BasisSet::max_function_per_shell,
              "The max number of basis functions in a shell")
         .def("max_nprimitive", &BasisSet::max_nprimitive, "The max number of primitives in a shell")
+        .def("shell_extents", &BasisSet::shell_extents,
+             "Radius beyond which the functions of each shell are below the cutoff delta", "delta"_a)
+        .def("compute_phi_batch", phi_batch_matrix(&BasisSet::compute_phi_batch),
+             "Evaluates the basis functions (deriv=0) and their gradients (deriv=1) at the rows of an npoints x 3 "
+             "matrix of coordinates in bohr. Returns [PHI] or [PHI, PHI_X, PHI_Y, PHI_Z], each npoints x nbf.",
+             "points"_a, "deriv"_a = 0, "delta"_a = 1.0E-12, "block_size"_a = 128)
         .def_static("construct_from_pydict", &construct_basisset_from_pydict, "docstring");
 
     py::class_<SOBasisSet, std::shared_ptr<SOBasisSet>>(
@@ -1486,6 +1494,9 @@ void export_mints(py::module& m) {
         .def("addBasis", &ExternalPotential::addBasis, "Add a basis of S auxiliary functions iwth Df coefficients",
              "basis"_a, "coefs"_a)
         .def("clear", &ExternalPotential::clear, "Reset the field to zero (eliminates all entries)")
+        .def("setNearFieldRadius", &ExternalPotential::setNearFieldRadius,
+             "Set the radius [bohr] beyond which charges are replaced by fitted equivalent charges", "radius"_a)
+        .def("nearFieldRadius", &ExternalPotential::nearFieldRadius, "The near-field radius [bohr]")
         .def("computePotentialMatrix", &ExternalPotential::computePotentialMatrix,
              "Compute the external potential matrix in the given basis set", "basis"_a)
         .def("print_out", &ExternalPotential::py_print, "Print python print helper to the outfile");
@@ -1527,6 +1538,37 @@ void export_mints(py::module& m) {
         .def(py::init<std::shared_ptr<Wavefunction>>())
         .def("write", &MOWriter::write, "Write the MOs");  // should the writer.h file take a filename as an argument?
 
+    typedef void (CheckpointWriter::*checkpoint_write_final)(const std::string&);
+    typedef void (CheckpointWriter::*checkpoint_write_iter)(const std::string&, double, int);
+
+    py::class_<CheckpointWriter, std::shared_ptr<CheckpointWriter>>(
+        m, "CheckpointWriter", "Writes the SCF state of a wavefunction to a binary checkpoint file")
+        .def(py::init<std::shared_ptr<Wavefunction>>())
+        .def("write", checkpoint_write_final(&CheckpointWriter::write),
+             "Atomically write the checkpoint file for a converged wavefunction", "filename"_a)
+        .def("write", checkpoint_write_iter(&CheckpointWriter::write),
+             "Atomically write a mid-iteration checkpoint file", "filename"_a, "energy"_a, "iteration"_a);
+
+    py::class_<CheckpointReader, std::shared_ptr<CheckpointReader>>(
+        m, "CheckpointReader", "Memory-mapped, random-access reader for binary checkpoint files")
+        .def(py::init<const std::string&>())
+        .def_static("basis_fingerprint", &CheckpointReader::basis_fingerprint,
+                    "Fingerprint of the shell structure of a basis set", "basis"_a)
+        .def("filename", &CheckpointReader::filename, "The checkpoint file name")
+        .def("fingerprint", &CheckpointReader::fingerprint, "Fingerprint of the basis the checkpoint was written with")
+        .def("compatible", &CheckpointReader::compatible,
+             "Was the checkpoint written with the basis set and point group of this wavefunction?", "wfn"_a)
+        .def("has_entry", &CheckpointReader::has_entry, "Is the section present?", "label"_a)
+        .def("labels", &CheckpointReader::labels, "Labels of all sections in the file")
+        .def("scalar", &CheckpointReader::scalar, "Read a scalar section", "label"_a)
+        .def("integer", &CheckpointReader::integer, "Read an integer section", "label"_a)
+        .def("text", &CheckpointReader::text, "Read a text section", "label"_a)
+        .def("dimension", &CheckpointReader::dimension, "Read a per-irrep dimension section", "label"_a)
+        .def("vector", &CheckpointReader::vector, "Read a vector section", "label"_a)
+        .def("matrix", &CheckpointReader::matrix, "Read a matrix section", "label"_a)
+        .def("matrix_columns", &CheckpointReader::matrix_columns,
+             "Read only the leading columns per irrep of a matrix section", "label"_a, "ncolpi"_a);
+
     py::class_<OperatorSymmetry, std::shared_ptr<OperatorSymmetry>>(m, "MultipoleSymmetry", "docstring")
         .def(py::init<int, const std::shared_ptr<Molecule>&, const std::shared_ptr<IntegralFactory>&,
                       const std::shared_ptr<MatrixFactory>&>())
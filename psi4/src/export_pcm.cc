@@ -48,6 +48,9 @@ void export_pcm(py::module& m) {
 
     pcm.def(py::init<std::string, int, std::shared_ptr<BasisSet>>())
         .def("compute_PCM_terms", &PCM::compute_PCM_terms, "Compute PCM contributions to energy and Fock matrix", "D"_a,
-             "type"_a);
+             "type"_a)
+        .def("set_screening_threshold", &PCM::set_screening_threshold,
+             "Set the magnitude below which contributions to the tessera potential integrals are neglected",
+             "threshold"_a);
 }
 #endif
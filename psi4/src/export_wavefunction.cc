@@ -222,6 +222,8 @@ void export_wavefunction(py::module& m) {
         .def("form_Shalf", &scf::HF::form_Shalf, "Forms the S^1/2 matrix")
         .def("guess", &scf::HF::guess, "Forms the guess (guarantees C, D, and E)")
         .def("initialize_gtfock_jk", &scf::HF::initialize_gtfock_jk, "Sets up a GTFock JK object")
+        .def("scf_type", &scf::HF::scf_type, "The SCF algorithm this wavefunction runs with.")
+        .def("set_scf_type", &scf::HF::set_scf_type, "Sets the SCF algorithm, e.g. the one SCF_TYPE AUTO resolved to.")
         .def("onel_Hx", &scf::HF::onel_Hx, "One-electron Hessian-vector products.")
         .def("twoel_Hx", &scf::HF::twoel_Hx, "Two-electron Hessian-vector products")
         .def("cphf_Hx", &scf::HF::cphf_Hx, "CPHF Hessian-vector prodcuts (4 * J - K - K.T).")
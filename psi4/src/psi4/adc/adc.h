@@ -77,9 +77,12 @@ class ADCWfn : public Wavefunction {
     double rhf_init_tensors();
     double rhf_differentiate_omega(int irrep, int root);
     void rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, double *eps);
-    void rhf_construct_sigma(int irrep, int root);
-    void shift_denom2(int root, int irrep, double omega);
+    void rhf_construct_sigma(int irrep, int first, int last);
     void shift_denom4(int irrep, double omega);
+    void rhf_read_ov(int filenum, const char *label, int irrep, double *v);
+    void rhf_write_ov(int filenum, const char *label, int irrep, const double *v);
+    bool cache_tensor(int filenum, int irrep, int pqnum, int rsnum, const char *label);
+    void uncache_tensor(int filenum, int irrep, int pqnum, int rsnum, const char *label);
 
     // Number of the singly excited configurations
     int nxs_;
@@ -80,6 +80,10 @@ double ADCWfn::compute_energy() {
     psio_->open(PSIF_ADC_SEM, PSIO_OPEN_OLD);
     psio_->open(PSIF_ADC, PSIO_OPEN_OLD);
 
+    // The integrals contracted with every trial vector are kept in core for the whole calculation when they fit
+    bool ovvv_cached = cache_tensor(PSIF_LIBTRANS_DPD, 0, ID("[O,V]"), ID("[V,V]"), "MO Ints <OV|VV>");
+    bool oovo_cached = cache_tensor(PSIF_LIBTRANS_DPD, 0, ID("[O,O]"), ID("[V,O]"), "MO Ints <OO|VO>");
+
     for (int irrep = 0; irrep < nirrep_; irrep++) {
         if (rpi_[irrep]) {
             omega = init_array(rpi_[irrep]);
@@ -278,6 +282,9 @@ double ADCWfn::compute_energy() {
         }
     }
 
+    if (oovo_cached) uncache_tensor(PSIF_LIBTRANS_DPD, 0, ID("[O,O]"), ID("[V,O]"), "MO Ints <OO|VO>");
+    if (ovvv_cached) uncache_tensor(PSIF_LIBTRANS_DPD, 0, ID("[O,V]"), ID("[V,V]"), "MO Ints <OV|VV>");
+
     psio_->close(PSIF_ADC, 1);
     psio_->close(PSIF_ADC_SEM, 1);
     psio_->close(PSIF_LIBTRANS_DPD, 1);
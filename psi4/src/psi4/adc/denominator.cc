@@ -33,38 +33,6 @@
 namespace psi {
 namespace adc {
 
-void ADCWfn::shift_denom2(int root, int irrep, double omega) {
-    char lbl[32];
-    dpdfile2 D, L;
-
-    sprintf(lbl, "D_[%d]12", irrep);
-    global_dpd_->file2_init(&D, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-    global_dpd_->file2_mat_init(&D);
-    global_dpd_->file2_mat_rd(&D);
-
-    sprintf(lbl, "L^(%d)_[%d]12", root, irrep);
-    global_dpd_->file2_init(&L, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-    global_dpd_->file2_mat_init(&L);
-    global_dpd_->file2_mat_rd(&L);
-
-    for (int Isym = 0; Isym < nirrep_; Isym++) {
-        for (int i = 0; i < D.params->rowtot[Isym]; i++) {
-            for (int a = 0; a < D.params->coltot[Isym ^ irrep]; a++) {
-                double denom = omega - D.matrix[Isym][i][a];
-                if (std::fabs(denom) > 1e-6)
-                    L.matrix[Isym][i][a] = 1 / denom;
-                else
-                    L.matrix[Isym][i][a] = 0;
-            }
-        }
-    }
-    global_dpd_->file2_mat_wrt(&L);
-    global_dpd_->file2_mat_close(&L);
-    global_dpd_->file2_close(&L);
-    global_dpd_->file2_mat_close(&D);
-    global_dpd_->file2_close(&D);
-}
-
 void ADCWfn::shift_denom4(int irrep, double omega) {
     char lbl[32];
     dpdbuf4 D;
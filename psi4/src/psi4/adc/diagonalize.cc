@@ -34,6 +34,7 @@
 #include "psi4/libqt/qt.h"
 #include "psi4/libciomr/libciomr.h"
 #include <cmath>
+#include <cstring>
 #include "adc.h"
 
 namespace psi {
@@ -41,171 +42,196 @@ namespace adc {
 
 //
 //  This block-Davidson code is based on the in-core version put in lib/libqt/david.cc
-//  but written by utilizind DPD algorithm.
+//  but written by utilizind DPD algorithm. The trial and sigma vectors live on disk as DPD
+//  two-index files and are packed into core once per iteration, so the mini-Hamiltonian,
+//  the correction vectors and the collapse are all done as matrix products over the roots.
 //
 //  S: Sigma vector for the response matrix with OV indices.
 //  F: The correction vectors for the basis of Ritz space.
 //  V: Converged eigenvectors.
 //
 
+void ADCWfn::rhf_read_ov(int filenum, const char *label, int irrep, double *v) {
+    dpdfile2 X;
+
+    global_dpd_->file2_init(&X, filenum, irrep, ID('O'), ID('V'), label);
+    global_dpd_->file2_mat_init(&X);
+    global_dpd_->file2_mat_rd(&X);
+    for (int h = 0; h < nirrep_; h++) {
+        size_t size = (size_t)X.params->rowtot[h] * X.params->coltot[h ^ irrep];
+        if (size) ::memcpy(v, X.matrix[h][0], size * sizeof(double));
+        v += size;
+    }
+    global_dpd_->file2_mat_close(&X);
+    global_dpd_->file2_close(&X);
+}
+
+void ADCWfn::rhf_write_ov(int filenum, const char *label, int irrep, const double *v) {
+    dpdfile2 X;
+
+    global_dpd_->file2_init(&X, filenum, irrep, ID('O'), ID('V'), label);
+    global_dpd_->file2_mat_init(&X);
+    for (int h = 0; h < nirrep_; h++) {
+        size_t size = (size_t)X.params->rowtot[h] * X.params->coltot[h ^ irrep];
+        if (size) ::memcpy(X.matrix[h][0], v, size * sizeof(double));
+        v += size;
+    }
+    global_dpd_->file2_mat_wrt(&X);
+    global_dpd_->file2_mat_close(&X);
+    global_dpd_->file2_close(&X);
+}
+
+// Pulls a four-index tensor into the DPD cache if it fits into half of the free DPD memory.
+// Returns whether this call added it, so that the caller knows to release it again.
+bool ADCWfn::cache_tensor(int filenum, int irrep, int pqnum, int rsnum, const char *label) {
+    dpdfile4 X;
+
+    global_dpd_->file4_init(&X, filenum, irrep, pqnum, rsnum, label);
+    long int size = 0;
+    for (int h = 0; h < nirrep_; h++) size += (long int)X.params->rowtot[h] * X.params->coltot[h ^ irrep];
+    bool cached = !X.incore && 2 * size < dpd_memfree();
+    if (cached) {
+        global_dpd_->file4_cache_add(&X, 0);
+        global_dpd_->file4_cache_lock(&X);
+    }
+    global_dpd_->file4_close(&X);
+    return cached;
+}
+
+void ADCWfn::uncache_tensor(int filenum, int irrep, int pqnum, int rsnum, const char *label) {
+    dpdfile4 X;
+
+    global_dpd_->file4_init(&X, filenum, irrep, pqnum, rsnum, label);
+    if (X.incore) global_dpd_->file4_cache_del(&X);
+    global_dpd_->file4_close(&X);
+}
+
 void ADCWfn::rhf_diagonalize(int irrep, int num_root, bool first, double omega_in, double *eps) {
     char lbl[32];
     int iter, converged, prev_length, length, *conv, skip_check, maxdim, *residual_ok;
-    double **Alpha, **G, *lambda, *lambda_o, *residual_norm, cutoff;
-    dpdfile2 B, S, Bp, Bn, F, L, V;
-    dpdfile4 A;
+    double **Alpha, **G, **X, **B, **S, **F, *lambda, *lambda_o, *residual_norm, *denom, cutoff;
 
-    maxdim = 10 * rpi_[irrep];
+    int nroot = rpi_[irrep];
+    int nxs = nxspi_[irrep];
+    maxdim = 10 * nroot;
     iter = 0;
     converged = 0;
     cutoff = conv_;
-    length = rpi_[irrep];
+    length = nroot;
     prev_length = 0;
 
-    residual_ok = init_int_array(rpi_[irrep]);
-    residual_norm = init_array(rpi_[irrep]);
-    conv = init_int_array(rpi_[irrep]);
+    residual_ok = init_int_array(nroot);
+    residual_norm = init_array(nroot);
+    conv = init_int_array(nroot);
 
     G = block_matrix(maxdim, maxdim);
     Alpha = block_matrix(maxdim, maxdim);
+    X = block_matrix(maxdim, maxdim);
     lambda = init_array(maxdim);
     lambda_o = init_array(maxdim);
 
-    for (int I = 0; I < rpi_[irrep]; I++) lambda_o[I] = omega_guess_->get(irrep, I);
+    // Room for the current subspace plus one new vector per root
+    B = block_matrix(maxdim + nroot, nxs);
+    S = block_matrix(maxdim, nxs);
+    F = block_matrix(nroot, nxs);
+    denom = init_array(nxs);
+
+    for (int I = 0; I < nroot; I++) lambda_o[I] = omega_guess_->get(irrep, I);
     shift_denom4(irrep, omega_in);
+    sprintf(lbl, "D_[%d]1234", irrep);
+    bool denom_cached = cache_tensor(PSIF_ADC_SEM, irrep, ID("[O,O]"), ID("[V,V]"), lbl);
+    sprintf(lbl, "D_[%d]12", irrep);
+    rhf_read_ov(PSIF_ADC_SEM, lbl, irrep, denom);
+
+    for (int I = 0; I < length; I++) {
+        sprintf(lbl, "B^(%d)_[%d]12", I, irrep);
+        rhf_read_ov(PSIF_ADC, lbl, irrep, B[I]);
+    }
 
     auto mode = std::ostream::app;
     auto printer = std::make_shared<PsiOutStream>("iter.dat", mode);
 
     timer_on("SEM");
-    while (converged < rpi_[irrep] && iter < sem_max_) {
+    while (converged < nroot && iter < sem_max_) {
         skip_check = 0;
         printer->Printf("\niter = %d, dim = %d\n", iter, length);
 
-        // Evaluating the sigma vectors
+        // Evaluating the sigma vectors of all the new trial vectors together
         timer_on("Sigma construction");
-        for (int I = prev_length; I < length; I++)
-            if (!nopen_) rhf_construct_sigma(irrep, I);
+        if (!nopen_) rhf_construct_sigma(irrep, prev_length, length);
         timer_off("Sigma construction");
-
-        // Making so called Davidson mini-Hamiltonian, or Rayleigh matrix
         for (int I = prev_length; I < length; I++) {
             sprintf(lbl, "S^(%d)_[%d]12", I, irrep);
-            global_dpd_->file2_init(&S, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-            for (int J = 0; J <= I; J++) {
-                sprintf(lbl, "B^(%d)_[%d]12", J, irrep);
-                global_dpd_->file2_init(&B, PSIF_ADC, irrep, ID('O'), ID('V'), lbl);
-                double sum = global_dpd_->file2_dot(&B, &S);
-                if (I != J)
-                    G[I][J] = G[J][I] = sum;
-                else
-                    G[I][J] = sum;
-                global_dpd_->file2_close(&B);
-            }
-            global_dpd_->file2_close(&S);
+            rhf_read_ov(PSIF_ADC_SEM, lbl, irrep, S[I]);
         }
+
+        // Making so called Davidson mini-Hamiltonian, or Rayleigh matrix
+        C_DGEMM('n', 't', length, length, nxs, 1.0, S[0], nxs, B[0], nxs, 0.0, X[0], maxdim);
+        for (int I = 0; I < length; I++)
+            for (int J = 0; J <= I; J++) G[I][J] = G[J][I] = X[I][J];
         if (first && !iter) poles_[irrep][num_root - 1].ps_value = G[num_root - 1][num_root - 1];
         sq_rsp(length, length, G, lambda, 1, Alpha, 1e-12);
 
-        // Constructing the corretion vectors
-        for (int k = 0; k < rpi_[irrep]; k++) {
-            sprintf(lbl, "F^(%d)_[%d]12", k, irrep);
-            global_dpd_->file2_init(&F, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-            global_dpd_->file2_scm(&F, 0.0);
-            for (int I = 0; I < length; I++) {
-                sprintf(lbl, "B^(%d)_[%d]12", I, irrep);
-                global_dpd_->file2_init(&B, PSIF_ADC, irrep, ID('O'), ID('V'), lbl);
-                global_dpd_->file2_axpy(&B, &F, -Alpha[I][k] * lambda[k], 0);
-                global_dpd_->file2_close(&B);
-                sprintf(lbl, "S^(%d)_[%d]12", I, irrep);
-                global_dpd_->file2_init(&S, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-                global_dpd_->file2_axpy(&S, &F, Alpha[I][k], 0);
-                global_dpd_->file2_close(&S);
+        // Constructing the corretion vectors, F_k = \sum_I \alpha_{Ik} (S_I - \lambda_k B_I) / (\lambda_k - D)
+        C_DGEMM('t', 'n', nroot, nxs, length, 1.0, Alpha[0], maxdim, S[0], nxs, 0.0, F[0], nxs);
+        for (int I = 0; I < length; I++)
+            for (int k = 0; k < nroot; k++) X[I][k] = Alpha[I][k] * lambda[k];
+        C_DGEMM('t', 'n', nroot, nxs, length, -1.0, X[0], maxdim, B[0], nxs, 1.0, F[0], nxs);
+
+#pragma omp parallel for schedule(static)
+        for (int k = 0; k < nroot; k++) {
+            for (int ia = 0; ia < nxs; ia++) {
+                double shift = lambda[k] - denom[ia];
+                F[k][ia] = std::fabs(shift) > 1e-6 ? F[k][ia] / shift : 0.0;
             }
-            shift_denom2(k, irrep, lambda[k]);
-            sprintf(lbl, "L^(%d)_[%d]12", k, irrep);
-            global_dpd_->file2_init(&L, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-            global_dpd_->file2_dirprd(&L, &F);
-            global_dpd_->file2_close(&L);
-
-            double norm = global_dpd_->file2_dot_self(&F);
-            residual_norm[k] = sqrt(norm);
+            residual_norm[k] = std::sqrt(C_DDOT(nxs, F[k], 1, F[k], 1));
             if (residual_norm[k] > norm_tol_)
-                global_dpd_->file2_scm(&F, 1 / residual_norm[k]);
+                C_DSCAL(nxs, 1 / residual_norm[k], F[k], 1);
             else {
-                global_dpd_->file2_scm(&F, 0.0);
+                ::memset(F[k], 0, nxs * sizeof(double));
                 residual_ok[k] = 1;
             }
-            global_dpd_->file2_close(&F);
         }
 
         prev_length = length;
 
         // Expand the Ritz space by orthogonalizing {F} to {B} according to Gram-Schmidt procedure
-        for (int k = 0; k < rpi_[irrep]; k++) {
-            sprintf(lbl, "F^(%d)_[%d]12", k, irrep);
-            global_dpd_->file2_init(&F, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-            sprintf(lbl, "Bpp_[%d]12", irrep);
-            global_dpd_->file2_copy(&F, PSIF_ADC_SEM, lbl);
-            for (int I = 0; I < length; I++) {
-                sprintf(lbl, "B^(%d)_[%d]12", I, irrep);
-                global_dpd_->file2_init(&B, PSIF_ADC, irrep, ID('O'), ID('V'), lbl);
-                double coeff = -global_dpd_->file2_dot(&F, &B);
-                sprintf(lbl, "Bpp_[%d]12", irrep);
-                global_dpd_->file2_init(&Bp, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-                global_dpd_->file2_axpy(&B, &Bp, coeff, 0.0);
-                global_dpd_->file2_close(&B);
-                global_dpd_->file2_close(&Bp);
-            }
-            global_dpd_->file2_close(&F);
-            sprintf(lbl, "Bpp_[%d]12", irrep);
-            global_dpd_->file2_init(&B, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-            double norm = global_dpd_->file2_dot_self(&B);
-            norm = sqrt(norm);
+        for (int k = 0; k < nroot; k++) {
+            double *Bpp = B[length];
+            C_DCOPY(nxs, F[k], 1, Bpp, 1);
+            C_DGEMV('n', length, nxs, 1.0, B[0], nxs, F[k], 1, 0.0, X[0], 1);
+            C_DGEMV('t', length, nxs, -1.0, B[0], nxs, X[0], 1, 1.0, Bpp, 1);
+            double norm = std::sqrt(C_DDOT(nxs, Bpp, 1, Bpp, 1));
 
             if (norm > norm_tol_) {
-                global_dpd_->file2_scm(&B, 1 / norm);
+                C_DSCAL(nxs, 1 / norm, Bpp, 1);
                 sprintf(lbl, "B^(%d)_[%d]12", length, irrep);
-                global_dpd_->file2_copy(&B, PSIF_ADC, lbl);
+                rhf_write_ov(PSIF_ADC, lbl, irrep, Bpp);
                 length++;
             }
-            global_dpd_->file2_close(&B);
         }
 
-        if (maxdim - length < rpi_[irrep] || (nxspi_[irrep] - length) < rpi_[irrep]) {
+        if (maxdim - length < nroot || (nxs - length) < nroot) {
             printer->Printf("Subspace too large:maxdim = %d, L = %d\n", maxdim, length);
             printer->Printf("Collapsing eigenvectors.\n");
 
-            for (int k = 0; k < rpi_[irrep]; k++) {
-                sprintf(lbl, "Bn^(%d)_[%d]12", k, irrep);
-                global_dpd_->file2_init(&Bn, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
-                global_dpd_->file2_scm(&Bn, 0.0);
-                for (int I = 0; I < prev_length; I++) {
-                    sprintf(lbl, "B^(%d)_[%d]12", I, irrep);
-                    global_dpd_->file2_init(&B, PSIF_ADC, irrep, ID('O'), ID('V'), lbl);
-                    global_dpd_->file2_axpy(&B, &Bn, Alpha[I][k], 0);
-                    global_dpd_->file2_close(&B);
-                }
-                global_dpd_->file2_close(&Bn);
-            }
-            for (int k = 0; k < rpi_[irrep]; k++) {
-                sprintf(lbl, "Bn^(%d)_[%d]12", k, irrep);
-                global_dpd_->file2_init(&Bn, PSIF_ADC_SEM, irrep, ID('O'), ID('V'), lbl);
+            C_DGEMM('t', 'n', nroot, nxs, prev_length, 1.0, Alpha[0], maxdim, B[0], nxs, 0.0, F[0], nxs);
+            for (int k = 0; k < nroot; k++) {
+                C_DCOPY(nxs, F[k], 1, B[k], 1);
                 sprintf(lbl, "B^(%d)_[%d]12", k, irrep);
-                global_dpd_->file2_copy(&Bn, PSIF_ADC, lbl);
-                global_dpd_->file2_close(&Bn);
+                rhf_write_ov(PSIF_ADC, lbl, irrep, B[k]);
             }
             skip_check = 1;
-            length = rpi_[irrep];
+            length = nroot;
             prev_length = 0;
         }
 
         if (!skip_check) {
-            zero_int_array(conv, rpi_[irrep]);
+            zero_int_array(conv, nroot);
             printer->Printf("Root          Eigenvalue   Delta     Res_Norm     Conv?\n");
             printer->Printf("----     ---------------- -------    --------- ----------\n");
 
-            for (int k = 0; k < rpi_[irrep]; k++) {
+            for (int k = 0; k < nroot; k++) {
                 double diff = std::fabs(lambda[k] - lambda_o[k]);
                 if (diff < cutoff && residual_ok[k]) {
                     conv[k] = 1;
@@ -222,18 +248,12 @@ void ADCWfn::rhf_diagonalize(int irrep, int num_root, bool first, double omega_i
 
         if (all_conv == num_root && converged >= num_root) {
             printer->Printf("Davidson algorithm converged in %d iterations for %dth root.\n", iter, num_root - 1);
+            // The Ritz vectors are expanded in the subspace the Rayleigh matrix was built in
+            C_DGEMM('t', 'n', num_root, nxs, prev_length, 1.0, Alpha[0], maxdim, B[0], nxs, 0.0, F[0], nxs);
             for (int I = 0; I < num_root; I++) {
                 eps[I] = lambda[I];
                 sprintf(lbl, "V^(%d)_[%d]12", I, irrep);
-                global_dpd_->file2_init(&V, PSIF_ADC, irrep, ID('O'), ID('V'), lbl);
-                global_dpd_->file2_scm(&V, 0.0);
-                for (int k = 0; k < length; k++) {
-                    sprintf(lbl, "B^(%d)_[%d]12", k, irrep);
-                    global_dpd_->file2_init(&B, PSIF_ADC, irrep, ID('O'), ID('V'), lbl);
-                    global_dpd_->file2_axpy(&B, &V, Alpha[k][I], 0);
-                    global_dpd_->file2_close(&B);
-                }
-                global_dpd_->file2_close(&V);
+                rhf_write_ov(PSIF_ADC, lbl, irrep, F[I]);
             }
             break;
         }
@@ -241,11 +261,19 @@ void ADCWfn::rhf_diagonalize(int irrep, int num_root, bool first, double omega_i
     }
     timer_off("SEM");
 
+    sprintf(lbl, "D_[%d]1234", irrep);
+    if (denom_cached) uncache_tensor(PSIF_ADC_SEM, irrep, ID("[O,O]"), ID("[V,V]"), lbl);
+
     free(residual_ok);
     free(residual_norm);
     free(conv);
     free_block(G);
     free_block(Alpha);
+    free_block(X);
+    free_block(B);
+    free_block(S);
+    free_block(F);
+    free(denom);
     free(lambda);
     free(lambda_o);
 }
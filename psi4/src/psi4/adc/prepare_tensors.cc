@@ -46,6 +46,9 @@
 //         independently from the trial vector in the SEM procedure.
 //  AVV  : Tensor with OO indices that represents the time reversed contribution from the above one.
 //  D    : Diagonal elements packed in DPD fashon of two index tensors, which is used in diagonalization step.
+//  ASS  : A3h3p plus the two 3h-3p diagrams that the sigma construction used to rebuild from the trial vector
+//         through DOV and EOV. Both are linear in the trial vector, so the whole frequency independent part of
+//         the singles-singles block is assembled once here.
 //
 
 namespace psi {
@@ -233,6 +236,29 @@ void ADCWfn::rhf_prepare_tensors() {
     }
     global_dpd_->buf4_close(&Aovov);
 
+    global_dpd_->buf4_init(&K, PSIF_ADC, 0, ID("[O,O]"), ID("[V,V]"), ID("[O,O]"), ID("[V,V]"), 0, ampname);
+    global_dpd_->buf4_sort(&K, PSIF_ADC_SEM, prqs, ID("[O,V]"), ID("[O,V]"), "K (OV|OV)");
+    global_dpd_->buf4_close(&K);
+    global_dpd_->buf4_init(&V, PSIF_LIBTRANS_DPD, 0, ID("[O,O]"), ID("[V,V]"), ID("[O,O]"), ID("[V,V]"), 0,
+                           "MO Ints 2 V1234 - V1243");
+    global_dpd_->buf4_sort(&V, PSIF_ADC_SEM, prqs, ID("[O,V]"), ID("[O,V]"), "V (OV|OV)");
+    global_dpd_->buf4_close(&V);
+
+    global_dpd_->buf4_init(&Aovov, PSIF_ADC_SEM, 0, ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), 0, "A3h3p1234");
+    global_dpd_->buf4_copy(&Aovov, PSIF_ADC_SEM, "ASS1234");
+    global_dpd_->buf4_close(&Aovov);
+
+    global_dpd_->buf4_init(&Aovov, PSIF_ADC_SEM, 0, ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), 0, "ASS1234");
+    global_dpd_->buf4_init(&K, PSIF_ADC_SEM, 0, ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), 0, "K (OV|OV)");
+    global_dpd_->buf4_init(&V, PSIF_ADC_SEM, 0, ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), ID("[O,V]"), 0, "V (OV|OV)");
+    // ASS_{iajb} <-- 0.5 \sum_{kc} (2 K_{ikac} - K_{ikca}) (2 <kj|cb> - <kj|bc>)
+    global_dpd_->contract444(&K, &V, &Aovov, 0, 1, 0.5, 1);
+    // ASS_{iajb} <-- 0.5 \sum_{kc} (2 <ik|ac> - <ik|ca>) (2 K_{kjcb} - K_{kjbc})
+    global_dpd_->contract444(&V, &K, &Aovov, 0, 1, 0.5, 1);
+    global_dpd_->buf4_close(&V);
+    global_dpd_->buf4_close(&K);
+    global_dpd_->buf4_close(&Aovov);
+
     psio_->close(PSIF_ADC, 1);
     psio_->close(PSIF_ADC_SEM, 1);
     psio_->close(PSIF_LIBTRANS_DPD, 1);
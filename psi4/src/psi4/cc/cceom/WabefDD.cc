@@ -33,6 +33,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include "psi4/libciomr/libciomr.h"
 #include "psi4/libpsio/psio.h"
 #include "psi4/libqt/qt.h"
@@ -48,52 +50,118 @@ namespace cceom {
 
 void c_clean(dpdfile2 *CME, dpdfile2 *Cme, dpdbuf4 *CMNEF, dpdbuf4 *Cmnef, dpdbuf4 *CMnEf);
 
-/* This function computes the H-bar doubles-doubles block contribution
-   from Wabef to a Sigma vector stored at Sigma plus 'i' */
+/* Z_k(pq,ij) = alpha * B(pq,rs) C_k(ij,rs) + beta * Z_k(pq,ij) for a set of trial vectors C_k.
+   Each row block of B is read once and contracted against every C_k while it is resident, so the
+   <ab|cd>-sized integrals are streamed once per batch rather than once per vector.  The C_k and Z_k
+   irrep blocks are held in core; if they do not fit, the batch is split, and if not even two fit we
+   fall back to contract444() vector by vector. */
+static void contract_batch(dpdbuf4 *B, std::vector<dpdbuf4> &C, std::vector<dpdbuf4> &Z, double alpha, double beta) {
+    int nvec = C.size();
+    int nirreps = B->params->nirreps;
+    int B_irr = B->file.my_irrep;
+    int C_irr = C[0].file.my_irrep;
+    long int memfree = dpd_memfree();
+    long int maxvec = nvec;
+
+    for (int h = 0; h < nirreps; h++) {
+        int Gij = h ^ B_irr ^ C_irr;
+        long int nlinks = B->params->coltot[h ^ B_irr];
+        long int vecsize = (long int)C[0].params->rowtot[Gij] * (nlinks + B->params->rowtot[h]);
+        if (vecsize) maxvec = std::min(maxvec, (memfree - nlinks) / vecsize);
+    }
 
-void WabefDD(int i, int C_irr) {
-    dpdfile2 tIA, tia, SIA, Sia;
-    dpdbuf4 SIJAB, Sijab, SIjAb, B;
-    dpdbuf4 CMNEF, Cmnef, CMnEf, X, F, tau, D, WM, WP, Z;
-    char CMNEF_lbl[32], Cmnef_lbl[32], CMnEf_lbl[32];
-    char SIJAB_lbl[32], Sijab_lbl[32], SIjAb_lbl[32], SIA_lbl[32], Sia_lbl[32];
-    char lbl_a[32], lbl_s[32];
-    dpdbuf4 tau_a, tau_s;
-    dpdbuf4 B_a, B_s;
-    dpdbuf4 S, A;
-    double **B_diag, **tau_diag;
+    if (nvec == 1 || maxvec < 2) {
+        for (int k = 0; k < nvec; k++) global_dpd_->contract444(B, &C[k], &Z[k], 0, 0, alpha, beta);
+        return;
+    }
+
+    for (int k0 = 0; k0 < nvec; k0 += maxvec) {
+        int k1 = std::min((long int)nvec, k0 + maxvec);
+        for (int h = 0; h < nirreps; h++) {
+            int Gij = h ^ B_irr ^ C_irr;
+            int nrows = B->params->rowtot[h];
+            int ncols = C[k0].params->rowtot[Gij];
+            int nlinks = B->params->coltot[h ^ B_irr];
+
+            for (int k = k0; k < k1; k++) {
+                global_dpd_->buf4_mat_irrep_init(&C[k], Gij);
+                global_dpd_->buf4_mat_irrep_rd(&C[k], Gij);
+                global_dpd_->buf4_mat_irrep_init(&Z[k], h);
+                if (beta != 0.0) global_dpd_->buf4_mat_irrep_rd(&Z[k], h);
+            }
+
+            if (nrows && ncols && nlinks) {
+                int rows_per_bucket = dpd_memfree() / nlinks;
+                if (rows_per_bucket > nrows) rows_per_bucket = nrows;
+                if (rows_per_bucket < 1) rows_per_bucket = 1;
+                global_dpd_->buf4_mat_irrep_init_block(B, h, rows_per_bucket);
+                for (int row_start = 0; row_start < nrows; row_start += rows_per_bucket) {
+                    int nbrows = std::min(rows_per_bucket, nrows - row_start);
+                    global_dpd_->buf4_mat_irrep_rd_block(B, h, row_start, nbrows);
+                    for (int k = k0; k < k1; k++)
+                        C_DGEMM('n', 't', nbrows, ncols, nlinks, alpha, B->matrix[h][0], nlinks, C[k].matrix[Gij][0],
+                                nlinks, beta, Z[k].matrix[h][row_start], ncols);
+                }
+                global_dpd_->buf4_mat_irrep_close_block(B, h, rows_per_bucket);
+            }
+
+            for (int k = k0; k < k1; k++) {
+                global_dpd_->buf4_mat_irrep_wrt(&Z[k], h);
+                global_dpd_->buf4_mat_irrep_close(&Z[k], h);
+                global_dpd_->buf4_mat_irrep_close(&C[k], Gij);
+            }
+        }
+    }
+}
+
+/* RHF-reference Wabef contribution for the trial vectors listed in vecs.  The <ab|cd> and <ia|bc>
+   contractions are carried out for the whole set at once with contract_batch(); temporaries are
+   labeled by position in the batch so that they are overwritten, not accumulated, on later calls. */
+static void WabefDD_RHF(const std::vector<int> &vecs, int C_irr) {
+    dpdfile2 tIA;
+    dpdbuf4 SIjAb, B, CMnEf, X, F, tau, D, Z;
+    dpdbuf4 tau_a, B_a, B_s, S, A;
+    char CMnEf_lbl[32], SIjAb_lbl[32], lbl_a[32], lbl_s[32], lbl[32];
+    double **B_diag;
     int ij, Gc, C, c, cc;
-    int nbuckets, rows_per_bucket, rows_left, m, row_start, ab, cd, dc, d;
+    int nbuckets, rows_per_bucket, rows_left, m, row_start;
     int nrows, ncols, nlinks;
     psio_address next;
+    int nvec = vecs.size();
+    std::vector<dpdbuf4> Cb(nvec), Zb(nvec);
 
-    if (params.eom_ref == 0) { /* RHF */
-        /* SIjAb += WAbEf*CIjEf */
-        sprintf(SIjAb_lbl, "%s %d", "SIjAb", i);
-        sprintf(CMnEf_lbl, "%s %d", "CMnEf", i);
+    /* SIjAb += <Ab|Ef> CIjEf -- allow out of core algorithm */
 
-        /* SIjAb += <Ab|Ef> CIjEf -- allow out of core algorithm */
+    timer_on("WabefDD Z");
 
-        timer_on("WabefDD Z");
+    if (params.abcd == "OLD") {
+        for (int k = 0; k < nvec; k++) {
+            sprintf(CMnEf_lbl, "%s %d", "CMnEf", vecs[k]);
+            sprintf(lbl, "WabefDD Z(Ab,Ij) %d", k);
+            global_dpd_->buf4_init(&Cb[k], PSIF_EOM_CMnEf, C_irr, 0, 5, 0, 5, 0, CMnEf_lbl);
+            global_dpd_->buf4_init(&Zb[k], PSIF_EOM_TMP, C_irr, 5, 0, 5, 0, 0, lbl);
+        }
+        global_dpd_->buf4_init(&B, PSIF_CC_BINTS, H_IRR, 5, 5, 5, 5, 0, "B <ab|cd>");
+        contract_batch(&B, Cb, Zb, 1.0, 0.0);
+        global_dpd_->buf4_close(&B);
 
-        if (params.abcd == "OLD") {
-            global_dpd_->buf4_init(&CMnEf, PSIF_EOM_CMnEf, C_irr, 0, 5, 0, 5, 0, CMnEf_lbl);
-            global_dpd_->buf4_init(&Z, PSIF_EOM_TMP, C_irr, 5, 0, 5, 0, 0, "WabefDD Z(Ab,Ij)");
-            global_dpd_->buf4_init(&B, PSIF_CC_BINTS, H_IRR, 5, 5, 5, 5, 0, "B <ab|cd>");
-            global_dpd_->contract444(&B, &CMnEf, &Z, 0, 0, 1.0, 0.0);
-            global_dpd_->buf4_close(&B);
-            global_dpd_->buf4_close(&CMnEf);
-            global_dpd_->buf4_sort(&Z, PSIF_EOM_TMP, rspq, 0, 5, "WabefDD Z(Ij,Ab)");
-            global_dpd_->buf4_close(&Z);
+        for (int k = 0; k < nvec; k++) {
+            global_dpd_->buf4_close(&Cb[k]);
+            global_dpd_->buf4_sort(&Zb[k], PSIF_EOM_TMP, rspq, 0, 5, "WabefDD Z(Ij,Ab)");
+            global_dpd_->buf4_close(&Zb[k]);
 
+            sprintf(SIjAb_lbl, "%s %d", "SIjAb", vecs[k]);
             global_dpd_->buf4_init(&SIjAb, PSIF_EOM_SIjAb, C_irr, 0, 5, 0, 5, 0, SIjAb_lbl);
             global_dpd_->buf4_init(&Z, PSIF_EOM_TMP, C_irr, 0, 5, 0, 5, 0, "WabefDD Z(Ij,Ab)");
             global_dpd_->buf4_axpy(&Z, &SIjAb, 1);
             global_dpd_->buf4_close(&Z);
             global_dpd_->buf4_close(&SIjAb);
-        } else if (params.abcd == "NEW") {
-            sprintf(lbl_a, "CMnEf(-)(mn,ef) %d", i);
-            sprintf(lbl_s, "CMnEf(+)(mn,ef) %d", i);
+        }
+    } else if (params.abcd == "NEW") {
+        for (int k = 0; k < nvec; k++) {
+            sprintf(CMnEf_lbl, "%s %d", "CMnEf", vecs[k]);
+            sprintf(lbl_a, "CMnEf(-)(mn,ef) %d", vecs[k]);
+            sprintf(lbl_s, "CMnEf(+)(mn,ef) %d", vecs[k]);
 
             /* L_a(-)(ij,ab) (i>j, a>b) = L(ij,ab) - L(ij,ba) */
             global_dpd_->buf4_init(&tau_a, PSIF_EOM_CMnEf, C_irr, 4, 9, 0, 5, 1, CMnEf_lbl);
@@ -108,116 +176,148 @@ void WabefDD(int i, int C_irr) {
             global_dpd_->buf4_init(&tau_a, PSIF_EOM_TMP, C_irr, 3, 8, 0, 5, 0, lbl_s);
             global_dpd_->buf4_copy(&tau_a, PSIF_EOM_CMnEf, lbl_s);
             global_dpd_->buf4_close(&tau_a);
+        }
 
-            timer_on("ABCD:S");
-            global_dpd_->buf4_init(&tau_s, PSIF_EOM_CMnEf, C_irr, 3, 8, 3, 8, 0, lbl_s);
-            global_dpd_->buf4_init(&B_s, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
-            global_dpd_->buf4_init(&S, PSIF_EOM_TMP, C_irr, 8, 3, 8, 3, 0, "S(ab,ij)");
-            global_dpd_->contract444(&B_s, &tau_s, &S, 0, 0, 0.5, 0);
-            global_dpd_->buf4_close(&S);
-            global_dpd_->buf4_close(&B_s);
-            global_dpd_->buf4_close(&tau_s);
-            timer_off("ABCD:S");
-
-            /* L_diag(ij,c)  = 2 * L(ij,cc)*/
-
-            /* NB: Gcc = 0, and B is totally symmetric, so Gab = 0 */
-            /* But Gij = L_irr ^ Gab = L_irr */
-            global_dpd_->buf4_init(&tau, PSIF_EOM_CMnEf, C_irr, 3, 8, 3, 8, 0, lbl_s);
-            global_dpd_->buf4_mat_irrep_init(&tau, C_irr);
-            global_dpd_->buf4_mat_irrep_rd(&tau, C_irr);
-            tau_diag = global_dpd_->dpd_block_matrix(tau.params->rowtot[C_irr], moinfo.nvirt);
-            for (ij = 0; ij < tau.params->rowtot[C_irr]; ij++)
-                for (Gc = 0; Gc < moinfo.nirreps; Gc++)
-                    for (C = 0; C < moinfo.virtpi[Gc]; C++) {
-                        c = C + moinfo.vir_off[Gc];
-                        cc = tau.params->colidx[c][c];
-                        tau_diag[ij][c] = tau.matrix[C_irr][ij][cc];
-                    }
-            global_dpd_->buf4_mat_irrep_close(&tau, C_irr);
-
-            global_dpd_->buf4_init(&B_s, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
-            global_dpd_->buf4_init(&S, PSIF_EOM_TMP, C_irr, 8, 3, 8, 3, 0, "S(ab,ij)");
-            global_dpd_->buf4_mat_irrep_init(&S, 0);
-            global_dpd_->buf4_mat_irrep_rd(&S, 0);
+        timer_on("ABCD:S");
+        for (int k = 0; k < nvec; k++) {
+            sprintf(lbl_s, "CMnEf(+)(mn,ef) %d", vecs[k]);
+            sprintf(lbl, "S(ab,ij) %d", k);
+            global_dpd_->buf4_init(&Cb[k], PSIF_EOM_CMnEf, C_irr, 3, 8, 3, 8, 0, lbl_s);
+            global_dpd_->buf4_init(&Zb[k], PSIF_EOM_TMP, C_irr, 8, 3, 8, 3, 0, lbl);
+        }
+        global_dpd_->buf4_init(&B_s, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
+        contract_batch(&B_s, Cb, Zb, 0.5, 0);
+        global_dpd_->buf4_close(&B_s);
+        timer_off("ABCD:S");
+
+        /* L_diag(ij,c)  = 2 * L(ij,cc)*/
+
+        /* NB: Gcc = 0, and B is totally symmetric, so Gab = 0 */
+        /* But Gij = L_irr ^ Gab = L_irr */
+        ncols = Cb[0].params->rowtot[C_irr];
+        nlinks = moinfo.nvirt;
+        global_dpd_->buf4_init(&B_s, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
+
+        /* Each vector holds its L_diag and its Z(ab,ij) block in core while B(+) <ab|cc> streams past;
+           split the batch so that those blocks leave room for at least one row of B */
+        long int row_size = B_s.params->coltot[0] + moinfo.nvirt;
+        long int vecsize = (long int)ncols * nlinks + (long int)Zb[0].params->rowtot[0] * Zb[0].params->coltot[C_irr];
+        long int maxvec = nvec;
+        if (vecsize) maxvec = std::min(maxvec, (dpd_memfree() - row_size) / vecsize);
+        if (maxvec < 1) maxvec = 1;
+
+        std::vector<double **> tau_diag(nvec);
+        for (int k0 = 0; k0 < nvec; k0 += maxvec) {
+            int k1 = std::min((long int)nvec, k0 + maxvec);
+            for (int k = k0; k < k1; k++) {
+                tau_diag[k] = global_dpd_->dpd_block_matrix(ncols, nlinks);
+                global_dpd_->buf4_mat_irrep_init(&Cb[k], C_irr);
+                global_dpd_->buf4_mat_irrep_rd(&Cb[k], C_irr);
+                for (ij = 0; ij < ncols; ij++)
+                    for (Gc = 0; Gc < moinfo.nirreps; Gc++)
+                        for (C = 0; C < moinfo.virtpi[Gc]; C++) {
+                            c = C + moinfo.vir_off[Gc];
+                            cc = Cb[k].params->colidx[c][c];
+                            tau_diag[k][ij][c] = Cb[k].matrix[C_irr][ij][cc];
+                        }
+                global_dpd_->buf4_mat_irrep_close(&Cb[k], C_irr);
+                global_dpd_->buf4_mat_irrep_init(&Zb[k], 0);
+                global_dpd_->buf4_mat_irrep_rd(&Zb[k], 0);
+            }
 
-            rows_per_bucket = dpd_memfree() / (B_s.params->coltot[0] + moinfo.nvirt);
+            rows_per_bucket = dpd_memfree() / row_size;
+            if (!rows_per_bucket) global_dpd_->dpd_error("WabefDD: Not enough memory for one row!", "outfile");
             if (rows_per_bucket > B_s.params->rowtot[0]) rows_per_bucket = B_s.params->rowtot[0];
-            nbuckets = (int)ceil((double)B_s.params->rowtot[0] / (double)rows_per_bucket);
-            rows_left = B_s.params->rowtot[0] % rows_per_bucket;
-
-            B_diag = global_dpd_->dpd_block_matrix(rows_per_bucket, moinfo.nvirt);
-            next = PSIO_ZERO;
-            ncols = tau.params->rowtot[C_irr];
-            nlinks = moinfo.nvirt;
-            for (m = 0; m < (rows_left ? nbuckets - 1 : nbuckets); m++) {
-                row_start = m * rows_per_bucket;
-                nrows = rows_per_bucket;
-                if (nrows && ncols && nlinks) {
-                    psio_read(PSIF_CC_BINTS, "B(+) <ab|cc>", (char *)B_diag[0], sizeof(double) * nrows * nlinks, next,
-                              &next);
-                    C_DGEMM('n', 't', nrows, ncols, nlinks, -0.25, B_diag[0], nlinks, tau_diag[0], nlinks, 1,
-                            S.matrix[0][row_start], ncols);
+            if (rows_per_bucket) {
+                nbuckets = (int)ceil((double)B_s.params->rowtot[0] / (double)rows_per_bucket);
+                rows_left = B_s.params->rowtot[0] % rows_per_bucket;
+
+                B_diag = global_dpd_->dpd_block_matrix(rows_per_bucket, moinfo.nvirt);
+                next = PSIO_ZERO;
+                for (m = 0; m < nbuckets; m++) {
+                    row_start = m * rows_per_bucket;
+                    nrows = (rows_left && m == nbuckets - 1) ? rows_left : rows_per_bucket;
+                    if (nrows && ncols && nlinks) {
+                        psio_read(PSIF_CC_BINTS, "B(+) <ab|cc>", (char *)B_diag[0], sizeof(double) * nrows * nlinks,
+                                  next, &next);
+                        for (int k = k0; k < k1; k++)
+                            C_DGEMM('n', 't', nrows, ncols, nlinks, -0.25, B_diag[0], nlinks, tau_diag[k][0], nlinks,
+                                    1, Zb[k].matrix[0][row_start], ncols);
+                    }
                 }
+                global_dpd_->free_dpd_block(B_diag, rows_per_bucket, moinfo.nvirt);
             }
-            if (rows_left) {
-                row_start = m * rows_per_bucket;
-                nrows = rows_left;
-                if (nrows && ncols && nlinks) {
-                    psio_read(PSIF_CC_BINTS, "B(+) <ab|cc>", (char *)B_diag[0], sizeof(double) * nrows * nlinks, next,
-                              &next);
-                    C_DGEMM('n', 't', nrows, ncols, nlinks, -0.25, B_diag[0], nlinks, tau_diag[0], nlinks, 1,
-                            S.matrix[0][row_start], ncols);
-                }
+
+            for (int k = k0; k < k1; k++) {
+                global_dpd_->buf4_mat_irrep_wrt(&Zb[k], 0);
+                global_dpd_->buf4_mat_irrep_close(&Zb[k], 0);
+                global_dpd_->free_dpd_block(tau_diag[k], ncols, nlinks);
             }
-            global_dpd_->buf4_mat_irrep_wrt(&S, 0);
-            global_dpd_->buf4_mat_irrep_close(&S, 0);
-            global_dpd_->buf4_close(&S);
-            global_dpd_->buf4_close(&B_s);
-            global_dpd_->free_dpd_block(B_diag, rows_per_bucket, moinfo.nvirt);
-            global_dpd_->free_dpd_block(tau_diag, tau.params->rowtot[C_irr], moinfo.nvirt);
-            global_dpd_->buf4_close(&tau);
-
-            timer_on("ABCD:A");
-            global_dpd_->buf4_init(&tau_a, PSIF_EOM_CMnEf, C_irr, 4, 9, 4, 9, 0, lbl_a);
-            global_dpd_->buf4_init(&B_a, PSIF_CC_BINTS, 0, 9, 9, 9, 9, 0, "B(-) <ab|cd> - <ab|dc>");
-            global_dpd_->buf4_init(&A, PSIF_EOM_TMP, C_irr, 9, 4, 9, 4, 0, "A(ab,ij)");
-            global_dpd_->contract444(&B_a, &tau_a, &A, 0, 0, 0.5, 0);
-            global_dpd_->buf4_close(&A);
-            global_dpd_->buf4_close(&B_a);
-            global_dpd_->buf4_close(&tau_a);
-            timer_off("ABCD:A");
+        }
+        global_dpd_->buf4_close(&B_s);
+        for (int k = 0; k < nvec; k++) {
+            global_dpd_->buf4_close(&Zb[k]);
+            global_dpd_->buf4_close(&Cb[k]);
+        }
 
-            timer_on("ABCD:axpy");
-            global_dpd_->buf4_init(&S, PSIF_EOM_TMP, C_irr, 5, 0, 8, 3, 0, "S(ab,ij)");
+        timer_on("ABCD:A");
+        for (int k = 0; k < nvec; k++) {
+            sprintf(lbl_a, "CMnEf(-)(mn,ef) %d", vecs[k]);
+            sprintf(lbl, "A(ab,ij) %d", k);
+            global_dpd_->buf4_init(&Cb[k], PSIF_EOM_CMnEf, C_irr, 4, 9, 4, 9, 0, lbl_a);
+            global_dpd_->buf4_init(&Zb[k], PSIF_EOM_TMP, C_irr, 9, 4, 9, 4, 0, lbl);
+        }
+        global_dpd_->buf4_init(&B_a, PSIF_CC_BINTS, 0, 9, 9, 9, 9, 0, "B(-) <ab|cd> - <ab|dc>");
+        contract_batch(&B_a, Cb, Zb, 0.5, 0);
+        global_dpd_->buf4_close(&B_a);
+        for (int k = 0; k < nvec; k++) {
+            global_dpd_->buf4_close(&Zb[k]);
+            global_dpd_->buf4_close(&Cb[k]);
+        }
+        timer_off("ABCD:A");
+
+        timer_on("ABCD:axpy");
+        for (int k = 0; k < nvec; k++) {
+            sprintf(SIjAb_lbl, "%s %d", "SIjAb", vecs[k]);
+            sprintf(lbl, "S(ab,ij) %d", k);
+            global_dpd_->buf4_init(&S, PSIF_EOM_TMP, C_irr, 5, 0, 8, 3, 0, lbl);
             global_dpd_->buf4_sort_axpy(&S, PSIF_EOM_SIjAb, rspq, 0, 5, SIjAb_lbl, 1);
             global_dpd_->buf4_close(&S);
-            global_dpd_->buf4_init(&A, PSIF_EOM_TMP, C_irr, 5, 0, 9, 4, 0, "A(ab,ij)");
+            sprintf(lbl, "A(ab,ij) %d", k);
+            global_dpd_->buf4_init(&A, PSIF_EOM_TMP, C_irr, 5, 0, 9, 4, 0, lbl);
             global_dpd_->buf4_sort_axpy(&A, PSIF_EOM_SIjAb, rspq, 0, 5, SIjAb_lbl, 1);
             global_dpd_->buf4_close(&A);
-            timer_off("ABCD:axpy");
         }
+        timer_off("ABCD:axpy");
+    }
 
-        timer_off("WabefDD Z");
+    timer_off("WabefDD Z");
 
-        /* construct XIjMb = CIjEf * <mb|ef> */
-        global_dpd_->buf4_init(&X, PSIF_EOM_TMP, C_irr, 10, 0, 10, 0, 0, "WabefDD X(Mb,Ij)");
-        global_dpd_->buf4_init(&CMnEf, PSIF_EOM_CMnEf, C_irr, 0, 5, 0, 5, 0, CMnEf_lbl);
-        global_dpd_->buf4_init(&F, PSIF_CC_FINTS, H_IRR, 10, 5, 10, 5, 0, "F <ia|bc>");
-        global_dpd_->contract444(&F, &CMnEf, &X, 0, 0, 1.0, 0.0);
-        global_dpd_->buf4_close(&F);
-        global_dpd_->buf4_close(&CMnEf);
+    /* construct XIjMb = CIjEf * <mb|ef> */
+    for (int k = 0; k < nvec; k++) {
+        sprintf(CMnEf_lbl, "%s %d", "CMnEf", vecs[k]);
+        sprintf(lbl, "WabefDD X(Mb,Ij) %d", k);
+        global_dpd_->buf4_init(&Cb[k], PSIF_EOM_CMnEf, C_irr, 0, 5, 0, 5, 0, CMnEf_lbl);
+        global_dpd_->buf4_init(&Zb[k], PSIF_EOM_TMP, C_irr, 10, 0, 10, 0, 0, lbl);
+    }
+    global_dpd_->buf4_init(&F, PSIF_CC_FINTS, H_IRR, 10, 5, 10, 5, 0, "F <ia|bc>");
+    contract_batch(&F, Cb, Zb, 1.0, 0.0);
+    global_dpd_->buf4_close(&F);
+    for (int k = 0; k < nvec; k++) global_dpd_->buf4_close(&Cb[k]);
+
+    for (int k = 0; k < nvec; k++) {
+        sprintf(CMnEf_lbl, "%s %d", "CMnEf", vecs[k]);
+        sprintf(SIjAb_lbl, "%s %d", "SIjAb", vecs[k]);
 
         global_dpd_->buf4_init(&Z, PSIF_EOM_TMP, C_irr, 5, 0, 5, 0, 0, "WabefDD Z(Ab,Ij)");
         global_dpd_->file2_init(&tIA, PSIF_CC_OEI, H_IRR, 0, 1, "tIA");
-        /* outfile->Printf("\n begin contract244 in WabefDD\n"); */
-        global_dpd_->contract244(&tIA, &X, &Z, 0, 0, 0, 1.0, 0.0);
+        global_dpd_->contract244(&tIA, &Zb[k], &Z, 0, 0, 0, 1.0, 0.0);
         global_dpd_->file2_close(&tIA);
-        /* dpd_buf4_print(&Z,outfile,1); */
-        global_dpd_->buf4_close(&X);
+        global_dpd_->buf4_close(&Zb[k]);
 
         global_dpd_->buf4_sort_axpy(&Z, PSIF_EOM_SIjAb, rspq, 0, 5, SIjAb_lbl, -1);
         global_dpd_->buf4_sort_axpy(&Z, PSIF_EOM_SIjAb, srqp, 0, 5, SIjAb_lbl, -1);
+        global_dpd_->buf4_close(&Z);
 
         /* SIjAb += tau_MnAb <Mn||ef> CIjEf */
         global_dpd_->buf4_init(&SIjAb, PSIF_EOM_SIjAb, C_irr, 0, 5, 0, 5, 0, SIjAb_lbl);
@@ -233,6 +333,22 @@ void WabefDD(int i, int C_irr) {
         global_dpd_->buf4_close(&X);
         global_dpd_->buf4_close(&SIjAb);
     }
+}
+
+/* This function computes the H-bar doubles-doubles block contribution
+   from Wabef to a Sigma vector stored at Sigma plus 'i' */
+
+void WabefDD(int i, int C_irr) {
+    dpdfile2 tIA, tia, SIA, Sia;
+    dpdbuf4 SIJAB, Sijab, SIjAb, B;
+    dpdbuf4 CMNEF, Cmnef, CMnEf, X, F, tau, D, WM, WP, Z;
+    char CMNEF_lbl[32], Cmnef_lbl[32], CMnEf_lbl[32];
+    char SIJAB_lbl[32], Sijab_lbl[32], SIjAb_lbl[32], SIA_lbl[32], Sia_lbl[32];
+
+    if (params.eom_ref == 0) { /* RHF */
+        std::vector<int> vecs(1, i);
+        WabefDD_RHF(vecs, C_irr);
+    }
 
     else if (params.eom_ref == 1) { /* ROHF */
         sprintf(CMNEF_lbl, "%s %d", "CMNEF", i);
@@ -525,5 +641,34 @@ void WabefDD(int i, int C_irr) {
     return;
 }
 
+/* Wabef contribution for a set of trial vectors.  For RHF references the <ab|cd> and <ia|bc>
+   integrals are streamed once for as many vectors as fit in core; otherwise each vector is
+   handled by WabefDD() in turn. */
+void WabefDD_batch(const std::vector<int> &vecs, int C_irr) {
+    dpdbuf4 CMnEf;
+    char CMnEf_lbl[32];
+    long int vecsize = 0;
+    int nvec = vecs.size();
+    int maxvec;
+
+    if (params.eom_ref != 0) {
+        for (int k = 0; k < nvec; k++) WabefDD(vecs[k], C_irr);
+        return;
+    }
+
+    /* each vector in the batch needs its C2 and a sigma-sized intermediate in core */
+    sprintf(CMnEf_lbl, "%s %d", "CMnEf", vecs[0]);
+    global_dpd_->buf4_init(&CMnEf, PSIF_EOM_CMnEf, C_irr, 0, 5, 0, 5, 0, CMnEf_lbl);
+    for (int h = 0; h < moinfo.nirreps; h++)
+        vecsize += (long int)CMnEf.params->rowtot[h] * CMnEf.params->coltot[h ^ C_irr];
+    global_dpd_->buf4_close(&CMnEf);
+    maxvec = (vecsize ? std::max(1L, dpd_memfree() / (2 * vecsize)) : nvec);
+
+    for (int k0 = 0; k0 < nvec; k0 += maxvec) {
+        std::vector<int> chunk(vecs.begin() + k0, vecs.begin() + std::min(nvec, k0 + maxvec));
+        WabefDD_RHF(chunk, C_irr);
+    }
+}
+
 }  // namespace cceom
 }  // namespace psi
@@ -40,6 +40,7 @@
 #include <string>
 #include <sstream>
 #include <cmath>
+#include <vector>
 #include "psi4/libpsi4util/process.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsio/psio.h"
@@ -89,7 +90,8 @@ void c_clean(dpdfile2 *CME, dpdfile2 *Cme, dpdbuf4 *CMNEF, dpdbuf4 *Cmnef, dpdbu
 void sigmaSS(int index, int irrep);
 void sigmaSD(int index, int irrep);
 void sigmaDS(int index, int irrep);
-void sigmaDD(int index, int irrep);
+void sigmaDD(int index, int irrep, bool do_Wabef);
+void sigmaDD_batch(const std::vector<int> &vecs, int irrep);
 void sigma00(int index, int irrep);
 void sigma0S(int index, int irrep);
 void sigma0D(int index, int irrep);
@@ -147,6 +149,8 @@ void diag() {
     int cc3_stage; /* 0=eom_ccsd; 1=eom_cc3 (reuse sigmas), 2=recompute sigma */
     int L_start_iter, L_old;
     char *keyw;
+    bool batch_sigma;
+    std::vector<int> sigma_pending;
 
     timer_on("HBAR_EXTRA");
     if (params.wfn == "EOM_CC2")
@@ -313,6 +317,13 @@ void diag() {
             numCs = L_start_iter = L;
             num_converged = 0;
 
+            /* defer the Wabef term of RHF EOM-CCSD sigma builds so that it can be
+               evaluated for several new C vectors per pass over the integrals */
+            batch_sigma = (params.eom_ref == 0) && (params.wfn != "EOM_CC2") && !params.full_matrix &&
+                          (eom_params.sigma_batch != 1) && !((params.wfn == "EOM_CC3") && (cc3_stage > 0)) &&
+                          !eom_params.restart_eom_cc3;
+            sigma_pending.clear();
+
             for (i = already_sigma; i < L; ++i) {
                 /* Form a zeroed S vector for each C vector
                    SIA and Sia do get overwritten by sigmaSS
@@ -344,7 +355,7 @@ void diag() {
                     sigmaDS(i, C_irr);
                     timer_off("sigmaDS");
                     timer_on("sigmaDD");
-                    sigmaDD(i, C_irr);
+                    sigmaDD(i, C_irr, !batch_sigma);
                     timer_off("sigmaDD");
                     if (((params.wfn == "EOM_CC3") && (cc3_stage > 0)) || eom_params.restart_eom_cc3) {
                         timer_on("cc3_HC1");
@@ -401,6 +412,18 @@ void diag() {
                     global_dpd_->buf4_close(&Sijab);
                     global_dpd_->buf4_close(&SIjAb);
                 }
+
+                if (batch_sigma) {
+                    sigma_pending.push_back(i);
+                    if (((int)sigma_pending.size() == eom_params.sigma_batch) || (i == L - 1)) {
+                        timer_on("SIGMA ALL");
+                        timer_on("sigmaDD");
+                        sigmaDD_batch(sigma_pending, C_irr);
+                        timer_off("sigmaDD");
+                        timer_off("SIGMA ALL");
+                        sigma_pending.clear();
+                    }
+                }
             }
 
             timer_on("BUILD G");
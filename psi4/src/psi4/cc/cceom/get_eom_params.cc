@@ -161,6 +161,7 @@ void get_eom_params(SharedWavefunction ref_wfn, Options &options) {
     eom_params.restart_eom_cc3 = options["RESTART_EOM_CC3"].to_integer();
     eom_params.max_iter_SS = 500;
     eom_params.guess = options.get_str("EOM_GUESS");
+    eom_params.sigma_batch = options.get_int("EOM_SIGMA_BATCH");
 
     outfile->Printf("\n\tCCEOM parameters:\n");
     outfile->Printf("\t-----------------\n");
@@ -183,6 +184,7 @@ void get_eom_params(SharedWavefunction ref_wfn, Options &options) {
     outfile->Printf("\tGuess vectors taken from    = %s\n", eom_params.guess.c_str());
     outfile->Printf("\tRestart EOM CC3             = %s\n", eom_params.restart_eom_cc3 ? "YES" : "NO");
     outfile->Printf("\tCollapse with last vector   = %s\n", eom_params.collapse_with_last ? "YES" : "NO");
+    outfile->Printf("\tSigma vectors per batch     = %5d\n", eom_params.sigma_batch);
     if (eom_params.follow_root) outfile->Printf("\tRoot following for CC3 turned on.\n");
     outfile->Printf("\n\n");
 }
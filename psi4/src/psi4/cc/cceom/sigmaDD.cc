@@ -31,6 +31,7 @@
     \brief Enter brief description of file here
 */
 #include <cstdio>
+#include <vector>
 #include "psi4/libqt/qt.h"
 #include "MOInfo.h"
 #include "Params.h"
@@ -46,20 +47,24 @@ void WabefDD(int i, int C_irr);
 void WmnijDD(int i, int C_irr);
 void WmbejDD(int i, int C_irr);
 void WmnefDD(int i, int C_irr);
+void WabefDD_batch(const std::vector<int> &vecs, int C_irr);
 
 /* This function computes the H-bar doubles-doubles block contribution
-to a Sigma vector stored at Sigma plus 'i' */
+to a Sigma vector stored at Sigma plus 'i'.  If do_Wabef is false the
+Wabef term is left out; the caller must then add it with sigmaDD_batch() */
 
-void sigmaDD(int i, int C_irr) {
+void sigmaDD(int i, int C_irr, bool do_Wabef) {
     timer_on("FDD");
     FDD(i, C_irr);
     timer_off("FDD");
     timer_on("WmnijDD");
     WmnijDD(i, C_irr);
     timer_off("WmnijDD");
-    timer_on("WabefDD");
-    WabefDD(i, C_irr);
-    timer_off("WabefDD");
+    if (do_Wabef) {
+        timer_on("WabefDD");
+        WabefDD(i, C_irr);
+        timer_off("WabefDD");
+    }
     timer_on("WmbejDD");
     WmbejDD(i, C_irr);
     timer_off("WmbejDD");
@@ -70,5 +75,15 @@ void sigmaDD(int i, int C_irr) {
     return;
 }
 
+/* Adds the Wabef contribution for all trial vectors in vecs, streaming
+   the <ab|cd> and <ia|bc> integrals once per batch rather than once per
+   vector */
+
+void sigmaDD_batch(const std::vector<int> &vecs, int C_irr) {
+    timer_on("WabefDD");
+    WabefDD_batch(vecs, C_irr);
+    timer_off("WabefDD");
+}
+
 }  // namespace cceom
 }  // namespace psi
@@ -58,6 +58,7 @@ struct Params {
     int num_amps;
     int sekino; /* Sekino-Bartlett size-extensive model-III */
     int linear; /* Bartlett size-extensive (?) linear model */
+    int simultaneous; /* solve for all perturbed wfns of a property together */
 };
 
 }  // namespace ccresponse
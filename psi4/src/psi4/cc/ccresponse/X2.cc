@@ -34,6 +34,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
 #include "psi4/libdpd/dpd.h"
 #include "psi4/libqt/qt.h"
 #include "psi4/libpsio/psio.h"
@@ -50,18 +53,199 @@ namespace ccresponse {
 void denom2(dpdbuf4 *X2, double omega);
 void local_filter_T2(dpdbuf4 *T2);
 
-void X2_build(const char *pert, int irrep, double omega) {
+/* Z_k(pq,ij) = alpha * B(pq,rs) X_k(ij,rs) for a set of perturbed amplitudes X_k, which may belong
+   to different irreps.  Each row block of the totally symmetric B is read once and contracted with
+   every X_k while resident.  The X_k and Z_k blocks are held in core; if fewer than two fit at a time
+   we fall back to contract444() for each vector. */
+static void contract_batch(dpdbuf4 *B, std::vector<dpdbuf4> &X, std::vector<dpdbuf4> &Z, double alpha) {
+    int nvec = X.size();
+    int nirreps = B->params->nirreps;
+    long int memfree = dpd_memfree();
+    long int maxvec = nvec;
+
+    for (int h = 0; h < nirreps; h++) {
+        long int nlinks = B->params->coltot[h];
+        long int vecsize = 0;
+        for (int k = 0; k < nvec; k++) {
+            int Gij = h ^ X[k].file.my_irrep;
+            vecsize = std::max(vecsize, (long int)X[k].params->rowtot[Gij] * (nlinks + B->params->rowtot[h]));
+        }
+        if (vecsize) maxvec = std::min(maxvec, (memfree - nlinks) / vecsize);
+    }
+
+    if (nvec == 1 || maxvec < 2) {
+        for (int k = 0; k < nvec; k++) global_dpd_->contract444(B, &X[k], &Z[k], 0, 0, alpha, 0);
+        return;
+    }
+
+    for (int k0 = 0; k0 < nvec; k0 += maxvec) {
+        int k1 = std::min((long int)nvec, k0 + maxvec);
+        for (int h = 0; h < nirreps; h++) {
+            int nrows = B->params->rowtot[h];
+            int nlinks = B->params->coltot[h];
+
+            for (int k = k0; k < k1; k++) {
+                int Gij = h ^ X[k].file.my_irrep;
+                global_dpd_->buf4_mat_irrep_init(&X[k], Gij);
+                global_dpd_->buf4_mat_irrep_rd(&X[k], Gij);
+                global_dpd_->buf4_mat_irrep_init(&Z[k], h);
+            }
+
+            if (nrows && nlinks) {
+                int rows_per_bucket = dpd_memfree() / nlinks;
+                if (rows_per_bucket > nrows) rows_per_bucket = nrows;
+                if (rows_per_bucket < 1) rows_per_bucket = 1;
+                global_dpd_->buf4_mat_irrep_init_block(B, h, rows_per_bucket);
+                for (int row_start = 0; row_start < nrows; row_start += rows_per_bucket) {
+                    int nbrows = std::min(rows_per_bucket, nrows - row_start);
+                    global_dpd_->buf4_mat_irrep_rd_block(B, h, row_start, nbrows);
+                    for (int k = k0; k < k1; k++) {
+                        int Gij = h ^ X[k].file.my_irrep;
+                        int ncols = X[k].params->rowtot[Gij];
+                        if (ncols)
+                            C_DGEMM('n', 't', nbrows, ncols, nlinks, alpha, B->matrix[h][0], nlinks,
+                                    X[k].matrix[Gij][0], nlinks, 0, Z[k].matrix[h][row_start], ncols);
+                    }
+                }
+                global_dpd_->buf4_mat_irrep_close_block(B, h, rows_per_bucket);
+            }
+
+            for (int k = k0; k < k1; k++) {
+                int Gij = h ^ X[k].file.my_irrep;
+                global_dpd_->buf4_mat_irrep_wrt(&Z[k], h);
+                global_dpd_->buf4_mat_irrep_close(&Z[k], h);
+                global_dpd_->buf4_mat_irrep_close(&X[k], Gij);
+            }
+        }
+    }
+}
+
+/* <ab|cd> contributions to the X2 residuals of a set of perturbed wave functions.  The results
+   are left in CC_TMP0 -- Z(Ab,Ij) for ABCD=OLD, S(ab,ij) and A(ab,ij) for ABCD=NEW, labeled by
+   perturbation and frequency -- for X2_build() to add to New X2.  Requires sort_X() to have been
+   called for every vector. */
+void X2_abcd_build(const std::vector<std::string> &perts, const std::vector<int> &irreps,
+                   const std::vector<double> &omegas) {
+    dpdbuf4 I, B_s;
+    char lbl[32];
+    double **B_diag;
+    int ij, Gc, C, c, cc, m;
+    int rows_per_bucket, nbuckets, row_start, rows_left, nrows, nlinks;
+    psio_address next;
+    int nvec = perts.size();
+    std::vector<dpdbuf4> X(nvec), Z(nvec);
+
+    if (params.abcd == "OLD") {
+        for (int k = 0; k < nvec; k++) {
+            sprintf(lbl, "X_%s_IjAb (%5.3f)", perts[k].c_str(), omegas[k]);
+            global_dpd_->buf4_init(&X[k], PSIF_CC_LR, irreps[k], 0, 5, 0, 5, 0, lbl);
+            sprintf(lbl, "Z(Ab,Ij) %s (%5.3f)", perts[k].c_str(), omegas[k]);
+            global_dpd_->buf4_init(&Z[k], PSIF_CC_TMP0, irreps[k], 5, 0, 5, 0, 0, lbl);
+        }
+        global_dpd_->buf4_init(&I, PSIF_CC_BINTS, 0, 5, 5, 5, 5, 0, "B <ab|cd>");
+        contract_batch(&I, X, Z, 1);
+        global_dpd_->buf4_close(&I);
+        for (int k = 0; k < nvec; k++) {
+            global_dpd_->buf4_close(&Z[k]);
+            global_dpd_->buf4_close(&X[k]);
+        }
+    } else if (params.abcd == "NEW") {
+        timer_on("ABCD:new");
+
+        timer_on("ABCD:S");
+        for (int k = 0; k < nvec; k++) {
+            sprintf(lbl, "X_%s_(+)(ij,ab) (%5.3f)", perts[k].c_str(), omegas[k]);
+            global_dpd_->buf4_init(&X[k], PSIF_CC_LR, irreps[k], 3, 8, 3, 8, 0, lbl);
+            sprintf(lbl, "S_%s_(ab,ij) (%5.3f)", perts[k].c_str(), omegas[k]);
+            global_dpd_->buf4_init(&Z[k], PSIF_CC_TMP0, irreps[k], 8, 3, 8, 3, 0, lbl);
+        }
+        global_dpd_->buf4_init(&I, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
+        contract_batch(&I, X, Z, 0.5);
+        global_dpd_->buf4_close(&I);
+        timer_off("ABCD:S");
+
+        /* X_diag(ij,c)  = 2 * X(ij,cc)*/
+        /* NB: Gcc = 0 and B is totally symmetry, so Gab = 0 */
+        /* But Gij = irrep ^ Gab = irrep */
+        nlinks = moinfo.nvirt;
+        std::vector<double **> X_diag(nvec);
+        for (int k = 0; k < nvec; k++) {
+            int irrep = irreps[k];
+            global_dpd_->buf4_mat_irrep_init(&X[k], irrep);
+            global_dpd_->buf4_mat_irrep_rd(&X[k], irrep);
+            X_diag[k] = global_dpd_->dpd_block_matrix(X[k].params->rowtot[irrep], nlinks);
+            for (ij = 0; ij < X[k].params->rowtot[irrep]; ij++)
+                for (Gc = 0; Gc < moinfo.nirreps; Gc++)
+                    for (C = 0; C < moinfo.virtpi[Gc]; C++) {
+                        c = C + moinfo.vir_off[Gc];
+                        cc = X[k].params->colidx[c][c];
+                        X_diag[k][ij][c] = X[k].matrix[irrep][ij][cc];
+                    }
+            global_dpd_->buf4_mat_irrep_close(&X[k], irrep);
+            global_dpd_->buf4_mat_irrep_init(&Z[k], 0);
+            global_dpd_->buf4_mat_irrep_rd(&Z[k], 0);
+        }
+
+        global_dpd_->buf4_init(&B_s, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
+        rows_per_bucket = dpd_memfree() / (B_s.params->coltot[0] + moinfo.nvirt);
+        if (rows_per_bucket > B_s.params->rowtot[0]) rows_per_bucket = B_s.params->rowtot[0];
+        nbuckets = (int)ceil((double)B_s.params->rowtot[0] / (double)rows_per_bucket);
+        rows_left = B_s.params->rowtot[0] % rows_per_bucket;
+
+        B_diag = global_dpd_->dpd_block_matrix(rows_per_bucket, moinfo.nvirt);
+        next = PSIO_ZERO;
+        for (m = 0; m < nbuckets; m++) {
+            row_start = m * rows_per_bucket;
+            nrows = (rows_left && m == nbuckets - 1) ? rows_left : rows_per_bucket;
+            if (!nrows || !nlinks) continue;
+            psio_read(PSIF_CC_BINTS, "B(+) <ab|cc>", (char *)B_diag[0], sizeof(double) * nrows * nlinks, next, &next);
+            for (int k = 0; k < nvec; k++) {
+                int ncols = X[k].params->rowtot[irreps[k]];
+                if (ncols)
+                    C_DGEMM('n', 't', nrows, ncols, nlinks, -0.25, B_diag[0], nlinks, X_diag[k][0], nlinks, 1,
+                            Z[k].matrix[0][row_start], ncols);
+            }
+        }
+        global_dpd_->buf4_close(&B_s);
+        global_dpd_->free_dpd_block(B_diag, rows_per_bucket, moinfo.nvirt);
+        for (int k = 0; k < nvec; k++) {
+            global_dpd_->buf4_mat_irrep_wrt(&Z[k], 0);
+            global_dpd_->buf4_mat_irrep_close(&Z[k], 0);
+            global_dpd_->buf4_close(&Z[k]);
+            global_dpd_->free_dpd_block(X_diag[k], X[k].params->rowtot[irreps[k]], nlinks);
+            global_dpd_->buf4_close(&X[k]);
+        }
+
+        timer_on("ABCD:A");
+        for (int k = 0; k < nvec; k++) {
+            sprintf(lbl, "X_%s_(-)(ij,ab) (%5.3f)", perts[k].c_str(), omegas[k]);
+            global_dpd_->buf4_init(&X[k], PSIF_CC_LR, irreps[k], 4, 9, 4, 9, 0, lbl);
+            sprintf(lbl, "A_%s_(ab,ij) (%5.3f)", perts[k].c_str(), omegas[k]);
+            global_dpd_->buf4_init(&Z[k], PSIF_CC_TMP0, irreps[k], 9, 4, 9, 4, 0, lbl);
+        }
+        global_dpd_->buf4_init(&I, PSIF_CC_BINTS, 0, 9, 9, 9, 9, 0, "B(-) <ab|cd> - <ab|dc>");
+        contract_batch(&I, X, Z, 0.5);
+        global_dpd_->buf4_close(&I);
+        for (int k = 0; k < nvec; k++) {
+            global_dpd_->buf4_close(&Z[k]);
+            global_dpd_->buf4_close(&X[k]);
+        }
+        timer_off("ABCD:A");
+
+        timer_off("ABCD:new");
+    }
+}
+
+/* If abcd_ready is set, the <ab|cd> intermediates for this vector have already been
+   formed by a batched call to X2_abcd_build() */
+void X2_build(const char *pert, int irrep, double omega, bool abcd_ready) {
     dpdfile2 X1, z, F, t1;
     dpdbuf4 X2, X2new, Z, Z1, Z2, W, T2, I;
     char lbl[32];
     int Gej, Gab, Gij, Ge, Gj, Gi, nrows, length, E, e, II;
     int Gbm, Gfe, bm, b, m, Gb, Gm, Gf, B, M, fe, f, ef, ncols;
     double *X;
-    dpdbuf4 S, A, B_s;
-    int ij, Gc, C, c, cc;
-    int rows_per_bucket, nbuckets, row_start, rows_left, nlinks;
-    psio_address next;
-    double **X_diag, **B_diag;
+    dpdbuf4 S, A;
 
     sprintf(lbl, "%sBAR_IjAb", pert);
     global_dpd_->buf4_init(&X2new, PSIF_CC_LR, irrep, 0, 5, 0, 5, 0, lbl);
@@ -240,127 +424,32 @@ void X2_build(const char *pert, int irrep, double omega) {
     global_dpd_->contract444(&W, &X2, &X2new, 1, 1, 1, 1);
     global_dpd_->buf4_close(&W);
 
+    if (!abcd_ready)
+        X2_abcd_build(std::vector<std::string>(1, pert), std::vector<int>(1, irrep), std::vector<double>(1, omega));
+
+    global_dpd_->buf4_close(&X2new); /* Need to close X2new to avoid collisions */
     if (params.abcd == "OLD") {
-        sprintf(lbl, "Z(Ab,Ij) %s", pert);
+        sprintf(lbl, "Z(Ab,Ij) %s (%5.3f)", pert, omega);
         global_dpd_->buf4_init(&Z, PSIF_CC_TMP0, irrep, 5, 0, 5, 0, 0, lbl);
-        global_dpd_->buf4_init(&I, PSIF_CC_BINTS, 0, 5, 5, 5, 5, 0, "B <ab|cd>");
-        global_dpd_->contract444(&I, &X2, &Z, 0, 0, 1, 0);
-        global_dpd_->buf4_close(&I);
-        global_dpd_->buf4_close(&X2new); /* Need to close X2new to avoid collisions */
         sprintf(lbl, "New X_%s_IjAb (%5.3f)", pert, omega);
         global_dpd_->buf4_sort_axpy(&Z, PSIF_CC_LR, rspq, 0, 5, lbl, 1);
-        global_dpd_->buf4_init(&X2new, PSIF_CC_LR, irrep, 0, 5, 0, 5, 0, lbl); /* re-open X2new here */
         global_dpd_->buf4_close(&Z);
     } else if (params.abcd == "NEW") {
-        timer_on("ABCD:new");
-
-        global_dpd_->buf4_close(&X2);
-
-        timer_on("ABCD:S");
-        sprintf(lbl, "X_%s_(+)(ij,ab) (%5.3f)", pert, omega);
-        global_dpd_->buf4_init(&X2, PSIF_CC_LR, irrep, 3, 8, 3, 8, 0, lbl);
-        global_dpd_->buf4_init(&I, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
-        sprintf(lbl, "S_%s_(ab,ij)", pert);
-        global_dpd_->buf4_init(&S, PSIF_CC_TMP0, irrep, 8, 3, 8, 3, 0, lbl);
-        global_dpd_->contract444(&I, &X2, &S, 0, 0, 0.5, 0);
-        global_dpd_->buf4_close(&S);
-        global_dpd_->buf4_close(&I);
-        global_dpd_->buf4_close(&X2);
-        timer_off("ABCD:S");
-
-        /* X_diag(ij,c)  = 2 * X(ij,cc)*/
-        /* NB: Gcc = 0 and B is totally symmetry, so Gab = 0 */
-        /* But Gij = irrep ^ Gab = irrep */
-        sprintf(lbl, "X_%s_(+)(ij,ab) (%5.3f)", pert, omega);
-        global_dpd_->buf4_init(&X2, PSIF_CC_LR, irrep, 3, 8, 3, 8, 0, lbl);
-        global_dpd_->buf4_mat_irrep_init(&X2, irrep);
-        global_dpd_->buf4_mat_irrep_rd(&X2, irrep);
-        X_diag = global_dpd_->dpd_block_matrix(X2.params->rowtot[irrep], moinfo.nvirt);
-        for (ij = 0; ij < X2.params->rowtot[irrep]; ij++)
-            for (Gc = 0; Gc < moinfo.nirreps; Gc++)
-                for (C = 0; C < moinfo.virtpi[Gc]; C++) {
-                    c = C + moinfo.vir_off[Gc];
-                    cc = X2.params->colidx[c][c];
-                    X_diag[ij][c] = X2.matrix[irrep][ij][cc];
-                }
-        global_dpd_->buf4_mat_irrep_close(&X2, irrep);
-
-        global_dpd_->buf4_init(&B_s, PSIF_CC_BINTS, 0, 8, 8, 8, 8, 0, "B(+) <ab|cd> + <ab|dc>");
-        sprintf(lbl, "S_%s_(ab,ij)", pert);
-        global_dpd_->buf4_init(&S, PSIF_CC_TMP0, irrep, 8, 3, 8, 3, 0, lbl);
-        global_dpd_->buf4_mat_irrep_init(&S, 0);
-        global_dpd_->buf4_mat_irrep_rd(&S, 0);
-
-        rows_per_bucket = dpd_memfree() / (B_s.params->coltot[0] + moinfo.nvirt);
-        if (rows_per_bucket > B_s.params->rowtot[0]) rows_per_bucket = B_s.params->rowtot[0];
-        nbuckets = (int)ceil((double)B_s.params->rowtot[0] / (double)rows_per_bucket);
-        rows_left = B_s.params->rowtot[0] % rows_per_bucket;
-
-        B_diag = global_dpd_->dpd_block_matrix(rows_per_bucket, moinfo.nvirt);
-        next = PSIO_ZERO;
-        ncols = X2.params->rowtot[irrep];
-        nlinks = moinfo.nvirt;
-        for (m = 0; m < (rows_left ? nbuckets - 1 : nbuckets); m++) {
-            row_start = m * rows_per_bucket;
-            nrows = rows_per_bucket;
-            if (nrows && ncols && nlinks) {
-                psio_read(PSIF_CC_BINTS, "B(+) <ab|cc>", (char *)B_diag[0], sizeof(double) * nrows * nlinks, next,
-                          &next);
-                C_DGEMM('n', 't', nrows, ncols, nlinks, -0.25, B_diag[0], nlinks, X_diag[0], nlinks, 1,
-                        S.matrix[0][row_start], ncols);
-            }
-        }
-        if (rows_left) {
-            row_start = m * rows_per_bucket;
-            nrows = rows_left;
-            if (nrows && ncols && nlinks) {
-                psio_read(PSIF_CC_BINTS, "B(+) <ab|cc>", (char *)B_diag[0], sizeof(double) * nrows * nlinks, next,
-                          &next);
-                C_DGEMM('n', 't', nrows, ncols, nlinks, -0.25, B_diag[0], nlinks, X_diag[0], nlinks, 1,
-                        S.matrix[0][row_start], ncols);
-            }
-        }
-        global_dpd_->buf4_mat_irrep_wrt(&S, 0);
-        global_dpd_->buf4_mat_irrep_close(&S, 0);
-        global_dpd_->buf4_close(&S);
-        global_dpd_->buf4_close(&B_s);
-        global_dpd_->free_dpd_block(B_diag, rows_per_bucket, moinfo.nvirt);
-        global_dpd_->free_dpd_block(X_diag, X2.params->rowtot[irrep], moinfo.nvirt);
-        global_dpd_->buf4_close(&X2);
-
-        timer_on("ABCD:A");
-        sprintf(lbl, "X_%s_(-)(ij,ab) (%5.3f)", pert, omega);
-        global_dpd_->buf4_init(&X2, PSIF_CC_LR, irrep, 4, 9, 4, 9, 0, lbl);
-        global_dpd_->buf4_init(&I, PSIF_CC_BINTS, 0, 9, 9, 9, 9, 0, "B(-) <ab|cd> - <ab|dc>");
-        sprintf(lbl, "A_%s_(ab,ij)", pert);
-        global_dpd_->buf4_init(&A, PSIF_CC_TMP0, irrep, 9, 4, 9, 4, 0, lbl);
-        global_dpd_->contract444(&I, &X2, &A, 0, 0, 0.5, 0);
-        global_dpd_->buf4_close(&A);
-        global_dpd_->buf4_close(&I);
-        global_dpd_->buf4_close(&X2);
-        timer_off("ABCD:A");
-
         timer_on("ABCD:axpy");
-        global_dpd_->buf4_close(&X2new); /* Need to close X2new to avoid collisions */
-        sprintf(lbl, "S_%s_(ab,ij)", pert);
+        sprintf(lbl, "S_%s_(ab,ij) (%5.3f)", pert, omega);
         global_dpd_->buf4_init(&S, PSIF_CC_TMP0, irrep, 5, 0, 8, 3, 0, lbl);
         sprintf(lbl, "New X_%s_IjAb (%5.3f)", pert, omega);
         global_dpd_->buf4_sort_axpy(&S, PSIF_CC_LR, rspq, 0, 5, lbl, 1);
         global_dpd_->buf4_close(&S);
-        sprintf(lbl, "A_%s_(ab,ij)", pert);
+        sprintf(lbl, "A_%s_(ab,ij) (%5.3f)", pert, omega);
         global_dpd_->buf4_init(&A, PSIF_CC_TMP0, irrep, 5, 0, 9, 4, 0, lbl);
         sprintf(lbl, "New X_%s_IjAb (%5.3f)", pert, omega);
         global_dpd_->buf4_sort_axpy(&A, PSIF_CC_LR, rspq, 0, 5, lbl, 1);
         global_dpd_->buf4_close(&A);
-        global_dpd_->buf4_init(&X2new, PSIF_CC_LR, irrep, 0, 5, 0, 5, 0, lbl); /* re-open X2new here */
-
         timer_off("ABCD:axpy");
-
-        sprintf(lbl, "X_%s_IjAb (%5.3f)", pert, omega);
-        global_dpd_->buf4_init(&X2, PSIF_CC_LR, irrep, 0, 5, 0, 5, 0, lbl);
-
-        timer_off("ABCD:new");
     }
+    sprintf(lbl, "New X_%s_IjAb (%5.3f)", pert, omega);
+    global_dpd_->buf4_init(&X2new, PSIF_CC_LR, irrep, 0, 5, 0, 5, 0, lbl); /* re-open X2new here */
 
     sprintf(lbl, "Z(Mb,Ij) %s", pert);
     global_dpd_->buf4_init(&Z, PSIF_CC_TMP0, irrep, 10, 0, 10, 0, 0, lbl);
@@ -34,6 +34,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <string>
+#include <vector>
 #include "psi4/libdpd/dpd.h"
 #include "psi4/libqt/qt.h"
 #include "psi4/libpsio/psio.h"
@@ -52,7 +54,9 @@ void init_X(const char *pert, int irrep, double omega);
 void sort_X(const char *pert, int irrep, double omega);
 void cc2_sort_X(const char *pert, int irrep, double omega);
 void X1_build(const char *pert, int irrep, double omega);
-void X2_build(const char *pert, int irrep, double omega);
+void X2_build(const char *pert, int irrep, double omega, bool abcd_ready);
+void X2_abcd_build(const std::vector<std::string> &perts, const std::vector<int> &irreps,
+                   const std::vector<double> &omegas);
 void cc2_X1_build(const char *pert, int irrep, double omega);
 void cc2_X2_build(const char *pert, int irrep, double omega);
 double converged(const char *pert, int irrep, double omega);
@@ -95,7 +99,7 @@ void compute_X(const char *pert, int irrep, double omega) {
         } else {
             sort_X(pert, irrep, omega);
             X1_build(pert, irrep, omega);
-            X2_build(pert, irrep, omega);
+            X2_build(pert, irrep, omega, false);
         }
         update_X(pert, irrep, omega);
         rms = converged(pert, irrep, omega);
@@ -156,5 +160,137 @@ void compute_X(const char *pert, int irrep, double omega) {
     timer_off("compute_X");
 }
 
+/* Solves for several perturbed wave functions together.  All right-hand sides are iterated in
+   lockstep so that the <ab|cd> contractions, the most expensive and most I/O-bound part of the
+   X2 residual, are formed with a single pass over the integrals per iteration for all vectors
+   (see X2_abcd_build()); everything else, including the frequency-dependent denominators and
+   DIIS, remains per vector.  Each vector is locked as soon as it converges. */
+void compute_X_batch(const std::vector<std::string> &perts, const std::vector<int> &irreps,
+                     const std::vector<double> &omegas) {
+    int i, k, iter, nvec = perts.size(), nactive = perts.size();
+    double rms, max_rms, polar, X2_norm;
+    char lbl[32];
+    dpdbuf4 X2;
+    std::vector<int> done(nvec, 0);
+    std::vector<long int> size(nvec, 0);
+
+    if (params.wfn == "CC2" || nvec == 1) {
+        for (k = 0; k < nvec; k++) compute_X(perts[k].c_str(), irreps[k], omegas[k]);
+        return;
+    }
+
+    timer_on("compute_X");
+
+    outfile->Printf("\n\tComputing %d Perturbed Wave Functions Simultaneously.\n", nvec);
+    outfile->Printf("\tPerturbation     Omega (E_h)   Pseudopolarizability\n");
+    outfile->Printf("\t------------     -----------   --------------------\n");
+    for (k = 0; k < nvec; k++) {
+        init_X(perts[k].c_str(), irreps[k], omegas[k]);
+        sort_X(perts[k].c_str(), irreps[k], omegas[k]);
+        polar = -2.0 * pseudopolar(perts[k].c_str(), irreps[k], omegas[k]);
+        outfile->Printf("\t%-12s     %11.3f   %20.12f\n", perts[k].c_str(), omegas[k], polar);
+
+        sprintf(lbl, "X_%s_IjAb (%5.3f)", perts[k].c_str(), omegas[k]);
+        global_dpd_->buf4_init(&X2, PSIF_CC_LR, irreps[k], 0, 5, 0, 5, 0, lbl);
+        for (int h = 0; h < moinfo.nirreps; h++)
+            size[k] += (long int)X2.params->rowtot[h] * X2.params->coltot[h ^ irreps[k]];
+        global_dpd_->buf4_close(&X2);
+    }
+
+    outfile->Printf("\n\tIter   Active      Max RMS\n");
+    outfile->Printf("\t----   ------   -----------\n");
+
+    for (iter = 1; iter <= params.maxiter && nactive; iter++) {
+        /* <ab|cd> terms for all unconverged vectors, in as few passes as memory allows */
+        std::vector<std::string> bperts;
+        std::vector<int> birreps;
+        std::vector<double> bomegas;
+        long int used = 0;
+        for (k = 0; k < nvec; k++) {
+            if (done[k]) continue;
+            if (!bperts.empty() && used + 2 * size[k] > dpd_memfree()) {
+                X2_abcd_build(bperts, birreps, bomegas);
+                bperts.clear();
+                birreps.clear();
+                bomegas.clear();
+                used = 0;
+            }
+            bperts.push_back(perts[k]);
+            birreps.push_back(irreps[k]);
+            bomegas.push_back(omegas[k]);
+            used += 2 * size[k];
+        }
+        if (!bperts.empty()) X2_abcd_build(bperts, birreps, bomegas);
+
+        max_rms = 0.0;
+        int nactive_iter = nactive;
+        for (k = 0; k < nvec; k++) {
+            if (done[k]) continue;
+            const char *pert = perts[k].c_str();
+            int irrep = irreps[k];
+            double omega = omegas[k];
+
+            X1_build(pert, irrep, omega);
+            X2_build(pert, irrep, omega, true);
+            update_X(pert, irrep, omega);
+            rms = converged(pert, irrep, omega);
+            if (rms > max_rms) max_rms = rms;
+
+            if (rms <= params.convergence) {
+                done[k] = 1;
+                nactive--;
+                save_X(pert, irrep, omega);
+                sort_X(pert, irrep, omega);
+                outfile->Printf("\tConverged %s-Perturbed Wfn (%5.3f E_h) to %4.3e\n", pert, omega, rms);
+                if (params.print & 2) {
+                    sprintf(lbl, "X_%s_IjAb (%5.3f)", pert, omega);
+                    global_dpd_->buf4_init(&X2, PSIF_CC_LR, irrep, 0, 5, 0, 5, 0, lbl);
+                    X2_norm = global_dpd_->buf4_dot_self(&X2);
+                    global_dpd_->buf4_close(&X2);
+                    X2_norm = sqrt(X2_norm);
+                    outfile->Printf("\tNorm of the converged X2 amplitudes %20.15f\n", X2_norm);
+                    amp_write(pert, irrep, omega);
+                }
+                continue;
+            }
+
+            if (params.diis) diis(iter, pert, irrep, omega);
+            save_X(pert, irrep, omega);
+            sort_X(pert, irrep, omega);
+        }
+        outfile->Printf("\t%4d   %6d    %4.3e\n", iter, nactive_iter, max_rms);
+    }
+    if (nactive) {
+        dpd_close(0);
+        cleanup();
+        exit_io();
+        throw PsiException("Failed to converge perturbed wavefunction", __FILE__, __LINE__);
+    }
+    outfile->Printf("\t---------------------------\n");
+
+    outfile->Printf("\n\tConverged pseudopolarizabilities:\n");
+    for (k = 0; k < nvec; k++) {
+        polar = -2.0 * pseudopolar(perts[k].c_str(), irreps[k], omegas[k]);
+        outfile->Printf("\t%-12s     %11.3f   %20.12f\n", perts[k].c_str(), omegas[k], polar);
+    }
+
+    /* Clean up disk space */
+    psio_close(PSIF_CC_DIIS_AMP, 0);
+    psio_close(PSIF_CC_DIIS_ERR, 0);
+
+    psio_open(PSIF_CC_DIIS_AMP, 0);
+    psio_open(PSIF_CC_DIIS_ERR, 0);
+
+    for (i = PSIF_CC_TMP; i <= PSIF_CC_TMP11; i++) {
+        psio_close(i, 0);
+        psio_open(i, 0);
+    }
+
+    if (params.analyze)
+        for (k = 0; k < nvec; k++) analyze(perts[k].c_str(), irreps[k], omegas[k]);
+
+    timer_off("compute_X");
+}
+
 }  // namespace ccresponse
 }  // namespace psi
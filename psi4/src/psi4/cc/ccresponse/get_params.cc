@@ -207,6 +207,7 @@ void get_params(std::shared_ptr<Wavefunction> wfn, Options &options) {
     params.num_amps = options.get_int("NUM_AMPS_PRINT");
     params.sekino = options.get_bool("SEKINO");
     params.linear = options.get_bool("LINEAR");
+    params.simultaneous = options.get_bool("SIMULTANEOUS_SOLVE");
 
     outfile->Printf("\n\tInput parameters:\n");
     outfile->Printf("\t-----------------\n");
@@ -225,6 +226,7 @@ void get_params(std::shared_ptr<Wavefunction> wfn, Options &options) {
     outfile->Printf("\tModel III        =    %s\n", params.sekino ? "Yes" : "No");
     outfile->Printf("\tLinear Model     =    %s\n", params.linear ? "Yes" : "No");
     outfile->Printf("\tABCD             =    %s\n", params.abcd.c_str());
+    outfile->Printf("\tSimultaneous     =    %s\n", params.simultaneous ? "Yes" : "No");
     outfile->Printf("\tIrrep X          =    %s\n", moinfo.labels[moinfo.mu_irreps[0]].c_str());
     outfile->Printf("\tIrrep Y          =    %s\n", moinfo.labels[moinfo.mu_irreps[1]].c_str());
     outfile->Printf("\tIrrep Z          =    %s\n", moinfo.labels[moinfo.mu_irreps[2]].c_str());
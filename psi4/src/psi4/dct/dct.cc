@@ -62,6 +62,11 @@ DCTSolver::DCTSolver(SharedWavefunction ref_wfn, Options &options) : Wavefunctio
     cumulant_threshold_ = options.get_double("R_CONVERGENCE");
     int_tolerance_ = options.get_double("INTS_TOLERANCE");
     energy_level_shift_ = options.get_double("ENERGY_LEVEL_SHIFT");
+    qc_quasi_newton_ = options.get_str("QC_HESSIAN") == "QUASI_NEWTON";
+    qc_model_hessian_ = false;
+    qc_hessian_vecs_ = options.get_int("QC_HESSIAN_VECS");
+    qc_hessian_ratio_ = options.get_double("QC_HESSIAN_RATIO");
+    qc_gradient_rms_ = 0.0;
 
     if (!options_["E_CONVERGENCE"].has_changed())
         energy_threshold_ = options.get_double("R_CONVERGENCE");
@@ -158,6 +158,8 @@ class DCTSolver : public Wavefunction {
     void compute_sigma_vector_orb_cum();
     void compute_sigma_vector_cum_cum();
     void compute_sigma_vector_cum_orb();
+    void compute_nr_sigma_vector();
+    void update_qc_hessian_model();
     int iterate_nr_conjugate_gradients();
     int iterate_nr_jacobi();
     void check_qc_convergence();
@@ -321,6 +323,18 @@ class DCTSolver : public Wavefunction {
     int *lookup_orbitals_;
     /// The lookup array that determines which compound indices belong to cumulant IDPs and which don't
     int *lookup_cumulant_;
+    /// Whether Hessian-vector products are reused between macroiterations (QC_HESSIAN = QUASI_NEWTON)
+    bool qc_quasi_newton_;
+    /// Whether the sigma vectors of the current macroiteration come from the quasi-Newton model of the Hessian
+    bool qc_model_hessian_;
+    /// The maximum number of exact Hessian-vector products kept for the quasi-Newton model
+    size_t qc_hessian_vecs_;
+    /// The factor by which the gradient has to drop for the quasi-Newton model to be used in the next macroiteration
+    double qc_hessian_ratio_;
+    /// The RMS of the gradient in the IDP basis at the previous macroiteration
+    double qc_gradient_rms_;
+    /// The orbital and cumulant lookup arrays the stored Hessian-vector products were computed with
+    std::vector<int> qc_lookup_;
     /// The number of the guess subspace vectors for the Davidson diagonalization
     int nguess_;
     /// The dimension of the subspace in the Davidson diagonalization
@@ -485,6 +499,14 @@ class DCTSolver : public Wavefunction {
     SharedVector S_;
     /// The new element of Krylov subspace vector in the IDP basis for conjugate gradient procedure
     SharedVector Q_;
+    /// The trial vectors of the last Newton-Raphson solve done with exact Hessian-vector products
+    std::vector<SharedVector> qc_s_;
+    /// The exact Hessian-vector products of the trial vectors in qc_s_
+    std::vector<SharedVector> qc_y_;
+    /// The stored products less their diagonal part, R = Y - Hd S, one per row
+    SharedMatrix qc_r_;
+    /// The pseudoinverse of R^T S in the quasi-Newton model of the Hessian
+    SharedMatrix qc_m_;
     /// The subspace vector in the Davidson diagonalization procedure
     SharedMatrix b_;
     /// Generator of the orbital rotations (Alpha) with respect to the orbitals from the previous update
@@ -37,7 +37,9 @@
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/liboptions/liboptions.h"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace psi {
 namespace dct {
@@ -64,6 +66,12 @@ void DCTSolver::run_qc_dct() {
     int cycle_NR = 0;
     int cycle_jacobi = 0;
 
+    // No Hessian-vector products from earlier computations are reused
+    qc_s_.clear();
+    qc_y_.clear();
+    qc_model_hessian_ = false;
+    qc_gradient_rms_ = 0.0;
+
     // Copy the reference orbitals and to use them as the reference for the orbital rotation
     outfile->Printf("About to Copied C matrices\n");
     old_ca_->copy(Ca_);
@@ -116,8 +124,10 @@ void DCTSolver::run_qc_dct() {
         // IDPs
         form_idps();
         if (nidp_ != 0) {
+            // Choose between the exact Hessian and its quasi-Newton model for this macroiteration
+            if (qc_quasi_newton_) update_qc_hessian_model();
             // Compute sigma vector in the basis of IDPs
-            compute_sigma_vector();
+            compute_nr_sigma_vector();
             // Solve the NR equations using conjugate gradients
             cycle_NR = iterate_nr_conjugate_gradients();
             // Check the convergence by computing the change in the orbitals and the cumulant
@@ -1751,6 +1761,80 @@ void DCTSolver::compute_sigma_vector_cum_orb() {
     global_dpd_->buf4_close(&S4);
 }
 
+void DCTSolver::compute_nr_sigma_vector() {
+    if (qc_model_hessian_) {
+        // sigma = R (R^T S)^+ R^T D, the off-diagonal part of the quasi-Newton model of the Hessian
+        int nvec = qc_m_->rowdim();
+        std::vector<double> t(nvec), u(nvec);
+        C_DGEMV('n', nvec, nidp_, 1.0, qc_r_->pointer()[0], nidp_, D_->pointer(), 1, 0.0, t.data(), 1);
+        C_DGEMV('n', nvec, nvec, 1.0, qc_m_->pointer()[0], nvec, t.data(), 1, 0.0, u.data(), 1);
+        C_DGEMV('t', nvec, nidp_, 1.0, qc_r_->pointer()[0], nidp_, u.data(), 1, 0.0, sigma_->pointer(), 1);
+        return;
+    }
+
+    compute_sigma_vector();
+
+    // Keep the exact product H D = sigma + Hd D for the quasi-Newton model of the following macroiterations
+    if (qc_quasi_newton_ && qc_s_.size() < qc_hessian_vecs_ && D_->norm() > 1.0e-10) {
+        auto s = std::make_shared<Vector>(*D_);
+        auto y = std::make_shared<Vector>(*sigma_);
+        for (int p = 0; p < nidp_; ++p) y->add(p, Hd_->get(p) * s->get(p));
+        qc_s_.push_back(s);
+        qc_y_.push_back(y);
+    }
+}
+
+void DCTSolver::update_qc_hessian_model() {
+    // The model is only trusted if the last step reduced the gradient well enough and the IDPs did not change,
+    // otherwise the Hessian-vector products are computed exactly and stored for the next macroiterations
+    double gradient_rms = gradient_->rms();
+    std::vector<int> lookup(lookup_orbitals_, lookup_orbitals_ + dim_orbitals_);
+    lookup.insert(lookup.end(), lookup_cumulant_, lookup_cumulant_ + dim_cumulant_);
+
+    qc_model_hessian_ = !qc_s_.empty() && lookup == qc_lookup_ && gradient_rms < qc_hessian_ratio_ * qc_gradient_rms_;
+    qc_gradient_rms_ = gradient_rms;
+
+    if (!qc_model_hessian_) {
+        qc_s_.clear();
+        qc_y_.clear();
+        qc_lookup_ = lookup;
+        return;
+    }
+
+    // Multi-secant model H = Hd + R (R^T S)^+ R^T with R = Y - Hd S, which reproduces every stored product.
+    // The diagonal Hd changes with the Fock matrix, so R is rebuilt every macroiteration
+    int nvec = qc_s_.size();
+    qc_r_ = std::make_shared<Matrix>("R = Y - Hd S", nvec, nidp_);
+    double **Rp = qc_r_->pointer();
+    for (int k = 0; k < nvec; ++k) {
+        for (int p = 0; p < nidp_; ++p) Rp[k][p] = qc_y_[k]->get(p) - Hd_->get(p) * qc_s_[k]->get(p);
+    }
+    auto RtS = std::make_shared<Matrix>("R^T S", nvec, nvec);
+    for (int k = 0; k < nvec; ++k) {
+        for (int l = 0; l <= k; ++l) {
+            double value = 0.5 * (C_DDOT(nidp_, Rp[k], 1, qc_s_[l]->pointer(), 1) +
+                                  C_DDOT(nidp_, Rp[l], 1, qc_s_[k]->pointer(), 1));
+            RtS->set(k, l, value);
+            RtS->set(l, k, value);
+        }
+    }
+    auto evecs = std::make_shared<Matrix>("R^T S eigenvectors", nvec, nvec);
+    auto evals = std::make_shared<Vector>("R^T S eigenvalues", nvec);
+    RtS->diagonalize(evecs, evals);
+    double max_eval = 0.0;
+    for (int k = 0; k < nvec; ++k) max_eval = std::max(max_eval, std::fabs(evals->get(k)));
+    qc_m_ = std::make_shared<Matrix>("(R^T S)^+", nvec, nvec);
+    for (int k = 0; k < nvec; ++k) {
+        double e = evals->get(k);
+        if (std::fabs(e) < 1.0e-10 * max_eval) continue;
+        for (int p = 0; p < nvec; ++p) {
+            for (int q = 0; q < nvec; ++q) qc_m_->add(p, q, evecs->get(p, k) * evecs->get(q, k) / e);
+        }
+    }
+
+    if (print_ > 1) outfile->Printf("\tUsing the quasi-Newton Hessian from %d stored products\n", nvec);
+}
+
 int DCTSolver::iterate_nr_conjugate_gradients() {
     // Conjugate gradients solution of the NR equations
 
@@ -1777,7 +1861,7 @@ int DCTSolver::iterate_nr_conjugate_gradients() {
         residual_rms = 0.0;
 
         // Compute sigma vector
-        compute_sigma_vector();
+        compute_nr_sigma_vector();
 
         // Compute the element of the Krylov subspace Q = Hd * D
         double dT_q = 0.0;
@@ -1854,7 +1938,7 @@ int DCTSolver::iterate_nr_jacobi() {
         residual_rms = 0.0;
 
         // Compute sigma vector
-        compute_sigma_vector();
+        compute_nr_sigma_vector();
 
         double residual_rms = 0.0;
         // Update X
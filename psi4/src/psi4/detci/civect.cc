@@ -49,6 +49,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
+#include <vector>
 #include "psi4/pybind11.h"
 
 #include "psi4/libciomr/libciomr.h"
@@ -61,6 +63,9 @@
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libmints/vector.h"
 
+/* doubles converted per psio call by the packed CI vector format */
+#define CIVECT_PACK_CHUNK 65536
+
 namespace psi {
 namespace detci {
 
@@ -1764,7 +1769,7 @@ int CIvect::read(int ivect, int ibuf) {
     int unit, buf, k, i;
     size_t size;
     int blk;
-    char key[20];
+    char key[20], pkey[20];
 
     timer_on("CIWave: CIvect read");
     if (nunits_ < 1) {
@@ -1791,7 +1796,17 @@ int CIvect::read(int ivect, int ibuf) {
     sprintf(key, "buffer_ %d", buf);
     unit = file_number_[buf];
 
-    psio_read_entry((size_t)unit, key, (char *)buffer_, size);
+    /* prefer the entry in the current format, but accept one left in the
+       other format by an earlier run (e.g., on restart) */
+    sprintf(pkey, "packed_ %d", buf);
+    bool packed = (storage() != PARM_CIVECT_FULL);
+    if (packed && !psio_tocentry_exists((size_t)unit, pkey))
+        packed = false;
+    else if (!packed && !psio_tocentry_exists((size_t)unit, key) && psio_tocentry_exists((size_t)unit, pkey))
+        packed = true;
+
+    if (!packed || !read_packed((size_t)unit, pkey, ibuf))
+        psio_read_entry((size_t)unit, key, (char *)buffer_, size);
 
     cur_vect_ = ivect;
     cur_buf_ = ibuf;
@@ -1816,7 +1831,7 @@ int CIvect::write(int ivect, int ibuf) {
     int unit, buf, i;
     size_t size;
     int blk;
-    char key[20];
+    char key[20], pkey[20];
 
     // If we are just an incore buffer
     if (nunits_ < 1) return (1);
@@ -1841,7 +1856,10 @@ int CIvect::write(int ivect, int ibuf) {
     sprintf(key, "buffer_ %d", buf);
     unit = file_number_[buf];
 
-    psio_write_entry((size_t)unit, key, (char *)buffer_, size);
+    /* a packed entry that can no longer hold the buffer hands it to the FULL layout */
+    sprintf(pkey, "packed_ %d", buf);
+    if (storage() == PARM_CIVECT_FULL || !write_packed((size_t)unit, pkey, ibuf))
+        psio_write_entry((size_t)unit, key, (char *)buffer_, size);
 
     if (ivect >= nvect_) nvect_ = ivect + 1;
     cur_vect_ = ivect;
@@ -1852,6 +1870,162 @@ int CIvect::write(int ivect, int ibuf) {
     return (1);
 }
 
+/*
+** CIvect::storage(): On-disk format of this vector.  SINGLE precision is
+** applied only to the Davidson subspace (C and sigma) files; H0 diagonal and
+** the D file, which holds the converged roots kept for restarts, guesses and
+** densities, stay in double precision (SPARSE).  MPn vectors hold the
+** perturbation corrections themselves and also stay in double precision.
+*/
+int CIvect::storage() {
+    if (CI_Params_ == nullptr || nunits_ < 1) return PARM_CIVECT_FULL;
+
+    int format = CI_Params_->civect_storage;
+    if (format == PARM_CIVECT_SINGLE) {
+        if (CI_Params_->mpn || CI_Params_->nodfile || units_[0] == CI_Params_->hd_filenum ||
+            units_[0] == CI_Params_->d_filenum)
+            format = PARM_CIVECT_SPARSE;
+    }
+    return format;
+}
+
+/*
+** CIvect::buf_block_range(): First and last block held in buffer ibuf.
+** The blocks of a buffer are contiguous in memory (see buf_lock()).
+*/
+void CIvect::buf_block_range(int ibuf, int *first, int *last) {
+    if (icore_ == 1) {
+        *first = 0;
+        *last = num_blocks_ - 1;
+    } else if (icore_ == 2) {
+        *first = first_ablk_[buf2blk_[ibuf]];
+        *last = last_ablk_[buf2blk_[ibuf]];
+    } else {
+        *first = *last = buf2blk_[ibuf];
+    }
+}
+
+/*
+** CIvect::write_packed(): Write buffer ibuf in the packed format under its
+** own key ("packed_ %d"), so it never shares an entry with the FULL layout.
+** The header holds the element size (sizeof(float) or sizeof(double)) and
+** one int per block (1 if the block is stored, 0 if it is all zero); the
+** stored blocks follow.  Entries are written at their exact size.  An entry
+** can only grow while it is the last one in the file, so if the buffer no
+** longer fits an earlier entry, the element size in its header is negated
+** to mark it as moved and 0 is returned; the caller then writes the buffer
+** in the FULL layout.
+**
+** Returns: 1 if the buffer was written packed, 0 otherwise
+*/
+int CIvect::write_packed(size_t unit, const char *key, int ibuf) {
+    int first, last;
+    int elsize = (storage() == PARM_CIVECT_SINGLE) ? (int)sizeof(float) : (int)sizeof(double);
+    bool single = (elsize == (int)sizeof(float));
+
+    buf_block_range(ibuf, &first, &last);
+    int nblk = last - first + 1;
+    size_t header = (nblk + 1) * sizeof(int);
+
+    std::vector<int> stored(nblk, 0);
+    size_t needed = header;
+    for (int blk = first; blk <= last; blk++) {
+        size_t n = (size_t)Ia_size_[blk] * (size_t)Ib_size_[blk];
+        if (!n) continue;
+        double *p = blocks_[blk][0];
+        for (size_t i = 0; i < n; i++) {
+            if (p[i] != 0.0) {
+                stored[blk - first] = 1;
+                needed += n * elsize;
+                break;
+            }
+        }
+    }
+
+    psio_address next = PSIO_ZERO;
+    psio_tocentry *entry = psio_tocscan(unit, key);
+    if (entry != nullptr && entry->next != nullptr) {
+        /* the entry is boxed in by the next one; its capacity is what it last held */
+        int old_elsize;
+        std::vector<int> old_stored(nblk);
+        psio_read(unit, key, (char *)&old_elsize, sizeof(int), next, &next);
+        psio_read(unit, key, (char *)old_stored.data(), nblk * sizeof(int), next, &next);
+        size_t capacity = header;
+        for (int blk = first; blk <= last; blk++) {
+            if (!old_stored[blk - first]) continue;
+            capacity += (size_t)Ia_size_[blk] * (size_t)Ib_size_[blk] * std::abs(old_elsize);
+        }
+        next = PSIO_ZERO;
+        if (needed > capacity) {
+            int moved = -std::abs(old_elsize);
+            psio_write(unit, key, (char *)&moved, sizeof(int), next, &next);
+            return 0;
+        }
+    }
+    psio_write(unit, key, (char *)&elsize, sizeof(int), next, &next);
+    psio_write(unit, key, (char *)stored.data(), nblk * sizeof(int), next, &next);
+
+    std::vector<float> chunk(single ? CIVECT_PACK_CHUNK : 0);
+    for (int blk = first; blk <= last; blk++) {
+        if (!stored[blk - first]) continue;
+        size_t n = (size_t)Ia_size_[blk] * (size_t)Ib_size_[blk];
+        double *p = blocks_[blk][0];
+        if (single) {
+            for (size_t off = 0; off < n; off += chunk.size()) {
+                size_t len = std::min(chunk.size(), n - off);
+                for (size_t i = 0; i < len; i++) chunk[i] = (float)p[off + i];
+                psio_write(unit, key, (char *)chunk.data(), len * sizeof(float), next, &next);
+            }
+        } else {
+            psio_write(unit, key, (char *)p, n * sizeof(double), next, &next);
+        }
+    }
+
+    return 1;
+}
+
+/*
+** CIvect::read_packed(): Read buffer ibuf written by write_packed(),
+** zero-filling the blocks that were not stored.  The precision is taken
+** from the entry's header, not from the current options.
+**
+** Returns: 1 if the buffer was read, 0 if the entry is marked as moved to
+**    the FULL layout
+*/
+int CIvect::read_packed(size_t unit, const char *key, int ibuf) {
+    int first, last, elsize;
+
+    buf_block_range(ibuf, &first, &last);
+    int nblk = last - first + 1;
+
+    std::vector<int> stored(nblk);
+    psio_address next = PSIO_ZERO;
+    psio_read(unit, key, (char *)&elsize, sizeof(int), next, &next);
+    if (elsize < 0) return 0;
+    psio_read(unit, key, (char *)stored.data(), nblk * sizeof(int), next, &next);
+    bool single = (elsize == (int)sizeof(float));
+
+    std::vector<float> chunk(single ? CIVECT_PACK_CHUNK : 0);
+    for (int blk = first; blk <= last; blk++) {
+        size_t n = (size_t)Ia_size_[blk] * (size_t)Ib_size_[blk];
+        if (!n) continue;
+        double *p = blocks_[blk][0];
+        if (!stored[blk - first]) {
+            std::fill(p, p + n, 0.0);
+        } else if (single) {
+            for (size_t off = 0; off < n; off += chunk.size()) {
+                size_t len = std::min(chunk.size(), n - off);
+                psio_read(unit, key, (char *)chunk.data(), len * sizeof(float), next, &next);
+                for (size_t i = 0; i < len; i++) p[off + i] = chunk[i];
+            }
+        } else {
+            psio_read(unit, key, (char *)p, n * sizeof(double), next, &next);
+        }
+    }
+
+    return 1;
+}
+
 /*
 ** CIvect::schmidt_add()
 **
@@ -3155,6 +3329,19 @@ int CIvect::check_zero_block(int blocknum) {
     return (zero_blocks_[blocknum]);
 }
 
+/*
+** CIvect::blk_max_abs(): Largest |c| in a block held in the current buffer
+*/
+double CIvect::blk_max_abs(int blocknum) {
+    size_t n = (size_t)Ia_size_[blocknum] * (size_t)Ib_size_[blocknum];
+    double maxval = 0.0;
+    if (!n) return maxval;
+
+    double *p = blocks_[blocknum][0];
+    for (size_t i = 0; i < n; i++) maxval = std::max(maxval, std::fabs(p[i]));
+    return maxval;
+}
+
 void CIvect::set_zero_block(int blocknum, int value) {
     if (blocknum < 0 || blocknum > num_blocks_) {
         outfile->Printf("CIvect::set_zero_block(): Block %d out of range\n", blocknum);
@@ -127,6 +127,12 @@ class CIvect {
     double ssq(struct stringwr *alplist, struct stringwr *betlist, double **CL, double **CR, int nas, int nbs,
                int Ja_list, int Jb_list);
 
+    /* packed (CI_VECTOR_STORAGE = SPARSE or SINGLE) disk format */
+    int storage();
+    void buf_block_range(int ibuf, int *first, int *last);
+    int read_packed(size_t unit, const char *key, int ibuf);
+    int write_packed(size_t unit, const char *key, int ibuf);
+
    public:
     CIvect();
     CIvect(size_t vl, int nb, int incor, int ms0, int *iac, int *ibc, int *ias, int *ibs, size_t *offs, int nac,
@@ -230,6 +236,7 @@ class CIvect {
     void h0block_gather_vec(int vecode);
     void h0block_gather_multivec(double *vec);
     int check_zero_block(int blocknum);
+    double blk_max_abs(int blocknum);
     void set_zero_block(int blocknum, int value);
     void set_zero_blocks_all();
     void copy_zero_blocks(CIvect &src);
@@ -467,6 +467,15 @@ void CIWavefunction::get_parameters(Options &options) {
     }
     if (Parameters_->nthreads < 1) Parameters_->nthreads = 1;
 
+    std::string storage = options.get_str("CI_VECTOR_STORAGE");
+    if (storage == "SPARSE")
+        Parameters_->civect_storage = PARM_CIVECT_SPARSE;
+    else if (storage == "SINGLE")
+        Parameters_->civect_storage = PARM_CIVECT_SINGLE;
+    else
+        Parameters_->civect_storage = PARM_CIVECT_FULL;
+    Parameters_->sigma_block_tol = options.get_double("SIGMA_BLOCK_TOLERANCE");
+
     Parameters_->sf_restrict = options["SF_RESTRICT"].to_integer();
     Parameters_->print_sigma_overlap = options["SIGMA_OVERLAP"].to_integer();
 
@@ -797,6 +806,11 @@ void CIWavefunction::print_parameters() {
             break;
     }
 
+    outfile->Printf("    CI STORAGE     =   %6s      SIGMA BLK TOL = %6.2e\n",
+                    Parameters_->civect_storage == PARM_CIVECT_SINGLE
+                        ? "SINGLE"
+                        : (Parameters_->civect_storage == PARM_CIVECT_SPARSE ? "SPARSE" : "FULL"),
+                    Parameters_->sigma_block_tol);
     outfile->Printf("    COLLAPSE SIZE  =   %6d", Parameters_->collapse_size);
     outfile->Printf("      HD AVG        = ");
     switch (Parameters_->hd_ave) {
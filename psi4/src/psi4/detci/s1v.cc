@@ -51,6 +51,10 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "psi4/libciomr/libciomr.h"
 #include "psi4/libqt/qt.h"
 #include "psi4/libmints/wavefunction.h"
@@ -84,77 +88,92 @@ extern void b2brepl(unsigned char **occs, int *Jcnt, int **Jij, int **Joij, int
 ** Modified 5/10/96 for new sparse-F method
 */
 void s1_block_vfci(struct stringwr **alplist, struct stringwr **betlist, double **C, double **S, double *oei,
-                   double *tei, double *F, int nlists, int nas, int nbs, int Ib_list, int Jb_list, int Jb_list_nbs) {
-    struct stringwr *Ib, *Kb;
-    size_t Ia_idx, Ib_idx, Kb_idx, Jb_idx;
-    size_t Ibcnt, Kbcnt, Kb_list, Ib_ex, Kb_ex;
-    size_t *Ibridx, *Kbridx;
-    int *Ibij, *Kbij;
-    signed char *Ibsgn, *Kbsgn;
-    int ij, kl, ijkl;
-    double Kb_sgn, Jb_sgn;
-    double tval;
+                   double *tei, double *Fshared, int nlists, int nas, int nbs, int Ib_list, int Jb_list,
+                   int Jb_list_nbs, int nthreads) {
+    /* each thread owns whole columns I_b of S and keeps its own F */
+#pragma omp parallel num_threads(nthreads)
+    {
+        struct stringwr *Ib, *Kb;
+        size_t Ia_idx, Ib_idx, Kb_idx, Jb_idx;
+        size_t Ibcnt, Kbcnt, Kb_list, Ib_ex, Kb_ex;
+        size_t *Ibridx, *Kbridx;
+        int *Ibij, *Kbij;
+        signed char *Ibsgn, *Kbsgn;
+        int ij, kl, ijkl;
+        double Kb_sgn, Jb_sgn;
+        double tval;
+        std::vector<double> Fprivate;
+        double *F = Fshared;
+#ifdef _OPENMP
+        if (omp_get_thread_num() != 0) {
+            Fprivate.resize(Jb_list_nbs);
+            F = Fprivate.data();
+        }
+#endif
 
-    /* loop over I_b */
-    for (Ib = betlist[Ib_list], Ib_idx = 0; Ib_idx < nbs; Ib_idx++, Ib++) {
-        zero_arr(F, Jb_list_nbs);
+        /* loop over I_b */
+#pragma omp for schedule(dynamic)
+        for (Ib_idx = 0; Ib_idx < nbs; Ib_idx++) {
+            Ib = betlist[Ib_list] + Ib_idx;
+            zero_arr(F, Jb_list_nbs);
 
-        /* loop over excitations E^b_{kl} from |B(I_b)> */
-        for (Kb_list = 0; Kb_list < nlists; Kb_list++) {
-            Ibcnt = Ib->cnt[Kb_list];
-            Ibridx = Ib->ridx[Kb_list];
-            Ibsgn = Ib->sgn[Kb_list];
-            Ibij = Ib->ij[Kb_list];
-            for (Ib_ex = 0; Ib_ex < Ibcnt; Ib_ex++) {
-                kl = *Ibij++;
-                Kb_idx = *Ibridx++;
-                Kb_sgn = (double)*Ibsgn++;
+            /* loop over excitations E^b_{kl} from |B(I_b)> */
+            for (Kb_list = 0; Kb_list < nlists; Kb_list++) {
+                Ibcnt = Ib->cnt[Kb_list];
+                Ibridx = Ib->ridx[Kb_list];
+                Ibsgn = Ib->sgn[Kb_list];
+                Ibij = Ib->ij[Kb_list];
+                for (Ib_ex = 0; Ib_ex < Ibcnt; Ib_ex++) {
+                    kl = *Ibij++;
+                    Kb_idx = *Ibridx++;
+                    Kb_sgn = (double)*Ibsgn++;
+
+                    /* B(K_b) = sgn(kl) * E^b_{kl} |B(I_b)> */
+                    Kb = betlist[Kb_list] + Kb_idx;
+                    if (Kb_list == Jb_list) F[Kb_idx] += Kb_sgn * oei[kl];
+
+                    /* loop over excitations E^b_{ij} from |B(K_b)> */
+                    /* Jb_list pre-determined because of C blocking */
+                    Kbcnt = Kb->cnt[Jb_list];
+                    Kbridx = Kb->ridx[Jb_list];
+                    Kbsgn = Kb->sgn[Jb_list];
+                    Kbij = Kb->ij[Jb_list];
+                    for (Kb_ex = 0; Kb_ex < Kbcnt; Kb_ex++) {
+                        Jb_idx = *Kbridx++;
+                        Jb_sgn = (double)*Kbsgn++;
+                        ij = *Kbij++;
+                        ijkl = INDEX(ij, kl);
+                        F[Jb_idx] += 0.5 * Kb_sgn * Jb_sgn * tei[ijkl];
+                    }
+                } /* end loop over Ib excitations */
+            }     /* end loop over Kb_list */
 
-                /* B(K_b) = sgn(kl) * E^b_{kl} |B(I_b)> */
-                Kb = betlist[Kb_list] + Kb_idx;
-                if (Kb_list == Jb_list) F[Kb_idx] += Kb_sgn * oei[kl];
+            /*
+            for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
+               tval = 0.0;
+               for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
+                  tval += C[Ia_idx][Jb_idx] * F[Jb_idx];
+                  }
+               S[Ia_idx][Ib_idx] += tval;
+               }
+            */
 
-                /* loop over excitations E^b_{ij} from |B(K_b)> */
-                /* Jb_list pre-determined because of C blocking */
-                Kbcnt = Kb->cnt[Jb_list];
-                Kbridx = Kb->ridx[Jb_list];
-                Kbsgn = Kb->sgn[Jb_list];
-                Kbij = Kb->ij[Jb_list];
-                for (Kb_ex = 0; Kb_ex < Kbcnt; Kb_ex++) {
-                    Jb_idx = *Kbridx++;
-                    Jb_sgn = (double)*Kbsgn++;
-                    ij = *Kbij++;
-                    ijkl = INDEX(ij, kl);
-                    F[Jb_idx] += 0.5 * Kb_sgn * Jb_sgn * tei[ijkl];
-                }
-            } /* end loop over Ib excitations */
-        }     /* end loop over Kb_list */
-
-        /*
-        for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
-           tval = 0.0;
-           for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
-              tval += C[Ia_idx][Jb_idx] * F[Jb_idx];
-              }
-           S[Ia_idx][Ib_idx] += tval;
-           }
-        */
-
-        /* need to improve mem access pattern here! Above vers may be better! */
-        /* min op cnt may also be better */
-        for (Jb_idx = 0; Jb_idx < Jb_list_nbs; Jb_idx++) {
-            if ((tval = F[Jb_idx]) == 0.0) continue;
+            /* need to improve mem access pattern here! Above vers may be better! */
+            /* min op cnt may also be better */
+            for (Jb_idx = 0; Jb_idx < Jb_list_nbs; Jb_idx++) {
+                if ((tval = F[Jb_idx]) == 0.0) continue;
 
 #ifdef USE_BLAS
-            C_DAXPY(nas, tval, (C[0] + Jb_idx), Jb_list_nbs, (S[0] + Ib_idx), nbs);
+                C_DAXPY(nas, tval, (C[0] + Jb_idx), Jb_list_nbs, (S[0] + Ib_idx), nbs);
 #else
-            for (Ia_idx = 0; Ia_idx < nas; Ia_idx++) {
-                S[Ia_idx][Ib_idx] += tval * C[Ia_idx][Jb_idx];
-            }
+                for (Ia_idx = 0; Ia_idx < nas; Ia_idx++) {
+                    S[Ia_idx][Ib_idx] += tval * C[Ia_idx][Jb_idx];
+                }
 #endif
-        }
+            }
 
-    } /* end loop over Ib */
+        } /* end loop over Ib */
+    }
 }
 
 /*
@@ -178,85 +197,100 @@ void s1_block_vfci(struct stringwr **alplist, struct stringwr **betlist, double
 ** Modified 5/10/96 for new sparse-F method
 */
 void s1_block_vras(struct stringwr **alplist, struct stringwr **betlist, double **C, double **S, double *oei,
-                   double *tei, double *F, int nlists, int nas, int nbs, int Ib_list, int Jb_list, int Jb_list_nbs) {
-    struct stringwr *Ib, *Kb;
-    size_t Ia_idx, Ib_idx, Kb_idx, Jb_idx;
-    size_t Ibcnt, Kbcnt, Kb_list, Ib_ex, Kb_ex;
-    size_t *Ibridx, *Kbridx;
-    int *Ibij, *Kbij, *Iboij, *Kboij;
-    signed char *Ibsgn, *Kbsgn;
-    int ij, kl, ijkl, oij, okl;
-    double Kb_sgn, Jb_sgn;
-    double tval;
+                   double *tei, double *Fshared, int nlists, int nas, int nbs, int Ib_list, int Jb_list,
+                   int Jb_list_nbs, int nthreads) {
+    /* each thread owns whole columns I_b of S and keeps its own F */
+#pragma omp parallel num_threads(nthreads)
+    {
+        struct stringwr *Ib, *Kb;
+        size_t Ia_idx, Ib_idx, Kb_idx, Jb_idx;
+        size_t Ibcnt, Kbcnt, Kb_list, Ib_ex, Kb_ex;
+        size_t *Ibridx, *Kbridx;
+        int *Ibij, *Kbij, *Iboij, *Kboij;
+        signed char *Ibsgn, *Kbsgn;
+        int ij, kl, ijkl, oij, okl;
+        double Kb_sgn, Jb_sgn;
+        double tval;
+        std::vector<double> Fprivate;
+        double *F = Fshared;
+#ifdef _OPENMP
+        if (omp_get_thread_num() != 0) {
+            Fprivate.resize(Jb_list_nbs);
+            F = Fprivate.data();
+        }
+#endif
 
-    /* loop over I_b */
-    for (Ib = betlist[Ib_list], Ib_idx = 0; Ib_idx < nbs; Ib_idx++, Ib++) {
-        zero_arr(F, Jb_list_nbs);
-
-        /* loop over excitations E^b_{kl} from |B(I_b)> */
-        for (Kb_list = 0; Kb_list < nlists; Kb_list++) {
-            Ibcnt = Ib->cnt[Kb_list];
-            Ibridx = Ib->ridx[Kb_list];
-            Ibsgn = Ib->sgn[Kb_list];
-            Ibij = Ib->ij[Kb_list];
-            Iboij = Ib->oij[Kb_list];
-            for (Ib_ex = 0; Ib_ex < Ibcnt; Ib_ex++) {
-                kl = *Ibij++;
-                okl = *Iboij++;
-                Kb_idx = *Ibridx++;
-                Kb_sgn = (double)*Ibsgn++;
+        /* loop over I_b */
+#pragma omp for schedule(dynamic)
+        for (Ib_idx = 0; Ib_idx < nbs; Ib_idx++) {
+            Ib = betlist[Ib_list] + Ib_idx;
+            zero_arr(F, Jb_list_nbs);
 
-                /* B(K_b) = sgn(kl) * E^b_{kl} |B(I_b)> */
-                Kb = betlist[Kb_list] + Kb_idx;
-                /* note okl on next line, not kl */
-                if (Kb_list == Jb_list) F[Kb_idx] += Kb_sgn * oei[okl];
+            /* loop over excitations E^b_{kl} from |B(I_b)> */
+            for (Kb_list = 0; Kb_list < nlists; Kb_list++) {
+                Ibcnt = Ib->cnt[Kb_list];
+                Ibridx = Ib->ridx[Kb_list];
+                Ibsgn = Ib->sgn[Kb_list];
+                Ibij = Ib->ij[Kb_list];
+                Iboij = Ib->oij[Kb_list];
+                for (Ib_ex = 0; Ib_ex < Ibcnt; Ib_ex++) {
+                    kl = *Ibij++;
+                    okl = *Iboij++;
+                    Kb_idx = *Ibridx++;
+                    Kb_sgn = (double)*Ibsgn++;
+
+                    /* B(K_b) = sgn(kl) * E^b_{kl} |B(I_b)> */
+                    Kb = betlist[Kb_list] + Kb_idx;
+                    /* note okl on next line, not kl */
+                    if (Kb_list == Jb_list) F[Kb_idx] += Kb_sgn * oei[okl];
+
+                    /* loop over excitations E^b_{ij} from |B(K_b)> */
+                    /* Jb_list pre-determined because of C blocking */
+                    Kbcnt = Kb->cnt[Jb_list];
+                    Kbridx = Kb->ridx[Jb_list];
+                    Kbsgn = Kb->sgn[Jb_list];
+                    Kbij = Kb->ij[Jb_list];
+                    Kboij = Kb->oij[Jb_list];
+                    for (Kb_ex = 0; Kb_ex < Kbcnt; Kb_ex++) {
+                        Jb_idx = *Kbridx++;
+                        Jb_sgn = (double)*Kbsgn++;
+                        ij = *Kbij++;
+                        oij = *Kboij++;
+                        ijkl = INDEX(ij, kl);
+                        if (oij > okl)
+                            F[Jb_idx] += Kb_sgn * Jb_sgn * tei[ijkl];
+                        else if (oij == okl)
+                            F[Jb_idx] += 0.5 * Kb_sgn * Jb_sgn * tei[ijkl];
+                    }
+                } /* end loop over Ib excitations */
+            }     /* end loop over Kb_list */
 
-                /* loop over excitations E^b_{ij} from |B(K_b)> */
-                /* Jb_list pre-determined because of C blocking */
-                Kbcnt = Kb->cnt[Jb_list];
-                Kbridx = Kb->ridx[Jb_list];
-                Kbsgn = Kb->sgn[Jb_list];
-                Kbij = Kb->ij[Jb_list];
-                Kboij = Kb->oij[Jb_list];
-                for (Kb_ex = 0; Kb_ex < Kbcnt; Kb_ex++) {
-                    Jb_idx = *Kbridx++;
-                    Jb_sgn = (double)*Kbsgn++;
-                    ij = *Kbij++;
-                    oij = *Kboij++;
-                    ijkl = INDEX(ij, kl);
-                    if (oij > okl)
-                        F[Jb_idx] += Kb_sgn * Jb_sgn * tei[ijkl];
-                    else if (oij == okl)
-                        F[Jb_idx] += 0.5 * Kb_sgn * Jb_sgn * tei[ijkl];
-                }
-            } /* end loop over Ib excitations */
-        }     /* end loop over Kb_list */
-
-        /*
-        for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
-           tval = 0.0;
-           for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
-              tval += C[Ia_idx][Jb_idx] * F[Jb_idx];
-              }
-           S[Ia_idx][Ib_idx] += tval;
-           }
-        */
-
-        /* need to improve mem access pattern here! Above vers may be better!  */
-        /* min op cnt may also be better */
-        for (Jb_idx = 0; Jb_idx < Jb_list_nbs; Jb_idx++) {
-            if ((tval = F[Jb_idx]) == 0.0) continue;
+            /*
+            for (Ia_idx=0; Ia_idx < nas; Ia_idx++) {
+               tval = 0.0;
+               for (Jb_idx=0; Jb_idx < Jb_list_nbs; Jb_idx++) {
+                  tval += C[Ia_idx][Jb_idx] * F[Jb_idx];
+                  }
+               S[Ia_idx][Ib_idx] += tval;
+               }
+            */
+
+            /* need to improve mem access pattern here! Above vers may be better!  */
+            /* min op cnt may also be better */
+            for (Jb_idx = 0; Jb_idx < Jb_list_nbs; Jb_idx++) {
+                if ((tval = F[Jb_idx]) == 0.0) continue;
 
 #ifdef USE_BLAS
-            C_DAXPY(nas, tval, (C[0] + Jb_idx), Jb_list_nbs, (S[0] + Ib_idx), nbs);
+                C_DAXPY(nas, tval, (C[0] + Jb_idx), Jb_list_nbs, (S[0] + Ib_idx), nbs);
 #else
-            for (Ia_idx = 0; Ia_idx < nas; Ia_idx++) {
-                S[Ia_idx][Ib_idx] += tval * C[Ia_idx][Jb_idx];
-            }
+                for (Ia_idx = 0; Ia_idx < nas; Ia_idx++) {
+                    S[Ia_idx][Ib_idx] += tval * C[Ia_idx][Jb_idx];
+                }
 #endif
-        }
+            }
 
-    } /* end loop over Ib */
+        } /* end loop over Ib */
+    }
 }
 
 /*
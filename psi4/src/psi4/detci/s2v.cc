@@ -39,6 +39,10 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "psi4/libciomr/libciomr.h"
 #include "psi4/libqt/qt.h"
 #include "psi4/libmints/wavefunction.h"
@@ -66,84 +70,99 @@ extern void b2brepl(unsigned char **occs, int *Jcnt, int **Jij, int **Joij, int
 ** Based on many previous versions by David Sherrill 1994-5
 */
 void s2_block_vfci(struct stringwr **alplist, struct stringwr **betlist, double **C, double **S, double *oei,
-                   double *tei, double *F, int nlists, int nas, int nbs, int Ia_list, int Ja_list, int Ja_list_nas) {
-    struct stringwr *Ia, *Ka;
-    size_t Ia_idx, Ib_idx, Ka_idx, Ja_idx;
-    size_t Iacnt, Kacnt, Ka_list, Ia_ex, Ka_ex;
-    size_t *Iaridx, *Karidx;
-    int *Iaij, *Kaij;
-    signed char *Iasgn, *Kasgn;
-    int ij, kl, ijkl;
-    double Ka_sgn, Ja_sgn;
-    double tval;
-    double *Sptr, *Cptr;
-
-    /* loop over all alpha strings Ia that belong to list Ia_list (irrep, block
-     * of alpha strings) */
-    for (Ia = alplist[Ia_list], Ia_idx = 0; Ia_idx < nas; Ia_idx++, Ia++) {
-        Sptr = S[Ia_idx];
-        zero_arr(F, Ja_list_nas);
-
-        /* loop over excitations E^a_{kl} from |A(I_a)> */
-
-        /* first loop over the K_a lists to block the excited strings by
-         * irrep or RAS code */
-        for (Ka_list = 0; Ka_list < nlists; Ka_list++) {
-            Iacnt = Ia->cnt[Ka_list];
-            Iaridx = Ia->ridx[Ka_list];
-            Iasgn = Ia->sgn[Ka_list];
-            Iaij = Ia->ij[Ka_list];
-
-            /* Now loop over excited strings that belong to the given block Ka_list */
-            for (Ia_ex = 0; Ia_ex < Iacnt; Ia_ex++) {
-                kl = *Iaij++;
-                Ka_idx = *Iaridx++;
-                Ka_sgn = (double)*Iasgn++;
+                   double *tei, double *Fshared, int nlists, int nas, int nbs, int Ia_list, int Ja_list,
+                   int Ja_list_nas, int nthreads) {
+    /* each thread owns whole rows I_a of S and keeps its own F */
+#pragma omp parallel num_threads(nthreads)
+    {
+        struct stringwr *Ia, *Ka;
+        size_t Ia_idx, Ib_idx, Ka_idx, Ja_idx;
+        size_t Iacnt, Kacnt, Ka_list, Ia_ex, Ka_ex;
+        size_t *Iaridx, *Karidx;
+        int *Iaij, *Kaij;
+        signed char *Iasgn, *Kasgn;
+        int ij, kl, ijkl;
+        double Ka_sgn, Ja_sgn;
+        double tval;
+        double *Sptr, *Cptr;
+        std::vector<double> Fprivate;
+        double *F = Fshared;
+#ifdef _OPENMP
+        if (omp_get_thread_num() != 0) {
+            Fprivate.resize(Ja_list_nas);
+            F = Fprivate.data();
+        }
+#endif
 
-                /* A(K_a) = sgn(kl) * E^a_{kl} |A(I_a)> */
-                Ka = alplist[Ka_list] + Ka_idx;
-                if (Ka_list == Ja_list) F[Ka_idx] += Ka_sgn * oei[kl];
+        /* loop over all alpha strings Ia that belong to list Ia_list (irrep, block
+         * of alpha strings) */
+#pragma omp for schedule(dynamic)
+        for (Ia_idx = 0; Ia_idx < nas; Ia_idx++) {
+            Ia = alplist[Ia_list] + Ia_idx;
+            Sptr = S[Ia_idx];
+            zero_arr(F, Ja_list_nas);
 
-                /* loop over excitations E^a_{ij} from |A(K_a)> */
-                /* Ja_list pre-determined because of C blocking */
-                Kacnt = Ka->cnt[Ja_list];
-                Karidx = Ka->ridx[Ja_list];
-                Kasgn = Ka->sgn[Ja_list];
-                Kaij = Ka->ij[Ja_list];
-                for (Ka_ex = 0; Ka_ex < Kacnt; Ka_ex++) {
-                    Ja_idx = *Karidx++;
-                    Ja_sgn = (double)*Kasgn++;
-                    ij = *Kaij++;
-                    ijkl = INDEX(ij, kl);
-                    F[Ja_idx] += 0.5 * Ka_sgn * Ja_sgn * tei[ijkl];
-                }
-            } /* end loop over Ia excitations */
-        }     /* end loop over Ka_list */
-
-        /*
-        for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
-           tval = 0.0;
-           for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
-              tval += C[Ja_idx][Ib_idx] * F[Ja_idx];
-              }
-           S[Ia_idx][Ib_idx] += tval;
-           }
-        */
-
-        for (Ja_idx = 0; Ja_idx < Ja_list_nas; Ja_idx++) {
-            if ((tval = F[Ja_idx]) == 0.0) continue;
-            Cptr = C[Ja_idx];
+            /* loop over excitations E^a_{kl} from |A(I_a)> */
+
+            /* first loop over the K_a lists to block the excited strings by
+             * irrep or RAS code */
+            for (Ka_list = 0; Ka_list < nlists; Ka_list++) {
+                Iacnt = Ia->cnt[Ka_list];
+                Iaridx = Ia->ridx[Ka_list];
+                Iasgn = Ia->sgn[Ka_list];
+                Iaij = Ia->ij[Ka_list];
+
+                /* Now loop over excited strings that belong to the given block Ka_list */
+                for (Ia_ex = 0; Ia_ex < Iacnt; Ia_ex++) {
+                    kl = *Iaij++;
+                    Ka_idx = *Iaridx++;
+                    Ka_sgn = (double)*Iasgn++;
+
+                    /* A(K_a) = sgn(kl) * E^a_{kl} |A(I_a)> */
+                    Ka = alplist[Ka_list] + Ka_idx;
+                    if (Ka_list == Ja_list) F[Ka_idx] += Ka_sgn * oei[kl];
+
+                    /* loop over excitations E^a_{ij} from |A(K_a)> */
+                    /* Ja_list pre-determined because of C blocking */
+                    Kacnt = Ka->cnt[Ja_list];
+                    Karidx = Ka->ridx[Ja_list];
+                    Kasgn = Ka->sgn[Ja_list];
+                    Kaij = Ka->ij[Ja_list];
+                    for (Ka_ex = 0; Ka_ex < Kacnt; Ka_ex++) {
+                        Ja_idx = *Karidx++;
+                        Ja_sgn = (double)*Kasgn++;
+                        ij = *Kaij++;
+                        ijkl = INDEX(ij, kl);
+                        F[Ja_idx] += 0.5 * Ka_sgn * Ja_sgn * tei[ijkl];
+                    }
+                } /* end loop over Ia excitations */
+            }     /* end loop over Ka_list */
+
+            /*
+            for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
+               tval = 0.0;
+               for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
+                  tval += C[Ja_idx][Ib_idx] * F[Ja_idx];
+                  }
+               S[Ia_idx][Ib_idx] += tval;
+               }
+            */
+
+            for (Ja_idx = 0; Ja_idx < Ja_list_nas; Ja_idx++) {
+                if ((tval = F[Ja_idx]) == 0.0) continue;
+                Cptr = C[Ja_idx];
 
 #ifdef USE_BLAS
-            C_DAXPY(nbs, tval, Cptr, 1, Sptr, 1);
+                C_DAXPY(nbs, tval, Cptr, 1, Sptr, 1);
 #else
-            for (Ib_idx = 0; Ib_idx < nbs; Ib_idx++) {
-                Sptr[Ib_idx] += tval * Cptr[Ib_idx];
-            }
+                for (Ib_idx = 0; Ib_idx < nbs; Ib_idx++) {
+                    Sptr[Ib_idx] += tval * Cptr[Ib_idx];
+                }
 #endif
-        }
+            }
 
-    } /* end loop over Ia */
+        } /* end loop over Ia */
+    }
 }
 
 /*
@@ -166,85 +185,100 @@ void s2_block_vfci(struct stringwr **alplist, struct stringwr **betlist, double
 ** Modified 5/10/96 for more vectorized approach
 */
 void s2_block_vras(struct stringwr **alplist, struct stringwr **betlist, double **C, double **S, double *oei,
-                   double *tei, double *F, int nlists, int nas, int nbs, int Ia_list, int Ja_list, int Ja_list_nas) {
-    struct stringwr *Ia, *Ka;
-    size_t Ia_idx, Ib_idx, Ka_idx, Ja_idx;
-    size_t Iacnt, Kacnt, Ka_list, Ia_ex, Ka_ex;
-    size_t *Iaridx, *Karidx;
-    int *Iaij, *Kaij, *Iaoij, *Kaoij;
-    signed char *Iasgn, *Kasgn;
-    int ij, kl, ijkl, oij, okl;
-    double Ka_sgn, Ja_sgn;
-    double tval;
-    double *Sptr, *Cptr;
-
-    /* loop over I_a */
-    for (Ia = alplist[Ia_list], Ia_idx = 0; Ia_idx < nas; Ia_idx++, Ia++) {
-        Sptr = S[Ia_idx];
-        zero_arr(F, Ja_list_nas);
-
-        /* loop over excitations E^a_{kl} from |A(I_a)> */
-        for (Ka_list = 0; Ka_list < nlists; Ka_list++) {
-            Iacnt = Ia->cnt[Ka_list];
-            Iaridx = Ia->ridx[Ka_list];
-            Iasgn = Ia->sgn[Ka_list];
-            Iaij = Ia->ij[Ka_list];
-            Iaoij = Ia->oij[Ka_list];
-            for (Ia_ex = 0; Ia_ex < Iacnt; Ia_ex++) {
-                kl = *Iaij++;
-                okl = *Iaoij++;
-                Ka_idx = *Iaridx++;
-                Ka_sgn = (double)*Iasgn++;
+                   double *tei, double *Fshared, int nlists, int nas, int nbs, int Ia_list, int Ja_list,
+                   int Ja_list_nas, int nthreads) {
+    /* each thread owns whole rows I_a of S and keeps its own F */
+#pragma omp parallel num_threads(nthreads)
+    {
+        struct stringwr *Ia, *Ka;
+        size_t Ia_idx, Ib_idx, Ka_idx, Ja_idx;
+        size_t Iacnt, Kacnt, Ka_list, Ia_ex, Ka_ex;
+        size_t *Iaridx, *Karidx;
+        int *Iaij, *Kaij, *Iaoij, *Kaoij;
+        signed char *Iasgn, *Kasgn;
+        int ij, kl, ijkl, oij, okl;
+        double Ka_sgn, Ja_sgn;
+        double tval;
+        double *Sptr, *Cptr;
+        std::vector<double> Fprivate;
+        double *F = Fshared;
+#ifdef _OPENMP
+        if (omp_get_thread_num() != 0) {
+            Fprivate.resize(Ja_list_nas);
+            F = Fprivate.data();
+        }
+#endif
 
-                /* A(K_a) = sgn(kl) * E^a_{kl} |A(I_a)> */
-                Ka = alplist[Ka_list] + Ka_idx;
-                /* note okl on next line, not kl */
-                if (Ka_list == Ja_list) F[Ka_idx] += Ka_sgn * oei[okl];
+        /* loop over I_a */
+#pragma omp for schedule(dynamic)
+        for (Ia_idx = 0; Ia_idx < nas; Ia_idx++) {
+            Ia = alplist[Ia_list] + Ia_idx;
+            Sptr = S[Ia_idx];
+            zero_arr(F, Ja_list_nas);
 
-                /* loop over excitations E^a_{ij} from |A(K_a)> */
-                /* Ja_list pre-determined because of C blocking */
-                Kacnt = Ka->cnt[Ja_list];
-                Karidx = Ka->ridx[Ja_list];
-                Kasgn = Ka->sgn[Ja_list];
-                Kaij = Ka->ij[Ja_list];
-                Kaoij = Ka->oij[Ja_list];
-                for (Ka_ex = 0; Ka_ex < Kacnt; Ka_ex++) {
-                    Ja_idx = *Karidx++;
-                    Ja_sgn = (double)*Kasgn++;
-                    ij = *Kaij++;
-                    oij = *Kaoij++;
-                    ijkl = INDEX(ij, kl);
-                    if (oij > okl)
-                        F[Ja_idx] += Ka_sgn * Ja_sgn * tei[ijkl];
-                    else if (oij == okl)
-                        F[Ja_idx] += 0.5 * Ka_sgn * Ja_sgn * tei[ijkl];
-                }
-            } /* end loop over Ia excitations */
-        }     /* end loop over Ka_list */
-
-        /*
-        for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
-           tval = 0.0;
-           for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
-              tval += C[Ja_idx][Ib_idx] * F[Ja_idx];
-              }
-           S[Ia_idx][Ib_idx] += tval;
-           }
-        */
-
-        for (Ja_idx = 0; Ja_idx < Ja_list_nas; Ja_idx++) {
-            if ((tval = F[Ja_idx]) == 0.0) continue;
-            Cptr = C[Ja_idx];
+            /* loop over excitations E^a_{kl} from |A(I_a)> */
+            for (Ka_list = 0; Ka_list < nlists; Ka_list++) {
+                Iacnt = Ia->cnt[Ka_list];
+                Iaridx = Ia->ridx[Ka_list];
+                Iasgn = Ia->sgn[Ka_list];
+                Iaij = Ia->ij[Ka_list];
+                Iaoij = Ia->oij[Ka_list];
+                for (Ia_ex = 0; Ia_ex < Iacnt; Ia_ex++) {
+                    kl = *Iaij++;
+                    okl = *Iaoij++;
+                    Ka_idx = *Iaridx++;
+                    Ka_sgn = (double)*Iasgn++;
+
+                    /* A(K_a) = sgn(kl) * E^a_{kl} |A(I_a)> */
+                    Ka = alplist[Ka_list] + Ka_idx;
+                    /* note okl on next line, not kl */
+                    if (Ka_list == Ja_list) F[Ka_idx] += Ka_sgn * oei[okl];
+
+                    /* loop over excitations E^a_{ij} from |A(K_a)> */
+                    /* Ja_list pre-determined because of C blocking */
+                    Kacnt = Ka->cnt[Ja_list];
+                    Karidx = Ka->ridx[Ja_list];
+                    Kasgn = Ka->sgn[Ja_list];
+                    Kaij = Ka->ij[Ja_list];
+                    Kaoij = Ka->oij[Ja_list];
+                    for (Ka_ex = 0; Ka_ex < Kacnt; Ka_ex++) {
+                        Ja_idx = *Karidx++;
+                        Ja_sgn = (double)*Kasgn++;
+                        ij = *Kaij++;
+                        oij = *Kaoij++;
+                        ijkl = INDEX(ij, kl);
+                        if (oij > okl)
+                            F[Ja_idx] += Ka_sgn * Ja_sgn * tei[ijkl];
+                        else if (oij == okl)
+                            F[Ja_idx] += 0.5 * Ka_sgn * Ja_sgn * tei[ijkl];
+                    }
+                } /* end loop over Ia excitations */
+            }     /* end loop over Ka_list */
+
+            /*
+            for (Ib_idx=0; Ib_idx < nbs; Ib_idx++) {
+               tval = 0.0;
+               for (Ja_idx=0; Ja_idx < Ja_list_nas; Ja_idx++) {
+                  tval += C[Ja_idx][Ib_idx] * F[Ja_idx];
+                  }
+               S[Ia_idx][Ib_idx] += tval;
+               }
+            */
+
+            for (Ja_idx = 0; Ja_idx < Ja_list_nas; Ja_idx++) {
+                if ((tval = F[Ja_idx]) == 0.0) continue;
+                Cptr = C[Ja_idx];
 #ifdef USE_BLAS
-            C_DAXPY(nbs, tval, Cptr, 1, Sptr, 1);
+                C_DAXPY(nbs, tval, Cptr, 1, Sptr, 1);
 #else
-            for (Ib_idx = 0; Ib_idx < nbs; Ib_idx++) {
-                Sptr[Ib_idx] += tval * Cptr[Ib_idx];
-            }
+                for (Ib_idx = 0; Ib_idx < nbs; Ib_idx++) {
+                    Sptr[Ib_idx] += tval * Cptr[Ib_idx];
+                }
 #endif
-        }
+            }
 
-    } /* end loop over Ia */
+        } /* end loop over Ia */
+    }
 }
 
 /*
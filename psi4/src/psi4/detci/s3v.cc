@@ -36,6 +36,10 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "psi4/libciomr/libciomr.h"
 #include "psi4/libqt/qt.h"
 #include "psi4/libmints/wavefunction.h"
@@ -64,73 +68,86 @@ int form_ilist_rotf(int *Cnt, int **Ridx, signed char **Sn, int **Ij, int nas, i
 */
 void s3_block_vdiag(struct stringwr *alplist, struct stringwr *betlist, double **C, double **S, double *tei, int nas,
                     int nbs, int cnas, int Ib_list, int Ja_list, int Jb_list, int Ib_sym, int Jb_sym, double **Cprime,
-                    double *F, double *V, double *Sgn, int *L, int *R, int norbs, int *orbsym) {
-    struct stringwr *Ia;
-    size_t Ia_ex;
-    int ij, i, j, t, kl, I, J, RJ;
-    double tval, VS, *CprimeI0, *CI0;
-    int jlen, Jacnt, *Iaij, Ia_idx;
-    size_t *Iaridx;
-    signed char *Iasgn;
-    double *Tptr;
-    int npthreads, rc, status;
+                    double *F, double *Vshared, double *Sgn, int *L, int *R, int norbs, int *orbsym, int nthreads) {
+    /* the ij loop is run by every thread; each thread owns whole rows I_a of S */
+#pragma omp parallel num_threads(nthreads)
+    {
+        struct stringwr *Ia;
+        size_t Ia_ex;
+        int ij, i, j, kl, I, J, RJ;
+        double tval, VS, *CprimeI0, *CI0;
+        int jlen, Jacnt, *Iaij, Ia_idx;
+        size_t *Iaridx;
+        signed char *Iasgn;
+        double *Tptr;
+        std::vector<double> Vprivate;
+        double *V = Vshared;
+#ifdef _OPENMP
+        if (omp_get_thread_num() != 0) {
+            Vprivate.resize(nbs);
+            V = Vprivate.data();
+        }
+#endif
 
-    /* loop over i, j */
-    for (i = 0; i < norbs; i++) {
-        for (j = 0; j <= i; j++) {
-            if ((orbsym[i] ^ orbsym[j] ^ Jb_sym ^ Ib_sym) != 0) continue;
-            ij = ioff[i] + j;
-            jlen = form_ilist(betlist, Jb_list, nbs, ij, L, R, Sgn);
+        /* loop over i, j */
+        for (i = 0; i < norbs; i++) {
+            for (j = 0; j <= i; j++) {
+                if ((orbsym[i] ^ orbsym[j] ^ Jb_sym ^ Ib_sym) != 0) continue;
+                ij = ioff[i] + j;
+#pragma omp single copyprivate(jlen)
+                jlen = form_ilist(betlist, Jb_list, nbs, ij, L, R, Sgn);
 
-            if (!jlen) continue;
-            /*  outfile->Printf("S3_BLOCK_VDIAG: ij = %d\t jlen = %d\n", ij, jlen);
-             */
-            Tptr = tei + ioff[ij];
+                if (!jlen) continue;
+                Tptr = tei + ioff[ij];
 
-            /* gather operation */
-            for (I = 0; I < cnas; I++) {
-                CprimeI0 = Cprime[I];
-                CI0 = C[I];
-                for (J = 0; J < jlen; J++) {
-                    tval = Sgn[J];
-                    CprimeI0[J] = CI0[L[J]] * tval;
+/* gather operation */
+#pragma omp for schedule(static)
+                for (I = 0; I < cnas; I++) {
+                    CprimeI0 = Cprime[I];
+                    CI0 = C[I];
+                    for (J = 0; J < jlen; J++) {
+                        tval = Sgn[J];
+                        CprimeI0[J] = CI0[L[J]] * tval;
+                    }
                 }
-            }
 
-            for (Ia = alplist, Ia_idx = 0; Ia_idx < nas; Ia_idx++, Ia++) {
-                /* loop over excitations E^a_{kl} from |A(I_a)> */
-                Jacnt = Ia->cnt[Ja_list];
-                Iaridx = Ia->ridx[Ja_list];
-                Iasgn = Ia->sgn[Ja_list];
-                Iaij = Ia->ij[Ja_list];
-
-                zero_arr(V, jlen);
-                for (Ia_ex = 0; Ia_ex < Jacnt && (kl = *Iaij++) <= ij; Ia_ex++) {
-                    I = *Iaridx++;
-                    tval = *Iasgn++;
-                    if (ij == kl) tval *= 0.5;
-                    VS = Tptr[kl] * tval;
-                    CprimeI0 = Cprime[I];
+#pragma omp for schedule(dynamic, 16)
+                for (Ia_idx = 0; Ia_idx < nas; Ia_idx++) {
+                    Ia = alplist + Ia_idx;
+                    /* loop over excitations E^a_{kl} from |A(I_a)> */
+                    Jacnt = Ia->cnt[Ja_list];
+                    Iaridx = Ia->ridx[Ja_list];
+                    Iasgn = Ia->sgn[Ja_list];
+                    Iaij = Ia->ij[Ja_list];
+
+                    zero_arr(V, jlen);
+                    for (Ia_ex = 0; Ia_ex < Jacnt && (kl = *Iaij++) <= ij; Ia_ex++) {
+                        I = *Iaridx++;
+                        tval = *Iasgn++;
+                        if (ij == kl) tval *= 0.5;
+                        VS = Tptr[kl] * tval;
+                        CprimeI0 = Cprime[I];
 
 #ifdef USE_BS
-                    C_DAXPY(jlen, VS, CprimeI0, 1, V, 1);
+                        C_DAXPY(jlen, VS, CprimeI0, 1, V, 1);
 #else
-                    for (J = 0; J < jlen; J++) {
-                        V[J] += VS * CprimeI0[J];
-                    }
+                        for (J = 0; J < jlen; J++) {
+                            V[J] += VS * CprimeI0[J];
+                        }
 #endif
-                }
+                    }
 
-                /* scatter */
-                for (J = 0; J < jlen; J++) {
-                    RJ = R[J];
-                    S[Ia_idx][RJ] += V[J];
-                }
+                    /* scatter */
+                    for (J = 0; J < jlen; J++) {
+                        RJ = R[J];
+                        S[Ia_idx][RJ] += V[J];
+                    }
 
-            } /* end loop over Ia */
+                } /* end loop over Ia */
 
-        } /* end loop over j */
-    }     /* end loop over i */
+            } /* end loop over j */
+        }     /* end loop over i */
+    }
 }
 
 /*
@@ -142,75 +159,86 @@ void s3_block_vdiag(struct stringwr *alplist, struct stringwr *betlist, double *
 */
 void s3_block_v(struct stringwr *alplist, struct stringwr *betlist, double **C, double **S, double *tei, int nas,
                 int nbs, int cnas, int Ib_list, int Ja_list, int Jb_list, int Ib_sym, int Jb_sym, double **Cprime,
-                double *F, double *V, double *Sgn, int *L, int *R, int norbs, int *orbsym) {
-    struct stringwr *Ia;
-    size_t Ia_ex;
-    int ij, i, j, kl, ijkl, I, J, RJ;
-    double tval, VS, *CprimeI0, *CI0;
-    int jlen, Ia_idx, Jacnt, *Iaij;
-    size_t *Iaridx;
-    signed char *Iasgn;
-    double *Tptr;
-
-    /* loop over i, j */
-    for (i = 0; i < norbs; i++) {
-        for (j = 0; j <= i; j++) {
-            if ((orbsym[i] ^ orbsym[j] ^ Jb_sym ^ Ib_sym) != 0) continue;
-            ij = ioff[i] + j;
-            jlen = form_ilist(betlist, Jb_list, nbs, ij, L, R, Sgn);
+                double *F, double *Vshared, double *Sgn, int *L, int *R, int norbs, int *orbsym, int nthreads) {
+    /* the ij loop is run by every thread; each thread owns whole rows I_a of S */
+#pragma omp parallel num_threads(nthreads)
+    {
+        struct stringwr *Ia;
+        size_t Ia_ex;
+        int ij, i, j, kl, ijkl, I, J, RJ;
+        double tval, VS, *CprimeI0, *CI0;
+        int jlen, Ia_idx, Jacnt, *Iaij;
+        size_t *Iaridx;
+        signed char *Iasgn;
+        std::vector<double> Vprivate;
+        double *V = Vshared;
+#ifdef _OPENMP
+        if (omp_get_thread_num() != 0) {
+            Vprivate.resize(nbs);
+            V = Vprivate.data();
+        }
+#endif
 
-            if (!jlen) continue;
+        /* loop over i, j */
+        for (i = 0; i < norbs; i++) {
+            for (j = 0; j <= i; j++) {
+                if ((orbsym[i] ^ orbsym[j] ^ Jb_sym ^ Ib_sym) != 0) continue;
+                ij = ioff[i] + j;
+#pragma omp single copyprivate(jlen)
+                jlen = form_ilist(betlist, Jb_list, nbs, ij, L, R, Sgn);
 
-            Tptr = tei + ioff[ij];
+                if (!jlen) continue;
 
-            /* gather operation */
-            for (I = 0; I < cnas; I++) {
-                CprimeI0 = Cprime[I];
-                CI0 = C[I];
-                for (J = 0; J < jlen; J++) {
-                    tval = Sgn[J];
-                    CprimeI0[J] = CI0[L[J]] * tval;
+/* gather operation */
+#pragma omp for schedule(static)
+                for (I = 0; I < cnas; I++) {
+                    CprimeI0 = Cprime[I];
+                    CI0 = C[I];
+                    for (J = 0; J < jlen; J++) {
+                        tval = Sgn[J];
+                        CprimeI0[J] = CI0[L[J]] * tval;
+                    }
                 }
-            }
-
-            timer_on("CIWave: s3_mt");
-            for (Ia = alplist, Ia_idx = 0; Ia_idx < nas; Ia_idx++, Ia++) {
-                /* loop over excitations E^a_{kl} from |A(I_a)> */
-                Jacnt = Ia->cnt[Ja_list];
-                Iaridx = Ia->ridx[Ja_list];
-                Iasgn = Ia->sgn[Ja_list];
-                Iaij = Ia->ij[Ja_list];
 
-                zero_arr(V, jlen);
-
-                for (Ia_ex = 0; Ia_ex < Jacnt; Ia_ex++) {
-                    kl = *Iaij++;
-                    I = *Iaridx++;
-                    tval = *Iasgn++;
-                    ijkl = INDEX(ij, kl);
-                    VS = tval * tei[ijkl];
-                    CprimeI0 = Cprime[I];
+#pragma omp for schedule(dynamic, 16)
+                for (Ia_idx = 0; Ia_idx < nas; Ia_idx++) {
+                    Ia = alplist + Ia_idx;
+                    /* loop over excitations E^a_{kl} from |A(I_a)> */
+                    Jacnt = Ia->cnt[Ja_list];
+                    Iaridx = Ia->ridx[Ja_list];
+                    Iasgn = Ia->sgn[Ja_list];
+                    Iaij = Ia->ij[Ja_list];
+
+                    zero_arr(V, jlen);
+
+                    for (Ia_ex = 0; Ia_ex < Jacnt; Ia_ex++) {
+                        kl = *Iaij++;
+                        I = *Iaridx++;
+                        tval = *Iasgn++;
+                        ijkl = INDEX(ij, kl);
+                        VS = tval * tei[ijkl];
+                        CprimeI0 = Cprime[I];
 
 #ifdef UBLAS
-                    C_DAXPY(jlen, VS, CprimeI0, 1, V, 1);
+                        C_DAXPY(jlen, VS, CprimeI0, 1, V, 1);
 #else
-                    for (J = 0; J < jlen; J++) {
-                        V[J] += VS * CprimeI0[J];
-                    }
+                        for (J = 0; J < jlen; J++) {
+                            V[J] += VS * CprimeI0[J];
+                        }
 #endif
-                }
+                    }
 
-                /* scatter */
-                for (J = 0; J < jlen; J++) {
-                    RJ = R[J];
-                    S[Ia_idx][RJ] += V[J];
-                }
+                    /* scatter */
+                    for (J = 0; J < jlen; J++) {
+                        RJ = R[J];
+                        S[Ia_idx][RJ] += V[J];
+                    }
 
-            } /* end loop over Ia */
-            timer_off("CIWave: s3_mt");
+                } /* end loop over Ia */
 
-        } /* end loop over j */
-    }     /* end loop over i */
+            } /* end loop over j */
+        }     /* end loop over i */
+    }
 }
 
 int form_ilist(struct stringwr *alplist, int Ja_list, int nas, int kl, int *L, int *R, double *Sgn) {
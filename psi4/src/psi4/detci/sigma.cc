@@ -45,6 +45,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <cstring>
+#include <vector>
 #include "psi4/libciomr/libciomr.h"
 #include "psi4/libqt/qt.h"
 #include "psi4/libmints/vector.h"
@@ -68,18 +69,20 @@ extern void set_row_ptrs(int rows, int cols, double **matrix);
 
 extern void s1_block_vfci(struct stringwr **alplist, struct stringwr **betlist, double **C, double **S, double *oei,
                           double *tei, double *F, int nlists, int nas, int nbs, int Ib_list, int Jb_list,
-                          int Jb_list_nbs);
+                          int Jb_list_nbs, int nthreads);
 extern void s1_block_vras(struct stringwr **alplist, struct stringwr **betlist, double **C, double **S, double *oei,
-                          double *tei, double *F, int nlists, int nas, int nbs, int sbc, int cbc, int cnbs);
+                          double *tei, double *F, int nlists, int nas, int nbs, int sbc, int cbc, int cnbs,
+                          int nthreads);
 extern void s1_block_vras_rotf(int *Cnt[2], int **Ij[2], int **Oij[2], int **Ridx[2], signed char **Sgn[2],
                                unsigned char **Toccs, double **C, double **S, double *oei, double *tei, double *F,
                                int nlists, int nas, int nbs, int Ib_list, int Jb_list, int Jb_list_nbs,
                                struct olsen_graph *BetaG, struct calcinfo *CIinfo, unsigned char ***Occs);
 extern void s2_block_vfci(struct stringwr **alplist, struct stringwr **betlist, double **C, double **S, double *oei,
                           double *tei, double *F, int nlists, int nas, int nbs, int Ia_list, int Ja_list,
-                          int Ja_list_nas);
+                          int Ja_list_nas, int nthreads);
 extern void s2_block_vras(struct stringwr **alplist, struct stringwr **betlist, double **C, double **S, double *oei,
-                          double *tei, double *F, int nlists, int nas, int nbs, int sac, int cac, int cnas);
+                          double *tei, double *F, int nlists, int nas, int nbs, int sac, int cac, int cnas,
+                          int nthreads);
 extern void s2_block_vras_rotf(int *Cnt[2], int **Ij[2], int **Oij[2], int **Ridx[2], signed char **Sgn[2],
                                unsigned char **Toccs, double **C, double **S, double *oei, double *tei, double *F,
                                int nlists, int nas, int nbs, int Ia_list, int Ja_list, int Ja_list_nbs,
@@ -87,10 +90,12 @@ extern void s2_block_vras_rotf(int *Cnt[2], int **Ij[2], int **Oij[2], int **Rid
                                unsigned char ***Occs);
 extern void s3_block_vdiag(struct stringwr *alplist, struct stringwr *betlist, double **C, double **S, double *tei,
                            int nas, int nbs, int cnas, int Ib_list, int Ja_list, int Jb_list, int Ib_sym, int Jb_sym,
-                           double **Cprime, double *F, double *V, double *Sgn, int *L, int *R, int norbs, int *orbsym);
+                           double **Cprime, double *F, double *V, double *Sgn, int *L, int *R, int norbs, int *orbsym,
+                           int nthreads);
 extern void s3_block_v(struct stringwr *alplist, struct stringwr *betlist, double **C, double **S, double *tei, int nas,
                        int nbs, int cnas, int Ib_list, int Ja_list, int Jb_list, int Ib_sym, int Jb_sym,
-                       double **Cprime, double *F, double *V, double *Sgn, int *L, int *R, int norbs, int *orbsym);
+                       double **Cprime, double *F, double *V, double *Sgn, int *L, int *R, int norbs, int *orbsym,
+                       int nthreads);
 extern void s3_block_vrotf(int *Cnt[2], int **Ij[2], int **Ridx[2], signed char **Sn[2], double **C, double **S,
                            double *tei, int nas, int nbs, int cnas, int Ib_list, int Ja_list, int Jb_list, int Ib_sym,
                            int Jb_sym, double **Cprime, double *F, double *V, double *Sgn, int *L, int *R, int norbs,
@@ -363,6 +368,9 @@ void CIWavefunction::sigma_a(struct stringwr **alplist, struct stringwr **betlis
 
             C.read(C.cur_vect_, cbuf);
 
+            /* cblock2 is the transpose of cblock, so one test covers both */
+            if (C.blk_max_abs(cblock) <= Parameters_->sigma_block_tol) continue;
+
             if (do_cblock) {
                 if (SigmaData_->cprime != nullptr) set_row_ptrs(cnas, cnbs, SigmaData_->cprime);
                 sigma_block(alplist, betlist, C.blocks_[cblock], S.blocks_[sblock], oei, tei, fci, cblock, sblock, nas,
@@ -444,6 +452,11 @@ void CIWavefunction::sigma_b(struct stringwr **alplist, struct stringwr **betlis
     S.zero();
     C.read(C.cur_vect_, 0);
 
+    /* C blocks too small to matter are left out of every sigma block */
+    std::vector<int> cskip(C.num_blocks_);
+    for (cblock = 0; cblock < C.num_blocks_; cblock++)
+        cskip[cblock] = (C.blk_max_abs(cblock) <= Parameters_->sigma_block_tol);
+
     /* loop over unique sigma subblocks */
     for (sblock = 0; sblock < S.num_blocks_; sblock++) {
         // if (Parameters_->cc && !cc_reqd_sblocks[sblock]) continue;
@@ -458,7 +471,7 @@ void CIWavefunction::sigma_b(struct stringwr **alplist, struct stringwr **betlis
         if (SigmaData_->sprime != nullptr) set_row_ptrs(nas, nbs, SigmaData_->sprime);
 
         for (cblock = 0; cblock < C.num_blocks_; cblock++) {
-            if (C.check_zero_block(cblock)) continue;
+            if (C.check_zero_block(cblock) || cskip[cblock]) continue;
             cac = C.Ia_code_[cblock];
             cbc = C.Ib_code_[cblock];
             cnas = C.Ia_size_[cblock];
@@ -533,6 +546,11 @@ void CIWavefunction::sigma_c(struct stringwr **alplist, struct stringwr **betlis
             cairr = C.buf2blk_[cbuf];
             cbirr = cairr ^ CalcInfo_->ref_sym;
 
+            /* C blocks too small to matter; a transposed block shares its flag */
+            std::vector<int> cskip(C.num_blocks_);
+            for (cblock = C.first_ablk_[cairr]; cblock <= C.last_ablk_[cairr]; cblock++)
+                cskip[cblock] = (C.blk_max_abs(cblock) <= Parameters_->sigma_block_tol);
+
             for (sblock = S.first_ablk_[sairr]; sblock <= S.last_ablk_[sairr]; sblock++) {
                 sac = S.Ia_code_[sblock];
                 sbc = S.Ib_code_[sblock];
@@ -548,6 +566,7 @@ void CIWavefunction::sigma_c(struct stringwr **alplist, struct stringwr **betlis
                     cbc = C.Ib_code_[cblock];
                     cnas = C.Ia_size_[cblock];
                     cnbs = C.Ib_size_[cblock];
+                    if (cskip[cblock]) continue;
 
                     if ((s1_contrib_[sblock][cblock] || s2_contrib_[sblock][cblock] || s3_contrib_[sblock][cblock]) &&
                         !C.check_zero_block(cblock)) {
@@ -618,14 +637,16 @@ void CIWavefunction::sigma_block(struct stringwr **alplist, struct stringwr **be
         timer_on("CIWave: s2");
 
         if (fci) {
-            s2_block_vfci(alplist, betlist, cmat, smat, oei, tei, SigmaData_->F, cnac, nas, nbs, sac, cac, cnas);
+            s2_block_vfci(alplist, betlist, cmat, smat, oei, tei, SigmaData_->F, cnac, nas, nbs, sac, cac, cnas,
+                          Parameters_->nthreads);
         } else {
             if (Parameters_->repl_otf) {
                 s2_block_vras_rotf(SigmaData_->Jcnt, SigmaData_->Jij, SigmaData_->Joij, SigmaData_->Jridx,
                                    SigmaData_->Jsgn, SigmaData_->Toccs, cmat, smat, oei, tei, SigmaData_->F, cnac, nas,
                                    nbs, sac, cac, cnas, AlphaG_, BetaG_, CalcInfo_, Occs_);
             } else {
-                s2_block_vras(alplist, betlist, cmat, smat, oei, tei, SigmaData_->F, cnac, nas, nbs, sac, cac, cnas);
+                s2_block_vras(alplist, betlist, cmat, smat, oei, tei, SigmaData_->F, cnac, nas, nbs, sac, cac, cnas,
+                              Parameters_->nthreads);
             }
         }
         timer_off("CIWave: s2");
@@ -643,7 +664,8 @@ void CIWavefunction::sigma_block(struct stringwr **alplist, struct stringwr **be
 
         if (s1_contrib_[sblock][cblock]) {
             if (fci) {
-                s1_block_vfci(alplist, betlist, cmat, smat, oei, tei, SigmaData_->F, cnbc, nas, nbs, sbc, cbc, cnbs);
+                s1_block_vfci(alplist, betlist, cmat, smat, oei, tei, SigmaData_->F, cnbc, nas, nbs, sbc, cbc, cnbs,
+                              Parameters_->nthreads);
             } else {
                 if (Parameters_->repl_otf) {
                     s1_block_vras_rotf(SigmaData_->Jcnt, SigmaData_->Jij, SigmaData_->Joij, SigmaData_->Jridx,
@@ -651,7 +673,7 @@ void CIWavefunction::sigma_block(struct stringwr **alplist, struct stringwr **be
                                        nas, nbs, sbc, cbc, cnbs, BetaG_, CalcInfo_, Occs_);
                 } else {
                     s1_block_vras(alplist, betlist, cmat, smat, oei, tei, SigmaData_->F, cnbc, nas, nbs, sbc, cbc,
-                                  cnbs);
+                                  cnbs, Parameters_->nthreads);
                 }
             }
         }
@@ -683,7 +705,8 @@ void CIWavefunction::sigma_block(struct stringwr **alplist, struct stringwr **be
             } else {
                 s3_block_v(alplist[sac], betlist[sbc], cmat, smat, tei, nas, nbs, cnas, sbc, cac, cbc, sbirr, cbirr,
                            SigmaData_->cprime, SigmaData_->F, SigmaData_->V, SigmaData_->Sgn, SigmaData_->L,
-                           SigmaData_->R, CalcInfo_->num_ci_orbs, CalcInfo_->orbsym + CalcInfo_->num_drc_orbs);
+                           SigmaData_->R, CalcInfo_->num_ci_orbs, CalcInfo_->orbsym + CalcInfo_->num_drc_orbs,
+                           Parameters_->nthreads);
             }
         }
 
@@ -705,7 +728,8 @@ void CIWavefunction::sigma_block(struct stringwr **alplist, struct stringwr **be
             } else {
                 s3_block_vdiag(alplist[sac], betlist[sbc], cmat, smat, tei, nas, nbs, cnas, sbc, cac, cbc, sbirr, cbirr,
                                SigmaData_->cprime, SigmaData_->F, SigmaData_->V, SigmaData_->Sgn, SigmaData_->L,
-                               SigmaData_->R, CalcInfo_->num_ci_orbs, CalcInfo_->orbsym + CalcInfo_->num_drc_orbs);
+                               SigmaData_->R, CalcInfo_->num_ci_orbs, CalcInfo_->orbsym + CalcInfo_->num_drc_orbs,
+                               Parameters_->nthreads);
             }
         }
 
@@ -63,6 +63,9 @@ namespace detci {
 #define PARM_GUESS_VEC_UNIT 0
 #define PARM_GUESS_VEC_H0_BLOCK 1
 #define PARM_GUESS_VEC_DFILE 3
+#define PARM_CIVECT_FULL 0
+#define PARM_CIVECT_SPARSE 1
+#define PARM_CIVECT_SINGLE 2
 #define PARM_OPENTYPE_UNKNOWN -1
 #define PARM_OPENTYPE_NONE 0
 #define PARM_OPENTYPE_HIGHSPIN 1
@@ -536,6 +539,10 @@ struct params {
     int z_scale_H;                       /* 1(0) if pert. scaling used */
     double special_conv;                 /* special convergence value */
     int nthreads;                        /* number of threads to use in sigma routines */
+    int civect_storage;                  /* on-disk CI vector format: full, sparse
+                                            (zero blocks dropped), or single precision */
+    double sigma_block_tol;              /* C blocks with max |c| at or below this are
+                                            skipped in sigma */
     int sf_restrict;                     /* 1 if restrict CI space (CI blocks) to
                                             do only determinants (or their
                                             spin-complements) in RASCI versions of
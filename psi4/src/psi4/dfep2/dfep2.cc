@@ -29,6 +29,9 @@
 #include "dfep2.h"
 
 #include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
 #include <iomanip>
 #ifdef _OPENMP
 #include <omp.h>
@@ -44,13 +47,126 @@
 #include "psi4/libmints/matrix.h"
 #include "psi4/libpsio/psio.hpp"
 #include "psi4/libpsio/psio.h"
-#include "psi4/libpsio/aiohandler.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/lib3index/dfhelper.h"
 
 namespace psi {
 namespace dfep2 {
 
+namespace {
+
+// Binned pole expansion of one channel of the EP2 self-energy,
+//   sigma_e(E) = sum_k n_ek / (E - w_k) = sum_m sum_p M_mep / (E - c_m)^(p + 1),
+// with the moments M_mep = sum_{k in bin m} n_ek (w_k - c_m)^p. The moments are accumulated while the
+// integrals are built, so the Newton iterations evaluate sigma without reading the integrals again.
+class PoleExpansion {
+    size_t nE_;
+    size_t nbins_;
+    size_t order_;
+    double wmin_;
+    double width_;
+    // Moments, nbins x nE x order
+    std::vector<double> moments_;
+    std::vector<char> filled_;
+
+    size_t bin(double w) const {
+        double x = (w - wmin_) / width_;
+        if (x <= 0.0) return 0;
+        size_t m = (size_t)x;
+        return (m < nbins_ ? m : nbins_ - 1);
+    }
+    double center(size_t m) const { return wmin_ + ((double)m + 0.5) * width_; }
+
+   public:
+    PoleExpansion(size_t nE, double wmin, double wmax, size_t nbins, size_t order)
+        : nE_(nE), nbins_(nbins), order_(order), wmin_(wmin) {
+        width_ = (wmax - wmin) / (double)nbins;
+        if (width_ <= 0.0) width_ = 1.0;
+        moments_.assign(nbins_ * nE_ * order_, 0.0);
+        filled_.assign(nbins_, 0);
+    }
+
+    static size_t size(size_t nE, size_t nbins, size_t order) { return nbins * nE * order + nbins; }
+
+    // Adds the poles w[k], numer(k, n) fills the nE residues of pole k into n.
+    // Poles are sorted by bin so that each thread owns the bins it accumulates.
+    template <typename Numer>
+    void add(const std::vector<double>& w, const Numer& numer, size_t nthreads) {
+        size_t npole = w.size();
+        std::vector<size_t> bins(npole);
+        std::vector<size_t> start(nbins_ + 1, 0);
+        for (size_t k = 0; k < npole; k++) {
+            bins[k] = bin(w[k]);
+            start[bins[k] + 1]++;
+        }
+        for (size_t m = 0; m < nbins_; m++) start[m + 1] += start[m];
+
+        std::vector<size_t> sorted(npole);
+        std::vector<size_t> fill(start.begin(), start.end() - 1);
+        for (size_t k = 0; k < npole; k++) {
+            sorted[fill[bins[k]]++] = k;
+        }
+
+#pragma omp parallel num_threads(nthreads)
+        {
+            std::vector<double> n(nE_);
+#pragma omp for schedule(dynamic, 1)
+            for (size_t m = 0; m < nbins_; m++) {
+                if (start[m] == start[m + 1]) continue;
+                filled_[m] = 1;
+
+                double c = center(m);
+                double* Mm = moments_.data() + m * nE_ * order_;
+                for (size_t idx = start[m]; idx < start[m + 1]; idx++) {
+                    size_t k = sorted[idx];
+                    double delta = w[k] - c;
+                    numer(k, n.data());
+                    for (size_t e = 0; e < nE_; e++) {
+                        double* Mme = Mm + e * order_;
+                        double pw = n[e];
+                        for (size_t p = 0; p < order_; p++) {
+                            Mme[p] += pw;
+                            pw *= delta;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Adds sigma and its derivative -dsigma/dE at the energies E. Returns false, leaving sigma and deriv
+    // untouched, if any pole bin lies too close to one of the energies for the expansion to converge.
+    bool evaluate(const std::vector<double>& E, std::vector<double>& sigma, std::vector<double>& deriv) const {
+        // Bins must be at least two widths away, so |w_k - c_m| / |E - c_m| <= 1/4
+        for (size_t e = 0; e < nE_; e++) {
+            for (size_t m = 0; m < nbins_; m++) {
+                if (filled_[m] && std::fabs(E[e] - center(m)) < 2.0 * width_) return false;
+            }
+        }
+
+        for (size_t e = 0; e < nE_; e++) {
+            double s = 0.0;
+            double d = 0.0;
+            for (size_t m = 0; m < nbins_; m++) {
+                if (!filled_[m]) continue;
+                const double* Mme = moments_.data() + (m * nE_ + e) * order_;
+                double inv = 1.0 / (E[e] - center(m));
+                double pw = inv;
+                for (size_t p = 0; p < order_; p++) {
+                    s += Mme[p] * pw;
+                    d += (double)(p + 1) * Mme[p] * pw * inv;
+                    pw *= inv;
+                }
+            }
+            sigma[e] += s;
+            deriv[e] += d;
+        }
+        return true;
+    }
+};
+
+}  // namespace
+
 DFEP2Wavefunction::DFEP2Wavefunction(std::shared_ptr<Wavefunction> ref_wfn)
     : Wavefunction(Process::environment.options) {
     // Copy the wavefuntion then update
@@ -67,6 +183,7 @@ DFEP2Wavefunction::DFEP2Wavefunction(std::shared_ptr<Wavefunction> ref_wfn)
     max_iter_ = options_.get_int("EP2_MAXITER");
     debug_ = options_.get_int("DEBUG");
     memory_doubles_ = (size_t)(0.1 * (double)Process::environment.get_memory());
+    pole_expansion_ = options_.get_bool("EP2_POLE_EXPANSION");
 
     AO_C_ = Ca_subset("AO", "ALL");
     AO_Cocc_ = Ca_subset("AO", "OCC");
@@ -216,24 +333,45 @@ std::vector<std::vector<std::pair<double, double>>> DFEP2Wavefunction::compute(
 
     // ==> Build ERI's <== /
 
+    // Both integral files are written front to back, so they need no zeroing beforehand
     std::shared_ptr<PSIO> psio = PSIO::shared_object();
-    auto aio = std::make_shared<AIOHandler>(psio);
-
     psio->open(unit_, PSIO_OPEN_OLD);
 
-    aio->zero_disk(unit_, "EP2 I_ovvE Integrals", (size_t)(nocc * nvir), (size_t)(nvir * nE));
-    aio->zero_disk(unit_, "EP2 I_vooE Integrals", (size_t)(nocc * nvir), (size_t)(nocc * nE));
-    aio->synchronize();
+    // Pole expansions of the excitation (v + v - o) and de-excitation (o + o - v) self-energy channels
+    const size_t pole_bins = 2048;
+    const size_t pole_order = 12;
+    std::unique_ptr<PoleExpansion> ovv_poles;
+    std::unique_ptr<PoleExpansion> voo_poles;
+    size_t poles_size = 0;
+    if (pole_expansion_) {
+        double omin = *std::min_element(eps_occ.begin(), eps_occ.end());
+        double omax = *std::max_element(eps_occ.begin(), eps_occ.end());
+        double vmin = *std::min_element(eps_vir.begin(), eps_vir.end());
+        double vmax = *std::max_element(eps_vir.begin(), eps_vir.end());
+        ovv_poles.reset(new PoleExpansion(nE, 2.0 * vmin - omax, 2.0 * vmax - omin, pole_bins, pole_order));
+        voo_poles.reset(new PoleExpansion(nE, 2.0 * omin - vmax, 2.0 * omax - vmin, pole_bins, pole_order));
+        poles_size = 2 * PoleExpansion::size(nE, pole_bins, pole_order);
+    }
 
-    // How much memory are we working with?
-    size_t E_tensor_size = nE * nvir * nQ + nE * nocc * nQ;
-    size_t I_block_sizes = nvir * nvir * nE + nocc * nvir * nE + nvir * nQ;
-    size_t free_doubles = memory_doubles_ - E_tensor_size;
+    // How much memory are we working with? Pole lists take a value, a bin and a sort index per pole.
+    size_t E_tensor_size = nE * nvir * nQ + nE * nocc * nQ + poles_size;
+    size_t I_block_sizes = nvir * nvir * nE + nvir * nQ + (pole_expansion_ ? 3 * nvir * nvir : 0);
+    size_t free_doubles = (memory_doubles_ > E_tensor_size ? memory_doubles_ - E_tensor_size : 0);
 
     size_t block_size = free_doubles / I_block_sizes;
     if (block_size > nocc) block_size = nocc;
     // block_size = 2;
 
+    // Without a single occupied block the integral files and pole expansions would stay empty
+    if (block_size == 0) {
+        std::stringstream message;
+        double mem_gb = 8.0 * (double)(E_tensor_size + I_block_sizes) / 1.e9;
+        message << "DF-EP2 requires at least is nvir^2 * number solve orbitals in memory." << std::endl;
+        message << "       After taxes this is " << std::setprecision(2) << mem_gb << " GB of memory.";
+
+        throw PSIEXCEPTION(message.str());
+    }
+
     size_t nblocks = 1 + ((nocc - 1) / block_size);
 
     if (debug_ > 1) {
@@ -247,31 +385,22 @@ std::vector<std::vector<std::pair<double, double>>> DFEP2Wavefunction::compute(
         outfile->Printf("\n\n");
     }
 
-    if (block_size < 1) {
-        std::stringstream message;
-        double mem_gb = ((double)(E_tensor_size + I_block_sizes) / 1.e10);
-        message << "DF-EP2 requires at least is nvir^2 * number solve orbitals in memory." << std::endl;
-        message << "       After taxes this is " << std::setprecision(2) << mem_gb << " GB of memory.";
-
-        throw PSIEXCEPTION(message.str());
-    }
-
     // Read in part of the tensors
     auto aEQ = std::make_shared<Matrix>("aEQ", nE * nvir, nQ);
-    double* aEQp = aEQ->pointer()[0];
     dfh_->fill_tensor("aEQ", aEQ);
 
     auto iEQ = std::make_shared<Matrix>("iEQ", nE * nocc, nQ);
     double* iEQp = iEQ->pointer()[0];
     dfh_->fill_tensor("iEQ", iEQ);
 
-    // Allocate temps
+    // => OVVE <= //
+
     auto block_iaQ = std::make_shared<Matrix>(block_size * nvir, nQ);
     auto temp_ovvE = std::make_shared<Matrix>(block_size * nvir, nvir * nE);
-    auto temp_ovoE = std::make_shared<Matrix>(block_size * nvir, nocc * nE);
+    double** temp_ovvEp = temp_ovvE->pointer();
+    std::vector<double> w_poles;
 
     psio_address ovvE_addr = psio_get_address(PSIO_ZERO, 0);
-    psio_address ovoE_addr = psio_get_address(PSIO_ZERO, 0);
     psio_address vooE_addr = psio_get_address(PSIO_ZERO, 0);
 
     for (size_t block = 0; block < nblocks; block++) {
@@ -288,28 +417,105 @@ std::vector<std::vector<std::pair<double, double>>> DFEP2Wavefunction::compute(
 
         // Write out OVVE
         temp_ovvE->gemm(false, true, 1.0, block_iaQ, aEQ, 0.0);
-        psio_->write(unit_, "EP2 I_ovvE Integrals", (char*)temp_ovvE->pointer()[0],
+        psio_->write(unit_, "EP2 I_ovvE Integrals", (char*)temp_ovvEp[0],
                      sizeof(double) * block_size * nvir * nvir * nE, ovvE_addr, &ovvE_addr);
 
-        // Write out VOOE
-        temp_ovoE->gemm(false, true, 1.0, block_iaQ, iEQ, 0.0);
-        double** temp_ovoEp = temp_ovoE->pointer();
-        for (size_t a = 0; a < nvir; a++) {
-            size_t local_i = 0;
-            for (size_t i = bstart; i < bstart + block_size; i++) {
-                psio_address vooE_addr = psio_get_address(PSIO_ZERO, sizeof(double) * (a * nocc + i) * nocc * nE);
-                psio_->write(unit_, "EP2 I_vooE Integrals", (char*)temp_ovoEp[local_i * nvir + a],
-                             sizeof(double) * nocc * nE, vooE_addr, &vooE_addr);
-                local_i++;
+        // Fold the block into the excitation poles, w = a + b - i
+        if (pole_expansion_) {
+            w_poles.resize(block_size * nvir * nvir);
+            for (size_t i = 0; i < block_size; i++) {
+                for (size_t a = 0; a < nvir; a++) {
+                    for (size_t b = 0; b < nvir; b++) {
+                        w_poles[(i * nvir + a) * nvir + b] = eps_vir[a] + eps_vir[b] - eps_occ[bstart + i];
+                    }
+                }
             }
+            ovv_poles->add(w_poles,
+                           [&](size_t k, double* n) {
+                               size_t i = k / (nvir * nvir);
+                               size_t a = (k / nvir) % nvir;
+                               size_t b = k % nvir;
+                               for (size_t e = 0; e < nE; e++) {
+                                   double Eabi = temp_ovvEp[i * nvir + b][a * nE + e];
+                                   double Ebai = temp_ovvEp[i * nvir + a][b * nE + e];
+                                   n[e] = (2.0 * Eabi - Ebai) * Eabi;
+                               }
+                           },
+                           num_threads_);
         }
     }
     // Blow away the temp tensors
     block_iaQ.reset();
     temp_ovvE.reset();
-    temp_ovoE.reset();
     aEQ.reset();
+
+    // => VOOE <= //
+
+    // Built in blocks of virtuals with all occupied pairs, so each block is one sequential write
+    size_t a_block_sizes = nocc * nQ + nocc * nocc * nE + (pole_expansion_ ? 3 * nocc * nocc : 0);
+    // aEQ has been released, so its share of E_tensor_size is available again
+    size_t voo_fixed = E_tensor_size - nE * nvir * nQ;
+    size_t voo_free = (memory_doubles_ > voo_fixed ? memory_doubles_ - voo_fixed : 0);
+    size_t a_block_size = voo_free / a_block_sizes;
+    if (a_block_size > nvir) a_block_size = nvir;
+    if (a_block_size == 0) {
+        std::stringstream message;
+        double mem_gb = 8.0 * (double)(voo_fixed + a_block_sizes) / 1.e9;
+        message << "DF-EP2 requires at least nocc^2 * number solve orbitals in memory." << std::endl;
+        message << "       After taxes this is " << std::setprecision(2) << mem_gb << " GB of memory.";
+
+        throw PSIEXCEPTION(message.str());
+    }
+    size_t a_nblocks = 1 + ((nvir - 1) / a_block_size);
+
+    auto block_aiQ = std::make_shared<Matrix>(nocc * a_block_size, nQ);
+    auto temp_vooE = std::make_shared<Matrix>(a_block_size * nocc, nocc * nE);
+    double* block_aiQp = block_aiQ->pointer()[0];
+    double** temp_vooEp = temp_vooE->pointer();
+
+    for (size_t block = 0; block < a_nblocks; block++) {
+        size_t astart = block * a_block_size;
+        size_t ab_size = std::min(a_block_size, nvir - astart);
+
+        // Read the (i, a in block) slice, laid out as [i][a][Q]
+        dfh_->fill_tensor("iaQ", block_aiQ, {0, nocc}, {astart, astart + ab_size});
+
+        // (ia|jE) for the block in [a][i][jE] order
+        for (size_t a = 0; a < ab_size; a++) {
+            C_DGEMM('N', 'T', nocc, nocc * nE, nQ, 1.0, block_aiQp + a * nQ, ab_size * nQ, iEQp, nQ, 0.0,
+                    temp_vooEp[a * nocc], nocc * nE);
+        }
+        psio_->write(unit_, "EP2 I_vooE Integrals", (char*)temp_vooEp[0], sizeof(double) * ab_size * nocc * nocc * nE,
+                     vooE_addr, &vooE_addr);
+
+        // Fold the block into the de-excitation poles, w = i + j - a
+        if (pole_expansion_) {
+            w_poles.resize(ab_size * nocc * nocc);
+            for (size_t a = 0; a < ab_size; a++) {
+                for (size_t i = 0; i < nocc; i++) {
+                    for (size_t j = 0; j < nocc; j++) {
+                        w_poles[(a * nocc + i) * nocc + j] = eps_occ[i] + eps_occ[j] - eps_vir[astart + a];
+                    }
+                }
+            }
+            voo_poles->add(w_poles,
+                           [&](size_t k, double* n) {
+                               size_t a = k / (nocc * nocc);
+                               size_t i = (k / nocc) % nocc;
+                               size_t j = k % nocc;
+                               for (size_t e = 0; e < nE; e++) {
+                                   double Eija = temp_vooEp[a * nocc + j][i * nE + e];
+                                   double Ejia = temp_vooEp[a * nocc + i][j * nE + e];
+                                   n[e] = (2.0 * Eija - Ejia) * Eija;
+                               }
+                           },
+                           num_threads_);
+        }
+    }
+    block_aiQ.reset();
+    temp_vooE.reset();
     iEQ.reset();
+    std::vector<double>().swap(w_poles);
 
     // ==> More Sizing <== /
 
@@ -348,8 +554,11 @@ std::vector<std::vector<std::pair<double, double>>> DFEP2Wavefunction::compute(
     std::vector<std::vector<double>> deriv_temps(num_threads_, std::vector<double>(nE));
     std::vector<std::vector<double>> sigma_temps(num_threads_, std::vector<double>(nE));
     size_t rank = 0;
+    size_t nstream = 0;
+    size_t niter = 0;
 
     for (size_t iter = 0; iter < max_iter_; iter++) {
+        niter++;
         // Reset data for loop
         for (size_t i = 0; i < nE; i++) {
             Esigma[i] = 0.0;
@@ -361,83 +570,99 @@ std::vector<std::vector<std::pair<double, double>>> DFEP2Wavefunction::compute(
             }
         }
 
-        // => Excitations <= //
-        // sigma <= (Eabi - Ebai) * Eabi / (E - v - v + o)
+        // Converged pole expansions give sigma without touching the integrals, otherwise stream them from disk
+        bool from_poles = false;
+        if (pole_expansion_) {
+            std::vector<double> pole_sigma(nE, 0.0);
+            std::vector<double> pole_deriv(nE, 0.0);
+            if (ovv_poles->evaluate(denom_E, pole_sigma, pole_deriv) &&
+                voo_poles->evaluate(denom_E, pole_sigma, pole_deriv)) {
+                from_poles = true;
+                sigma_temps[0] = pole_sigma;
+                deriv_temps[0] = pole_deriv;
+            }
+        }
 
-        ovvE_addr = psio_get_address(PSIO_ZERO, 0);
-        auto I_ovvE = std::make_shared<Matrix>(aaE_size * nvir, nvir * nE);
-        double** I_ovvEp = I_ovvE->pointer();
+        if (!from_poles) {
+            nstream++;
+            // => Excitations <= //
+            // sigma <= (Eabi - Ebai) * Eabi / (E - v - v + o)
 
-        for (size_t i_block = 0; i_block < aaE_nblocks; i_block++) {
-            size_t i_start = aaE_size * i_block;
-            size_t ib_size = aaE_size;
-            if ((i_start + aaE_size) > nocc) {
-                ib_size = nocc - i_start;
-            }
+            ovvE_addr = psio_get_address(PSIO_ZERO, 0);
+            auto I_ovvE = std::make_shared<Matrix>(aaE_size * nvir, nvir * nE);
+            double** I_ovvEp = I_ovvE->pointer();
+
+            for (size_t i_block = 0; i_block < aaE_nblocks; i_block++) {
+                size_t i_start = aaE_size * i_block;
+                size_t ib_size = aaE_size;
+                if ((i_start + aaE_size) > nocc) {
+                    ib_size = nocc - i_start;
+                }
 
-            psio_->read(unit_, "EP2 I_ovvE Integrals", (char*)I_ovvEp[0], (sizeof(double) * ib_size * nvir * nvir * nE),
-                        ovvE_addr, &ovvE_addr);
+                psio_->read(unit_, "EP2 I_ovvE Integrals", (char*)I_ovvEp[0],
+                            (sizeof(double) * ib_size * nvir * nvir * nE), ovvE_addr, &ovvE_addr);
 
 #pragma omp parallel for private(rank) schedule(dynamic, 1) collapse(2) num_threads(num_threads_)
-            for (size_t i = 0; i < ib_size; i++) {
-                for (size_t a = 0; a < nvir; a++) {
+                for (size_t i = 0; i < ib_size; i++) {
+                    for (size_t a = 0; a < nvir; a++) {
 #ifdef _OPENMP
-                    rank = omp_get_thread_num();
+                        rank = omp_get_thread_num();
 #endif
-                    for (size_t b = 0; b < nvir; b++) {
-                        for (size_t e = 0; e < nE; e++) {
-                            double Eabi = I_ovvEp[i * nvir + b][a * nE + e];
-                            double Ebai = I_ovvEp[i * nvir + a][b * nE + e];
-                            double numer = (2.0 * Eabi - Ebai) * Eabi;
-                            double denom = (denom_E[e] - eps_vir[a] - eps_vir[b] + eps_occ[i_start + i]);
-
-                            sigma_temps[rank][e] += numer / denom;
-                            deriv_temps[rank][e] += numer / (denom * denom);
+                        for (size_t b = 0; b < nvir; b++) {
+                            for (size_t e = 0; e < nE; e++) {
+                                double Eabi = I_ovvEp[i * nvir + b][a * nE + e];
+                                double Ebai = I_ovvEp[i * nvir + a][b * nE + e];
+                                double numer = (2.0 * Eabi - Ebai) * Eabi;
+                                double denom = (denom_E[e] - eps_vir[a] - eps_vir[b] + eps_occ[i_start + i]);
+
+                                sigma_temps[rank][e] += numer / denom;
+                                deriv_temps[rank][e] += numer / (denom * denom);
+                            }
                         }
                     }
                 }
             }
-        }
-        I_ovvE.reset();
+            I_ovvE.reset();
 
-        // => De-excitations <= //
-        // sigma <= (Eija - Ejia) * Eija / (E - o - o + v)
+            // => De-excitations <= //
+            // sigma <= (Eija - Ejia) * Eija / (E - o - o + v)
 
-        vooE_addr = psio_get_address(PSIO_ZERO, 0);
-        auto I_vooE = std::make_shared<Matrix>(ooE_size * nocc, nocc * nE);
-        double** I_vooEp = I_vooE->pointer();
+            vooE_addr = psio_get_address(PSIO_ZERO, 0);
+            auto I_vooE = std::make_shared<Matrix>(ooE_size * nocc, nocc * nE);
+            double** I_vooEp = I_vooE->pointer();
 
-        for (size_t a_block = 0; a_block < ooE_nblocks; a_block++) {
-            size_t a_start = ooE_size * a_block;
-            size_t ab_size = ooE_size;
-            if ((a_start + ooE_size) > nvir) {
-                ab_size = nvir - a_start;
-            }
+            for (size_t a_block = 0; a_block < ooE_nblocks; a_block++) {
+                size_t a_start = ooE_size * a_block;
+                size_t ab_size = ooE_size;
+                if ((a_start + ooE_size) > nvir) {
+                    ab_size = nvir - a_start;
+                }
 
-            psio_->read(unit_, "EP2 I_vooE Integrals", (char*)I_vooEp[0], sizeof(double) * ab_size * nocc * nocc * nE,
-                        vooE_addr, &vooE_addr);
+                psio_->read(unit_, "EP2 I_vooE Integrals", (char*)I_vooEp[0],
+                            sizeof(double) * ab_size * nocc * nocc * nE, vooE_addr, &vooE_addr);
 
 #pragma omp parallel for private(rank) schedule(dynamic, 1) collapse(2) num_threads(num_threads_)
-            for (size_t a = 0; a < ab_size; a++) {
-                for (size_t i = 0; i < nocc; i++) {
+                for (size_t a = 0; a < ab_size; a++) {
+                    for (size_t i = 0; i < nocc; i++) {
 #ifdef _OPENMP
-                    rank = omp_get_thread_num();
+                        rank = omp_get_thread_num();
 #endif
-                    for (size_t j = 0; j < nocc; j++) {
-                        for (size_t e = 0; e < nE; e++) {
-                            double Eija = I_vooEp[a * nocc + j][i * nE + e];
-                            double Ejia = I_vooEp[a * nocc + i][j * nE + e];
-                            double numer = (2.0 * Eija - Ejia) * Eija;
-                            double denom = (denom_E[e] - eps_occ[i] - eps_occ[j] + eps_vir[a_start + a]);
-
-                            sigma_temps[rank][e] += numer / denom;
-                            deriv_temps[rank][e] += numer / (denom * denom);
+                        for (size_t j = 0; j < nocc; j++) {
+                            for (size_t e = 0; e < nE; e++) {
+                                double Eija = I_vooEp[a * nocc + j][i * nE + e];
+                                double Ejia = I_vooEp[a * nocc + i][j * nE + e];
+                                double numer = (2.0 * Eija - Ejia) * Eija;
+                                double denom = (denom_E[e] - eps_occ[i] - eps_occ[j] + eps_vir[a_start + a]);
+
+                                sigma_temps[rank][e] += numer / denom;
+                                deriv_temps[rank][e] += numer / (denom * denom);
+                            }
                         }
                     }
                 }
             }
+            I_vooE.reset();
         }
-        I_vooE.reset();
 
         // Sum up thread data
         for (size_t i = 0; i < nE; i++) {
@@ -485,6 +710,11 @@ std::vector<std::vector<std::pair<double, double>>> DFEP2Wavefunction::compute(
         // printf("\n");
     }
     outfile->Printf("   --------------------------------------------\n\n");
+    if (pole_expansion_) {
+        outfile->Printf("  Iterations streaming integrals from disk: %zu\n\n", nstream);
+    }
+    set_scalar_variable("EP2 ITERATIONS", (double)niter);
+    set_scalar_variable("EP2 STREAMED ITERATIONS", (double)nstream);
     psio->close(unit_, 0);
 
     // Build output array and remap symmetry
@@ -60,6 +60,7 @@ class DFEP2Wavefunction : public Wavefunction {
     size_t memory_doubles_;
     size_t unit_;
     size_t num_threads_;
+    bool pole_expansion_;
 
    public:
     DFEP2Wavefunction(std::shared_ptr<Wavefunction> wfn);
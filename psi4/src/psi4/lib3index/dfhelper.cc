@@ -2778,6 +2778,16 @@ void DFHelper::compute_JK(std::vector<SharedMatrix> Cleft, std::vector<SharedMat
     } else
         Mp = Ppq_.get();
 
+    // the screened exchange wants local orbitals, built once per call
+    std::vector<SharedMatrix> Kleft = Cleft;
+    std::vector<SharedMatrix> Kright = Cright;
+    if (do_K && sparse_K_ && lr_symmetric) {
+        timer_on("DFH: cholesky_orbitals");
+        for (size_t i = 0; i < D.size(); i++) Kleft[i] = cholesky_orbitals(D[i], Cleft[i]->colspi()[0]);
+        Kright = Kleft;
+        timer_off("DFH: cholesky_orbitals");
+    }
+
     // transform in steps (blocks of Q)
     for (size_t j = 0, bcount = 0; j < Qsteps.size(); j++) {
         // Qshell step info
@@ -2810,7 +2820,11 @@ void DFHelper::compute_JK(std::vector<SharedMatrix> Cleft, std::vector<SharedMat
 
         if (do_K) {
             timer_on("DFH: compute_K");
-            compute_K(Cleft, Cright, K, T1p, T2p, Mp, bcount, block_size, C_buffers, lr_symmetric);
+            if (sparse_K_) {
+                compute_sparse_K(Kleft, Kright, K, T1p, T2p, Mp, bcount, block_size, C_buffers, lr_symmetric);
+            } else {
+                compute_K(Cleft, Cright, K, T1p, T2p, Mp, bcount, block_size, C_buffers, lr_symmetric);
+            }
             timer_off("DFH: compute_K");
         }
 
@@ -2970,4 +2984,154 @@ void DFHelper::compute_K(std::vector<SharedMatrix> Cleft, std::vector<SharedMatr
     }
 }
 
+void DFHelper::compute_sparse_K(std::vector<SharedMatrix> Cleft, std::vector<SharedMatrix> Cright,
+                                std::vector<SharedMatrix> K, double* T1p, double* T2p, double* Mp, size_t bcount,
+                                size_t block_size, std::vector<std::vector<double>>& C_buffers, bool lr_symmetric) {
+    std::vector<double> Kblock;
+    for (size_t i = 0; i < K.size(); i++) {
+        size_t nocc = Cleft[i]->colspi()[0];
+        if (!nocc) {
+            continue;
+        }
+
+        double* Clp = Cleft[i]->pointer()[0];
+        double* Crp = Cright[i]->pointer()[0];
+        double* Kp = K[i]->pointer()[0];
+
+        size_t obatch = occ_batch_size(block_size, nocc);
+        for (size_t o0 = 0; o0 < nocc; o0 += obatch) {
+            size_t nb = std::min(obatch, nocc - o0);
+
+            // (Q|m i) only for the rows m this batch of orbitals reaches
+            std::vector<size_t> lrows = significant_rows(Clp, nocc, o0, nb);
+            if (lrows.empty()) continue;
+            transform_rows_pQq(lrows, nocc, o0, nb, bcount, block_size, Mp, T1p, Clp, C_buffers);
+
+            std::vector<size_t> rrows;
+            double* Trp = T1p;
+            if (lr_symmetric) {
+                rrows = lrows;
+            } else {
+                rrows = significant_rows(Crp, nocc, o0, nb);
+                if (rrows.empty()) continue;
+                transform_rows_pQq(rrows, nocc, o0, nb, bcount, block_size, Mp, T2p, Crp, C_buffers);
+                Trp = T2p;
+            }
+
+            // K[l][r] += (Q|l i)(Q|r i) over the surviving rows
+            size_t nl = lrows.size();
+            size_t nr = rrows.size();
+            Kblock.resize(nl * nr);
+            C_DGEMM('N', 'T', nl, nr, nb * block_size, 1.0, T1p, nb * block_size, Trp, nb * block_size, 0.0,
+                    Kblock.data(), nr);
+
+#pragma omp parallel for schedule(static) num_threads(nthreads_)
+            for (size_t l = 0; l < nl; l++) {
+                double* Krow = &Kp[lrows[l] * nbf_];
+                for (size_t r = 0; r < nr; r++) Krow[rrows[r]] += Kblock[l * nr + r];
+            }
+        }
+    }
+}
+void DFHelper::transform_rows_pQq(const std::vector<size_t>& rows, size_t nocc, size_t o0, size_t nb,
+                                  size_t bcount, size_t block_size, double* Mp, double* Tp, double* Bp,
+                                  std::vector<std::vector<double>>& C_buffers) {
+// same contraction as first_transform_pQq, restricted to rows and one occupied batch
+#pragma omp parallel for schedule(guided) num_threads(nthreads_)
+    for (size_t c = 0; c < rows.size(); c++) {
+        size_t k = rows[c];
+        size_t sp_size = small_skips_[k];
+        size_t jump = (AO_core_ ? big_skips_[k] + bcount * sp_size : (big_skips_[k] * block_size) / naux_);
+
+        int rank = 0;
+#ifdef _OPENMP
+        rank = omp_get_thread_num();
+#endif
+        for (size_t m = 0, sp_count = -1; m < nbf_; m++) {
+            if (schwarz_fun_mask_[k * nbf_ + m]) {
+                sp_count++;
+                C_DCOPY(nb, &Bp[m * nocc + o0], 1, &C_buffers[rank][sp_count * nb], 1);
+            }
+        }
+
+        // (Qm)(mb)->(Qb)
+        C_DGEMM('N', 'N', block_size, nb, sp_size, 1.0, &Mp[jump], sp_size, &C_buffers[rank][0], nb, 0.0,
+                &Tp[c * block_size * nb], nb);
+    }
+}
+std::vector<size_t> DFHelper::significant_rows(double* Bp, size_t nocc, size_t o0, size_t nb) {
+    std::vector<double> cmax(nbf_, 0.0);
+    for (size_t m = 0; m < nbf_; m++) {
+        for (size_t i = o0; i < o0 + nb; i++) cmax[m] = std::max(cmax[m], std::fabs(Bp[m * nocc + i]));
+    }
+
+    std::vector<size_t> rows;
+    for (size_t k = 0; k < nbf_; k++) {
+        for (size_t m = 0; m < nbf_; m++) {
+            if (schwarz_fun_mask_[k * nbf_ + m] && cmax[m] >= sparse_K_tol_) {
+                rows.push_back(k);
+                break;
+            }
+        }
+    }
+    return rows;
+}
+size_t DFHelper::occ_batch_size(size_t block_size, size_t nocc) {
+    // keep a thread's coefficient slice and (Q|m i) row within its L2 cache
+    size_t cache = 256 * 1024;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2 > 0) cache = l2;
+#endif
+    size_t max_sp = 0;
+    for (size_t k = 0; k < nbf_; k++) max_sp = std::max(max_sp, small_skips_[k]);
+
+    size_t batch = cache / (sizeof(double) * (max_sp + block_size));
+    batch = std::max(batch, (size_t)16);
+    return std::min(batch, nocc);
+}
+SharedMatrix DFHelper::cholesky_orbitals(SharedMatrix D, size_t max_rank) {
+    // pivoted Cholesky D = L L^T, each column centred on its pivot function
+    double** Dp = D->pointer();
+    std::vector<double> diag(nbf_);
+    double dmax = 0.0;
+    for (size_t k = 0; k < nbf_; k++) {
+        diag[k] = Dp[k][k];
+        dmax = std::max(dmax, diag[k]);
+    }
+    double tol = dmax * 1.0E-14;
+
+    std::vector<std::vector<double>> cols;
+    std::vector<size_t> pivots;
+    while (cols.size() < max_rank) {
+        size_t p = std::max_element(diag.begin(), diag.end()) - diag.begin();
+        if (diag[p] <= tol) break;
+        double scale = 1.0 / std::sqrt(diag[p]);
+
+        std::vector<double> col(nbf_);
+        for (size_t n = 0; n < nbf_; n++) {
+            double val = Dp[n][p];
+            for (size_t s = 0; s < cols.size(); s++) val -= cols[s][n] * cols[s][p];
+            col[n] = val * scale;
+        }
+        for (size_t n = 0; n < nbf_; n++) diag[n] -= col[n] * col[n];
+        diag[p] = 0.0;
+
+        cols.push_back(std::move(col));
+        pivots.push_back(p);
+    }
+
+    // order by pivot so that neighbouring orbitals land in the same occupied batch
+    std::vector<size_t> order(cols.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&pivots](size_t a, size_t b) { return pivots[a] < pivots[b]; });
+
+    auto L = std::make_shared<Matrix>("Cholesky orbitals", nbf_, cols.size());
+    double** Lp = L->pointer();
+    for (size_t i = 0; i < order.size(); i++) {
+        for (size_t n = 0; n < nbf_; n++) Lp[n][i] = cols[order[i]][n];
+    }
+    return L;
+}
+
 }  // End namespaces
@@ -147,6 +147,21 @@ class PSI_API DFHelper {
     void set_omega(double omega) { omega_ = omega; }
     size_t get_omega() { return omega_; }
 
+    ///
+    /// Screens the exchange build on the occupied orbitals. Rows (Q|m i) of an
+    /// occupied batch whose coefficients over the Schwarz mask of m are all below
+    /// tol are skipped, and K is assembled from the surviving rows only. Symmetric
+    /// densities are first rewritten in pivoted Cholesky (localized) orbitals;
+    /// nonsymmetric builds use the incoming orbitals as given.
+    /// @param sparse turn the screened exchange on
+    /// @param tol coefficient cutoff
+    ///
+    void set_sparse_K(bool sparse, double tol = 1.0E-10) {
+        sparse_K_ = sparse;
+        sparse_K_tol_ = tol;
+    }
+    bool get_sparse_K() { return sparse_K_; }
+
     ///
     /// set the printing verbosity parameter
     /// @param print_lvl indicating verbosity
@@ -308,6 +323,8 @@ class PSI_API DFHelper {
     double omega_;
     bool debug_ = false;
     bool sparsity_prepared_ = false;
+    bool sparse_K_ = false;
+    double sparse_K_tol_ = 1.0E-10;
     int print_lvl_ = 1;
 
     // => in-core machinery <=
@@ -457,6 +474,15 @@ class PSI_API DFHelper {
     void compute_K(std::vector<SharedMatrix> Cleft, std::vector<SharedMatrix> Cright, std::vector<SharedMatrix> K,
                    double* Tp, double* Jtmp, double* Mp, size_t bcount, size_t block_size,
                    std::vector<std::vector<double>>& C_buffers, bool lr_symmetric);
+    void compute_sparse_K(std::vector<SharedMatrix> Cleft, std::vector<SharedMatrix> Cright,
+                          std::vector<SharedMatrix> K, double* T1p, double* T2p, double* Mp, size_t bcount,
+                          size_t block_size, std::vector<std::vector<double>>& C_buffers, bool lr_symmetric);
+    void transform_rows_pQq(const std::vector<size_t>& rows, size_t nocc, size_t o0, size_t nb, size_t bcount,
+                            size_t block_size, double* Mp, double* Tp, double* Bp,
+                            std::vector<std::vector<double>>& C_buffers);
+    std::vector<size_t> significant_rows(double* Bp, size_t nocc, size_t o0, size_t nb);
+    size_t occ_batch_size(size_t block_size, size_t nocc);
+    SharedMatrix cholesky_orbitals(SharedMatrix D, size_t max_rank);
     std::tuple<size_t, size_t> Qshell_blocks_for_JK_build(std::vector<std::pair<size_t, size_t>>& b, size_t max_nocc,
                                                           bool lr_symmetric);
 
@@ -0,0 +1,453 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+#include "psi4/lib3index/localdf.h"
+
+#include "psi4/libmints/basisset.h"
+#include "psi4/libmints/integral.h"
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/molecule.h"
+#include "psi4/libmints/sieve.h"
+#include "psi4/libmints/twobody.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libqt/qt.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace psi {
+
+LocalDFHelper::LocalDFHelper(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> aux)
+    : primary_(primary), aux_(aux) {}
+
+LocalDFHelper::~LocalDFHelper() {}
+
+std::vector<int> LocalDFHelper::aux_functions(const std::vector<int>& atoms) const {
+    std::vector<int> funcs;
+    for (int C : atoms) {
+        for (int p = 0; p < acount_[C]; p++) funcs.push_back(afirst_[C] + p);
+    }
+    return funcs;
+}
+
+void LocalDFHelper::prepare_domains() {
+    if (prepared_) return;
+
+    std::shared_ptr<Molecule> mol = primary_->molecule();
+    int natom = mol->natom();
+
+    // Functions on an atom are contiguous in both bases
+    auto atom_ranges = [natom](std::shared_ptr<BasisSet> basis, std::vector<int>& first, std::vector<int>& count) {
+        first.assign(natom, 0);
+        count.assign(natom, 0);
+        for (int A = 0; A < natom; A++) {
+            int nshell = basis->nshell_on_center(A);
+            if (nshell == 0) continue;
+            first[A] = basis->shell(basis->shell_on_center(A, 0)).function_index();
+            for (int s = 0; s < nshell; s++) count[A] += basis->shell(basis->shell_on_center(A, s)).nfunction();
+        }
+    };
+    atom_ranges(primary_, pfirst_, pcount_);
+    atom_ranges(aux_, afirst_, acount_);
+
+    // Atom pairs that hold at least one significant shell pair
+    ERISieve sieve(primary_, cutoff_);
+    std::set<std::pair<int, int>> pair_set;
+    for (const auto& MN : sieve.shell_pairs()) {
+        int A = primary_->shell_to_center(MN.first);
+        int B = primary_->shell_to_center(MN.second);
+        pair_set.insert(std::make_pair(std::max(A, B), std::min(A, B)));
+    }
+    pairs_.assign(pair_set.begin(), pair_set.end());
+
+    domains_.clear();
+    ndomain_.clear();
+    atom_pairs_.assign(natom, std::vector<size_t>());
+    std::vector<std::set<int>> neighbor_sets(natom);
+    for (size_t k = 0; k < pairs_.size(); k++) {
+        int A = pairs_[k].first;
+        int B = pairs_[k].second;
+        std::vector<int> domain;
+        size_t ndomain = 0;
+        for (int C = 0; C < natom; C++) {
+            if (acount_[C] == 0) continue;
+            bool inside = (C == A || C == B || mol->xyz(C).distance(mol->xyz(A)) <= radius_ ||
+                           mol->xyz(C).distance(mol->xyz(B)) <= radius_);
+            if (!inside) continue;
+            domain.push_back(C);
+            ndomain += acount_[C];
+        }
+        domains_.push_back(domain);
+        ndomain_.push_back(ndomain);
+        atom_pairs_[A].push_back(k);
+        if (A != B) atom_pairs_[B].push_back(k);
+        neighbor_sets[A].insert(domain.begin(), domain.end());
+        neighbor_sets[B].insert(domain.begin(), domain.end());
+    }
+
+    neighbors_.assign(natom, std::vector<int>());
+    nneighbor_.assign(natom, 0);
+    neighbor_offset_.assign(natom, std::vector<int>(natom, -1));
+    for (int A = 0; A < natom; A++) {
+        neighbors_[A].assign(neighbor_sets[A].begin(), neighbor_sets[A].end());
+        for (int C : neighbors_[A]) {
+            neighbor_offset_[A][C] = nneighbor_[A];
+            nneighbor_[A] += acount_[C];
+        }
+    }
+
+    prepared_ = true;
+}
+
+size_t LocalDFHelper::get_fit_size() {
+    prepare_domains();
+    size_t size = 0;
+    for (size_t k = 0; k < pairs_.size(); k++) {
+        size += ndomain_[k] * pcount_[pairs_[k].first] * pcount_[pairs_[k].second];
+    }
+    return size;
+}
+
+size_t LocalDFHelper::get_core_size(size_t nocc) {
+    size_t naux = aux_->nbf();
+    size_t size = naux * naux + get_fit_size();
+
+    // J: one fitted density per thread
+    size_t jscratch = nthreads_ * naux;
+
+    // K: left and right half-transformed coefficients, then per thread the
+    // metric columns of an atom's neighbors, E and Ebar for its rows, and Kblk
+    size_t kscratch = 0;
+    if (nocc) {
+        size_t maxn = 0, maxnn = 0, thread = 0;
+        for (size_t A = 0; A < pcount_.size(); A++) {
+            kscratch += 2 * pcount_[A] * nneighbor_[A] * nocc;
+            maxn = std::max(maxn, (size_t)pcount_[A]);
+            maxnn = std::max(maxnn, nneighbor_[A]);
+        }
+        for (size_t A = 0; A < pcount_.size(); A++) {
+            size_t nA = pcount_[A];
+            thread = std::max(thread, naux * nneighbor_[A] + nA * naux * nocc + nA * maxnn * nocc + nA * maxn);
+        }
+        kscratch += nthreads_ * thread;
+    }
+
+    return size + std::max(jscratch, kscratch);
+}
+
+double LocalDFHelper::K_flops(size_t nocc) {
+    prepare_domains();
+    size_t naux = aux_->nbf();
+    // Half transform, once per occupied set
+    double flops = 2.0 * get_fit_size() * nocc;
+    for (size_t A = 0; A < pcount_.size(); A++) {
+        // E for atom A's rows, then its blocks against every atom B
+        flops += 2.0 * pcount_[A] * naux * nneighbor_[A] * nocc;
+        for (size_t B = 0; B < pcount_.size(); B++) {
+            flops += 2.0 * pcount_[A] * pcount_[B] * nneighbor_[B] * nocc;
+        }
+    }
+    return flops;
+}
+
+void LocalDFHelper::initialize() {
+    prepare_domains();
+
+    size_t naux = aux_->nbf();
+    std::shared_ptr<BasisSet> zero = BasisSet::zero_ao_basis_set();
+
+    // => Full metric (P|Q) <= //
+
+    metric_ = std::make_shared<Matrix>("(P|Q)", naux, naux);
+    double** Jp = metric_->pointer();
+    {
+        IntegralFactory factory(aux_, zero, aux_, zero);
+        std::vector<std::shared_ptr<TwoBodyAOInt>> eri;
+        for (int thread = 0; thread < nthreads_; thread++) eri.push_back(std::shared_ptr<TwoBodyAOInt>(factory.eri()));
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
+        for (int P = 0; P < aux_->nshell(); P++) {
+            int thread = 0;
+#ifdef _OPENMP
+            thread = omp_get_thread_num();
+#endif
+            const double* buffer = eri[thread]->buffer();
+            int p0 = aux_->shell(P).function_index();
+            int np = aux_->shell(P).nfunction();
+            for (int Q = 0; Q <= P; Q++) {
+                int q0 = aux_->shell(Q).function_index();
+                int nq = aux_->shell(Q).nfunction();
+                eri[thread]->compute_shell(P, 0, Q, 0);
+                for (int p = 0; p < np; p++) {
+                    for (int q = 0; q < nq; q++) {
+                        Jp[p0 + p][q0 + q] = Jp[q0 + q][p0 + p] = buffer[p * nq + q];
+                    }
+                }
+            }
+        }
+    }
+
+    // => Fit blocks C^{AB} = (dom|dom)^-1 (dom|AB) <= //
+
+    ERISieve sieve(primary_, cutoff_);
+    IntegralFactory factory(aux_, zero, primary_, primary_);
+    std::vector<std::shared_ptr<TwoBodyAOInt>> eri;
+    for (int thread = 0; thread < nthreads_; thread++) eri.push_back(std::shared_ptr<TwoBodyAOInt>(factory.eri()));
+
+    blocks_.assign(pairs_.size(), std::vector<double>());
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
+    for (size_t k = 0; k < pairs_.size(); k++) {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        int A = pairs_[k].first;
+        int B = pairs_[k].second;
+        size_t nA = pcount_[A];
+        size_t nB = pcount_[B];
+        size_t ndom = ndomain_[k];
+        size_t nAB = nA * nB;
+        const double* buffer = eri[thread]->buffer();
+
+        std::vector<double> T(ndom * nAB, 0.0);
+        size_t pofs = 0;
+        for (int C : domains_[k]) {
+            for (int Ps = 0; Ps < aux_->nshell_on_center(C); Ps++) {
+                int P = aux_->shell_on_center(C, Ps);
+                size_t p0 = pofs + aux_->shell(P).function_index() - afirst_[C];
+                int np = aux_->shell(P).nfunction();
+                for (int Ms = 0; Ms < primary_->nshell_on_center(A); Ms++) {
+                    int M = primary_->shell_on_center(A, Ms);
+                    size_t m0 = primary_->shell(M).function_index() - pfirst_[A];
+                    int nm = primary_->shell(M).nfunction();
+                    for (int Ns = 0; Ns < primary_->nshell_on_center(B); Ns++) {
+                        int N = primary_->shell_on_center(B, Ns);
+                        if (!sieve.shell_pair_significant(M, N)) continue;
+                        size_t n0 = primary_->shell(N).function_index() - pfirst_[B];
+                        int nn = primary_->shell(N).nfunction();
+                        eri[thread]->compute_shell(P, 0, M, N);
+                        for (int p = 0; p < np; p++) {
+                            for (int m = 0; m < nm; m++) {
+                                ::memcpy(&T[(p0 + p) * nAB + (m0 + m) * nB + n0], &buffer[(p * nm + m) * nn],
+                                         sizeof(double) * nn);
+                            }
+                        }
+                    }
+                }
+            }
+            pofs += acount_[C];
+        }
+
+        std::vector<int> funcs = aux_functions(domains_[k]);
+        auto Jdom = std::make_shared<Matrix>("Jdom", ndom, ndom);
+        double** Jdp = Jdom->pointer();
+        for (size_t P = 0; P < ndom; P++) {
+            for (size_t Q = 0; Q < ndom; Q++) Jdp[P][Q] = Jp[funcs[P]][funcs[Q]];
+        }
+        Jdom->power(-1.0, condition_);
+
+        blocks_[k].resize(ndom * nAB);
+        C_DGEMM('N', 'N', ndom, nAB, ndom, 1.0, Jdp[0], ndom, T.data(), nAB, 0.0, blocks_[k].data(), nAB);
+    }
+}
+
+void LocalDFHelper::half_transform(SharedMatrix C, std::vector<std::vector<double>>& X) {
+    int natom = pcount_.size();
+    size_t nocc = C->colspi()[0];
+    double** Cp = C->pointer();
+
+    X.assign(natom, std::vector<double>());
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
+    for (int B = 0; B < natom; B++) {
+        size_t nB = pcount_[B];
+        size_t nnb = nneighbor_[B];
+        X[B].assign(nB * nnb * nocc, 0.0);
+        if (nB == 0 || nocc == 0) continue;
+
+        for (size_t k : atom_pairs_[B]) {
+            int A1 = pairs_[k].first;
+            int A2 = pairs_[k].second;
+            size_t n1 = pcount_[A1];
+            size_t n2 = pcount_[A2];
+            const double* Ck = blocks_[k].data();
+
+            size_t pofs = 0;
+            for (int Cat : domains_[k]) {
+                size_t xofs = neighbor_offset_[B][Cat];
+                for (int p = 0; p < acount_[Cat]; p++) {
+                    const double* CP = Ck + (pofs + p) * n1 * n2;
+                    double* XP = X[B].data() + (xofs + p) * nocc;
+                    if (B == A1) {
+                        // X[n][P][i] += C[P][n][l] C_li, l on A2
+                        C_DGEMM('N', 'N', nB, nocc, n2, 1.0, const_cast<double*>(CP), n2, Cp[pfirst_[A2]], nocc, 1.0,
+                                XP, nnb * nocc);
+                    } else {
+                        // X[n][P][i] += C[P][l][n] C_li, l on A1
+                        C_DGEMM('T', 'N', nB, nocc, n1, 1.0, const_cast<double*>(CP), n2, Cp[pfirst_[A1]], nocc, 1.0,
+                                XP, nnb * nocc);
+                    }
+                }
+                pofs += acount_[Cat];
+            }
+        }
+    }
+}
+
+void LocalDFHelper::build_JK(std::vector<SharedMatrix> Cleft, std::vector<SharedMatrix> Cright,
+                             std::vector<SharedMatrix> D, std::vector<SharedMatrix> J, std::vector<SharedMatrix> K,
+                             bool do_J, bool do_K, bool lr_symmetric) {
+    int natom = pcount_.size();
+    size_t naux = aux_->nbf();
+    double** Jp = metric_->pointer();
+
+    if (do_J) {
+        timer_on("LocalDF: J");
+        for (size_t i = 0; i < D.size(); i++) {
+            double** Dp = D[i]->pointer();
+            double** Jmp = J[i]->pointer();
+
+            // d_Q = \sum_{ls} C^{ls}_Q D_ls
+            std::vector<std::vector<double>> dthread(nthreads_, std::vector<double>(naux, 0.0));
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
+            for (size_t k = 0; k < pairs_.size(); k++) {
+                int thread = 0;
+#ifdef _OPENMP
+                thread = omp_get_thread_num();
+#endif
+                int A = pairs_[k].first;
+                int B = pairs_[k].second;
+                size_t nA = pcount_[A];
+                size_t nB = pcount_[B];
+                std::vector<double> Dblk(nA * nB);
+                for (size_t m = 0; m < nA; m++) {
+                    for (size_t n = 0; n < nB; n++) {
+                        double val = Dp[pfirst_[A] + m][pfirst_[B] + n];
+                        if (A != B) val += Dp[pfirst_[B] + n][pfirst_[A] + m];
+                        Dblk[m * nB + n] = val;
+                    }
+                }
+                std::vector<int> funcs = aux_functions(domains_[k]);
+                const double* Ck = blocks_[k].data();
+                for (size_t P = 0; P < funcs.size(); P++) {
+                    dthread[thread][funcs[P]] += C_DDOT(nA * nB, const_cast<double*>(Ck + P * nA * nB), 1, Dblk.data(), 1);
+                }
+            }
+            for (int thread = 1; thread < nthreads_; thread++) C_DAXPY(naux, 1.0, dthread[thread].data(), 1, dthread[0].data(), 1);
+
+            std::vector<double> e(naux);
+            C_DGEMV('N', naux, naux, 1.0, Jp[0], naux, dthread[0].data(), 1, 0.0, e.data(), 1);
+
+            // J_mn = \sum_P C^{mn}_P e_P, each pair owns its block
+            J[i]->zero();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
+            for (size_t k = 0; k < pairs_.size(); k++) {
+                int A = pairs_[k].first;
+                int B = pairs_[k].second;
+                size_t nA = pcount_[A];
+                size_t nB = pcount_[B];
+                std::vector<int> funcs = aux_functions(domains_[k]);
+                std::vector<double> eloc(funcs.size());
+                for (size_t P = 0; P < funcs.size(); P++) eloc[P] = e[funcs[P]];
+                std::vector<double> Jblk(nA * nB);
+                C_DGEMV('T', funcs.size(), nA * nB, 1.0, const_cast<double*>(blocks_[k].data()), nA * nB, eloc.data(),
+                        1, 0.0, Jblk.data(), 1);
+                for (size_t m = 0; m < nA; m++) {
+                    for (size_t n = 0; n < nB; n++) {
+                        Jmp[pfirst_[A] + m][pfirst_[B] + n] = Jblk[m * nB + n];
+                        Jmp[pfirst_[B] + n][pfirst_[A] + m] = Jblk[m * nB + n];
+                    }
+                }
+            }
+        }
+        timer_off("LocalDF: J");
+    }
+
+    if (do_K) {
+        timer_on("LocalDF: K");
+        for (size_t i = 0; i < Cleft.size(); i++) {
+            K[i]->zero();
+            size_t nocc = Cleft[i]->colspi()[0];
+            if (nocc == 0) continue;
+            double** Kp = K[i]->pointer();
+
+            std::vector<std::vector<double>> XL, XR;
+            half_transform(Cleft[i], XL);
+            if (!lr_symmetric) half_transform(Cright[i], XR);
+            std::vector<std::vector<double>>& Xr = (lr_symmetric ? XL : XR);
+
+            // K_mn = \sum_{PQ,i} X^L_{Pmi} (P|Q) X^R_{Qni}, one atom's rows at a time
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
+            for (int A = 0; A < natom; A++) {
+                size_t nA = pcount_[A];
+                size_t nnA = nneighbor_[A];
+                if (nA == 0 || nnA == 0) continue;
+
+                // E[m][Q][i] = \sum_{P near A} (Q|P) X^L[m][P][i]
+                std::vector<int> funcsA = aux_functions(neighbors_[A]);
+                std::vector<double> Jsub(naux * nnA);
+                for (size_t Q = 0; Q < naux; Q++) {
+                    for (size_t P = 0; P < nnA; P++) Jsub[Q * nnA + P] = Jp[Q][funcsA[P]];
+                }
+                std::vector<double> E(nA * naux * nocc);
+                for (size_t m = 0; m < nA; m++) {
+                    C_DGEMM('N', 'N', naux, nocc, nnA, 1.0, Jsub.data(), nnA, XL[A].data() + m * nnA * nocc, nocc,
+                            0.0, E.data() + m * naux * nocc, nocc);
+                }
+
+                std::vector<double> Ebar, Kblk;
+                for (int B = 0; B < natom; B++) {
+                    size_t nB = pcount_[B];
+                    size_t nnB = nneighbor_[B];
+                    if (nB == 0 || nnB == 0) continue;
+                    std::vector<int> funcsB = aux_functions(neighbors_[B]);
+                    Ebar.resize(nA * nnB * nocc);
+                    for (size_t m = 0; m < nA; m++) {
+                        for (size_t Q = 0; Q < nnB; Q++) {
+                            ::memcpy(&Ebar[(m * nnB + Q) * nocc], &E[(m * naux + funcsB[Q]) * nocc],
+                                     sizeof(double) * nocc);
+                        }
+                    }
+                    Kblk.resize(nA * nB);
+                    C_DGEMM('N', 'T', nA, nB, nnB * nocc, 1.0, Ebar.data(), nnB * nocc, Xr[B].data(), nnB * nocc,
+                            0.0, Kblk.data(), nB);
+                    for (size_t m = 0; m < nA; m++) {
+                        ::memcpy(&Kp[pfirst_[A] + m][pfirst_[B]], &Kblk[m * nB], sizeof(double) * nB);
+                    }
+                }
+            }
+        }
+        timer_off("LocalDF: K");
+    }
+}
+
+}  // namespace psi
@@ -0,0 +1,124 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+#ifndef three_index_localdf
+#define three_index_localdf
+
+#include "psi4/psi4-dec.h"
+#include <psi4/libmints/typedefs.h>
+
+#include <utility>
+#include <vector>
+
+namespace psi {
+
+class BasisSet;
+class Matrix;
+
+/**
+ * Pair-atomic (local) density fitting.
+ *
+ * Each product m n with m on atom A and n on atom B is fit only with the
+ * auxiliary functions on A, B and any atom within a given radius of
+ * either. The fit coefficients
+ *
+ *  C^{AB}_{P,mn} = \sum_{Q in dom(AB)} [(dom|dom)^-1]_{PQ} (Q|mn)
+ *
+ * are kept as one dense block per significant atom pair, so storage grows
+ * quadratically with system size instead of cubically. Integrals are
+ * approximated as (ml|ns) ~ \sum_{PQ} C^{ml}_P (P|Q) C^{ns}_Q with the
+ * full two-index metric (P|Q).
+ */
+class PSI_API LocalDFHelper {
+   public:
+    LocalDFHelper(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> aux);
+    ~LocalDFHelper();
+
+    /// Extra radius (bohr) around each pair's atoms for the fitting domain
+    void set_radius(double radius) { radius_ = radius; }
+    /// Schwarz cutoff deciding which atom pairs are kept
+    void set_schwarz_cutoff(double cutoff) { cutoff_ = cutoff; }
+    /// Minimum relative eigenvalue retained in each domain metric inverse
+    void set_fitting_condition(double condition) { condition_ = condition; }
+    void set_nthreads(int nthreads) { nthreads_ = nthreads; }
+
+    /// Doubles needed for the fit blocks and metric, plus the J and K scratch
+    /// for nocc occupied orbitals; sets up domains if needed
+    size_t get_core_size(size_t nocc = 0);
+    /// Number of stored fit coefficients, the sparse counterpart of naux * nbf^2
+    size_t get_fit_size();
+    /// Floating-point operations of one K build for nocc occupied orbitals
+    double K_flops(size_t nocc);
+    /// Number of significant atom pairs
+    size_t npairs() { prepare_domains(); return pairs_.size(); }
+
+    /// Computes the fit blocks and the full metric
+    void initialize();
+
+    /// J and K for densities D = Cleft Cright^T (all in C1 AO basis)
+    void build_JK(std::vector<SharedMatrix> Cleft, std::vector<SharedMatrix> Cright, std::vector<SharedMatrix> D,
+                  std::vector<SharedMatrix> J, std::vector<SharedMatrix> K, bool do_J, bool do_K, bool lr_symmetric);
+
+   protected:
+    std::shared_ptr<BasisSet> primary_;
+    std::shared_ptr<BasisSet> aux_;
+    double radius_ = 0.0;
+    double cutoff_ = 1.0E-12;
+    double condition_ = 1.0E-12;
+    int nthreads_ = 1;
+
+    /// First function and function count per atom, primary and auxiliary
+    std::vector<int> pfirst_, pcount_, afirst_, acount_;
+    /// Significant atom pairs (A >= B)
+    std::vector<std::pair<int, int>> pairs_;
+    /// Auxiliary atoms in each pair's fitting domain, and its size in functions
+    std::vector<std::vector<int>> domains_;
+    std::vector<size_t> ndomain_;
+    /// Fit coefficients per pair, laid out [P][m in A][n in B]
+    std::vector<std::vector<double>> blocks_;
+    /// Pairs each atom takes part in
+    std::vector<std::vector<size_t>> atom_pairs_;
+    /// Auxiliary atoms reachable from each atom through its pairs, their
+    /// function count, and each auxiliary atom's offset within them (-1 if absent)
+    std::vector<std::vector<int>> neighbors_;
+    std::vector<size_t> nneighbor_;
+    std::vector<std::vector<int>> neighbor_offset_;
+    /// Full (P|Q)
+    SharedMatrix metric_;
+    bool prepared_ = false;
+
+    void prepare_domains();
+    /// Auxiliary functions of a list of atoms, in order
+    std::vector<int> aux_functions(const std::vector<int>& atoms) const;
+    /// X_B[n][Q in neighbors(B)][i] = \sum_pairs C^{B.}_{Q,n l} C_{li} for every atom B
+    void half_transform(SharedMatrix C, std::vector<std::vector<double>>& X);
+};
+
+}  // namespace psi
+
+#endif
@@ -29,9 +29,13 @@
 #include "csg.h"
 
 #include <algorithm>
+#include <cstdint>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
 
 #include "psi4/psi4-dec.h"
 
@@ -165,6 +169,7 @@ void CubicScalarGrid::populate_grid() {
     nxyz_ = std::llround(pow((double)max_points, 1.0 / 3.0));
 
     blocks_.clear();
+    block_offsets_.clear();
     size_t offset = 0L;
     for (int istart = 0L; istart <= N_[0]; istart += nxyz_) {
         int ni = (istart + nxyz_ > N_[0] ? (N_[0] + 1) - istart : nxyz_);
@@ -177,6 +182,7 @@ void CubicScalarGrid::populate_grid() {
                 double* yp = &y_[offset];
                 double* zp = &z_[offset];
                 double* wp = &w_[offset];
+                block_offsets_.push_back(offset);
 
                 size_t block_size = 0L;
                 for (int i = istart; i < istart + ni; i++) {
@@ -203,8 +209,30 @@ void CubicScalarGrid::populate_grid() {
                              : blocks_[ind]->functions_local_to_global().size());
     }
 
-    points_ = std::make_shared<RKSFunctions>(primary_, max_points, max_functions);
-    points_->set_ansatz(0);
+    nthreads_ = 1;
+#ifdef _OPENMP
+    nthreads_ = Process::environment.get_n_threads();
+#endif
+    points_.clear();
+    for (int thread = 0; thread < nthreads_; thread++) {
+        points_.push_back(std::make_shared<RKSFunctions>(primary_, max_points, max_functions));
+        points_[thread]->set_ansatz(0);
+    }
+}
+size_t CubicScalarGrid::fast_index(int i, int j, int k) const {
+    // Blocks are laid out in (i, j, k) block order, points within a block in (i, j, k) order
+    int nbj = (N_[1] + nxyz_) / nxyz_;
+    int nbk = (N_[2] + nxyz_) / nxyz_;
+    int bi = i / nxyz_;
+    int bj = j / nxyz_;
+    int bk = k / nxyz_;
+    int istart = bi * nxyz_;
+    int jstart = bj * nxyz_;
+    int kstart = bk * nxyz_;
+    int nj = (jstart + nxyz_ > N_[1] ? (N_[1] + 1) - jstart : nxyz_);
+    int nk = (kstart + nxyz_ > N_[2] ? (N_[2] + 1) - kstart : nxyz_);
+    size_t block = ((size_t)bi * nbj + bj) * nbk + bk;
+    return block_offsets_[block] + ((size_t)(i - istart) * nj + (j - jstart)) * nk + (k - kstart);
 }
 void CubicScalarGrid::print_header() {
     outfile->Printf("  ==> CubicScalarGrid <==\n\n");
@@ -232,36 +260,15 @@ void CubicScalarGrid::write_gen_file(double* v, const std::string& name, const s
                                      const std::string& comment) {
     if (type == "CUBE") {
         write_cube_file(v, name, comment);
+    } else if (type == "BINARY") {
+        write_binary_file(v, name, comment, false);
+    } else if (type == "BINARY_GZ") {
+        write_binary_file(v, name, comment, true);
     } else {
         throw PSIEXCEPTION("CubicScalarGrid: Unrecognized output file type");
     }
 }
 void CubicScalarGrid::write_cube_file(double* v, const std::string& name, const std::string& comment) {
-    // => Reorder the grid <= //
-
-    double* v2 = new double[npoints_];
-    size_t offset = 0L;
-    for (int istart = 0L; istart <= N_[0]; istart += nxyz_) {
-        int ni = (istart + nxyz_ > N_[0] ? (N_[0] + 1) - istart : nxyz_);
-        for (int jstart = 0L; jstart <= N_[1]; jstart += nxyz_) {
-            int nj = (jstart + nxyz_ > N_[1] ? (N_[1] + 1) - jstart : nxyz_);
-            for (int kstart = 0L; kstart <= N_[2]; kstart += nxyz_) {
-                int nk = (kstart + nxyz_ > N_[2] ? (N_[2] + 1) - kstart : nxyz_);
-                for (int i = istart; i < istart + ni; i++) {
-                    for (int j = jstart; j < jstart + nj; j++) {
-                        for (int k = kstart; k < kstart + nk; k++) {
-                            size_t index = i * (N_[1] + 1L) * (N_[2] + 1L) + j * (N_[2] + 1L) + k;
-                            v2[index] = v[offset];
-                            offset++;
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    // => Drop the grid out <= //
-
     std::stringstream ss;
     ss << filepath_ << "/" << name << ".cube";
 
@@ -291,25 +298,112 @@ void CubicScalarGrid::write_cube_file(double* v, const std::string& name, const
                 mol_->z(A));
     }
 
-    // Data, striped (x, y, z)
-    for (size_t ind = 0; ind < npoints_; ind++) {
-        fprintf(fh, "%12.5E ", v2[ind]);
-        if (ind % 6 == 5) fprintf(fh, "\n");
+    // Data, striped (x, y, z), streamed straight from the fast ordering
+    size_t ind = 0L;
+    for (int i = 0; i <= N_[0]; i++) {
+        for (int j = 0; j <= N_[1]; j++) {
+            for (int k = 0; k <= N_[2]; k++, ind++) {
+                fprintf(fh, "%12.5E ", v[fast_index(i, j, k)]);
+                if (ind % 6 == 5) fprintf(fh, "\n");
+            }
+        }
     }
 
     fclose(fh);
 }
+void CubicScalarGrid::write_binary_file(double* v, const std::string& name, const std::string& comment,
+                                        bool compress) {
+    // Layout (native byte order):
+    //   char[8] "PSI4CUBE", int32 version, int32 natom, int32 points along x, y, z,
+    //   double origin[3], double spacing[3],
+    //   natom x (int32 Z, double x, y, z),
+    //   int32 length + characters of the property comment,
+    //   float32 values, striped (x, y, z) as in the text cube file
+#ifndef HAVE_ZLIB_H
+    if (compress) throw PSIEXCEPTION("CubicScalarGrid: BINARY_GZ output requires Psi4 to be built with zlib.");
+#endif
+
+    std::stringstream ss;
+    ss << filepath_ << "/" << name << ".cube.bin" << (compress ? ".gz" : "");
+
+    // Is filepath a valid directory?
+    if (filesystem::path(filepath_).make_absolute().is_directory() == false) {
+        printf("Filepath \"%s\" is not valid.  Please create this directory.\n", filepath_.c_str());
+        outfile->Printf("Filepath \"%s\" is not valid.  Please create this directory.\n", filepath_.c_str());
+        exit(Failure);
+    }
+
+    FILE* fh = nullptr;
+#ifdef HAVE_ZLIB_H
+    gzFile gz = nullptr;
+    if (compress) {
+        gz = gzopen(ss.str().c_str(), "wb");
+        if (!gz) throw PSIEXCEPTION("CubicScalarGrid: Unable to open " + ss.str());
+    } else
+#endif
+    {
+        fh = fopen(ss.str().c_str(), "wb");
+        if (!fh) throw PSIEXCEPTION("CubicScalarGrid: Unable to open " + ss.str());
+    }
+
+    auto write = [&](const void* data, size_t size) {
+#ifdef HAVE_ZLIB_H
+        if (gz) {
+            if (gzwrite(gz, data, size) != (int)size) throw PSIEXCEPTION("CubicScalarGrid: gzwrite failed.");
+            return;
+        }
+#endif
+        if (fwrite(data, 1, size, fh) != size) throw PSIEXCEPTION("CubicScalarGrid: fwrite failed.");
+    };
+
+    const char magic[8] = {'P', 'S', 'I', '4', 'C', 'U', 'B', 'E'};
+    int32_t header[5] = {1, mol_->natom(), N_[0] + 1, N_[1] + 1, N_[2] + 1};
+    write(magic, sizeof(magic));
+    write(header, sizeof(header));
+    write(O_, 3 * sizeof(double));
+    write(D_, 3 * sizeof(double));
+    for (int A = 0; A < mol_->natom(); A++) {
+        int32_t Z = (int32_t)mol_->true_atomic_number(A);
+        double xyz[3] = {mol_->x(A), mol_->y(A), mol_->z(A)};
+        write(&Z, sizeof(Z));
+        write(xyz, sizeof(xyz));
+    }
+    std::string property = "Property: " + name + comment;
+    int32_t length = property.size();
+    write(&length, sizeof(length));
+    write(property.c_str(), length);
+
+    // Stream the data one x plane at a time
+    std::vector<float> plane((N_[1] + 1L) * (N_[2] + 1L));
+    for (int i = 0; i <= N_[0]; i++) {
+        size_t ind = 0L;
+        for (int j = 0; j <= N_[1]; j++) {
+            for (int k = 0; k <= N_[2]; k++) {
+                plane[ind++] = (float)v[fast_index(i, j, k)];
+            }
+        }
+        write(plane.data(), plane.size() * sizeof(float));
+    }
+
+#ifdef HAVE_ZLIB_H
+    if (gz) gzclose(gz);
+#endif
+    if (fh) fclose(fh);
+}
 void CubicScalarGrid::add_density(double* v, std::shared_ptr<Matrix> D) {
-    points_->set_pointers(D);
-    std::shared_ptr<Vector> rho = points_->point_value("RHO_A");
-    double* rhop = rho->pointer();
+    for (int thread = 0; thread < nthreads_; thread++) points_[thread]->set_pointers(D);
 
-    size_t offset = 0L;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
     for (int ind = 0; ind < blocks_.size(); ind++) {
-        points_->compute_points(blocks_[ind]);
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        std::shared_ptr<RKSFunctions> points = points_[thread];
+        points->compute_points(blocks_[ind]);
+        double* rhop = points->point_value("RHO_A")->pointer();
         size_t npoints = blocks_[ind]->npoints();
-        C_DAXPY(npoints, 0.5, rhop, 1, &v[offset], 1);
-        offset += npoints;
+        C_DAXPY(npoints, 0.5, rhop, 1, &v[block_offsets_[ind]], 1);
     }
 }
 void CubicScalarGrid::add_esp(double* v, std::shared_ptr<Matrix> D, const std::vector<double>& nuc_weights) {
@@ -484,24 +578,28 @@ void CubicScalarGrid::add_esp(double* v, std::shared_ptr<Matrix> D, const std::v
         double x = mol_->x(A);
         double y = mol_->y(A);
         double z = mol_->z(A);
-        for (int P = 0; P < npoints_; P++) {
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+        for (size_t P = 0; P < npoints_; P++) {
             double R = sqrt((x - x_[P]) * (x - x_[P]) + (y - y_[P]) * (y - y_[P]) + (z - z_[P]) * (z - z_[P]));
             v[P] += (R >= 1.0E-15 ? Z / R : 0.0);
         }
     }
 }
 void CubicScalarGrid::add_basis_functions(double** v, const std::vector<int>& indices) {
-    std::shared_ptr<Matrix> phi = points_->basis_value("PHI");
-    double** phip = phi->pointer();
-
-    size_t offset = 0L;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
     for (int ind = 0; ind < blocks_.size(); ind++) {
-        points_->compute_functions(blocks_[ind]);
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        std::shared_ptr<RKSFunctions> points = points_[thread];
+        points->compute_functions(blocks_[ind]);
+        double** phip = points->basis_value("PHI")->pointer();
 
+        size_t offset = block_offsets_[ind];
         size_t npoints = blocks_[ind]->npoints();
         const std::vector<int>& function_map = blocks_[ind]->functions_local_to_global();
-        int nlocal = function_map.size();
-        int nglobal = points_->max_functions();
+        int nglobal = points->max_functions();
 
         for (int ind1 = 0; ind1 < indices.size(); ind1++) {
             for (int ind2 = 0; ind2 < function_map.size(); ind2++) {
@@ -510,43 +608,50 @@ void CubicScalarGrid::add_basis_functions(double** v, const std::vector<int>& in
                 }
             }
         }
-
-        offset += npoints;
     }
 }
 void CubicScalarGrid::add_orbitals(double** v, std::shared_ptr<Matrix> C) {
     int na = C->colspi()[0];
 
-    points_->set_Cs(C);
-    std::shared_ptr<Matrix> psi = points_->orbital_value("PSI_A");
-    double** psip = psi->pointer();
+    for (int thread = 0; thread < nthreads_; thread++) points_[thread]->set_Cs(C);
 
-    size_t offset = 0L;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
     for (int ind = 0; ind < blocks_.size(); ind++) {
-        points_->compute_orbitals(blocks_[ind]);
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        std::shared_ptr<RKSFunctions> points = points_[thread];
+        points->compute_orbitals(blocks_[ind]);
+        double** psip = points->orbital_value("PSI_A")->pointer();
 
+        size_t offset = block_offsets_[ind];
         size_t npoints = blocks_[ind]->npoints();
         for (int a = 0; a < na; a++) {
             C_DAXPY(npoints, 1.0, psip[a], 1, &v[a][offset], 1);
         }
-
-        offset += npoints;
     }
 }
 void CubicScalarGrid::add_LOL(double* v, std::shared_ptr<Matrix> D) {
-    points_->set_ansatz(2);
-    points_->set_pointers(D);
-
-    std::shared_ptr<Vector> rho = points_->point_value("RHO_A");
-    std::shared_ptr<Vector> tau = points_->point_value("TAU_A");
-    double* rhop = rho->pointer();
-    double* taup = tau->pointer();
+    for (int thread = 0; thread < nthreads_; thread++) {
+        points_[thread]->set_ansatz(2);
+        points_[thread]->set_pointers(D);
+    }
 
     double C = 3.0 / 5.0 * pow(6.0 * M_PI * M_PI, 2.0 / 3.0);
 
-    size_t offset = 0L;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
     for (int ind = 0; ind < blocks_.size(); ind++) {
-        points_->compute_points(blocks_[ind]);
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        std::shared_ptr<RKSFunctions> points = points_[thread];
+        points->compute_points(blocks_[ind]);
+        double* rhop = points->point_value("RHO_A")->pointer();
+        double* taup = points->point_value("TAU_A")->pointer();
+
+        size_t offset = block_offsets_[ind];
         size_t npoints = blocks_[ind]->npoints();
         for (int P = 0; P < npoints; P++) {
             double tau_LSDA = C * pow(0.5 * rhop[P], 5.0 / 3.0);
@@ -555,27 +660,31 @@ void CubicScalarGrid::add_LOL(double* v, std::shared_ptr<Matrix> D) {
             double v2 = (std::fabs(tau_EX / tau_LSDA) < 1.0E-15 ? 1.0 : t / (1.0 + t));
             v[P + offset] += v2;
         }
-        offset += npoints;
     }
 
-    points_->set_ansatz(0);
+    for (int thread = 0; thread < nthreads_; thread++) points_[thread]->set_ansatz(0);
 }
 void CubicScalarGrid::add_ELF(double* v, std::shared_ptr<Matrix> D) {
-    points_->set_ansatz(2);
-    points_->set_pointers(D);
-
-    std::shared_ptr<Vector> rho = points_->point_value("RHO_A");
-    std::shared_ptr<Vector> gam = points_->point_value("GAMMA_AA");
-    std::shared_ptr<Vector> tau = points_->point_value("TAU_A");
-    double* rhop = rho->pointer();
-    double* gamp = gam->pointer();
-    double* taup = tau->pointer();
+    for (int thread = 0; thread < nthreads_; thread++) {
+        points_[thread]->set_ansatz(2);
+        points_[thread]->set_pointers(D);
+    }
 
     double C = 3.0 / 5.0 * pow(6.0 * M_PI * M_PI, 2.0 / 3.0);
 
-    size_t offset = 0L;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads_)
     for (int ind = 0; ind < blocks_.size(); ind++) {
-        points_->compute_points(blocks_[ind]);
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        std::shared_ptr<RKSFunctions> points = points_[thread];
+        points->compute_points(blocks_[ind]);
+        double* rhop = points->point_value("RHO_A")->pointer();
+        double* gamp = points->point_value("GAMMA_AA")->pointer();
+        double* taup = points->point_value("TAU_A")->pointer();
+
+        size_t offset = block_offsets_[ind];
         size_t npoints = blocks_[ind]->npoints();
         for (int P = 0; P < npoints; P++) {
             double tau_LSDA = C * pow(0.5 * rhop[P], 5.0 / 3.0);
@@ -586,10 +695,9 @@ void CubicScalarGrid::add_ELF(double* v, std::shared_ptr<Matrix> D) {
             double v2 = (std::fabs(D_LSDA / D_EX) < 1.0E-15 ? 0.0 : 1.0 / (1.0 + B * B));
             v[P + offset] += v2;
         }
-        offset += npoints;
     }
 
-    points_->set_ansatz(0);
+    for (int thread = 0; thread < nthreads_; thread++) points_[thread]->set_ansatz(0);
 }
 void CubicScalarGrid::compute_density(std::shared_ptr<Matrix> D, const std::string& name, const std::string& type) {
     double* v = new double[npoints_];
@@ -86,15 +86,21 @@ class CubicScalarGrid {
 
     /// Vector of blocks
     std::vector<std::shared_ptr<BlockOPoints> > blocks_;
+    /// Offset of the first point of each block in the fast ordering
+    std::vector<size_t> block_offsets_;
     /// Points to basis extents, built internally
     std::shared_ptr<BasisExtents> extents_;
-    /// RKS points object
-    std::shared_ptr<RKSFunctions> points_;
+    /// Number of threads the blocks are distributed over
+    int nthreads_;
+    /// RKS points objects, one per thread
+    std::vector<std::shared_ptr<RKSFunctions> > points_;
 
     // => Helper Routines <= //
 
     /// Setup grid from info in N_, D_, O_
     void populate_grid();
+    /// Index in the fast ordering of grid point (i, j, k)
+    size_t fast_index(int i, int j, int k) const;
 
    public:
     // => Constructors <= //
@@ -151,9 +157,13 @@ class CubicScalarGrid {
     // => Low-Level Write Routines (Use only if you know what you are doing) <= //
 
     /// Write a general file of the scalar field v (in fast ordering) to filepath/name.ext
+    /// (type CUBE, BINARY or BINARY_GZ)
     void write_gen_file(double* v, const std::string& name, const std::string& type, const std::string& comment = "");
     /// Write a Gaussian cube file of the scalar field v (in fast ordering) to filepath/name.cube
     void write_cube_file(double* v, const std::string& name, const std::string& comment = "");
+    /// Write a binary cube file of the scalar field v (in fast ordering) to filepath/name.cube.bin,
+    /// or gzip-compressed to filepath/name.cube.bin.gz
+    void write_binary_file(double* v, const std::string& name, const std::string& comment = "", bool compress = false);
 
     // => Low-Level Scalar Field Computation (Use only if you know what you are doing) <= //
 
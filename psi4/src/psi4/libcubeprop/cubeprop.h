@@ -72,6 +72,8 @@ class PSI_API CubeProperties {
 
     /// Grid-based property computer
     std::shared_ptr<CubicScalarGrid> grid_;
+    /// Output file type (CUBE, BINARY or BINARY_GZ)
+    std::string file_type_;
 
     // => Helper Functions <= //
 
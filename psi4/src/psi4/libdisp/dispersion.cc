@@ -43,6 +43,8 @@
 #include "psi4/liboptions/liboptions.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsi4util/libpsi4util.h"
+#include "psi4/libpsi4util/process.h"
+#include "psi4/libqt/qt.h"
 
 #include <iostream>
 #include <iomanip>
@@ -51,10 +53,17 @@
 #include <sstream>
 #include <vector>
 #include <memory>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace psi {
 
-Dispersion::Dispersion() {}
+Dispersion::Dispersion() : s6_(0.0), d_(0.0), sr6_(0.0), s8_(0.0), a1_(0.0), a2_(0.0), cutoff_(0.0) {}
 
 Dispersion::~Dispersion() {}
 
@@ -79,6 +88,7 @@ std::shared_ptr<Dispersion> Dispersion::build(const std::string &name, double s6
         disp->bibtex_ = "Grimme:2004:1463";
         disp->s6_ = s6;
         disp->d_ = 23.0;
+        disp->sr6_ = 1.1;  // damping radius is the plain sum of the -D1 van der Waals radii
         disp->C6_ = C6_D1_;
         disp->RvdW_ = RvdW_D1_;
         disp->C6_type_ = C6_arit;
@@ -237,20 +247,11 @@ std::string Dispersion::print_hessian(std::shared_ptr<Molecule> m) {
     return s.str();
 }
 
-double Dispersion::compute_energy(std::shared_ptr<Molecule> m) {
-    double E = 0.0;
+void Dispersion::build_pairs(std::shared_ptr<Molecule> m, PairList &pairs) {
+    pairs = PairList();
 
     if (Damping_type_ == Damping_TT) {
         // -DAS dispersion only involves inter-fragment terms
-        if (m->nactive_fragments() == 1) {
-            // Just in case, since auto fragment is not called
-            outfile->Printf("\n    Only one fragment provided, no empirical dispersion will be added.\n\n");
-            return 0.0;
-        }
-
-        // need a check if there is only one active fragment ...
-
-        // list of atoms in monomer A
         std::vector<int> realsA;
         realsA.push_back(0);
         std::vector<int> ghostsA;
@@ -259,7 +260,6 @@ double Dispersion::compute_energy(std::shared_ptr<Molecule> m) {
         std::shared_ptr<Vector> alist = set_atom_list(monoA);
         double *alist_p = alist->pointer();
 
-        // list of atoms in monomer B
         std::vector<int> realsB;
         realsB.push_back(1);
         std::vector<int> ghostsB;
@@ -268,177 +268,369 @@ double Dispersion::compute_energy(std::shared_ptr<Molecule> m) {
         std::shared_ptr<Vector> blist = set_atom_list(monoB);
         double *blist_p = blist->pointer();
 
+        // Fragments 0 and 1 lead the atom list of m, so the monomer atom indices are those of m;
+        // any further fragments are left out, as -DAS only couples the first two
+
         for (int i = 0; i < monoA->natom(); i++) {
             if ((int)monoA->Z(i) == 0) continue;
             for (int j = 0; j < monoB->natom(); j++) {
                 if ((int)monoB->Z(j) == 0) continue;
+                add_pair(m, i, j, (int)alist_p[i], (int)blist_p[j], pairs);
+            }
+        }
+        return;
+    }
 
-                double C6, C8, Rm6, Rm8, f_6, f_8, g, beta;
+    std::shared_ptr<Vector> atom_list = set_atom_list(m);
+    double *atom_list_p = atom_list->pointer();
+    const int natom = m->natom();
 
-                double dx = monoB->x(j) - monoA->x(i);
-                double dy = monoB->y(j) - monoA->y(i);
-                double dz = monoB->z(j) - monoA->z(i);
+    if (cutoff_ <= 0.0) {
+        for (int i = 0; i < natom; i++) {
+            for (int j = 0; j < i; j++) add_pair(m, i, j, (int)atom_list_p[i], (int)atom_list_p[j], pairs);
+        }
+        return;
+    }
 
-                double R2 = dx * dx + dy * dy + dz * dz;
+    // Cell list: bin the atoms into cells with edges of at least cutoff_, so the partners of
+    // an atom within the cutoff all lie in its own or one of the 26 neighboring cells.  The
+    // edges grow for sparse geometries so that there are never many more cells than atoms.
+    double lo[3], hi[3];
+    for (int k = 0; k < 3; k++) {
+        lo[k] = std::numeric_limits<double>::max();
+        hi[k] = std::numeric_limits<double>::lowest();
+    }
+    for (int i = 0; i < natom; i++) {
+        Vector3 r = m->xyz(i);
+        for (int k = 0; k < 3; k++) {
+            lo[k] = std::min(lo[k], r[k]);
+            hi[k] = std::max(hi[k], r[k]);
+        }
+    }
+    long int ncell[3];
+    double edge[3];
+    const long int max_cell = std::max(1L, (long int)std::ceil(2.0 * std::cbrt((double)natom)));
+    for (int k = 0; k < 3; k++) {
+        edge[k] = std::max(cutoff_, (hi[k] - lo[k]) / max_cell);
+        ncell[k] = std::min(max_cell, (long int)std::floor((hi[k] - lo[k]) / edge[k]) + 1L);
+    }
 
-                double R = sqrt(R2);
-                double R6 = R2 * R2 * R2;
-                double R8 = R2 * R2 * R2 * R2;
-                Rm6 = 1.0 / R6;
-                Rm8 = 1.0 / R8;
+    std::vector<long int> cell_of(natom);
+    std::vector<long int> cell_start(ncell[0] * ncell[1] * ncell[2] + 1, 0);
+    std::vector<int> cell_atoms(natom);
+    std::vector<long int> cidx(3 * natom);
+    for (int i = 0; i < natom; i++) {
+        Vector3 r = m->xyz(i);
+        for (int k = 0; k < 3; k++)
+            cidx[3 * i + k] = std::min(ncell[k] - 1, (long int)std::floor((r[k] - lo[k]) / edge[k]));
+        cell_of[i] = (cidx[3 * i] * ncell[1] + cidx[3 * i + 1]) * ncell[2] + cidx[3 * i + 2];
+        cell_start[cell_of[i] + 1]++;
+    }
+    for (size_t c = 1; c < cell_start.size(); c++) cell_start[c] += cell_start[c - 1];
+    std::vector<long int> fill(cell_start.begin(), cell_start.end() - 1);
+    for (int i = 0; i < natom; i++) cell_atoms[fill[cell_of[i]]++] = i;
+
+    // Partners j < i are sorted so that the list keeps the order of the full double loop
+    const double cutoff2 = cutoff_ * cutoff_;
+    std::vector<int> partners;
+    for (int i = 0; i < natom; i++) {
+        partners.clear();
+        for (long int cx = std::max(0L, cidx[3 * i] - 1); cx <= std::min(ncell[0] - 1, cidx[3 * i] + 1); cx++) {
+            for (long int cy = std::max(0L, cidx[3 * i + 1] - 1); cy <= std::min(ncell[1] - 1, cidx[3 * i + 1] + 1);
+                 cy++) {
+                for (long int cz = std::max(0L, cidx[3 * i + 2] - 1);
+                     cz <= std::min(ncell[2] - 1, cidx[3 * i + 2] + 1); cz++) {
+                    long int c = (cx * ncell[1] + cy) * ncell[2] + cz;
+                    for (long int q = cell_start[c]; q < cell_start[c + 1]; q++) {
+                        int j = cell_atoms[q];
+                        if (j >= i) continue;
+                        double dx = m->x(j) - m->x(i);
+                        double dy = m->y(j) - m->y(i);
+                        double dz = m->z(j) - m->z(i);
+                        if (dx * dx + dy * dy + dz * dz <= cutoff2) partners.push_back(j);
+                    }
+                }
+            }
+        }
+        std::sort(partners.begin(), partners.end());
+        for (int j : partners) add_pair(m, i, j, (int)atom_list_p[i], (int)atom_list_p[j], pairs);
+    }
+}
 
-                // Compute geometric mean of atomic C6 coefficients
-                C6 = sqrt(C6_[(int)alist_p[i]] * C6_[(int)blist_p[j]]);
+void Dispersion::add_pair(std::shared_ptr<Molecule> m, int i, int j, int a, int b, PairList &pairs) const {
+    double dx = m->x(j) - m->x(i);
+    double dy = m->y(j) - m->y(i);
+    double dz = m->z(j) - m->z(i);
+    double R2 = dx * dx + dy * dy + dz * dz;
+    if (cutoff_ > 0.0 && R2 > cutoff_ * cutoff_) return;
+    double R = std::sqrt(R2);
+
+    pairs.i.push_back(i);
+    pairs.j.push_back(j);
+    pairs.R.push_back(R);
+    pairs.ux.push_back(dx / R);
+    pairs.uy.push_back(dy / R);
+    pairs.uz.push_back(dz / R);
+
+    double C6;
+    if (C6_type_ == C6_arit) {
+        C6 = 2.0 * C6_[a] * C6_[b] / (C6_[a] + C6_[b]);
+    } else if (C6_type_ == C6_geom) {
+        C6 = std::sqrt(C6_[a] * C6_[b]);
+    } else {
+        throw PSIEXCEPTION("Unrecognized C6 Type");
+    }
+    pairs.C6.push_back(C6);
 
-                // Compute geometric mean of atomic C8 coefficients
-                C8 = sqrt(C8_[(int)alist_p[i]] * C8_[(int)blist_p[j]]);
+    if (Damping_type_ == Damping_TT) {
+        pairs.C8.push_back(std::sqrt(C8_[a] * C8_[b]));
+        pairs.beta.push_back(std::sqrt(Beta_[a] * Beta_[b]));
+        if (Spherical_type_ == Spherical_Das) {
+            pairs.A.push_back(std::sqrt(A_[a] * A_[b]));
+        } else if (Spherical_type_ == Spherical_zero) {
+            pairs.A.push_back(0.0);
+        } else {
+            throw PSIEXCEPTION("Unrecognized Spherical Type");
+        }
+    } else if (Damping_type_ == Damping_D1) {
+        pairs.R0.push_back(sr6_ * (RvdW_[a] + RvdW_[b]) / 1.1);
+    } else if (Damping_type_ == Damping_CHG) {
+        pairs.R0.push_back(RvdW_[a] + RvdW_[b]);
+    } else {
+        throw PSIEXCEPTION("Unrecognized Damping Function");
+    }
+}
 
-                // Tang-Toennies Damping function
-                double f_6_sum = 1.0;
-                double f_8_sum = 1.0;
-                beta = sqrt(Beta_[(int)alist_p[i]] * Beta_[(int)blist_p[j]]);
-                for (int n = 1; n <= 6; n++) {
-                    f_6_sum += pow(R * beta, n) / fac[n];
-                }
-                for (int n = 1; n <= 8; n++) {
-                    f_8_sum += pow(R * beta, n) / fac[n];
+void Dispersion::compute_pair_terms(const PairList &pairs, int deriv, std::vector<double> &E, std::vector<double> &E_R,
+                                    std::vector<double> &E_RR) const {
+    const long int npair = pairs.size();
+    E.assign(npair, 0.0);
+    E_R.assign(deriv > 0 ? npair : 0, 0.0);
+    E_RR.assign(deriv > 1 ? npair : 0, 0.0);
+
+    const double *Rp = pairs.R.data();
+    const double *C6p = pairs.C6.data();
+    double *Ep = E.data();
+    double *E_Rp = E_R.data();
+    double *E_RRp = E_RR.data();
+    const double scale = -s6_;
+    const double d = d_;
+
+    // The damping type is fixed for the whole list, so each branch is a straight pair loop
+    if (Damping_type_ == Damping_D1) {
+        const double *R0p = pairs.R0.data();
+#pragma omp parallel for simd schedule(static) num_threads(Process::environment.get_n_threads())
+        for (long int p = 0; p < npair; p++) {
+            double R = Rp[p];
+            double h = scale * C6p[p] / (R * R * R * R * R * R);
+            double k = d / R0p[p];
+            double u = std::exp(-d * (R / R0p[p] - 1.0));
+            double f = 1.0 / (1.0 + u);
+            Ep[p] = h * f;
+            if (deriv > 0) {
+                double h_R = -6.0 * h / R;
+                double f_R = k * u * f * f;
+                E_Rp[p] = h_R * f + h * f_R;
+                if (deriv > 1) {
+                    double h_RR = 42.0 * h / (R * R);
+                    double f_RR = k * k * u * f * f * (2.0 * u * f - 1.0);
+                    E_RRp[p] = h_RR * f + 2.0 * h_R * f_R + h * f_RR;
                 }
-
-                f_6 = 1.0 - exp(-R * beta) * f_6_sum;
-                f_8 = 1.0 - exp(-R * beta) * f_8_sum;
-
-                if (Spherical_type_ == Spherical_Das) {
-                    g = sqrt(A_[(int)alist_p[i]] * A_[(int)blist_p[j]]) * exp(-R * beta);
-                } else if (Spherical_type_ == Spherical_zero) {
-                    g = 0.0;
-                } else {
-                    throw PSIEXCEPTION("Unrecognized Spherical Type");
+            }
+        }
+    } else if (Damping_type_ == Damping_CHG) {
+        const double *R0p = pairs.R0.data();
+#pragma omp parallel for simd schedule(static) num_threads(Process::environment.get_n_threads())
+        for (long int p = 0; p < npair; p++) {
+            double R = Rp[p];
+            double h = scale * C6p[p] / (R * R * R * R * R * R);
+            double x = R0p[p] / R;
+            double x2 = x * x;
+            double x6 = x2 * x2 * x2;
+            double v = d * x6 * x6;
+            double f = 1.0 / (1.0 + v);
+            Ep[p] = h * f;
+            if (deriv > 0) {
+                double h_R = -6.0 * h / R;
+                double v_R = -12.0 * v / R;
+                double f_R = -f * f * v_R;
+                E_Rp[p] = h_R * f + h * f_R;
+                if (deriv > 1) {
+                    double h_RR = 42.0 * h / (R * R);
+                    double v_RR = 156.0 * v / (R * R);
+                    double f_RR = 2.0 * f * f * f * v_R * v_R - f * f * v_RR;
+                    E_RRp[p] = h_RR * f + 2.0 * h_R * f_R + h * f_RR;
                 }
-
-                E += C6 * Rm6 * f_6;
-                E += C8 * Rm8 * f_8;
-                E += g;
             }
         }
-    } else {
-        std::shared_ptr<Vector> atom_list = set_atom_list(m);
-        double *atom_list_p = atom_list->pointer();
-        for (int i = 0; i < m->natom(); i++) {
-            for (int j = 0; j < i; j++) {
-                double C6, Rm6, f;
-
-                double dx = m->x(j) - m->x(i);
-                double dy = m->y(j) - m->y(i);
-                double dz = m->z(j) - m->z(i);
-
-                double R2 = dx * dx + dy * dy + dz * dz;
-                double R = sqrt(R2);
-                double R6 = R2 * R2 * R2;
-                Rm6 = 1.0 / R6;
-
-                if (C6_type_ == C6_arit) {
-                    C6 = 2.0 * C6_[(int)atom_list_p[i]] * C6_[(int)atom_list_p[j]] /
-                         (C6_[(int)atom_list_p[i]] + C6_[(int)atom_list_p[j]]);
-                } else if (C6_type_ == C6_geom) {
-                    C6 = sqrt(C6_[(int)atom_list_p[i]] * C6_[(int)atom_list_p[j]]);
-                } else {
-                    throw PSIEXCEPTION("Unrecognized C6 Type");
+    } else if (Damping_type_ == Damping_TT) {
+        const double *C8p = pairs.C8.data();
+        const double *betap = pairs.beta.data();
+        const double *Ap = pairs.A.data();
+#pragma omp parallel for simd schedule(static) num_threads(Process::environment.get_n_threads())
+        for (long int p = 0; p < npair; p++) {
+            double R = Rp[p];
+            double beta = betap[p];
+            double x = beta * R;
+            double e = std::exp(-x);
+
+            // Tang-Toennies damping: partial sums of the exponential series up to order 6 and 8
+            double term = 1.0;
+            double sum = 1.0;
+            double term6 = 0.0;
+            double sum6 = 0.0;
+            for (int n = 1; n <= 8; n++) {
+                term *= x / n;
+                sum += term;
+                if (n == 6) {
+                    term6 = term;
+                    sum6 = sum;
                 }
-
-                if (Damping_type_ == Damping_D1) {
-                    double RvdW = (RvdW_[(int) atom_list_p[i]] + RvdW_[(int) atom_list_p[j]]) / 1.1;
-                    f = 1.0 / (1.0 + exp(-d_ * (R / (sr6_ * RvdW) - 1)));
-                } else if (Damping_type_ == Damping_CHG) {
-                    double RvdW = RvdW_[(int)atom_list_p[i]] + RvdW_[(int)atom_list_p[j]];
-                    f = 1.0 / (1.0 + d_ * pow((R / RvdW), -12.0));
-                } else {
-                    throw PSIEXCEPTION("Unrecognized Damping Function");
+            }
+            double term8 = term;
+            double sum8 = sum;
+
+            double R2 = R * R;
+            double h6 = scale * C6p[p] / (R2 * R2 * R2);
+            double h8 = scale * C8p[p] / (R2 * R2 * R2 * R2);
+            double g = scale * Ap[p] * e;
+            double f6 = 1.0 - e * sum6;
+            double f8 = 1.0 - e * sum8;
+            Ep[p] = h6 * f6 + h8 * f8 + g;
+            if (deriv > 0) {
+                double h6_R = -6.0 * h6 / R;
+                double h8_R = -8.0 * h8 / R;
+                double f6_R = beta * e * term6;
+                double f8_R = beta * e * term8;
+                E_Rp[p] = h6_R * f6 + h6 * f6_R + h8_R * f8 + h8 * f8_R - beta * g;
+                if (deriv > 1) {
+                    double h6_RR = 42.0 * h6 / R2;
+                    double h8_RR = 72.0 * h8 / R2;
+                    double f6_RR = f6_R * (6.0 - x) / R;
+                    double f8_RR = f8_R * (8.0 - x) / R;
+                    E_RRp[p] = h6_RR * f6 + 2.0 * h6_R * f6_R + h6 * f6_RR + h8_RR * f8 + 2.0 * h8_R * f8_R +
+                               h8 * f8_RR + beta * beta * g;
                 }
-
-                E += C6 * Rm6 * f;
             }
         }
+    } else {
+        throw PSIEXCEPTION("Unrecognized Damping Function");
+    }
+}
+
+double Dispersion::compute_energy(std::shared_ptr<Molecule> m) {
+    if (Damping_type_ == Damping_TT && m->nactive_fragments() == 1) {
+        // Just in case, since auto fragment is not called
+        outfile->Printf("\n    Only one fragment provided, no empirical dispersion will be added.\n\n");
+        return 0.0;
+    }
+
+    PairList pairs;
+    build_pairs(m, pairs);
+    std::vector<double> E_p, E_R, E_RR;
+    compute_pair_terms(pairs, 0, E_p, E_R, E_RR);
+
+    const long int npair = pairs.size();
+    const double *E_pp = E_p.data();
+    double E = 0.0;
+#pragma omp parallel for simd schedule(static) reduction(+ : E) num_threads(Process::environment.get_n_threads())
+    for (long int p = 0; p < npair; p++) {
+        E += E_pp[p];
     }
-    E *= -s6_;
 
     return E;
 }
 
 SharedMatrix Dispersion::compute_gradient(std::shared_ptr<Molecule> m) {
     auto G = std::make_shared<Matrix>("Dispersion Gradient", m->natom(), 3);
-    double **Gp = G->pointer();
-
-    if (Damping_type_ == Damping_TT) {
-        throw PSIEXCEPTION("+Das Gradients not yet implemented");
+    if (Damping_type_ == Damping_TT && m->nactive_fragments() == 1) return G;
+
+    PairList pairs;
+    build_pairs(m, pairs);
+    std::vector<double> E_p, E_R, E_RR;
+    compute_pair_terms(pairs, 1, E_p, E_R, E_RR);
+
+    // dE/dr_j = E_R u and dE/dr_i = -E_R u, accumulated in per-thread buffers
+    const int natom = m->natom();
+    const long int npair = pairs.size();
+    int nthread = Process::environment.get_n_threads();
+    std::vector<std::vector<double>> Gt(nthread, std::vector<double>(3L * natom, 0.0));
+
+#pragma omp parallel for schedule(static) num_threads(nthread)
+    for (long int p = 0; p < npair; p++) {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        double *Gp = Gt[thread].data();
+        double gx = E_R[p] * pairs.ux[p];
+        double gy = E_R[p] * pairs.uy[p];
+        double gz = E_R[p] * pairs.uz[p];
+        int i = pairs.i[p];
+        int j = pairs.j[p];
+        Gp[3 * i + 0] -= gx;
+        Gp[3 * i + 1] -= gy;
+        Gp[3 * i + 2] -= gz;
+        Gp[3 * j + 0] += gx;
+        Gp[3 * j + 1] += gy;
+        Gp[3 * j + 2] += gz;
     }
 
-    for (int i = 0; i < m->natom(); i++) {
-        for (int j = 0; j < i; j++) {
-            double C6, Rm6, f;
-            double C6_R, Rm6_R, f_R;
-
-            double R;
-            double R_xi, R_yi, R_zi;
-            double R_xj, R_yj, R_zj;
-
-            double dx = m->x(j) - m->x(i);
-            double dy = m->y(j) - m->y(i);
-            double dz = m->z(j) - m->z(i);
-
-            double R2 = dx * dx + dy * dy + dz * dz;
-            R = sqrt(R2);
-
-            R_xi = -dx / R;
-            R_xj = dx / R;
-            R_yi = -dy / R;
-            R_yj = dy / R;
-            R_zi = -dz / R;
-            R_zj = dz / R;
-
-            double R6 = R2 * R2 * R2;
-            Rm6 = 1.0 / R6;
-            Rm6_R = -6.0 * Rm6 / R;
-
-            double RvdW = RvdW_[(int)m->Z(i)] + RvdW_[(int)m->Z(j)];
-
-            if (C6_type_ == C6_arit) {
-                C6 = 2.0 * C6_[(int)m->Z(i)] * C6_[(int)m->Z(j)] / (C6_[(int)m->Z(i)] + C6_[(int)m->Z(j)]);
-                C6_R = 0.0;
-            } else if (C6_type_ == C6_geom) {
-                C6 = sqrt(C6_[(int)m->Z(i)] * C6_[(int)m->Z(j)]);
-                C6_R = 0.0;
-            } else {
-                throw PSIEXCEPTION("Unrecognized C6 Type");
-            }
-            if (Damping_type_ == Damping_D1) {
-                f = 1.0 / (1.0 + exp(-d_ * (R / RvdW - 1.0)));
-                f_R = -f * f * exp(-d_ * (R / RvdW - 1.0)) * (-d_ / RvdW);
-            } else if (Damping_type_ == Damping_CHG) {
-                f = 1.0 / (1.0 + d_ * pow((R / RvdW), -12.0));
-                f_R = -f * f * d_ * (-12.0) * pow((R / RvdW), -13.0) * (1.0 / RvdW);
-            } else if (Damping_type_ == Damping_TT) {
-                throw PSIEXCEPTION("+Das Gradients not yet implemented");
-            } else {
-                throw PSIEXCEPTION("Unrecognized Damping Function");
-            }
-
-            double E_R = C6_R * Rm6 * f + C6 * Rm6_R * f + C6 * Rm6 * f_R;
-
-            Gp[i][0] += E_R * R_xi;
-            Gp[i][1] += E_R * R_yi;
-            Gp[i][2] += E_R * R_zi;
-            Gp[j][0] += E_R * R_xj;
-            Gp[j][1] += E_R * R_yj;
-            Gp[j][2] += E_R * R_zj;
-        }
+    double *Gp = G->pointer()[0];
+    for (int t = 0; t < nthread; t++) {
+        C_DAXPY(3 * natom, 1.0, Gt[t].data(), 1, Gp, 1);
     }
 
-    G->scale(-s6_);
     return G;
 }
 
 SharedMatrix Dispersion::compute_hessian(std::shared_ptr<Molecule> m) {
-    throw PSIEXCEPTION("Dispersion: Hessians not implemented");
+    const int natom = m->natom();
+    auto H = std::make_shared<Matrix>("Dispersion Hessian", 3 * natom, 3 * natom);
+    if (Damping_type_ == Damping_TT && m->nactive_fragments() == 1) return H;
+
+    PairList pairs;
+    build_pairs(m, pairs);
+    std::vector<double> E_p, E_R, E_RR;
+    compute_pair_terms(pairs, 2, E_p, E_R, E_RR);
+
+    double **Hp = H->pointer();
+    const long int npair = pairs.size();
+
+    // Each pair contributes H_p = E_RR u u^T + (E_R / R) (I - u u^T) to the ii and jj blocks and -H_p to the
+    // ij and ji blocks. Every pair owns its off-diagonal blocks, so those are written without conflicts.
+#pragma omp parallel for schedule(static) num_threads(Process::environment.get_n_threads())
+    for (long int p = 0; p < npair; p++) {
+        double u[3] = {pairs.ux[p], pairs.uy[p], pairs.uz[p]};
+        double a = E_RR[p];
+        double b = E_R[p] / pairs.R[p];
+        int i = pairs.i[p];
+        int j = pairs.j[p];
+        for (int x = 0; x < 3; x++) {
+            for (int y = 0; y < 3; y++) {
+                double Hxy = (a - b) * u[x] * u[y] + (x == y ? b : 0.0);
+                Hp[3 * i + x][3 * j + y] = -Hxy;
+                Hp[3 * j + x][3 * i + y] = -Hxy;
+            }
+        }
+    }
+
+    // Translational invariance fixes the diagonal blocks as minus the sum of the off-diagonal blocks in each row
+#pragma omp parallel for schedule(static) num_threads(Process::environment.get_n_threads())
+    for (int i = 0; i < natom; i++) {
+        for (int x = 0; x < 3; x++) {
+            for (int y = 0; y < 3; y++) {
+                double sum = 0.0;
+                for (int j = 0; j < natom; j++) {
+                    if (j == i) continue;
+                    sum += Hp[3 * i + x][3 * j + y];
+                }
+                Hp[3 * i + x][3 * i + y] = -sum;
+            }
+        }
+    }
+
+    return H;
 }
 
 std::shared_ptr<Vector> Dispersion::set_atom_list(std::shared_ptr<Molecule> mol) {
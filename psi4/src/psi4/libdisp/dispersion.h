@@ -37,6 +37,7 @@
 ***********************************************************/
 #include "psi4/psi4-dec.h"
 #include <string>
+#include <vector>
 
 namespace psi {
 
@@ -72,6 +73,35 @@ class Dispersion {
     const double *A_;
     const double *Beta_;
 
+    /// Neighbor cutoff [bohr] for the pair list, zero to keep all pairs
+    double cutoff_;
+
+    /// Interacting atom pairs, stored as flat arrays so the pair kernels vectorize
+    struct PairList {
+        std::vector<int> i;
+        std::vector<int> j;
+        /// Distance and unit vector from atom i to atom j
+        std::vector<double> R;
+        std::vector<double> ux;
+        std::vector<double> uy;
+        std::vector<double> uz;
+        /// Combined pair parameters (R0 is the damping radius, A and beta the TT parameters)
+        std::vector<double> C6;
+        std::vector<double> C8;
+        std::vector<double> R0;
+        std::vector<double> beta;
+        std::vector<double> A;
+        size_t size() const { return R.size(); }
+    };
+
+    /// Builds the list of interacting pairs of m that lie within the cutoff
+    void build_pairs(std::shared_ptr<Molecule> m, PairList &pairs);
+    /// Appends pair (i, j) of atom types a and b to pairs if it lies within the cutoff
+    void add_pair(std::shared_ptr<Molecule> m, int i, int j, int a, int b, PairList &pairs) const;
+    /// Computes the pair energies and, up to deriv, their first and second radial derivatives
+    void compute_pair_terms(const PairList &pairs, int deriv, std::vector<double> &E, std::vector<double> &E_R,
+                            std::vector<double> &E_RR) const;
+
    public:
     Dispersion();
     virtual ~Dispersion();
@@ -104,6 +134,10 @@ class Dispersion {
     void set_a1(double a1) { a1_ = a1; }
     void set_a2(double a2) { a2_ = a2; }
 
+    /// Neighbor cutoff [bohr]; atom pairs further apart are skipped (zero disables the cutoff)
+    double cutoff() const { return cutoff_; }
+    void set_cutoff(double cutoff) { cutoff_ = cutoff; }
+
     std::string print_energy(std::shared_ptr<Molecule> m);
     std::string print_gradient(std::shared_ptr<Molecule> m);
     std::string print_hessian(std::shared_ptr<Molecule> m);
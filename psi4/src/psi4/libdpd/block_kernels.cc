@@ -0,0 +1,87 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+/*! \file
+    \ingroup DPD
+    \brief Threaded elementwise kernels on contiguous DPD blocks
+*/
+
+/*
+** The buf4 and file2 linear algebra (axpy, scm, dot, dirprd, axpbycz)
+** works on whole irrep blocks or row buckets of them, which DPD always
+** allocates as one contiguous array. These kernels sweep such an array
+** with OpenMP threads over static row ranges, leaving the inner loops
+** simple enough for the compiler to vectorize. Arrays shorter than
+** DPD_OMP_MIN_LENGTH are done on the calling thread, where the cost of
+** waking the thread team would dominate.
+*/
+
+#include "dpd.h"
+
+namespace psi {
+
+#define DPD_OMP_MIN_LENGTH 32768
+
+/* Y <-- alpha X + Y */
+void DPD::block_axpy(size_t length, double alpha, const double *X, double *Y) {
+#pragma omp parallel for simd schedule(static) if (length > DPD_OMP_MIN_LENGTH)
+    for (size_t i = 0; i < length; i++) Y[i] += alpha * X[i];
+}
+
+/* X <-- alpha X */
+void DPD::block_scal(size_t length, double alpha, double *X) {
+    if (alpha == 0.0) {
+#pragma omp parallel for simd schedule(static) if (length > DPD_OMP_MIN_LENGTH)
+        for (size_t i = 0; i < length; i++) X[i] = 0.0;
+    } else {
+#pragma omp parallel for simd schedule(static) if (length > DPD_OMP_MIN_LENGTH)
+        for (size_t i = 0; i < length; i++) X[i] *= alpha;
+    }
+}
+
+/* Returns X . Y */
+double DPD::block_dot(size_t length, const double *X, const double *Y) {
+    double dot = 0.0;
+#pragma omp parallel for simd schedule(static) reduction(+ : dot) if (length > DPD_OMP_MIN_LENGTH)
+    for (size_t i = 0; i < length; i++) dot += X[i] * Y[i];
+    return dot;
+}
+
+/* Y <-- X * Y, elementwise */
+void DPD::block_dirprd(size_t length, const double *X, double *Y) {
+#pragma omp parallel for simd schedule(static) if (length > DPD_OMP_MIN_LENGTH)
+    for (size_t i = 0; i < length; i++) Y[i] *= X[i];
+}
+
+/* Z <-- a X + b Y + c Z */
+void DPD::block_axpbycz(size_t length, double a, const double *X, double b, const double *Y, double c, double *Z) {
+#pragma omp parallel for simd schedule(static) if (length > DPD_OMP_MIN_LENGTH)
+    for (size_t i = 0; i < length; i++) Z[i] = a * X[i] + b * Y[i] + c * Z[i];
+}
+
+}  // namespace psi
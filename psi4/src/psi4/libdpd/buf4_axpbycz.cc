@@ -31,7 +31,9 @@
     \brief Enter brief description of file here
 */
 #include <cstdio>
+#include <cmath>
 #include "psi4/libqt/qt.h"
+#include "psi4/libpsio/psio.h"
 #include "dpd.h"
 
 namespace psi {
@@ -44,14 +46,84 @@ namespace psi {
 **   dpdbuf4 *FileB: A pointer to the rightmost summand dpdbuf4.
 **   dpdbuf4 *FileC: A pointer to the target dpdbuf4.
 **   double a, b, c, scalar prefactors
+**
+** The three buffers are swept together in a single pass over each irrep
+** block, streamed in row buckets when a block does not fit into core. A
+** target that is not on disk yet is treated as zero.
 */
 
 int DPD::buf4_axpbycz(dpdbuf4 *FileA, dpdbuf4 *FileB, dpdbuf4 *FileC, double a, double b, double c) {
-    buf4_scm(FileC, c);
+    int h, n, nirreps, my_irrep, incore, nbuckets, new_buf4;
+    long int memoryd, rows_per_bucket, rows_left, coltot, length;
+
+    nirreps = FileA->params->nirreps;
+    my_irrep = FileA->file.my_irrep;
+
+    new_buf4 = (psio_tocscan(FileC->file.filenum, FileC->file.label) == nullptr);
+
+    for (h = 0; h < nirreps; h++) {
+        coltot = FileA->params->coltot[h ^ my_irrep];
+
+        incore = 1;
+        if (FileA->params->rowtot[h] && coltot) {
+            /* NB: we need at least one row of A, B, and C */
+            memoryd = dpd_memfree();
+            rows_per_bucket = memoryd / (3 * coltot);
+
+            if (rows_per_bucket > FileA->params->rowtot[h]) rows_per_bucket = FileA->params->rowtot[h];
+
+            if (!rows_per_bucket) dpd_error("buf4_axpbycz: Not enough memory for one row!", "outfile");
+
+            nbuckets = (int)ceil((double)FileA->params->rowtot[h] / (double)rows_per_bucket);
+
+            rows_left = FileA->params->rowtot[h] % rows_per_bucket;
+
+            if (nbuckets > 1) incore = 0;
+        }
+
+        if (incore) {
+            buf4_mat_irrep_init(FileA, h);
+            buf4_mat_irrep_init(FileB, h);
+            buf4_mat_irrep_init(FileC, h);
+            buf4_mat_irrep_rd(FileA, h);
+            buf4_mat_irrep_rd(FileB, h);
+            if (!new_buf4) buf4_mat_irrep_rd(FileC, h);
+
+            length = ((long)FileA->params->rowtot[h]) * coltot;
+            if (length)
+                block_axpbycz(length, a, FileA->matrix[h][0], b, FileB->matrix[h][0], c, FileC->matrix[h][0]);
+
+            buf4_mat_irrep_wrt(FileC, h);
+            buf4_mat_irrep_close(FileA, h);
+            buf4_mat_irrep_close(FileB, h);
+            buf4_mat_irrep_close(FileC, h);
+        } else {
+            buf4_mat_irrep_init_block(FileA, h, rows_per_bucket);
+            buf4_mat_irrep_init_block(FileB, h, rows_per_bucket);
+            buf4_mat_irrep_init_block(FileC, h, rows_per_bucket);
+
+            for (n = 0; n < nbuckets; n++) {
+                long int nrows = (rows_left && n == nbuckets - 1) ? rows_left : rows_per_bucket;
+                length = nrows * coltot;
+
+                buf4_mat_irrep_rd_block(FileA, h, n * rows_per_bucket, nrows);
+                buf4_mat_irrep_rd_block(FileB, h, n * rows_per_bucket, nrows);
+                if (!new_buf4)
+                    buf4_mat_irrep_rd_block(FileC, h, n * rows_per_bucket, nrows);
+                else
+                    block_scal(length, 0.0, FileC->matrix[h][0]);
+
+                block_axpbycz(length, a, FileA->matrix[h][0], b, FileB->matrix[h][0], c, FileC->matrix[h][0]);
+
+                buf4_mat_irrep_wrt_block(FileC, h, n * rows_per_bucket, nrows);
+            }
 
-    buf4_axpy(FileB, FileC, b);
+            buf4_mat_irrep_close_block(FileA, h, rows_per_bucket);
+            buf4_mat_irrep_close_block(FileB, h, rows_per_bucket);
+            buf4_mat_irrep_close_block(FileC, h, rows_per_bucket);
+        }
+    }
 
-    buf4_axpy(FileA, FileC, a);
     return 0;
 }
 
@@ -101,7 +101,7 @@ int DPD::buf4_axpy(dpdbuf4 *BufX, dpdbuf4 *BufY, double alpha) {
             if (length) {
                 X = &(BufX->matrix[h][0][0]);
                 Y = &(BufY->matrix[h][0][0]);
-                C_DAXPY(length, alpha, X, 1, Y, 1);
+                block_axpy(length, alpha, X, Y);
             }
 
             buf4_mat_irrep_wrt(BufY, h);
@@ -120,7 +120,7 @@ int DPD::buf4_axpy(dpdbuf4 *BufX, dpdbuf4 *BufY, double alpha) {
                 buf4_mat_irrep_rd_block(BufX, h, n * rows_per_bucket, rows_per_bucket);
                 buf4_mat_irrep_rd_block(BufY, h, n * rows_per_bucket, rows_per_bucket);
 
-                C_DAXPY(length, alpha, X, 1, Y, 1);
+                block_axpy(length, alpha, X, Y);
 
                 buf4_mat_irrep_wrt_block(BufY, h, n * rows_per_bucket, rows_per_bucket);
             }
@@ -131,7 +131,7 @@ int DPD::buf4_axpy(dpdbuf4 *BufX, dpdbuf4 *BufY, double alpha) {
                 buf4_mat_irrep_rd_block(BufX, h, n * rows_per_bucket, rows_left);
                 buf4_mat_irrep_rd_block(BufY, h, n * rows_per_bucket, rows_left);
 
-                C_DAXPY(length, alpha, X, 1, Y, 1);
+                block_axpy(length, alpha, X, Y);
 
                 buf4_mat_irrep_wrt_block(BufY, h, n * rows_per_bucket, rows_left);
             }
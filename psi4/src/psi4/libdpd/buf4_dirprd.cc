@@ -31,6 +31,7 @@
     \brief Enter brief description of file here
 */
 #include <cstdio>
+#include <cmath>
 #include "psi4/libqt/qt.h"
 #include "dpd.h"
 
@@ -42,25 +43,77 @@ namespace psi {
 ** Arguments:
 **   dpdbuf4 *BufA, *BufB: Pointers to the dpd four-index buffers.
 **  The results is written to FileB.
+**
+** Irrep blocks that do not fit into core are streamed in row buckets.
 */
 
 int DPD::buf4_dirprd(dpdbuf4 *BufA, dpdbuf4 *BufB) {
-    int h, nirreps, my_irrep;
+    int h, n, nirreps, my_irrep, incore, nbuckets;
+    long int memoryd, rows_per_bucket, rows_left, coltot, length;
 
     nirreps = BufA->params->nirreps;
     my_irrep = BufA->file.my_irrep;
 
     for (h = 0; h < nirreps; h++) {
-        buf4_mat_irrep_init(BufA, h);
-        buf4_mat_irrep_init(BufB, h);
-        buf4_mat_irrep_rd(BufA, h);
-        buf4_mat_irrep_rd(BufB, h);
+        coltot = BufA->params->coltot[h ^ my_irrep];
+
+        incore = 1;
+        if (BufA->params->rowtot[h] && coltot) {
+            /* NB: we need at least one row of both A and B */
+            memoryd = dpd_memfree();
+            rows_per_bucket = memoryd / (2 * coltot);
+
+            if (rows_per_bucket > BufA->params->rowtot[h]) rows_per_bucket = BufA->params->rowtot[h];
+
+            if (!rows_per_bucket) dpd_error("buf4_dirprd: Not enough memory for one row!", "outfile");
+
+            nbuckets = (int)ceil((double)BufA->params->rowtot[h] / (double)rows_per_bucket);
+
+            rows_left = BufA->params->rowtot[h] % rows_per_bucket;
+
+            if (nbuckets > 1) incore = 0;
+        }
+
+        if (incore) {
+            buf4_mat_irrep_init(BufA, h);
+            buf4_mat_irrep_init(BufB, h);
+            buf4_mat_irrep_rd(BufA, h);
+            buf4_mat_irrep_rd(BufB, h);
+
+            length = ((long)BufA->params->rowtot[h]) * coltot;
+            if (length) block_dirprd(length, BufA->matrix[h][0], BufB->matrix[h][0]);
+
+            buf4_mat_irrep_wrt(BufB, h);
+            buf4_mat_irrep_close(BufA, h);
+            buf4_mat_irrep_close(BufB, h);
+        } else {
+            buf4_mat_irrep_init_block(BufA, h, rows_per_bucket);
+            buf4_mat_irrep_init_block(BufB, h, rows_per_bucket);
+
+            length = rows_per_bucket * coltot;
+            for (n = 0; n < (rows_left ? nbuckets - 1 : nbuckets); n++) {
+                buf4_mat_irrep_rd_block(BufA, h, n * rows_per_bucket, rows_per_bucket);
+                buf4_mat_irrep_rd_block(BufB, h, n * rows_per_bucket, rows_per_bucket);
+
+                block_dirprd(length, BufA->matrix[h][0], BufB->matrix[h][0]);
+
+                buf4_mat_irrep_wrt_block(BufB, h, n * rows_per_bucket, rows_per_bucket);
+            }
+
+            if (rows_left) {
+                length = rows_left * coltot;
+
+                buf4_mat_irrep_rd_block(BufA, h, n * rows_per_bucket, rows_left);
+                buf4_mat_irrep_rd_block(BufB, h, n * rows_per_bucket, rows_left);
+
+                block_dirprd(length, BufA->matrix[h][0], BufB->matrix[h][0]);
 
-        dirprd_block(BufA->matrix[h], BufB->matrix[h], BufA->params->rowtot[h], BufA->params->coltot[h ^ my_irrep]);
+                buf4_mat_irrep_wrt_block(BufB, h, n * rows_per_bucket, rows_left);
+            }
 
-        buf4_mat_irrep_wrt(BufB, h);
-        buf4_mat_irrep_close(BufA, h);
-        buf4_mat_irrep_close(BufB, h);
+            buf4_mat_irrep_close_block(BufA, h, rows_per_bucket);
+            buf4_mat_irrep_close_block(BufB, h, rows_per_bucket);
+        }
     }
 
     return 0;
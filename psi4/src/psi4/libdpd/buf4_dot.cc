@@ -41,7 +41,7 @@ double DPD::buf4_dot(dpdbuf4 *BufA, dpdbuf4 *BufB) {
     int h, nirreps, n, my_irrep;
     double dot;
     int incore, nbuckets;
-    long int memoryd, rows_per_bucket, rows_left;
+    long int memoryd, rows_per_bucket, rows_left, length;
 
     nirreps = BufA->params->nirreps;
     my_irrep = BufA->file.my_irrep;
@@ -78,8 +78,8 @@ double DPD::buf4_dot(dpdbuf4 *BufA, dpdbuf4 *BufB) {
             buf4_mat_irrep_rd(BufA, h);
             buf4_mat_irrep_rd(BufB, h);
 
-            dot += dot_block(BufA->matrix[h], BufB->matrix[h], BufA->params->rowtot[h],
-                             BufA->params->coltot[h ^ my_irrep], 1.0);
+            length = ((long)BufA->params->rowtot[h]) * ((long)BufA->params->coltot[h ^ my_irrep]);
+            if (length) dot += block_dot(length, BufA->matrix[h][0], BufB->matrix[h][0]);
 
             buf4_mat_irrep_close(BufA, h);
             buf4_mat_irrep_close(BufB, h);
@@ -91,15 +91,16 @@ double DPD::buf4_dot(dpdbuf4 *BufA, dpdbuf4 *BufB) {
                 buf4_mat_irrep_rd_block(BufA, h, n * rows_per_bucket, rows_per_bucket);
                 buf4_mat_irrep_rd_block(BufB, h, n * rows_per_bucket, rows_per_bucket);
 
-                dot += dot_block(BufA->matrix[h], BufB->matrix[h], rows_per_bucket, BufA->params->coltot[h ^ my_irrep],
-                                 1.0);
+                length = rows_per_bucket * BufA->params->coltot[h ^ my_irrep];
+                dot += block_dot(length, BufA->matrix[h][0], BufB->matrix[h][0]);
             }
 
             if (rows_left) {
                 buf4_mat_irrep_rd_block(BufA, h, n * rows_per_bucket, rows_left);
                 buf4_mat_irrep_rd_block(BufB, h, n * rows_per_bucket, rows_left);
 
-                dot += dot_block(BufA->matrix[h], BufB->matrix[h], rows_left, BufA->params->coltot[h ^ my_irrep], 1.0);
+                length = rows_left * BufA->params->coltot[h ^ my_irrep];
+                dot += block_dot(length, BufA->matrix[h][0], BufB->matrix[h][0]);
             }
 
             buf4_mat_irrep_close_block(BufA, h, rows_per_bucket);
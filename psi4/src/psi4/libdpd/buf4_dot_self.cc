@@ -44,7 +44,7 @@ namespace psi {
 
 double DPD::buf4_dot_self(dpdbuf4 *BufX) {
     int h, nirreps, my_irrep;
-    int row, col;
+    long int length;
     double alpha = 0.0;
 
     nirreps = BufX->params->nirreps;
@@ -54,9 +54,8 @@ double DPD::buf4_dot_self(dpdbuf4 *BufX) {
         buf4_mat_irrep_init(BufX, h);
         buf4_mat_irrep_rd(BufX, h);
 
-        for (row = 0; row < BufX->params->rowtot[h]; row++)
-            for (col = 0; col < BufX->params->coltot[h ^ my_irrep]; col++)
-                alpha += BufX->matrix[h][row][col] * BufX->matrix[h][row][col];
+        length = ((long)BufX->params->rowtot[h]) * ((long)BufX->params->coltot[h ^ my_irrep]);
+        if (length) alpha += block_dot(length, BufX->matrix[h][0], BufX->matrix[h][0]);
 
         buf4_mat_irrep_close(BufX, h);
     }
@@ -119,7 +119,7 @@ int DPD::buf4_scm(dpdbuf4 *InBuf, double alpha) {
             length = ((long)InBuf->params->rowtot[h]) * ((long)InBuf->params->coltot[h ^ all_buf_irrep]);
             if (length) {
                 X = &(InBuf->matrix[h][0][0]);
-                C_DSCAL(length, alpha, X, 1);
+                block_scal(length, alpha, X);
             }
 
             buf4_mat_irrep_wrt(InBuf, h);
@@ -134,7 +134,7 @@ int DPD::buf4_scm(dpdbuf4 *InBuf, double alpha) {
 
                 if (length) {
                     X = &(InBuf->matrix[h][0][0]);
-                    C_DSCAL(length, alpha, X, 1);
+                    block_scal(length, alpha, X);
                 }
                 buf4_mat_irrep_row_wrt(InBuf, h, pq);
             }
@@ -327,6 +327,12 @@ class PSI_API DPD {
     double **dpd_block_matrix(size_t n, size_t m);
     void free_dpd_block(double **array, size_t n, size_t m);
 
+    void block_axpy(size_t length, double alpha, const double *X, double *Y);
+    void block_scal(size_t length, double alpha, double *X);
+    double block_dot(size_t length, const double *X, const double *Y);
+    void block_dirprd(size_t length, const double *X, double *Y);
+    void block_axpbycz(size_t length, double a, const double *X, double b, const double *Y, double c, double *Z);
+
     int contract222(dpdfile2 *X, dpdfile2 *Y, dpdfile2 *Z, int target_X, int target_Y, double alpha, double beta);
     int contract442(dpdbuf4 *X, dpdbuf4 *Y, dpdfile2 *Z, int target_X, int target_Y, double alpha, double beta);
     int contract422(dpdbuf4 *X, dpdfile2 *Y, dpdfile2 *Z, int trans_Y, int trans_Z, double alpha, double beta);
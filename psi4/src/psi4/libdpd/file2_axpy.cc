@@ -61,9 +61,8 @@ int DPD::file2_axpy(dpdfile2 *FileA, dpdfile2 *FileB, double alpha, int transA)
 
     for (h = 0; h < nirreps; h++) {
         if (!transA) {
-            for (row = 0; row < FileA->params->rowtot[h]; row++)
-                for (col = 0; col < FileA->params->coltot[h ^ my_irrep]; col++)
-                    FileB->matrix[h][row][col] += alpha * FileA->matrix[h][row][col];
+            long int length = ((long)FileA->params->rowtot[h]) * ((long)FileA->params->coltot[h ^ my_irrep]);
+            if (length) block_axpy(length, alpha, FileA->matrix[h][0], FileB->matrix[h][0]);
 
         } else {
             for (row = 0; row < FileB->params->rowtot[h]; row++)
@@ -46,6 +46,7 @@ namespace psi {
 
 int DPD::file2_dirprd(dpdfile2 *FileA, dpdfile2 *FileB) {
     int h, nirreps, my_irrep;
+    long int length;
 
     nirreps = FileA->params->nirreps;
     my_irrep = FileA->my_irrep;
@@ -56,7 +57,8 @@ int DPD::file2_dirprd(dpdfile2 *FileA, dpdfile2 *FileB) {
     file2_mat_rd(FileB);
 
     for (h = 0; h < nirreps; h++) {
-        dirprd_block(FileA->matrix[h], FileB->matrix[h], FileA->params->rowtot[h], FileA->params->coltot[h ^ my_irrep]);
+        length = ((long)FileA->params->rowtot[h]) * ((long)FileA->params->coltot[h ^ my_irrep]);
+        if (length) block_dirprd(length, FileA->matrix[h][0], FileB->matrix[h][0]);
     }
 
     file2_mat_wrt(FileB);
@@ -38,6 +38,7 @@ namespace psi {
 
 double DPD::file2_dot(dpdfile2 *FileA, dpdfile2 *FileB) {
     int h, nirreps, my_irrep;
+    long int length;
     double dot;
 
     nirreps = FileA->params->nirreps;
@@ -51,8 +52,8 @@ double DPD::file2_dot(dpdfile2 *FileA, dpdfile2 *FileB) {
     file2_mat_rd(FileB);
 
     for (h = 0; h < nirreps; h++) {
-        dot += dot_block(FileA->matrix[h], FileB->matrix[h], FileA->params->rowtot[h],
-                         FileA->params->coltot[h ^ my_irrep], 1.0);
+        length = ((long)FileA->params->rowtot[h]) * ((long)FileA->params->coltot[h ^ my_irrep]);
+        if (length) dot += block_dot(length, FileA->matrix[h][0], FileB->matrix[h][0]);
     }
 
     file2_mat_close(FileA);
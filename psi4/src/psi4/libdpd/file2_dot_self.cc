@@ -41,7 +41,7 @@ namespace psi {
 
 double DPD::file2_dot_self(dpdfile2 *BufX) {
     int h, nirreps, my_irrep;
-    int row, col;
+    long int length;
     double alpha = 0.0;
 
     nirreps = BufX->params->nirreps;
@@ -51,9 +51,8 @@ double DPD::file2_dot_self(dpdfile2 *BufX) {
     file2_mat_rd(BufX);
 
     for (h = 0; h < nirreps; h++) {
-        for (row = 0; row < BufX->params->rowtot[h]; row++)
-            for (col = 0; col < BufX->params->coltot[h ^ my_irrep]; col++)
-                alpha += BufX->matrix[h][row][col] * BufX->matrix[h][row][col];
+        length = ((long)BufX->params->rowtot[h]) * ((long)BufX->params->coltot[h ^ my_irrep]);
+        if (length) alpha += block_dot(length, BufX->matrix[h][0], BufX->matrix[h][0]);
     }
 
     file2_mat_close(BufX);
@@ -58,7 +58,7 @@ int DPD::file2_scm(dpdfile2 *InFile, double alpha) {
         length = InFile->params->rowtot[h] * InFile->params->coltot[h ^ my_irrep];
         if (length) {
             X = &(InFile->matrix[h][0][0]);
-            C_DSCAL(length, alpha, X, 1);
+            block_scal(length, alpha, X);
         }
     }
 
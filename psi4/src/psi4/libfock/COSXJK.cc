@@ -0,0 +1,331 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+#include "psi4/libqt/qt.h"
+#include "psi4/psi4-dec.h"
+#include "psi4/libmints/sieve.h"
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/vector.h"
+#include "psi4/libmints/basisset.h"
+#include "psi4/libmints/vector3.h"
+#include "psi4/libmints/integral.h"
+#include "psi4/libmints/electrostatic.h"
+#include "psi4/lib3index/dfhelper.h"
+#include "psi4/liboptions/liboptions.h"
+#include "psi4/libpsi4util/exception.h"
+
+#include "jk.h"
+#include "cubature.h"
+#include "points.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include "psi4/libpsi4util/PsiOutStream.h"
+#ifdef _OPENMP
+#include <omp.h>
+#include "psi4/libpsi4util/process.h"
+#endif
+
+using namespace psi;
+
+namespace psi {
+
+COSXJK::COSXJK(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary, Options& options)
+    : JK(primary), options_(options), auxiliary_(auxiliary) {
+    common_init();
+}
+
+COSXJK::~COSXJK() {}
+
+void COSXJK::common_init() {
+    dfh_ = std::make_shared<DFHelper>(primary_, auxiliary_);
+    cosx_cutoff_ = options_.get_double("COSX_INTS_TOLERANCE");
+}
+size_t COSXJK::memory_estimate() {
+    dfh_->set_nthreads(omp_nthread_);
+    dfh_->set_schwarz_cutoff(cutoff_);
+    return dfh_->get_core_size();
+}
+void COSXJK::print_header() const {
+    if (print_) {
+        outfile->Printf("  ==> COSXJK: Density-Fitted J, Seminumerical K <==\n\n");
+
+        outfile->Printf("    J tasked:           %11s\n", (do_J_ ? "Yes" : "No"));
+        outfile->Printf("    K tasked:           %11s\n", (do_K_ ? "Yes" : "No"));
+        outfile->Printf("    wK tasked:          %11s\n", (do_wK_ ? "Yes" : "No"));
+        outfile->Printf("    OpenMP threads:     %11d\n", omp_nthread_);
+        outfile->Printf("    Memory [MiB]:       %11ld\n", (memory_ * 8L) / (1024L * 1024L));
+        outfile->Printf("    Schwarz Cutoff:     %11.0E\n", cutoff_);
+        outfile->Printf("    COSX Cutoff:        %11.0E\n", cosx_cutoff_);
+        outfile->Printf("    Overlap Fitting:    %11s\n", (options_.get_bool("COSX_OVERLAP_FITTING") ? "Yes" : "No"));
+        outfile->Printf("    Fitting Condition:  %11.0E\n\n", condition_);
+
+        if (grid_) {
+            outfile->Printf("   => Exchange Grid <=\n\n");
+            grid_->print("outfile", print_);
+        }
+
+        outfile->Printf("   => Auxiliary Basis Set <=\n\n");
+        auxiliary_->print_by_level("outfile", print_);
+    }
+}
+void COSXJK::preiterations() {
+    if (do_wK_) throw PSIEXCEPTION("COSXJK does not yet support wK builds.");
+
+    // => Coulomb: DFHelper with the fitted (Q|mn) in core <= //
+    dfh_->set_nthreads(omp_nthread_);
+    dfh_->set_schwarz_cutoff(cutoff_);
+    dfh_->set_method("STORE");
+    dfh_->set_fitting_condition(condition_);
+    dfh_->set_memory(memory_ - memory_overhead());
+    dfh_->set_do_wK(false);
+    dfh_->initialize();
+
+    // => Exchange: a coarse grid and the shell pairs worth visiting on it <= //
+    std::map<std::string, int> int_opts;
+    int_opts["DFT_RADIAL_POINTS"] = options_.get_int("COSX_RADIAL_POINTS");
+    int_opts["DFT_SPHERICAL_POINTS"] = options_.get_int("COSX_SPHERICAL_POINTS");
+    std::map<std::string, std::string> str_opts;
+    str_opts["DFT_GRID_NAME"] = "";
+    grid_ = std::make_shared<DFTGrid>(primary_->molecule(), primary_, int_opts, str_opts, options_);
+    sieve_ = std::make_shared<ERISieve>(primary_, cutoff_);
+
+    size_t nbf = primary_->nbf();
+    fit_ = std::make_shared<Matrix>("COSX Fit", nbf, nbf);
+    if (!options_.get_bool("COSX_OVERLAP_FITTING")) {
+        fit_->identity();
+        return;
+    }
+
+    // Numerical overlap X^T W X on the exchange grid
+    std::vector<std::shared_ptr<BasisFunctions>> functions;
+    std::vector<SharedMatrix> Snum;
+    for (int thread = 0; thread < omp_nthread_; thread++) {
+        functions.push_back(std::make_shared<BasisFunctions>(primary_, grid_->max_points(), grid_->max_functions()));
+        functions.back()->set_deriv(0);
+        Snum.push_back(std::make_shared<Matrix>("Snum", nbf, nbf));
+    }
+
+    const auto& blocks = grid_->blocks();
+#pragma omp parallel for schedule(dynamic) num_threads(omp_nthread_)
+    for (size_t b = 0; b < blocks.size(); b++) {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        std::shared_ptr<BlockOPoints> block = blocks[b];
+        const std::vector<int>& funcs = block->functions_local_to_global();
+        int npoints = block->npoints();
+        int nlocal = funcs.size();
+        if (nlocal == 0) continue;
+        int ldphi = functions[thread]->max_functions();
+
+        functions[thread]->compute_functions(block);
+        double** phip = functions[thread]->basis_value("PHI")->pointer();
+        double* w = block->w();
+
+        std::vector<double> wphi(npoints * (size_t)nlocal);
+        for (int g = 0; g < npoints; g++) {
+            for (int m = 0; m < nlocal; m++) wphi[g * (size_t)nlocal + m] = w[g] * phip[g][m];
+        }
+        std::vector<double> Sloc(nlocal * (size_t)nlocal);
+        C_DGEMM('T', 'N', nlocal, nlocal, npoints, 1.0, wphi.data(), nlocal, phip[0], ldphi, 0.0, Sloc.data(),
+                nlocal);
+
+        double** Sp = Snum[thread]->pointer();
+        for (int m = 0; m < nlocal; m++) {
+            for (int n = 0; n < nlocal; n++) Sp[funcs[m]][funcs[n]] += Sloc[m * (size_t)nlocal + n];
+        }
+    }
+    for (int thread = 1; thread < omp_nthread_; thread++) Snum[0]->add(Snum[thread]);
+
+    // fit = S Snum^-1, dropping numerically singular directions of Snum
+    auto S = std::make_shared<Matrix>("S", nbf, nbf);
+    IntegralFactory factory(primary_);
+    std::unique_ptr<OneBodyAOInt> overlap(factory.ao_overlap());
+    overlap->compute(S);
+    Snum[0]->power(-1.0, condition_);
+    fit_ = Matrix::doublet(S, Snum[0]);
+    fit_->set_name("COSX Fit");
+}
+void COSXJK::compute_JK() {
+    if (do_J_) {
+        // DFHelper handles J only; K comes from the grid below
+        dfh_->build_JK(C_left_ao_, C_right_ao_, D_ao_, J_ao_, K_ao_, max_nocc(), true, false, false, lr_symmetric_);
+    }
+    if (do_K_) {
+        build_K(D_ao_, K_ao_);
+    }
+}
+void COSXJK::build_K(std::vector<SharedMatrix>& D, std::vector<SharedMatrix>& K) {
+    size_t nbf = primary_->nbf();
+    size_t ndens = D.size();
+    int nshell = primary_->nshell();
+    int max_points = grid_->max_points();
+
+    // => Per-thread integrals, collocation and accumulators <= //
+
+    auto factory = std::make_shared<IntegralFactory>(primary_);
+    std::vector<std::shared_ptr<ElectrostaticInt>> ints;
+    std::vector<std::vector<double>> Abuf(omp_nthread_);
+    std::vector<std::shared_ptr<BasisFunctions>> functions;
+    std::vector<std::vector<SharedMatrix>> Kraw(omp_nthread_);
+    size_t max_nfunc = primary_->max_function_per_shell();
+    for (int thread = 0; thread < omp_nthread_; thread++) {
+        ints.push_back(std::shared_ptr<ElectrostaticInt>(static_cast<ElectrostaticInt*>(factory->electrostatic())));
+        Abuf[thread].resize(max_points * max_nfunc * max_nfunc);
+        functions.push_back(std::make_shared<BasisFunctions>(primary_, max_points, grid_->max_functions()));
+        functions.back()->set_deriv(0);
+        for (size_t i = 0; i < ndens; i++) Kraw[thread].push_back(std::make_shared<Matrix>("Kraw", nbf, nbf));
+    }
+
+    const std::vector<std::pair<int, int>>& pairs = sieve_->shell_pairs();
+    const auto& blocks = grid_->blocks();
+    const double* extents = grid_->extents()->shell_extents()->pointer();
+
+    timer_on("COSXJK: K");
+#pragma omp parallel for schedule(dynamic) num_threads(omp_nthread_)
+    for (size_t b = 0; b < blocks.size(); b++) {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        std::shared_ptr<BlockOPoints> block = blocks[b];
+        const std::vector<int>& funcs = block->functions_local_to_global();
+        int npoints = block->npoints();
+        int nlocal = funcs.size();
+        if (nlocal == 0) continue;
+        int ldphi = functions[thread]->max_functions();
+
+        functions[thread]->compute_functions(block);
+        double** phip = functions[thread]->basis_value("PHI")->pointer();
+        double* x = block->x();
+        double* y = block->y();
+        double* z = block->z();
+        double* w = block->w();
+
+        // F_gs = X_gl D_ls for every density, and the largest |F| per shell
+        std::vector<double> Dloc(nlocal * nbf);
+        std::vector<std::vector<double>> F(ndens, std::vector<double>(npoints * nbf));
+        std::vector<std::vector<double>> G(ndens, std::vector<double>(npoints * nbf, 0.0));
+        std::vector<double> Fmax(nshell, 0.0);
+        for (size_t i = 0; i < ndens; i++) {
+            double** Dp = D[i]->pointer();
+            for (int l = 0; l < nlocal; l++) ::memcpy(&Dloc[l * nbf], Dp[funcs[l]], sizeof(double) * nbf);
+            C_DGEMM('N', 'N', npoints, nbf, nlocal, 1.0, phip[0], ldphi, Dloc.data(), nbf, 0.0, F[i].data(), nbf);
+            for (int S = 0; S < nshell; S++) {
+                int s0 = primary_->shell(S).function_index();
+                int ns = primary_->shell(S).nfunction();
+                double val = Fmax[S];
+                for (int g = 0; g < npoints; g++) {
+                    for (int s = s0; s < s0 + ns; s++) val = std::max(val, std::fabs(F[i][g * nbf + s]));
+                }
+                Fmax[S] = val;
+            }
+        }
+
+        // G_gn = A_ns(r_g) F_gs over the shell pairs this block can see.  The charge
+        // distribution of a pair lies inside the extents of both its shells, and |phi_m phi_n|
+        // integrates to at most one, so |A_mn(r_g)| <= 1/d for a block a distance d outside it.
+        std::shared_ptr<ElectrostaticInt> eint = ints[thread];
+        double* buffer = Abuf[thread].data();
+        const Vector3& xc = block->center();
+        double Rblock = block->radius();
+        for (const auto& pair : pairs) {
+            int M = pair.first;
+            int N = pair.second;
+            double Fpair = std::max(Fmax[M], Fmax[N]);
+            if (Fpair < cosx_cutoff_) continue;
+            const GaussianShell& shellM = primary_->shell(M);
+            const GaussianShell& shellN = primary_->shell(N);
+            double dist = std::max(xc.distance(shellM.center()) - extents[M],
+                                   xc.distance(shellN.center()) - extents[N]) - Rblock;
+            if (dist > 0.0 && Fpair < cosx_cutoff_ * dist) continue;
+            int m0 = shellM.function_index();
+            int nm = shellM.nfunction();
+            int n0 = shellN.function_index();
+            int nn = shellN.nfunction();
+
+            // All points of the block at once, sharing the primitive pair setup
+            eint->compute_shell_points(M, N, npoints, x, y, z, buffer);
+            for (int g = 0; g < npoints; g++) {
+                // ElectrostaticInt returns the potential of an electron, A = -buffer
+                const double* Ag = &buffer[g * (size_t)(nm * nn)];
+                for (size_t i = 0; i < ndens; i++) {
+                    double* Fg = &F[i][g * nbf];
+                    double* Gg = &G[i][g * nbf];
+                    for (int m = 0; m < nm; m++) {
+                        double gm = 0.0;
+                        for (int n = 0; n < nn; n++) {
+                            double A = -Ag[m * nn + n];
+                            gm += A * Fg[n0 + n];
+                            if (M != N) Gg[n0 + n] += A * Fg[m0 + m];
+                        }
+                        Gg[m0 + m] += gm;
+                    }
+                }
+            }
+        }
+
+        // Kraw_mn += w_g X_gm G_gn for the local rows m
+        std::vector<double> wphi(npoints * (size_t)nlocal);
+        for (int g = 0; g < npoints; g++) {
+            for (int m = 0; m < nlocal; m++) wphi[g * (size_t)nlocal + m] = w[g] * phip[g][m];
+        }
+        std::vector<double> Kloc(nlocal * nbf);
+        for (size_t i = 0; i < ndens; i++) {
+            C_DGEMM('T', 'N', nlocal, nbf, npoints, 1.0, wphi.data(), nlocal, G[i].data(), nbf, 0.0, Kloc.data(), nbf);
+            double** Kp = Kraw[thread][i]->pointer();
+            for (int m = 0; m < nlocal; m++) C_DAXPY(nbf, 1.0, &Kloc[m * nbf], 1, Kp[funcs[m]], 1);
+        }
+    }
+    timer_off("COSXJK: K");
+
+    // => Reduce, fit and symmetrize <= //
+
+    for (size_t i = 0; i < ndens; i++) {
+        for (int thread = 1; thread < omp_nthread_; thread++) Kraw[0][i]->add(Kraw[thread][i]);
+        K[i]->gemm(false, false, 1.0, fit_, Kraw[0][i], 0.0);
+        if (lr_symmetric_) K[i]->hermitivitize();
+    }
+}
+void COSXJK::postiterations() {
+    grid_.reset();
+    sieve_.reset();
+    fit_.reset();
+}
+int COSXJK::max_nocc() const {
+    int max_nocc = 0;
+    for (size_t N = 0; N < C_left_ao_.size(); N++) {
+        max_nocc = (C_left_ao_[N]->colspi()[0] > max_nocc ? C_left_ao_[N]->colspi()[0] : max_nocc);
+    }
+    return max_nocc;
+}
+}  // namespace psi
@@ -38,8 +38,10 @@
 #include "psi4/libmints/vector.h"
 #include "psi4/libmints/twobody.h"
 #include "psi4/libmints/integral.h"
+#include "psi4/libmints/molecule.h"
 #include "psi4/lib3index/dftensor.h"
 #include "psi4/lib3index/dfhelper.h"
+#include "psi4/lib3index/localdf.h"
 
 #include "jk.h"
 
@@ -62,16 +64,49 @@ MemDFJK::MemDFJK(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> au
 MemDFJK::~MemDFJK() {}
 
 void MemDFJK::common_init() { dfh_ = std::make_shared<DFHelper>(primary_, auxiliary_); }
+void MemDFJK::set_local_fitting(bool local, double radius) {
+    local_fitting_ = local;
+    local_radius_ = radius;
+    ldfh_.reset();
+    if (local_fitting_) ldfh_ = std::make_shared<LocalDFHelper>(primary_, auxiliary_);
+}
 size_t MemDFJK::memory_estimate() {
+    if (local_fitting_) {
+        ldfh_->set_nthreads(omp_nthread_);
+        ldfh_->set_schwarz_cutoff(cutoff_);
+        ldfh_->set_radius(local_radius_);
+        // The K scratch scales with the occupied count, which is not known
+        // before the first compute, so take it from the alpha electrons
+        std::shared_ptr<Molecule> mol = primary_->molecule();
+        int nelectron = mol->multiplicity() - 1 - mol->molecular_charge() - primary_->n_ecp_core();
+        for (int A = 0; A < mol->natom(); A++) nelectron += (int)mol->Z(A);
+        size_t nocc = std::max(1, (nelectron + 1) / 2);
+        return ldfh_->get_core_size(nocc);
+    }
     dfh_->set_nthreads(omp_nthread_);
     dfh_->set_schwarz_cutoff(cutoff_);
     return dfh_->get_core_size();
 }
 
+std::shared_ptr<DFHelper> MemDFJK::dfh() {
+    if (local_fitting_) throw PSIEXCEPTION("MemDFJK::dfh: no DFHelper is built with local fitting, use ldfh().");
+    return dfh_;
+}
+
 void MemDFJK::preiterations() {
     // Initialize calls your derived class's preiterations member
     // knobs are set and state variables assigned
 
+    if (local_fitting_) {
+        if (do_wK_) throw PSIEXCEPTION("MemDFJK does not yet support wK builds.");
+        ldfh_->set_nthreads(omp_nthread_);
+        ldfh_->set_schwarz_cutoff(cutoff_);
+        ldfh_->set_radius(local_radius_);
+        ldfh_->set_fitting_condition(condition_);
+        ldfh_->initialize();
+        return;
+    }
+
     // use previously set state variables to dfh instance
     dfh_->set_nthreads(omp_nthread_);
     dfh_->set_schwarz_cutoff(cutoff_);
@@ -80,6 +115,7 @@ void MemDFJK::preiterations() {
     dfh_->set_memory(memory_ - memory_overhead());
     dfh_->set_do_wK(do_wK_);
     dfh_->set_omega(omega_);
+    dfh_->set_sparse_K(sparse_K_, sparse_K_tol_);
 
     // we need to prepare the AOs here, and that's it.
     // DFHelper takes care of all the housekeeping
@@ -94,6 +130,10 @@ void MemDFJK::preiterations() {
     }
 }
 void MemDFJK::compute_JK() {
+    if (local_fitting_) {
+        ldfh_->build_JK(C_left_ao_, C_right_ao_, D_ao_, J_ao_, K_ao_, do_J_, do_K_, lr_symmetric_);
+        return;
+    }
     dfh_->build_JK(C_left_ao_, C_right_ao_, D_ao_, J_ao_, K_ao_, max_nocc(), do_J_, do_K_, do_wK_, lr_symmetric_);
 }
 void set_do_wK(bool do_wK) {
@@ -117,9 +157,17 @@ void MemDFJK::print_header() const {
         if (do_wK_) outfile->Printf("    Omega:              %11.3E\n", omega_);
         outfile->Printf("    OpenMP threads:     %11d\n", omp_nthread_);
         outfile->Printf("    Memory [MiB]:       %11ld\n", (memory_ * 8L) / (1024L * 1024L));
-        outfile->Printf("    Algorithm:          %11s\n", (dfh_->get_AO_core() ? "Core" : "Disk"));
-        outfile->Printf("    Schwarz Cutoff:     %11.0E\n", cutoff_);
-        outfile->Printf("    Mask sparsity (%%):  %11.4f\n", 100. * dfh_->ao_sparsity());
+        if (local_fitting_) {
+            outfile->Printf("    Algorithm:          %11s\n", "Local");
+            outfile->Printf("    Domain Radius:      %11.2f\n", local_radius_);
+            outfile->Printf("    Atom Pairs:         %11zu\n", ldfh_->npairs());
+            outfile->Printf("    Schwarz Cutoff:     %11.0E\n", cutoff_);
+        } else {
+            outfile->Printf("    Algorithm:          %11s\n", (dfh_->get_AO_core() ? "Core" : "Disk"));
+            outfile->Printf("    Schwarz Cutoff:     %11.0E\n", cutoff_);
+            outfile->Printf("    Mask sparsity (%%):  %11.4f\n", 100. * dfh_->ao_sparsity());
+            if (sparse_K_) outfile->Printf("    Sparse K Cutoff:    %11.0E\n", sparse_K_tol_);
+        }
         outfile->Printf("    Fitting Condition:  %11.0E\n\n", condition_);
 
         outfile->Printf("   => Auxiliary Basis Set <=\n\n");
@@ -95,19 +95,30 @@ void PKJK::preiterations() {
     // PK file to disk. Also, do everything in the AO basis
     // like the modern JK algos, for adding sieving later
 
-    PKmanager_ = pk::PKManager::build_PKManager(psio_, primary_, memory_, options, do_wK_, omega_);
+    auto form_PK = [&](bool force_disk) {
+        PKmanager_ = pk::PKManager::build_PKManager(psio_, primary_, memory_, options, do_wK_, omega_, force_disk);
 
-    PKmanager_->initialize();
+        PKmanager_->initialize();
 
-    PKmanager_->form_PK();
+        PKmanager_->form_PK();
 
-    // If range-separated K needed, we redo all the above steps
-    if (do_wK_) {
-        outfile->Printf("  Computing range-separated integrals for PK\n");
+        // If range-separated K needed, we redo all the above steps
+        if (do_wK_ && !PKmanager_->storage_overflow()) {
+            outfile->Printf("  Computing range-separated integrals for PK\n");
 
-        PKmanager_->initialize_wK();
+            PKmanager_->initialize_wK();
 
-        PKmanager_->form_PK_wK();
+            PKmanager_->form_PK_wK();
+        }
+    };
+
+    form_PK(false);
+
+    // Mixed-precision in-core storage can outgrow its correction budget,
+    // the integrals are then redone out of core
+    if (PKmanager_->storage_overflow()) {
+        outfile->Printf("  Falling back to an out-of-core PK algorithm.\n");
+        form_PK(true);
     }
 
     // PK files are written at this point. We are done.
@@ -36,6 +36,9 @@
 #include "psi4/libiwl/config.h"
 #include "PK_workers.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace psi {
 
 namespace pk {
@@ -749,6 +752,19 @@ PKWrkrInCore::PKWrkrInCore(std::shared_ptr<BasisSet> primary, SharedSieve sieve,
     J_bufp_ = nullptr;
     K_bufp_ = nullptr;
     wK_bufp_ = nullptr;
+    J_mixed_ = nullptr;
+    K_mixed_ = nullptr;
+    wK_mixed_ = nullptr;
+}
+
+PKWrkrInCore::PKWrkrInCore(std::shared_ptr<BasisSet> primary, SharedSieve sieve, size_t buf_size, size_t lastbuf,
+                           PKMixedInts *Jmixed, PKMixedInts *Kmixed, PKMixedInts *wKmixed, int nworkers)
+    : PKWrkrInCore(primary, sieve, buf_size, lastbuf, (double *)nullptr, nullptr, nullptr, nworkers) {
+    J_mixed_ = Jmixed;
+    K_mixed_ = Kmixed;
+    wK_mixed_ = wKmixed;
+    // Room for the J and K slices of the largest (last) task
+    task_buf_ = std::unique_ptr<double[]>(new double[2 * (buf_size + lastbuf)]);
 }
 
 void PKWrkrInCore::initialize_task() {
@@ -759,6 +775,18 @@ void PKWrkrInCore::initialize_task() {
         maxid += last_buf_;
     }
     set_max_idx(maxid - 1);
+    // Mixed precision: the task slice lives in the local buffer until finalized
+    if (J_mixed_) {
+        if (do_wK()) {
+            wK_bufp_ = task_buf_.get();
+            ::memset((void *)wK_bufp_, '\0', task_size() * sizeof(double));
+        } else {
+            J_bufp_ = task_buf_.get();
+            K_bufp_ = task_buf_.get() + task_size();
+            ::memset((void *)J_bufp_, '\0', 2 * task_size() * sizeof(double));
+        }
+        return;
+    }
     // We set the pointers to the beginning of the attributed buffer section
     if (do_wK()) {
         wK_bufp_ = wK_buf0_ + offset();
@@ -836,6 +864,10 @@ void PKWrkrInCore::finalize_ints(size_t pk_pairs) {
             K_bufp_[pqpq - offset()] *= 0.5;
         }
     }
+    if (J_mixed_) {
+        J_mixed_->store(bufidx(), offset(), J_bufp_, task_size());
+        K_mixed_->store(bufidx(), offset(), K_bufp_, task_size());
+    }
 }
 
 void PKWrkrInCore::finalize_ints_wK(size_t pk_pairs) {
@@ -845,6 +877,96 @@ void PKWrkrInCore::finalize_ints_wK(size_t pk_pairs) {
             wK_bufp_[pqpq - offset()] *= 0.5;
         }
     }
+    if (wK_mixed_) {
+        wK_mixed_->store(bufidx(), offset(), wK_bufp_, task_size());
+    }
+}
+
+PKMixedInts::PKMixedInts(size_t pk_pairs, size_t ntasks, double threshold, size_t budget)
+    : pk_pairs_(pk_pairs), threshold_(threshold), budget_(budget), ncorr_(0), overflow_(false), tasks_(ntasks) {
+    size_t pk_size = pk_pairs_ * (pk_pairs_ + 1) / 2;
+    values_ = std::unique_ptr<float[]>(new float[pk_size]);
+}
+
+void PKMixedInts::store(size_t task, size_t offset, const double *buf, size_t n) {
+    // Past the budget the supermatrix is discarded, no need to keep filling it
+    if (overflow_) return;
+
+    TaskCorrections &tc = tasks_[task];
+    // Row and column of the first element of the slice
+    size_t pq = (size_t)((std::sqrt(8.0 * offset + 1.0) - 1.0) / 2.0);
+    while (EXPLICIT_IOFF(pq) > offset) --pq;
+    while (EXPLICIT_IOFF(pq + 1) <= offset) ++pq;
+    size_t rs = offset - EXPLICIT_IOFF(pq);
+
+    size_t nstart = tc.corr.size();
+    float *val = values_.get() + offset;
+    for (size_t i = 0; i < n; ++i) {
+        float f = (float)buf[i];
+        val[i] = f;
+        double corr = buf[i] - (double)f;
+        if (std::fabs(corr) > threshold_) {
+            if (tc.rows.empty() || tc.rows.back() != pq) {
+                tc.rows.push_back(pq);
+                tc.counts.push_back(0);
+            }
+            ++tc.counts.back();
+            tc.rs.push_back(rs);
+            tc.corr.push_back((float)corr);
+        }
+        if (++rs > pq) {
+            rs = 0;
+            ++pq;
+        }
+    }
+
+    if ((ncorr_ += tc.corr.size() - nstart) > budget_) {
+        overflow_ = true;
+        tc = TaskCorrections();
+    }
+}
+
+void PKMixedInts::finalize() {
+    if (overflow_) {
+        throw PSIEXCEPTION("PKMixedInts: corrections exceeded their memory budget.");
+    }
+
+    row_start_.assign(pk_pairs_ + 1, 0);
+    task_first_.assign(tasks_.size() + 1, 0);
+    for (size_t t = 0; t < tasks_.size(); ++t) {
+        TaskCorrections &tc = tasks_[t];
+        for (size_t i = 0; i < tc.rows.size(); ++i) {
+            row_start_[tc.rows[i] + 1] += tc.counts[i];
+        }
+        task_first_[t + 1] = task_first_[t] + tc.corr.size();
+        // The row lists are no longer needed once indexed
+        std::vector<size_t>().swap(tc.rows);
+        std::vector<size_t>().swap(tc.counts);
+    }
+    // Tasks cover increasing canonical indices, so the concatenated
+    // task lists are sorted by row and column
+    for (size_t pq = 0; pq < pk_pairs_; ++pq) {
+        row_start_[pq + 1] += row_start_[pq];
+    }
+}
+
+void PKMixedInts::expand_row(size_t pq, double *row) const {
+    const float *val = values_.get() + EXPLICIT_IOFF(pq);
+    for (size_t rs = 0; rs <= pq; ++rs) {
+        row[rs] = val[rs];
+    }
+
+    size_t g = row_start_[pq];
+    size_t gend = row_start_[pq + 1];
+    if (g == gend) return;
+    // Last task starting at or before correction g, a row spans few tasks
+    size_t t = std::upper_bound(task_first_.begin(), task_first_.end(), g) - task_first_.begin() - 1;
+    for (; g < gend; ++g) {
+        while (g >= task_first_[t + 1]) ++t;
+        const TaskCorrections &tc = tasks_[t];
+        size_t i = g - task_first_[t];
+        row[tc.rs[i]] += tc.corr[i];
+    }
 }
 
 PKWrkrIWL::PKWrkrIWL(std::shared_ptr<BasisSet> primary, SharedSieve sieve, std::shared_ptr<AIOHandler> AIOp,
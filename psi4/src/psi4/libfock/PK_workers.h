@@ -45,6 +45,10 @@
 #include "psi4/libpsio/config.h"
 #include "psi4/libpsi4util/exception.h"
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 namespace psi {
 
 class AIOHandler;
@@ -415,6 +419,64 @@ class PKWrkrReord : public PKWorker {
     void write_wK(std::vector<size_t> min_ind, std::vector<size_t> max_ind, size_t pk_pairs) override;
 };
 
+/** class PKMixedInts: in-core PK supermatrix stored in mixed precision.
+ * Every element is kept as a float. When the float rounding error of an element
+ * exceeds a threshold, tied to the largest integral, the difference is kept as a
+ * float correction in a row-sparse list, so that the element is recovered to near
+ * double precision. Small elements, the bulk of the supermatrix for large
+ * molecules, cost 4 bytes.
+ *
+ * Each task of the in-core worker compresses its contiguous slice of the
+ * supermatrix with store(). The corrections live in a store bounded by a budget;
+ * once it is exceeded, overflow() is set and storage stops, so that the caller
+ * can fall back to an out-of-core algorithm. finalize() then indexes the
+ * corrections of all tasks by row. Rows are expanded back to doubles on the fly
+ * by expand_row() during the contraction.
+ */
+
+class PKMixedInts {
+   private:
+    /// Per-task corrections, in increasing canonical index order
+    struct TaskCorrections {
+        /// Rows pq holding corrections, and the number of corrections per row
+        std::vector<size_t> rows;
+        std::vector<size_t> counts;
+        /// Column rs and value of each correction
+        std::vector<unsigned int> rs;
+        std::vector<float> corr;
+    };
+
+    size_t pk_pairs_;
+    /// Largest rounding error tolerated on a single element
+    double threshold_;
+    /// Largest number of corrections that may be stored
+    size_t budget_;
+    std::atomic<size_t> ncorr_;
+    std::atomic<bool> overflow_;
+    /// Single-precision supermatrix, same layout as the double in-core PK
+    std::unique_ptr<float[]> values_;
+    /// Row pq owns the corrections [row_start_[pq], row_start_[pq+1]) of the
+    /// concatenated task lists, task t starting at correction task_first_[t]
+    std::vector<size_t> row_start_;
+    std::vector<size_t> task_first_;
+    std::vector<TaskCorrections> tasks_;
+
+   public:
+    PKMixedInts(size_t pk_pairs, size_t ntasks, double threshold, size_t budget);
+
+    /// Compress the n elements starting at canonical index offset, computed by task
+    void store(size_t task, size_t offset, const double* buf, size_t n);
+    /// Index the corrections of all tasks, to be called once all tasks are stored
+    void finalize();
+    /// Expand row pq, i.e. the pq + 1 elements (pq|rs), rs <= pq, into row
+    void expand_row(size_t pq, double* row) const;
+
+    /// Number of elements carrying a correction
+    size_t ncorrections() const { return ncorr_; }
+    /// Whether the corrections exceeded their budget, the supermatrix is then unusable
+    bool overflow() const { return overflow_; }
+};
+
 /** class PKWrkInCore: Computes all integrals for PK supermatrix
  * and stores them in core. To avoid atomic access to the giant array storing the matrix,
  * it is subdivided in nthreads_ buffers. Integrals are appropriately reordered such that
@@ -439,12 +501,23 @@ class PKWrkrInCore : public PKWorker {
     double* J_bufp_;
     double* K_bufp_;
     double* wK_bufp_;
+    // Mixed-precision storage, the task slice is then computed
+    // in a local double buffer and compressed at the end of the task
+    PKMixedInts* J_mixed_;
+    PKMixedInts* K_mixed_;
+    PKMixedInts* wK_mixed_;
+    std::unique_ptr<double[]> task_buf_;
 
     void initialize_task() override;
+    /// Number of elements in the current task
+    size_t task_size() const { return max_idx() - offset() + 1; }
 
    public:
     PKWrkrInCore(std::shared_ptr<BasisSet> primary, SharedSieve sieve, size_t buf_size, size_t lastbuf, double* Jbuf,
                  double* Kbuf, double* wKbuf, int nworkers);
+    /// Constructor for mixed-precision storage
+    PKWrkrInCore(std::shared_ptr<BasisSet> primary, SharedSieve sieve, size_t buf_size, size_t lastbuf,
+                 PKMixedInts* Jmixed, PKMixedInts* Kmixed, PKMixedInts* wKmixed, int nworkers);
 
     /// Filling values in the relevant part of the buffer
     void fill_values(double val, size_t i, size_t j, size_t k, size_t l) override;
@@ -45,6 +45,8 @@
 #include "psi4/libpsio/aiohandler.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 
+#include <algorithm>
+
 #ifdef _OPENMP
 #include <omp.h>
 #include "psi4/libpsi4util/process.h"
@@ -85,9 +87,10 @@ void ijklBasisIterator::next() {
 }
 
 std::shared_ptr<PKManager> PKManager::build_PKManager(std::shared_ptr<PSIO> psio, std::shared_ptr<BasisSet> primary,
-                                                      size_t memory, Options& options, bool dowK, double omega_in) {
+                                                      size_t memory, Options& options, bool dowK, double omega_in,
+                                                      bool force_disk) {
     std::string algo = options.get_str("PK_ALGO");
-    bool noincore = options.get_bool("PK_NO_INCORE");
+    bool noincore = options.get_bool("PK_NO_INCORE") || force_disk;
 
     // We introduce another safety factor in the memory, otherwise
     // we are apparently prone to being killed by the OS.
@@ -124,13 +127,30 @@ std::shared_ptr<PKManager> PKManager::build_PKManager(std::shared_ptr<PSIO> psio
         }
     }
 
-    if (ncorebuf * pk_size < memory && !noincore) do_incore = true;
+    int nthread = 1;
+#ifdef _OPENMP
+    nthread = Process::environment.get_n_threads();
+#endif
+
+    // Mixed-precision in-core storage needs the floats plus a bounded correction store.
+    // The supermatrices stay allocated while J and K are contracted from them.
+    bool do_mixed = options.get_str("PK_INCORE_PRECISION") == "MIXED";
+    if (do_mixed) {
+        size_t incore = PKMgrInCore::mixed_memory(pk_size, ncorebuf) + contraction_memory(nbf, nthread, true);
+        if (incore < memory && !noincore) do_incore = true;
+    } else {
+        if (ncorebuf * pk_size + contraction_memory(nbf, nthread) < memory && !noincore) do_incore = true;
+    }
 
     std::shared_ptr<PKManager> pkmgr;
 
     if (do_incore) {
-        outfile->Printf("  Using in-core PK algorithm.\n");
-        pkmgr = std::make_shared<PKMgrInCore>(primary, memory, options);
+        if (do_mixed) {
+            outfile->Printf("  Using mixed-precision in-core PK algorithm.\n");
+        } else {
+            outfile->Printf("  Using in-core PK algorithm.\n");
+        }
+        pkmgr = std::make_shared<PKMgrInCore>(primary, memory, options, do_mixed);
         // Estimate that we'll need less than 40 buffers: do integral reorder
     } else if (do_reord) {
         outfile->Printf("  Using integral reordering PK algorithm.\n");
@@ -151,6 +171,13 @@ std::shared_ptr<PKManager> PKManager::build_PKManager(std::shared_ptr<PSIO> psio
     return pkmgr;
 }
 
+size_t PKManager::contraction_memory(size_t nbf, int nthread, bool mixed) {
+    size_t pairs = nbf * (nbf + 1) / 2;
+    size_t per_thread = std::max(pairs, 2 * nbf * nbf);
+    if (mixed) per_thread += pairs;
+    return nthread * per_thread;
+}
+
 PKManager::PKManager(std::shared_ptr<BasisSet> primary, size_t memory, Options& options)
     : primary_(primary), memory_(memory), options_(options) {
     nbf_ = primary_->nbf();
@@ -221,6 +248,8 @@ void PKManager::compute_integrals(bool wK) {
     size_t nshqu = 0;
 #pragma omp parallel for num_threads(nthreads_) schedule(dynamic) reduction(+ : nshqu)
     for (size_t i = 0; i < ntasks_; ++i) {
+        // Storage already failed, the remaining tasks would be discarded
+        if (storage_overflow()) continue;
         // We need to get the list of shell quartets for each task
         int thread = 0;
 #ifdef _OPENMP
@@ -471,6 +500,53 @@ void PKManager::get_results(std::vector<SharedMatrix> J, std::string exch) {
     JK_vec_.clear();
 }
 
+void PKManager::contract_row_nonsym(int p, int q, const double* row, const double* D_vec, double** Dmat, double* J,
+                                    double* K) const {
+    const int n = nbf_;
+    const double* j_ptr = row;
+    for (int r = 0; r <= p; ++r) {
+        int maxs = (r == p) ? q : r;
+        for (int s = 0; s <= maxs; ++s) {
+            double val = *j_ptr;
+            if (J) {
+                double D_rs = D_vec[r * n + s] + D_vec[s * n + r];
+                double D_pq = D_vec[p * n + q] + D_vec[q * n + p];
+                J[p * n + q] += val * D_rs;
+                J[q * n + p] += val * D_rs;
+                J[r * n + s] += val * D_pq;
+                J[s * n + r] += val * D_pq;
+            }
+            // Primitive algorithm, just contract integrals with appropriate
+            // element on the fly. Might be faster than reading/writing the appropriate
+            // PK supermatrix
+            if (K) {
+                // Need ugly factors for now. A better solution would be great.
+                double fac = 1.0;
+                if (p == q && r == s && p == r) {
+                    fac = 0.25;  // Divide only be 4, PK stores integral with a
+                    // factor 0.5 on the (pq|pq) diagonal.
+                } else if ((p == q && q == r) || (q == r && r == s)) {
+                    fac = 0.5;
+                } else if (p == q && r == s) {
+                    fac = 0.25;
+                } else if (p == q || r == s) {
+                    fac = 0.5;
+                }
+                val *= fac;
+                K[p * n + r] += val * Dmat[q][s];
+                K[r * n + p] += val * Dmat[s][q];
+                K[q * n + r] += val * Dmat[p][s];
+                K[p * n + s] += val * Dmat[q][r];
+                K[s * n + p] += val * Dmat[r][q];
+                K[r * n + q] += val * Dmat[s][p];
+                K[s * n + q] += val * Dmat[r][p];
+                K[q * n + s] += val * Dmat[p][r];
+            }
+            ++j_ptr;
+        }
+    }
+}
+
 void PKManager::form_K(std::vector<SharedMatrix> K) {
     // Right now, this supports both J and K. K asym is
     // formed at the same time than J asym for convenience.
@@ -500,6 +576,14 @@ PKMgrDisk::PKMgrDisk(std::shared_ptr<PSIO> psio, std::shared_ptr<BasisSet> prima
 
     // No current writing since we are constructing
     writing_ = false;
+
+    // The batches are contracted into thread-local accumulators, which
+    // are not available for the integrals. A batch holds at least one row.
+    size_t scratch = contraction_memory(nbf(), nthreads());
+    batch_memory_ = (PKManager::memory() > scratch) ? PKManager::memory() - scratch : 0;
+    if (batch_memory_ < pk_pairs()) {
+        throw PSIEXCEPTION("Not enough memory for PK algorithm\n");
+    }
 }
 
 void PKMgrDisk::initialize() {
@@ -545,7 +629,7 @@ void PKMgrDisk::batch_sizing() {
         } else {
             size_t pqrs = INDEX2(pq, INDEX2(rb, sb));
             nintbatch += nintpq;
-            if (nintbatch > memory()) {
+            if (nintbatch > batch_memory()) {
                 batch_index_max_.push_back(old_max);
                 batch_pq_max_.push_back(old_pq);
                 batch_for_pq_.pop_back();
@@ -570,7 +654,7 @@ void PKMgrDisk::batch_sizing() {
     int lastb = batch_index_max_.size() - 1;
     if (lastb > 0) {
         size_t size_lastb = batch_index_max_[lastb] - batch_index_min_[lastb];
-        if (((double)size_lastb / memory()) < batch_thresh) {
+        if (((double)size_lastb / batch_memory()) < batch_thresh) {
             batch_index_max_[lastb - 1] = batch_index_max_[lastb];
             batch_pq_max_[lastb - 1] = batch_pq_max_[lastb];
             batch_pq_max_.pop_back();
@@ -658,140 +742,154 @@ void PKMgrDisk::finalize_PK() {
 void PKMgrDisk::form_J(std::vector<SharedMatrix> J, std::string exch, std::vector<SharedMatrix> K) {
     make_J_vec(J);
 
-    // Now loop over batches
-    for (int batch = 0; batch < batch_pq_min_.size(); ++batch) {
-        size_t min_index = batch_index_min_[batch];
-        size_t max_index = batch_index_max_[batch];
-        size_t batch_size = max_index - min_index;
-        size_t min_pq = batch_pq_min_[batch];
-        size_t max_pq = batch_pq_max_[batch];
-        double* j_block = new double[batch_size];
-
-        char* label;
+    const int nbatches = batch_pq_min_.size();
+    const int nthread = nthreads();
+    const size_t nbf2 = (size_t)nbf() * nbf();
+    const bool do_K = K.size() || exch == "wK";
+
+    // Batches are read through the AIO handler. When two of the largest batch
+    // fit in the PK memory left by the contraction scratch, batch + 1 is read while batch is being contracted.
+    // Otherwise a single buffer is used and the next read is only posted once
+    // the contraction is done.
+    size_t max_batch_size = 0;
+    for (int batch = 0; batch < nbatches; ++batch) {
+        max_batch_size = std::max(max_batch_size, batch_index_max_[batch] - batch_index_min_[batch]);
+    }
+    const bool prefetch = (nbatches > 1) && (2 * max_batch_size <= batch_memory());
+    const int nslots = prefetch ? 2 : 1;
+    double* j_blocks[2] = {nullptr, nullptr};
+    char* labels[2] = {nullptr, nullptr};
+    size_t jobs[2] = {0, 0};
+    for (int slot = 0; slot < nslots; ++slot) {
+        j_blocks[slot] = new double[max_batch_size];
+    }
+
+    auto post_read = [&](int batch) {
+        int slot = batch % nslots;
         if (exch == "K") {
-            label = PKWorker::get_label_K(batch);
+            labels[slot] = PKWorker::get_label_K(batch);
         } else if (exch == "wK") {
-            label = PKWorker::get_label_wK(batch);
+            labels[slot] = PKWorker::get_label_wK(batch);
         } else {
-            label = PKWorker::get_label_J(batch);
+            labels[slot] = PKWorker::get_label_J(batch);
         }
-        psio_->read_entry(pk_file_, label, (char*)j_block, batch_size * sizeof(double));
+        size_t batch_size = batch_index_max_[batch] - batch_index_min_[batch];
+        jobs[slot] = AIO_->read_entry(pk_file_, labels[slot], (char*)j_blocks[slot], batch_size * sizeof(double));
+    };
+
+    // Thread-local accumulators, sized for the path that uses them: the J_rs
+    // column of the triangular loop for symmetric densities, or the nbf x nbf
+    // J and/or K matrices otherwise. Accounted for in contraction_memory().
+    std::vector<double> acc;
+
+    post_read(0);
+    for (int batch = 0; batch < nbatches; ++batch) {
+        const int slot = batch % nslots;
+        timer_on("PK batch read wait");
+        AIO_->wait_for_job(jobs[slot]);
+        timer_off("PK batch read wait");
+        delete[] labels[slot];
+        labels[slot] = nullptr;
+        if (prefetch && batch + 1 < nbatches) post_read(batch + 1);
+
+        const size_t min_pq = batch_pq_min_[batch];
+        const size_t max_pq = batch_pq_max_[batch];
+        // Row pq holds the pq + 1 integrals (pq|rs), rs <= pq
+        const size_t row_offset0 = min_pq * (min_pq + 1) / 2;
+        const double* j_block = j_blocks[slot];
 
         // Read one entry, use it for all density matrices
         for (int N = 0; N < J.size(); ++N) {
             // Symmetric density matrix, pure triangular
             if (is_sym(N) && exch != "wK") {
-                double* D_vec = D_glob_vecs(N);
+                const double* D_vec = D_glob_vecs(N);
                 double* J_vec = JK_glob_vecs(N);
-                double* j_ptr = j_block;
-                // TODO Could consider parallelizing this loop
-                for (size_t pq = min_pq; pq < max_pq; ++pq) {
-                    double D_pq = D_vec[pq];
-                    double* D_rs = D_vec;
-                    double J_pq = 0.0;
-                    double* J_rs = J_vec;
-                    for (size_t rs = 0; rs <= pq; ++rs) {
-                        // DEBUG                        if(!exch && rs == 0) {
-                        // DEBUG                          outfile->Printf("PK int (%lu|%lu) = %20.16f\n",pq,rs,*j_ptr);
-                        // DEBUG                        }
-                        J_pq += *j_ptr * (*D_rs);
-                        *J_rs += *j_ptr * D_pq;
-                        ++D_rs;
-                        ++J_rs;
-                        ++j_ptr;
+                const size_t acc_stride = max_pq;
+                acc.assign(nthread * acc_stride, 0.0);
+                // Each pq row is owned by one thread, which writes J_pq directly.
+                // The scattered J_rs updates go to the thread-local accumulator.
+#pragma omp parallel num_threads(nthread)
+                {
+                    int thread = 0;
+#ifdef _OPENMP
+                    thread = omp_get_thread_num();
+#endif
+                    double* J_rs_acc = acc.data() + thread * acc_stride;
+#pragma omp for schedule(dynamic, 8)
+                    for (size_t pq = min_pq; pq < max_pq; ++pq) {
+                        const double* j_ptr = j_block + pq * (pq + 1) / 2 - row_offset0;
+                        double D_pq = D_vec[pq];
+                        double J_pq = 0.0;
+                        for (size_t rs = 0; rs <= pq; ++rs) {
+                            J_pq += j_ptr[rs] * D_vec[rs];
+                            J_rs_acc[rs] += j_ptr[rs] * D_pq;
+                        }
+                        J_vec[pq] += J_pq;
+                    }
+#pragma omp for schedule(static)
+                    for (size_t rs = 0; rs < max_pq; ++rs) {
+                        double J_rs = 0.0;
+                        for (int t = 0; t < nthread; ++t) {
+                            J_rs += acc[t * acc_stride + rs];
+                        }
+                        J_vec[rs] += J_rs;
                     }
-                    J_vec[pq] += J_pq;
                 }
                 // Non-symmetric density matrix case
             } else if (exch == "" || exch == "wK") {
-                double* j_ptr = j_block;
                 const int fp = ind_for_pq_[min_pq].first;
                 const int fq = ind_for_pq_[min_pq].second;
                 const int maxp = ind_for_pq_[max_pq].first;
-                if (exch != "wK") {
-                    double* D_vec = D_glob_vecs(N);
-                    double** J_vec = J[N]->pointer();
+                const int maxq_last = ind_for_pq_[max_pq].second;
+                const bool do_J = exch != "wK";
+                const double* D_vec = D_glob_vecs(N);
+                double** Dmat = original_D(N)->pointer();
+                double* J_vec = J[N]->pointer()[0];
+                double* K_vec = nullptr;
+                if (do_K) K_vec = (exch == "wK") ? J[N]->pointer()[0] : K[N]->pointer()[0];
+
+                const size_t K_off = do_J ? nbf2 : 0;
+                const size_t acc_stride = K_off + (do_K ? nbf2 : 0);
+                acc.assign(nthread * acc_stride, 0.0);
+#pragma omp parallel num_threads(nthread)
+                {
+                    int thread = 0;
+#ifdef _OPENMP
+                    thread = omp_get_thread_num();
+#endif
+                    double* J_loc = do_J ? acc.data() + thread * acc_stride : nullptr;
+                    double* K_loc = do_K ? acc.data() + thread * acc_stride + K_off : nullptr;
+#pragma omp for schedule(dynamic)
                     for (int p = fp; p <= maxp; ++p) {
-                        int maxq = (p == maxp) ? ind_for_pq_[max_pq].second : p + 1;
-                        int poffs = p * nbf();
+                        int maxq = (p == maxp) ? maxq_last : p + 1;
                         int q = (p == fp) ? fq : 0;
                         for (; q < maxq; ++q) {
-                            int qoffs = q * nbf();
-                            for (int r = 0; r <= p; ++r) {
-                                int roffs = r * nbf();
-                                int maxs = (r == p) ? q : r;
-                                for (int s = 0; s <= maxs; ++s) {
-                                    //                            if(!exch && INDEX2(r,s) == 0) {
-                                    //                              outfile->Printf("PK int (%lu|%lu) =
-                                    //                              %20.16f\n",INDEX2(p,q),INDEX2(r,s),*j_ptr);
-                                    //                              int x = 0;  // For the lolz
-                                    //                            }
-                                    J_vec[p][q] += *j_ptr * (D_vec[roffs + s] + D_vec[s * nbf() + r]);
-                                    J_vec[q][p] += *j_ptr * (D_vec[roffs + s] + D_vec[s * nbf() + r]);
-                                    J_vec[r][s] += *j_ptr * (D_vec[poffs + q] + D_vec[qoffs + p]);
-                                    J_vec[s][r] += *j_ptr * (D_vec[poffs + q] + D_vec[qoffs + p]);
-                                    ++j_ptr;
-                                }
-                            }
+                            size_t pq = (size_t)p * (p + 1) / 2 + q;
+                            const double* j_ptr = j_block + pq * (pq + 1) / 2 - row_offset0;
+                            contract_row_nonsym(p, q, j_ptr, D_vec, Dmat, J_loc, K_loc);
                         }
                     }
-                }
-                // Since we just read a batch, might as well compute K
-                // Primitive algorithm, just contract integrals with appropriate
-                // element on the fly. Might be faster than reading/writing the appropriate
-                // PK supermatrix
-                if (K.size() || exch == "wK") {
-                    double** Dmat = original_D(N)->pointer();
-                    double** K_vec;
-                    if (exch == "wK") {
-                        K_vec = J[N]->pointer();
-                    } else {
-                        K_vec = K[N]->pointer();
-                    }
-                    j_ptr = j_block;
-                    for (int p = fp; p <= maxp; ++p) {
-                        int maxq = (p == maxp) ? ind_for_pq_[max_pq].second : p + 1;
-                        //       int poffs = p * nbf();
-                        int q = (p == fp) ? fq : 0;
-                        for (; q < maxq; ++q) {
-                            //       int qoffs = q * nbf();
-                            for (int r = 0; r <= p; ++r) {
-                                //       int roffs = r * nbf();
-                                int maxs = (r == p) ? q : r;
-                                for (int s = 0; s <= maxs; ++s) {
-                                    // Need ugly factors for now. A better solution would be great.
-                                    double fac = 1.0;
-                                    //       int soffs = s * nbf();
-                                    if (p == q && r == s && p == r) {
-                                        fac = 0.25;  // Divide only be 4, PK stores integral with a
-                                        // factor 0.5 on the (pq|pq) diagonal.
-                                    } else if ((p == q && q == r) || (q == r && r == s)) {
-                                        fac = 0.5;
-                                    } else if (p == q && r == s) {
-                                        fac = 0.25;
-                                    } else if (p == q || r == s) {
-                                        fac = 0.5;
-                                    }
-                                    K_vec[p][r] += (*j_ptr) * fac * Dmat[q][s];
-                                    K_vec[r][p] += (*j_ptr) * fac * Dmat[s][q];
-                                    K_vec[q][r] += (*j_ptr) * fac * Dmat[p][s];
-                                    K_vec[p][s] += (*j_ptr) * fac * Dmat[q][r];
-                                    K_vec[s][p] += (*j_ptr) * fac * Dmat[r][q];
-                                    K_vec[r][q] += (*j_ptr) * fac * Dmat[s][p];
-                                    K_vec[s][q] += (*j_ptr) * fac * Dmat[r][p];
-                                    K_vec[q][s] += (*j_ptr) * fac * Dmat[p][r];
-                                    ++j_ptr;
-                                }
-                            }
+#pragma omp for schedule(static)
+                    for (size_t ij = 0; ij < nbf2; ++ij) {
+                        double J_ij = 0.0;
+                        double K_ij = 0.0;
+                        for (int t = 0; t < nthread; ++t) {
+                            if (do_J) J_ij += acc[t * acc_stride + ij];
+                            if (do_K) K_ij += acc[t * acc_stride + K_off + ij];
                         }
+                        if (do_J) J_vec[ij] += J_ij;
+                        if (do_K) K_vec[ij] += K_ij;
                     }
                 }
             }  // end of non-symmetric case
         }      // End of loop over J matrices
 
-        delete[] label;
-        delete[] j_block;
+        if (!prefetch && batch + 1 < nbatches) post_read(batch + 1);
     }  // End of batch loop
+
+    for (int slot = 0; slot < nslots; ++slot) {
+        delete[] j_blocks[slot];
+    }
     get_results(J, exch);
 }
 
@@ -1436,6 +1534,20 @@ void PKMgrYoshimine::generate_wK_PK(double* twoel_ints, size_t max_size) {
     inbuf.set_keep_flag(false);
 }
 
+PKMgrInCore::PKMgrInCore(std::shared_ptr<BasisSet> primary, size_t memory, Options& options, bool mixed)
+    : wK_ints_(nullptr), PKManager(primary, memory, options), mixed_(mixed) {
+    mixed_tol_ = options.get_double("PK_MIXED_TOLERANCE");
+}
+
+PKMgrInCore::~PKMgrInCore() {}
+
+bool PKMgrInCore::storage_overflow() const {
+    for (const PKMixedInts* ints : {J_mixed_.get(), K_mixed_.get(), wK_mixed_.get()}) {
+        if (ints && ints->overflow()) return true;
+    }
+    return false;
+}
+
 void PKMgrInCore::initialize() {
     print_batches();
     allocate_buffers();
@@ -1450,10 +1562,45 @@ void PKMgrInCore::print_batches() {
     PKManager::print_batches();
     outfile->Printf("  Performing in-core PK\n");
     int nbufincore = do_wk() ? 3 : 2;
-    outfile->Printf("  Using %lu doubles for integral storage.\n", nbufincore * pk_size());
+    if (mixed_) {
+        outfile->Printf("  Using %lu floats for mixed-precision integral storage.\n", nbufincore * pk_size());
+    } else {
+        outfile->Printf("  Using %lu doubles for integral storage.\n", nbufincore * pk_size());
+    }
 }
 
 void PKMgrInCore::allocate_buffers() {
+    if (mixed_) {
+        // Many small tasks, each computed in double in a thread buffer,
+        // then compressed into the mixed-precision supermatrices
+        size_t ntasks = (size_t)mixed_tasks_per_thread * nthreads();
+        size_t buffer_size = pk_size() / ntasks;
+        size_t lastbuf = pk_size() % ntasks;
+
+        // The tolerance is relative to the largest integral, so that only the
+        // large elements, whose float rounding error matters, carry a correction
+        double threshold = mixed_tol_ * sieve()->max();
+        // Whatever memory the floats, task buffers and contraction scratch leave is
+        // the correction store, one double (a float and an index) per correction
+        int nbufincore = do_wk() ? 3 : 2;
+        size_t fixed = nbufincore * (pk_size() / 2 + pk_pairs()) + pk_size() / 8;
+        fixed += contraction_memory(nbf(), nthreads(), true);
+        size_t budget = (memory() > fixed ? memory() - fixed : 0) / nbufincore;
+
+        J_mixed_ = std::unique_ptr<PKMixedInts>(new PKMixedInts(pk_pairs(), ntasks, threshold, budget));
+        K_mixed_ = std::unique_ptr<PKMixedInts>(new PKMixedInts(pk_pairs(), ntasks, threshold, budget));
+        if (do_wk()) {
+            wK_mixed_ = std::unique_ptr<PKMixedInts>(new PKMixedInts(pk_pairs(), ntasks, threshold, budget));
+        }
+        for (size_t i = 0; i < nthreads(); ++i) {
+            SharedPKWrkr buf = std::make_shared<PKWrkrInCore>(primary(), sieve(), buffer_size, lastbuf, J_mixed_.get(),
+                                                              K_mixed_.get(), wK_mixed_.get(), ntasks);
+            fill_buffer(buf);
+        }
+        set_ntasks(ntasks);
+        return;
+    }
+
     // Need to allocate two big arrays
     J_ints_ = std::unique_ptr<double[]>(new double[pk_size()]);
     K_ints_ = std::unique_ptr<double[]>(new double[pk_size()]);
@@ -1502,6 +1649,23 @@ void PKMgrInCore::finalize_PK() {
     for (int i = 0; i < nthreads(); ++i) {
         buffer(i).reset();
     }
+    if (mixed_) {
+        if (storage_overflow()) {
+            // The caller falls back to an out-of-core algorithm
+            outfile->Printf("  Mixed-precision PK corrections exceed their memory budget.\n\n");
+            return;
+        }
+        size_t ncorr = 0;
+        for (PKMixedInts* ints : {J_mixed_.get(), K_mixed_.get(), wK_mixed_.get()}) {
+            if (ints) {
+                ints->finalize();
+                ncorr += ints->ncorrections();
+            }
+        }
+        int nbufincore = do_wk() ? 3 : 2;
+        outfile->Printf("  Mixed-precision PK: %lu of %lu elements carry a double-precision correction.\n\n", ncorr,
+                        nbufincore * pk_size());
+    }
 }
 
 void PKMgrInCore::prepare_JK(std::vector<SharedMatrix> D, std::vector<SharedMatrix> Cl, std::vector<SharedMatrix> Cr) {
@@ -1511,118 +1675,113 @@ void PKMgrInCore::prepare_JK(std::vector<SharedMatrix> D, std::vector<SharedMatr
 void PKMgrInCore::form_J(std::vector<SharedMatrix> J, std::string exch, std::vector<SharedMatrix> K) {
     make_J_vec(J);
 
-    for (int N = 0; N < J.size(); ++N) {
-        double* j_ptr;
-        if (exch == "K") {
-            j_ptr = K_ints_.get();
-        } else {
-            j_ptr = J_ints_.get();
+    const int nthread = nthreads();
+    const size_t nbf2 = (size_t)nbf() * nbf();
+    const bool do_K = K.size() || exch == "wK";
+
+    // Supermatrix for the triangular contraction of symmetric densities
+    const double* sym_ints = (exch == "K") ? K_ints_.get() : J_ints_.get();
+    const PKMixedInts* sym_mixed = (exch == "K") ? K_mixed_.get() : J_mixed_.get();
+    // Supermatrix for non-symmetric densities. We use J supermatrix because it contains
+    // every unique integral, K supermatrix has summed some integrals that we need separately
+    const double* nonsym_ints = (exch == "wK") ? wK_ints_.get() : J_ints_.get();
+    const PKMixedInts* nonsym_mixed = (exch == "wK") ? wK_mixed_.get() : J_mixed_.get();
+
+    // Row pq holds the pq + 1 integrals (pq|rs), rs <= pq. In mixed precision
+    // it is expanded to doubles on the fly into a thread-local row.
+    auto get_row = [](const double* ints, const PKMixedInts* mixed, size_t pq, double* row) -> const double* {
+        if (mixed) {
+            mixed->expand_row(pq, row);
+            return row;
         }
-        // TODO We should totally parallelize this loop now.
+        return ints + pq * (pq + 1) / 2;
+    };
+
+    // Thread-local accumulators, sized for the path that uses them: the J_rs
+    // column of the triangular loop for symmetric densities, or the nbf x nbf
+    // J and/or K matrices otherwise. Accounted for in contraction_memory().
+    std::vector<double> acc;
+    std::vector<double> rows(mixed_ ? nthread * pk_pairs() : 0);
+
+    for (int N = 0; N < J.size(); ++N) {
         // Symmetric density matrix case
         if (is_sym(N) && exch != "wK") {
             double* J_vec = JK_glob_vecs(N);
-            double* D_vec = D_glob_vecs(N);
-            for (size_t pq = 0; pq < pk_pairs(); ++pq) {
-                double D_pq = D_vec[pq];
-                double* D_rs = D_vec;
-                double J_pq = 0.0;
-                double* J_rs = J_vec;
-                for (size_t rs = 0; rs <= pq; ++rs) {
-                    // DEBUG               if(!exch && rs == 0) {
-                    // DEBUG                 outfile->Printf("PK int (%lu|%lu) = %20.16f\n",pq,rs,*j_ptr);
-                    // DEBUG               }
-                    J_pq += *j_ptr * (*D_rs);
-                    *J_rs += *j_ptr * D_pq;
-                    ++D_rs;
-                    ++J_rs;
-                    ++j_ptr;
+            const double* D_vec = D_glob_vecs(N);
+            const size_t acc_stride = pk_pairs();
+            acc.assign(nthread * acc_stride, 0.0);
+            // Each pq row is owned by one thread, which writes J_pq directly.
+            // The scattered J_rs updates go to the thread-local accumulator.
+#pragma omp parallel num_threads(nthread)
+            {
+                int thread = 0;
+#ifdef _OPENMP
+                thread = omp_get_thread_num();
+#endif
+                double* J_rs_acc = acc.data() + thread * acc_stride;
+                double* row = mixed_ ? rows.data() + thread * pk_pairs() : nullptr;
+#pragma omp for schedule(dynamic, 8)
+                for (size_t pq = 0; pq < pk_pairs(); ++pq) {
+                    const double* j_ptr = get_row(sym_ints, sym_mixed, pq, row);
+                    double D_pq = D_vec[pq];
+                    double J_pq = 0.0;
+                    for (size_t rs = 0; rs <= pq; ++rs) {
+                        J_pq += j_ptr[rs] * D_vec[rs];
+                        J_rs_acc[rs] += j_ptr[rs] * D_pq;
+                    }
+                    J_vec[pq] += J_pq;
+                }
+#pragma omp for schedule(static)
+                for (size_t rs = 0; rs < pk_pairs(); ++rs) {
+                    double J_rs = 0.0;
+                    for (int t = 0; t < nthread; ++t) {
+                        J_rs += acc[t * acc_stride + rs];
+                    }
+                    J_vec[rs] += J_rs;
                 }
-                J_vec[pq] += J_pq;
             }
 
-            // TODO ? Fuse J and K loops ?
             // Non-symmetric density matrix
         } else if (exch == "" || exch == "wK") {
-            if (exch == "") {
-                double* D_vec = D_glob_vecs(N);
-                double** J_vec = J[N]->pointer();
+            const bool do_J = exch == "";
+            const double* D_vec = D_glob_vecs(N);
+            double** Dmat = original_D(N)->pointer();
+            double* J_vec = J[N]->pointer()[0];
+            double* K_vec = nullptr;
+            if (do_K) K_vec = (exch == "wK") ? J[N]->pointer()[0] : K[N]->pointer()[0];
+
+            const size_t K_off = do_J ? nbf2 : 0;
+            const size_t acc_stride = K_off + (do_K ? nbf2 : 0);
+            acc.assign(nthread * acc_stride, 0.0);
+#pragma omp parallel num_threads(nthread)
+            {
+                int thread = 0;
+#ifdef _OPENMP
+                thread = omp_get_thread_num();
+#endif
+                double* J_loc = do_J ? acc.data() + thread * acc_stride : nullptr;
+                double* K_loc = do_K ? acc.data() + thread * acc_stride + K_off : nullptr;
+                double* row = mixed_ ? rows.data() + thread * pk_pairs() : nullptr;
+#pragma omp for schedule(dynamic)
                 for (int p = 0; p < nbf(); ++p) {
-                    int poffs = p * nbf();
                     for (int q = 0; q <= p; ++q) {
-                        int qoffs = q * nbf();
-                        for (int r = 0; r <= p; ++r) {
-                            int roffs = r * nbf();
-                            int maxs = (r == p) ? q : r;
-                            for (int s = 0; s <= maxs; ++s) {
-                                J_vec[p][q] += *j_ptr * (D_vec[roffs + s] + D_vec[s * nbf() + r]);
-                                J_vec[q][p] += *j_ptr * (D_vec[roffs + s] + D_vec[s * nbf() + r]);
-                                J_vec[r][s] += *j_ptr * (D_vec[poffs + q] + D_vec[qoffs + p]);
-                                J_vec[s][r] += *j_ptr * (D_vec[poffs + q] + D_vec[qoffs + p]);
-                                ++j_ptr;
-                            }
-                        }
+                        size_t pq = (size_t)p * (p + 1) / 2 + q;
+                        const double* j_ptr = get_row(nonsym_ints, nonsym_mixed, pq, row);
+                        contract_row_nonsym(p, q, j_ptr, D_vec, Dmat, J_loc, K_loc);
                     }
                 }
-            }
-            // Since we just read a batch, might as well compute K
-            // Primitive algorithm, just contract integrals with appropriate
-            // element on the fly. Might be faster than reading/writing the appropriate
-            // PK supermatrix
-            if (K.size() || exch == "wK") {
-                double** Dmat = original_D(N)->pointer();
-                double** K_vec;
-                if (exch == "wK") {
-                    K_vec = J[N]->pointer();
-                    j_ptr = wK_ints_.get();
-                } else {
-                    K_vec = K[N]->pointer();
-                    // We use J supermatrix because it contains every unique integral
-                    // K supermatrix has summed some integrals that we need separately
-                    j_ptr = J_ints_.get();
-                }
-                for (int p = 0; p < nbf(); ++p) {
-                    //        int poffs = p * nbf();
-                    for (int q = 0; q <= p; ++q) {
-                        //          int qoffs = q * nbf();
-                        for (int r = 0; r <= p; ++r) {
-                            //            int roffs = r * nbf();
-                            int maxs = (r == p) ? q : r;
-                            for (int s = 0; s <= maxs; ++s) {
-                                // Need ugly factors for now. A better solution would be great.
-                                double fac = 1.0;
-                                //              int soffs = s * nbf();
-                                if (p == q && r == s && p == r) {
-                                    fac = 0.25;  // Divide only be 4, PK stores integral with a
-                                    // factor 0.5 on the (pq|pq) diagonal.
-                                } else if ((p == q && q == r) || (q == r && r == s)) {
-                                    fac = 0.5;
-                                } else if (p == q && r == s) {
-                                    fac = 0.25;
-                                } else if (p == q || r == s) {
-                                    fac = 0.5;
-                                }
-                                // DEBUG                       bool prt = (p == 0 && r == 0) || (q == 0 && r == 0) || (p
-                                // == 0 && s == 0) || (s == 0 && q == 0);
-                                // DEBUG                       if(exch == "wK" && prt) {
-                                // DEBUG                         outfile->Printf("PK int (%d %d|%d %d) =
-                                // %20.16f\n",p,q,r,s,*j_ptr);
-                                // DEBUG                       }
-                                K_vec[p][r] += (*j_ptr) * fac * Dmat[q][s];
-                                K_vec[r][p] += (*j_ptr) * fac * Dmat[s][q];
-                                K_vec[q][r] += (*j_ptr) * fac * Dmat[p][s];
-                                K_vec[p][s] += (*j_ptr) * fac * Dmat[q][r];
-                                K_vec[s][p] += (*j_ptr) * fac * Dmat[r][q];
-                                K_vec[r][q] += (*j_ptr) * fac * Dmat[s][p];
-                                K_vec[s][q] += (*j_ptr) * fac * Dmat[r][p];
-                                K_vec[q][s] += (*j_ptr) * fac * Dmat[p][r];
-                                ++j_ptr;
-                            }
-                        }
+#pragma omp for schedule(static)
+                for (size_t ij = 0; ij < nbf2; ++ij) {
+                    double J_ij = 0.0;
+                    double K_ij = 0.0;
+                    for (int t = 0; t < nthread; ++t) {
+                        if (do_J) J_ij += acc[t * acc_stride + ij];
+                        if (do_K) K_ij += acc[t * acc_stride + K_off + ij];
                     }
+                    if (do_J) J_vec[ij] += J_ij;
+                    if (do_K) K_vec[ij] += K_ij;
                 }
             }
-
         }  // End of non-symmetric condition
     }      // End of loop over J/K matrices
 
@@ -45,6 +45,7 @@ class BasisSet;
 namespace pk {
 
 class PKWorker;
+class PKMixedInts;
 
 typedef std::shared_ptr<PKWorker> SharedPKWrkr;
 
@@ -168,6 +169,11 @@ class PKManager {
     bool all_sym() const { return all_sym_; }
     SharedMatrix original_D(int N) const { return D_[N]; }
 
+    /// Peak thread-local scratch of form_J, in doubles: one accumulator per thread,
+    /// a pk_pairs column for symmetric densities or the nbf x nbf J and K matrices
+    /// otherwise, plus a pk_pairs row per thread to expand mixed-precision integrals
+    static size_t contraction_memory(size_t nbf, int nthread, bool mixed = false);
+
     /// Accessor that returns buffer corresponding to current thread
     SharedPKWrkr get_buffer();
     void set_ntasks(size_t tmp) { ntasks_ = tmp; }
@@ -177,10 +183,12 @@ class PKManager {
      * Static instance constructor, used to get a proper
      * instance of PKManager through automatic selection and
      * options provided
+     * @param force_disk excludes the in-core algorithm, used when in-core storage failed
      * @return abstract PKmanager object tuned with relevant options
      */
     static std::shared_ptr<PKManager> build_PKManager(std::shared_ptr<PSIO> psio, std::shared_ptr<BasisSet> primary,
-                                                      size_t memory, Options& options, bool dowK, double omega_in = 0);
+                                                      size_t memory, Options& options, bool dowK, double omega_in = 0,
+                                                      bool force_disk = false);
 
     // Base functions needed for the class to work
     /// Pure virtual initialize function: contains batch sizing and file
@@ -192,6 +200,9 @@ class PKManager {
     virtual void form_PK() = 0;
     /// Forming PK supermatrices for wK
     virtual void form_PK_wK() = 0;
+    /// Whether the supermatrices outgrew their storage while being formed.
+    /// They are then unusable and the PK algorithm has to be rebuilt out of core.
+    virtual bool storage_overflow() const { return false; }
     /// Preparing JK computation
     virtual void prepare_JK(std::vector<SharedMatrix> D, std::vector<SharedMatrix> Cl,
                             std::vector<SharedMatrix> Cr) = 0;
@@ -231,6 +242,10 @@ class PKManager {
     void make_J_vec(std::vector<SharedMatrix> J);
     /// Extracting results from vectors to matrix
     void get_results(std::vector<SharedMatrix> J, std::string exch);
+    /// Contract the row (pq|rs), rs <= pq, of a PK supermatrix with a non-symmetric
+    /// density. J and K are full nbf x nbf arrays, either may be nullptr.
+    void contract_row_nonsym(int p, int q, const double* row, const double* D_vec, double** Dmat, double* J,
+                             double* K) const;
     /// Forming K
     void form_K(std::vector<SharedMatrix> K);
     /// Forming wK
@@ -269,6 +284,8 @@ class PKMgrDisk : public PKManager {
     int pk_file_;
     /// Is there any pending AIO writing ?
     bool writing_;
+    /// Memory for the integral batches, what is left after the contraction scratch
+    size_t batch_memory_;
 
    public:
     /// Constructor for PKMgrDisk
@@ -280,6 +297,7 @@ class PKMgrDisk : public PKManager {
     void set_writing(bool tmp) { writing_ = tmp; }
     bool writing() const { return writing_; }
     int pk_file() const { return pk_file_; }
+    size_t batch_memory() const { return batch_memory_; }
     std::vector<size_t>& batch_ind_min() { return batch_index_min_; }
     std::vector<size_t>& batch_ind_max() { return batch_index_max_; }
     std::vector<size_t>& batch_pq_min() { return batch_pq_min_; }
@@ -472,13 +490,34 @@ class PKMgrInCore : public PKManager {
     std::unique_ptr<double[]> J_ints_;
     std::unique_ptr<double[]> K_ints_;
     std::unique_ptr<double[]> wK_ints_;
+    /// Mixed-precision storage, used instead of the arrays above
+    /// when PK_INCORE_PRECISION is MIXED
+    bool mixed_;
+    /// Largest rounding error tolerated on a mixed-precision element
+    double mixed_tol_;
+    std::unique_ptr<PKMixedInts> J_mixed_;
+    std::unique_ptr<PKMixedInts> K_mixed_;
+    std::unique_ptr<PKMixedInts> wK_mixed_;
 
    public:
     /// Constructor for in-core class
-    PKMgrInCore(std::shared_ptr<BasisSet> primary, size_t memory, Options& options)
-        : wK_ints_(nullptr), PKManager(primary, memory, options) {}
+    PKMgrInCore(std::shared_ptr<BasisSet> primary, size_t memory, Options& options, bool mixed = false);
+
+    /// Number of tasks per thread for the mixed-precision integral computation.
+    /// Each thread holds the double J and K of one task, so that the
+    /// thread buffers amount to 1/8 of the supermatrix.
+    static const int mixed_tasks_per_thread = 16;
+    /// Minimal memory, in doubles, for the mixed-precision in-core PK with nbufs
+    /// supermatrices of pk_size elements: the floats (1/2 double each), a correction
+    /// store for one element in eight (a float and an index, 1 double each), and the
+    /// thread task buffers (1/8 of a supermatrix). Memory beyond it enlarges the
+    /// correction store.
+    static size_t mixed_memory(size_t pk_size, int nbufs) { return (5 * nbufs + 1) * pk_size / 8; }
     /// Destructor for in-core class
-    ~PKMgrInCore() override {}
+    ~PKMgrInCore() override;
+
+    /// Whether the mixed-precision corrections exceeded their budget
+    bool storage_overflow() const override;
 
     /// Initialize sequence for in-core algorithm
     void initialize() override;
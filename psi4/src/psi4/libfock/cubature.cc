@@ -3811,115 +3811,15 @@ BasisExtents::BasisExtents(std::shared_ptr<BasisSet> primary, double delta) : pr
 }
 BasisExtents::~BasisExtents() {}
 void BasisExtents::computeExtents() {
-    // Here we assume the absolute spherical basis functions
-    // |\phi|_P(r) = |C_k| r^l exp(-a_k r^2)
-
-    // We are trying to zero the objective function
-    // O(r) = |\phi|_P(r) - \delta
-
-    // Bisection is used to avoid accidentally finding the
-    // nuclear cusp for p and higher functions
+    std::vector<double> extents = primary_->shell_extents(delta_);
 
     double *Rp = shell_extents_->pointer();
     maxR_ = 0.0;
-
-    // Compute each shell in turn
     for (int P = 0; P < primary_->nshell(); P++) {
-        // Corner case: \delta = 0.0
-        if (delta_ == 0.0) {
-            Rp[P] = std::numeric_limits<double>::max();
-            maxR_ = std::numeric_limits<double>::max();
-            continue;
-        }
-
-        // Stage 1: Collect information on the shell
-        const GaussianShell &Pshell = primary_->shell(P);
-        int l = Pshell.am();
-        int nprim = Pshell.nprimitive();
-        const double *alpha = Pshell.exps();
-        const double *norm = Pshell.coefs();
-
-        double norm_max = norm[0];
-        double alpha_max = alpha[0];
-
-        // Find most-diffuse primitive
-        for (int K = 0; K < nprim; K++) {
-            if (alpha_max > alpha[K]) {
-                alpha_max = alpha[K];
-                norm_max = std::fabs(norm[K]);
-            }
-        }
-
-        // Stage 2: Form a well-posed bounding box for R
-
-        // A: Force O at the right end of the box to be negative
-
-        // Take a crude guess based on most-diffuse exponent
-        // Removing nonlinearity with R0 = 10.0 a.u.
-        double Rr = 2.0;
-        double Or = 0.0;
-        do {
-            // Compute Or
-            Or = 0.0;
-            for (int K = 0; K < nprim; K++) {
-                Or += std::fabs(norm[K]) * pow(Rr, l) * exp(-alpha[K] * Rr * Rr);
-            }
-            Or = std::fabs(Or) - delta_;
-
-            // Move further right
-            if (Or > 0.0) Rr *= 2.0;
-
-        } while (Or > 0.0);
-
-        // B: Force O at the left end of the box to be positive
-        double Rl = Rr;  // We know this is negative due to Rr
-        double Ol = 0.0;
-        do {
-            // Compute Ol
-            Ol = 0.0;
-            for (int K = 0; K < nprim; K++) {
-                Ol += std::fabs(norm[K]) * pow(Rl, l) * exp(-alpha[K] * Rl * Rl);
-            }
-            Ol = std::fabs(Ol) - delta_;
-
-            // Move further left
-            if (Ol < 0.0) Rl /= 2.0;
-
-            // Check if we missed the positive bit in the middle somehow
-            if (std::fabs(Rl) == 0.0) {
-                throw PSIEXCEPTION(
-                    "BasisExtents: Left root of basis cutoffs found the nuclear cusp.\n"
-                    "This is very bad.");
-            }
-
-        } while (Ol < 0.0);
-
-        // Stage 3: Locate R via bisection
-        double Rc, Oc;
-        do {
-            Rc = 0.5 * (Rl + Rr);
-            Oc = 0.0;
-            for (int K = 0; K < nprim; K++) {
-                Oc += std::fabs(norm[K]) * pow(Rc, l) * exp(-alpha[K] * Rc * Rc);
-            }
-            Oc = std::fabs(Oc) - delta_;
-
-            if (Oc > 0.0) {
-                Rl = Rc;
-                Ol = Oc;
-            } else {
-                Rr = Rc;
-                Or = Oc;
-            }
-            // My MechE profs would disapprove of this cutoff.
-        } while (std::fabs(Rr - Rl) > 1.0E-8 * Rl && std::fabs(Oc) != 0.0);
-
-        // Assign the calculated value
-        Rp[P] = Rc;
-
+        Rp[P] = extents[P];
         // Keep track of the maximum extent
-        if (maxR_ < Rc) {
-            maxR_ = Rc;
+        if (maxR_ < Rp[P]) {
+            maxR_ = Rp[P];
         }
     }
 }
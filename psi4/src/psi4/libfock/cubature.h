@@ -399,6 +399,10 @@ class BlockOPoints {
     size_t index() const { return index_; }
     /// Print a trace of this BlockOPoints
     void print(std::string out_fname = "outfile", int print = 2);
+    /// Center of the bounding sphere of the points
+    const Vector3& center() const { return xc_; }
+    /// Radius of the bounding sphere of the points
+    double radius() const { return R_; }
 
     /// The x points. You do not own this
     double* x() const { return x_; }
@@ -71,6 +71,12 @@ JK::JK(std::shared_ptr<BasisSet> primary) : primary_(primary) { common_init(); }
 JK::~JK() {}
 std::shared_ptr<JK> JK::build_JK(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary,
                                  Options& options, std::string jk_type) {
+    if (jk_type == "AUTO") {
+        size_t doubles = Process::environment.get_memory() / 8;
+        if (options.exists_in_active("SCF_MEM_SAFETY_FACTOR")) doubles *= options.get_double("SCF_MEM_SAFETY_FACTOR");
+        jk_type = select_JK_type(primary, auxiliary, options, false, doubles);
+    }
+
     // Throw small DF warning
     if (jk_type == "DF") {
         outfile->Printf("\n  Warning: JK type 'DF' found in simple constructor, defaulting to DiskDFJK.\n");
@@ -104,6 +110,21 @@ std::shared_ptr<JK> JK::build_JK(std::shared_ptr<BasisSet> primary, std::shared_
     } else if (jk_type == "MEM_DF") {
         MemDFJK* jk = new MemDFJK(primary, auxiliary);
         _set_dfjk_options<MemDFJK>(jk, options);
+        if (options.exists_in_active("DF_LOCAL_FITTING") && options.get_bool("DF_LOCAL_FITTING"))
+            jk->set_local_fitting(true, options.get_double("DF_LOCAL_FITTING_RADIUS"));
+        if (options.exists_in_active("DF_SPARSE_K") && options.get_bool("DF_SPARSE_K"))
+            jk->set_sparse_K(true, options.get_double("DF_SPARSE_K_TOLERANCE"));
+
+        return std::shared_ptr<JK>(jk);
+
+    } else if (jk_type == "COSX") {
+        COSXJK* jk = new COSXJK(primary, auxiliary, options);
+
+        if (options["INTS_TOLERANCE"].has_changed()) jk->set_cutoff(options.get_double("INTS_TOLERANCE"));
+        if (options["PRINT"].has_changed()) jk->set_print(options.get_int("PRINT"));
+        if (options["DEBUG"].has_changed()) jk->set_debug(options.get_int("DEBUG"));
+        if (options["BENCH"].has_changed()) jk->set_bench(options.get_int("BENCH"));
+        jk->set_condition(options.get_double("DF_FITTING_CONDITION"));
 
         return std::shared_ptr<JK>(jk);
 
@@ -155,6 +176,9 @@ std::shared_ptr<JK> JK::build_JK(std::shared_ptr<BasisSet> primary, std::shared_
 std::shared_ptr<JK> JK::build_JK(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary,
                                  Options& options, bool do_wK, size_t doubles) {
     std::string jk_type = options.get_str("SCF_TYPE");
+    if (jk_type == "AUTO") {
+        return build_JK(primary, auxiliary, options, select_JK_type(primary, auxiliary, options, do_wK, doubles));
+    }
     if (do_wK && jk_type == "MEM_DF") {  // throw instead of auto fallback?
         std::stringstream error;
         error << "Cannot do SCF_TYPE == 'MEM_DF' and do_wK (yet), please set SCF_TYPE = 'DISK_DF' ";
@@ -47,6 +47,8 @@ class TwoBodyAOInt;
 class Options;
 class PSIO;
 class DFHelper;
+class LocalDFHelper;
+class DFTGrid;
 
 namespace pk {
 class PKManager;
@@ -366,6 +368,19 @@ class PSI_API JK {
     static std::shared_ptr<JK> build_JK(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary,
                                         Options& options, bool do_wK, size_t doubles);
 
+    /**
+    * Picks the JK algorithm (MEM_DF, DISK_DF, PK or DIRECT) predicted to be
+    * fastest for this basis and memory budget, as used by SCF_TYPE AUTO.
+    * Costs are built from operation counts and I/O volume scaled by
+    * nominal throughputs, or ones timed on this machine if SCF_AUTO_BENCHMARK
+    * is set; algorithms that do not fit in memory or on scratch are
+    * excluded. Prints the cost table.
+    * @param doubles memory available to the JK object
+    * @return the selected SCF_TYPE
+    */
+    static std::string select_JK_type(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary,
+                                      Options& options, bool do_wK, size_t doubles);
+
     /// Do we need to backtransform to C1 under the hood?
     virtual bool C1() const = 0;
     virtual std::string name() = 0;
@@ -997,6 +1012,8 @@ class PSI_API MemDFJK : public JK {
 
     /// This class wraps a DFHelper object
     std::shared_ptr<DFHelper> dfh_;
+    /// Pair-atomic fits used instead of dfh_ when local fitting is on
+    std::shared_ptr<LocalDFHelper> ldfh_;
 
     /// Auxiliary basis set
     std::shared_ptr<BasisSet> auxiliary_;
@@ -1004,6 +1021,14 @@ class PSI_API MemDFJK : public JK {
     int df_ints_num_threads_;
     /// Condition cutoff in fitting metric, defaults to 1.0E-12
     double condition_ = 1.0E-12;
+    /// Fit each (mn) only with auxiliary functions near the atoms of m and n?
+    bool local_fitting_ = false;
+    /// Extra radius (bohr) of the local fitting domains
+    double local_radius_ = 0.0;
+    /// Screen the exchange build on localized occupied orbitals?
+    bool sparse_K_ = false;
+    /// Coefficient cutoff of the screened exchange build
+    double sparse_K_tol_ = 1.0E-10;
 
     // => Required Algorithm-Specific Methods <= //
 
@@ -1050,6 +1075,26 @@ class PSI_API MemDFJK : public JK {
      */
     void set_df_ints_num_threads(int val) { df_ints_num_threads_ = val; }
 
+    /**
+     * Use pair-atomic local fitting: each (mn) is fit only with the
+     * auxiliary functions on the atoms of m and n plus any atom within
+     * radius, so the stored tensor grows quadratically with size
+     * @param local turn local fitting on or off, defaults to off
+     * @param radius extra domain radius in bohr, defaults to 0
+     */
+    void set_local_fitting(bool local, double radius = 0.0);
+
+    /**
+     * Build K in batches of (Cholesky-localized) occupied orbitals,
+     * skipping the (Q|mi) rows each batch does not reach
+     * @param sparse turn the screened exchange on or off, defaults to off
+     * @param tol orbital coefficient cutoff, defaults to 1.0E-10
+     */
+    void set_sparse_K(bool sparse, double tol = 1.0E-10) {
+        sparse_K_ = sparse;
+        sparse_K_tol_ = tol;
+    }
+
     // => Accessors <= //
 
     /**
@@ -1059,9 +1104,100 @@ class PSI_API MemDFJK : public JK {
     void print_header() const override;
 
     /**
-     * Returns the DFHelper object
+     * Returns the DFHelper object, throws if local fitting is on
      */
-    std::shared_ptr<DFHelper> dfh() { return dfh_; }
+    std::shared_ptr<DFHelper> dfh();
+    /**
+     * Returns the LocalDFHelper object, null unless local fitting is on
+     */
+    std::shared_ptr<LocalDFHelper> ldfh() { return ldfh_; }
+};
+
+/**
+ * Class COSXJK
+ *
+ * JK implementation pairing density-fitted J (through DFHelper)
+ * with seminumerical chain-of-spheres exchange:
+ *
+ *  K_mn = \sum_g Q_mg \sum_s A_ns(r_g) \sum_l X_gl D_ls
+ *
+ * where X_gl are basis function values on a DFT-style grid,
+ * A_ns(r_g) are one-electron potential integrals at grid point g
+ * and Q = S (X^T W X)^-1 X^T W is the overlap-fitted quadrature.
+ * Work is screened per grid block on the size of X D and on the
+ * distance of each shell pair from the block, so K scales close to
+ * linearly and no three-index tensor is needed for it.
+ */
+class PSI_API COSXJK : public JK {
+   protected:
+    std::string name() override { return "COSXJK"; }
+    size_t memory_estimate() override;
+
+    /// Options reference for the exchange grid
+    Options& options_;
+    /// DFHelper for the Coulomb matrix
+    std::shared_ptr<DFHelper> dfh_;
+    /// Auxiliary basis set
+    std::shared_ptr<BasisSet> auxiliary_;
+    /// Condition cutoff in fitting metric, defaults to 1.0E-12
+    double condition_ = 1.0E-12;
+
+    /// Exchange grid
+    std::shared_ptr<DFTGrid> grid_;
+    /// Significant shell pairs of the primary basis
+    std::shared_ptr<ERISieve> sieve_;
+    /// Overlap fitting correction S (X^T W X)^-1, identity if disabled
+    SharedMatrix fit_;
+    /// Cutoff on |X D| below which a shell drops out of a block
+    double cosx_cutoff_;
+
+    // => Required Algorithm-Specific Methods <= //
+
+    int max_nocc() const;
+    /// Do we need to backtransform to C1 under the hood?
+    bool C1() const override { return true; }
+    /// Setup integrals, files, etc
+    void preiterations() override;
+    /// Compute J/K for current C/D
+    void compute_JK() override;
+    /// Delete integrals, files, etc
+    void postiterations() override;
+
+    /// Seminumerical exchange for each density
+    void build_K(std::vector<SharedMatrix>& D, std::vector<SharedMatrix>& K);
+
+    /// Common initialization
+    void common_init();
+
+   public:
+    // => Constructors < = //
+
+    /**
+     * @param primary primary basis set for this system.
+     * @param auxiliary auxiliary basis set for the Coulomb fit.
+     * @param options Options reference, used for the exchange grid.
+     */
+    COSXJK(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary, Options& options);
+
+    /// Destructor
+    ~COSXJK() override;
+
+    // => Knobs <= //
+
+    /**
+     * Minimum relative eigenvalue to retain in fitting inverse
+     * @param condition minimum relative eigenvalue allowed,
+     *        defaults to 1.0E-12
+     */
+    void set_condition(double condition) { condition_ = condition; }
+
+    // => Accessors <= //
+
+    /**
+    * Print header information regarding JK
+    * type on output file
+    */
+    void print_header() const override;
 };
 }
 #endif
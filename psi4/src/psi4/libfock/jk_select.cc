@@ -0,0 +1,508 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+/*
+ * Automatic selection of the JK algorithm (SCF_TYPE AUTO).
+ *
+ * Each candidate builder gets a predicted wall time of
+ *     setup + niter * iteration
+ * from its operation counts, memory footprint and I/O volume, scaled by
+ * nominal per-thread throughputs (DGEMM, integrals, memory and scratch
+ * bandwidth). The integral rates are weighted by the primitive count of
+ * the basis. The choice thus depends only on the basis, memory and thread
+ * count, and is reproducible; SCF_AUTO_BENCHMARK replaces the nominal
+ * rates with ones timed on this machine. Builders that do not fit in
+ * memory or on scratch are excluded, and the fastest remaining one is
+ * returned.
+ */
+
+#include "jk.h"
+
+#include "psi4/lib3index/dfhelper.h"
+#include "psi4/lib3index/localdf.h"
+#include "psi4/libmints/basisset.h"
+#include "psi4/libmints/integral.h"
+#include "psi4/libmints/molecule.h"
+#include "psi4/libmints/sieve.h"
+#include "psi4/libmints/twobody.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libpsi4util/exception.h"
+#include "psi4/libpsi4util/process.h"
+#include "psi4/libpsio/psio.h"
+#include "psi4/libpsio/psio.hpp"
+#include "psi4/libqt/qt.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace psi {
+
+namespace {
+
+// Typical number of SCF iterations the setup cost is amortized over
+const double kIterations = 15.0;
+// Full-accuracy iterations after a DF_SCF_GUESS preconverged DIRECT run
+const double kDirectAfterGuess = 4.0;
+
+double seconds_since(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nominal throughputs of the cost model. They only have to rank the
+// algorithms, so round numbers for a current server core are used.
+const double kGemmRate = 1.0E10;              // flop/s per thread
+const double kStreamRate = 1.0E9;             // doubles/s per thread
+const double kStreamRateMax = 8.0E9;          // doubles/s, all threads
+const double kDiskWriteRate = 2.0E8;          // bytes/s
+const double kDiskReadRate = 5.0E8;           // bytes/s
+const double kPrimitiveIntegralRate = 2.0E8;  // primitive integrals/s per thread
+
+/// Machine throughputs, nominal or measured once and reused for every later selection
+struct MachineRates {
+    bool measured = false;
+    double gemm = 0.0;        // flop/s, all threads
+    double stream = 0.0;      // doubles/s read from memory, all threads
+    double disk_write = 0.0;  // bytes/s written and synced to scratch
+    double disk_read = 0.0;   // bytes/s read back from scratch
+};
+
+MachineRates nominal_rates(int nthread) {
+    MachineRates rates;
+    rates.gemm = nthread * kGemmRate;
+    rates.stream = std::min(nthread * kStreamRate, kStreamRateMax);
+    rates.disk_write = kDiskWriteRate;
+    rates.disk_read = kDiskReadRate;
+    return rates;
+}
+
+MachineRates& machine_rates() {
+    static MachineRates rates;
+    return rates;
+}
+
+double measure_gemm() {
+    const int n = 512;
+    std::vector<double> A(n * n, 1.0E-3), B(n * n, 2.0E-3), C(n * n, 0.0);
+    double best = std::numeric_limits<double>::max();
+    for (int rep = 0; rep < 3; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        C_DGEMM('N', 'N', n, n, n, 1.0, A.data(), n, B.data(), n, 0.0, C.data(), n);
+        best = std::min(best, seconds_since(start));
+    }
+    return 2.0 * n * n * (double)n / std::max(best, 1.0E-6);
+}
+
+double measure_stream() {
+    const size_t n = 8 * 1024 * 1024;
+    std::vector<double> A(n, 1.0);
+    double best = std::numeric_limits<double>::max();
+    double sum = 0.0;
+    for (int rep = 0; rep < 3; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        double local = 0.0;
+#pragma omp parallel for reduction(+ : local) schedule(static)
+        for (size_t i = 0; i < n; i++) local += A[i];
+        best = std::min(best, seconds_since(start));
+        sum += local;
+    }
+    // Keep the reduction observable
+    volatile double sink = sum;
+    (void)sink;
+    return (double)n / std::max(best, 1.0E-6);
+}
+
+/// Scratch write (synced) and read bandwidth in bytes/s, zero if the file cannot be used
+void measure_disk(const std::string& scratch, double& write, double& read) {
+    write = read = 0.0;
+    std::string filename = scratch + "psi." + psio_getpid() + ".jk_select.bench";
+    const size_t chunk = 1024 * 1024;
+    const size_t nchunk = 32;
+    std::vector<char> buffer(chunk, 'J');
+
+    auto start = std::chrono::steady_clock::now();
+    FILE* fh = std::fopen(filename.c_str(), "wb");
+    if (!fh) return;
+    size_t written = 0;
+    for (size_t i = 0; i < nchunk; i++) written += std::fwrite(buffer.data(), 1, chunk, fh);
+    std::fflush(fh);
+#ifndef _MSC_VER
+    ::fsync(::fileno(fh));
+#ifdef POSIX_FADV_DONTNEED
+    // Drop the pages just written, so the read below comes from the device
+    ::posix_fadvise(::fileno(fh), 0, 0, POSIX_FADV_DONTNEED);
+#endif
+#endif
+    std::fclose(fh);
+    double time = seconds_since(start);
+    if (written == chunk * nchunk) write = (double)written / std::max(time, 1.0E-6);
+
+    // Where the page cache cannot be dropped this overestimates the read bandwidth
+    start = std::chrono::steady_clock::now();
+    fh = std::fopen(filename.c_str(), "rb");
+    if (fh) {
+        size_t nread = 0;
+        for (size_t i = 0; i < nchunk; i++) nread += std::fread(buffer.data(), 1, chunk, fh);
+        std::fclose(fh);
+        time = seconds_since(start);
+        if (nread == chunk * nchunk) read = (double)nread / std::max(time, 1.0E-6);
+    }
+    std::remove(filename.c_str());
+}
+
+/// Free bytes on the scratch filesystem (max if unknown)
+double scratch_free_bytes(const std::string& scratch) {
+#ifndef _MSC_VER
+    struct statvfs fs;
+    if (::statvfs(scratch.c_str(), &fs) == 0) return (double)fs.f_bavail * (double)fs.f_frsize;
+#endif
+    return std::numeric_limits<double>::max();
+}
+
+/// Modeled integrals per second for (MN|RS), one thread: each contracted integral
+/// costs one unit per primitive quartet, averaged over a strided sample of pairs
+double model_eri4(std::shared_ptr<BasisSet> primary, const std::vector<std::pair<int, int>>& pairs) {
+    if (pairs.empty()) return 0.0;
+    size_t stride = std::max<size_t>(1, pairs.size() / 32);
+    double nints = 0.0;
+    double nprims = 0.0;
+    for (size_t MN = 0; MN < pairs.size(); MN += stride) {
+        const GaussianShell& M = primary->shell(pairs[MN].first);
+        const GaussianShell& N = primary->shell(pairs[MN].second);
+        for (size_t RS = 0; RS <= MN; RS += stride) {
+            const GaussianShell& R = primary->shell(pairs[RS].first);
+            const GaussianShell& S = primary->shell(pairs[RS].second);
+            double n = (double)M.nfunction() * N.nfunction() * R.nfunction() * S.nfunction();
+            nints += n;
+            nprims += n * M.nprimitive() * N.nprimitive() * R.nprimitive() * S.nprimitive();
+        }
+    }
+    return kPrimitiveIntegralRate * nints / std::max(nprims, 1.0);
+}
+
+/// Modeled integrals per second for (Q|MN), one thread, as model_eri4
+double model_eri3(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary,
+                  const std::vector<std::pair<int, int>>& pairs) {
+    if (pairs.empty() || auxiliary->nshell() == 0) return 0.0;
+    size_t stride = std::max<size_t>(1, pairs.size() / 64);
+    int Pstride = std::max(1, auxiliary->nshell() / 64);
+    double nints = 0.0;
+    double nprims = 0.0;
+    for (size_t MN = 0; MN < pairs.size(); MN += stride) {
+        const GaussianShell& M = primary->shell(pairs[MN].first);
+        const GaussianShell& N = primary->shell(pairs[MN].second);
+        for (int P = 0; P < auxiliary->nshell(); P += Pstride) {
+            const GaussianShell& Q = auxiliary->shell(P);
+            double n = (double)Q.nfunction() * M.nfunction() * N.nfunction();
+            nints += n;
+            nprims += n * Q.nprimitive() * M.nprimitive() * N.nprimitive();
+        }
+    }
+    return kPrimitiveIntegralRate * nints / std::max(nprims, 1.0);
+}
+
+/// Integrals per second for (MN|RS) over a strided sample of significant shell pairs, one thread
+double measure_eri4(std::shared_ptr<BasisSet> primary, const std::vector<std::pair<int, int>>& pairs) {
+    if (pairs.empty()) return 0.0;
+    IntegralFactory factory(primary, primary, primary, primary);
+    std::unique_ptr<TwoBodyAOInt> eri(factory.eri());
+
+    size_t stride = std::max<size_t>(1, pairs.size() / 32);
+    double nints = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t MN = 0; MN < pairs.size(); MN += stride) {
+        int M = pairs[MN].first;
+        int N = pairs[MN].second;
+        for (size_t RS = 0; RS <= MN; RS += stride) {
+            int R = pairs[RS].first;
+            int S = pairs[RS].second;
+            eri->compute_shell(M, N, R, S);
+            nints += (double)primary->shell(M).nfunction() * primary->shell(N).nfunction() *
+                     primary->shell(R).nfunction() * primary->shell(S).nfunction();
+        }
+        if (seconds_since(start) > 0.5) break;
+    }
+    return nints / std::max(seconds_since(start), 1.0E-6);
+}
+
+/// Integrals per second for (Q|MN) over a strided sample, one thread
+double measure_eri3(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary,
+                    const std::vector<std::pair<int, int>>& pairs) {
+    if (pairs.empty() || auxiliary->nshell() == 0) return 0.0;
+    std::shared_ptr<BasisSet> zero = BasisSet::zero_ao_basis_set();
+    IntegralFactory factory(auxiliary, zero, primary, primary);
+    std::unique_ptr<TwoBodyAOInt> eri(factory.eri());
+
+    size_t stride = std::max<size_t>(1, pairs.size() / 64);
+    int Pstride = std::max(1, auxiliary->nshell() / 64);
+    double nints = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t MN = 0; MN < pairs.size(); MN += stride) {
+        int M = pairs[MN].first;
+        int N = pairs[MN].second;
+        for (int P = 0; P < auxiliary->nshell(); P += Pstride) {
+            eri->compute_shell(P, 0, M, N);
+            nints += (double)auxiliary->shell(P).nfunction() * primary->shell(M).nfunction() *
+                     primary->shell(N).nfunction();
+        }
+        if (seconds_since(start) > 0.5) break;
+    }
+    return nints / std::max(seconds_since(start), 1.0E-6);
+}
+
+struct Candidate {
+    std::string type;
+    bool feasible = true;
+    std::string note;
+    double memory = 0.0;  // doubles
+    double disk = 0.0;    // bytes
+    double setup = 0.0;   // s
+    double iteration = 0.0;  // s
+    double niter = kIterations;
+    double total() const { return setup + niter * iteration; }
+};
+
+}  // namespace
+
+std::string JK::select_JK_type(std::shared_ptr<BasisSet> primary, std::shared_ptr<BasisSet> auxiliary,
+                               Options& options, bool do_wK, size_t doubles) {
+    int nthread = Process::environment.get_n_threads();
+    double cutoff = options.get_double("INTS_TOLERANCE");
+    std::string scratch = PSIOManager::shared_object()->get_default_path();
+    if (!scratch.empty() && scratch.back() != '/') scratch += "/";
+
+    // => Problem size <= //
+
+    double nbf = primary->nbf();
+    double naux = (auxiliary ? auxiliary->nbf() : 0);
+    bool have_aux = naux > 0;
+
+    ERISieve sieve(primary, cutoff);
+    double npair = sieve.function_pairs().size();
+    double npair_full = nbf * (nbf + 1.0) / 2.0;
+
+    std::shared_ptr<Molecule> mol = primary->molecule();
+    double nelectron = -mol->molecular_charge() - primary->n_ecp_core();
+    for (int A = 0; A < mol->natom(); A++) nelectron += mol->Z(A);
+    double nocc = std::max(1.0, std::ceil(nelectron / 2.0));
+
+    // => Machine rates <= //
+
+    // Nominal unless timing was asked for, which makes the choice depend on machine load
+    bool benchmark = options.get_bool("SCF_AUTO_BENCHMARK");
+    MachineRates rates = nominal_rates(nthread);
+    double eri4 = nthread * model_eri4(primary, sieve.shell_pairs());
+    double eri3 = (have_aux ? nthread * model_eri3(primary, auxiliary, sieve.shell_pairs()) : 0.0);
+    if (benchmark) {
+        MachineRates& measured = machine_rates();
+        if (!measured.measured) {
+            measured.gemm = measure_gemm();
+            measured.stream = measure_stream();
+            measure_disk(scratch, measured.disk_write, measured.disk_read);
+            measured.measured = true;
+        }
+        rates = measured;
+        // Integral throughput depends on the basis, so it is remeasured each time
+        eri4 = nthread * measure_eri4(primary, sieve.shell_pairs());
+        eri3 = (have_aux ? nthread * measure_eri3(primary, auxiliary, sieve.shell_pairs()) : 0.0);
+    }
+    double disk_free = scratch_free_bytes(scratch);
+
+    auto per_second = [](double work, double rate) {
+        return (rate > 0.0 ? work / rate : std::numeric_limits<double>::max());
+    };
+
+    std::vector<Candidate> candidates;
+
+    // => MEM_DF: screened (Q|mn) held in core by DFHelper <= //
+    {
+        Candidate c;
+        c.type = "MEM_DF";
+        if (!have_aux) {
+            c.feasible = false;
+            c.note = "no auxiliary basis";
+        } else if (do_wK) {
+            c.feasible = false;
+            c.note = "no wK support";
+        } else {
+            auto jk = std::make_shared<MemDFJK>(primary, auxiliary);
+            jk->set_cutoff(cutoff);
+            bool local = options.exists_in_active("DF_LOCAL_FITTING") && options.get_bool("DF_LOCAL_FITTING");
+            if (local) jk->set_local_fitting(true, options.get_double("DF_LOCAL_FITTING_RADIUS"));
+            std::shared_ptr<JK> base = jk;
+            c.memory = base->memory_estimate();
+
+            if (local) {
+                // Local fitting stores, and contracts, only the pair-atomic fit blocks
+                double nstored = jk->ldfh()->get_fit_size();
+                c.setup = per_second(nstored, eri3) + per_second(2.0 * naux * nstored + naux * naux * naux, rates.gemm);
+                c.iteration = per_second(4.0 * nstored + naux * naux + jk->ldfh()->K_flops(nocc), rates.gemm);
+            } else {
+                double nstored = jk->dfh()->get_AO_size();
+                c.setup = per_second(nstored, eri3) +
+                          per_second(2.0 * naux * naux * nstored + naux * naux * naux, rates.gemm);
+                c.iteration =
+                    per_second(4.0 * nstored + 2.0 * nstored * nocc + 2.0 * nbf * nbf * naux * nocc, rates.gemm);
+            }
+            if (c.memory > doubles) {
+                c.feasible = false;
+                c.note = "exceeds memory";
+            } else if (local) {
+                c.note = std::to_string(jk->ldfh()->npairs()) + " local pairs";
+            } else {
+                c.note = "sparsity " + std::to_string((int)(100.0 * jk->dfh()->ao_sparsity())) + "%";
+            }
+        }
+        candidates.push_back(c);
+    }
+
+    // => DISK_DF: (Q|mn) over significant pairs, in core if it fits, else streamed <= //
+    {
+        Candidate c;
+        c.type = "DISK_DF";
+        if (!have_aux) {
+            c.feasible = false;
+            c.note = "no auxiliary basis";
+        } else {
+            double three = naux * npair * (do_wK ? 3.0 : 1.0);
+            double two = 2.0 * naux * naux;
+            bool core = (three + two <= doubles);
+
+            c.memory = (core ? three + two : doubles);
+            c.disk = (core ? 0.0 : 8.0 * three);
+            c.setup = per_second(naux * npair * (do_wK ? 2.0 : 1.0), eri3) +
+                      per_second(2.0 * naux * naux * npair + naux * naux * naux, rates.gemm) +
+                      per_second(c.disk, rates.disk_write);
+            c.iteration = per_second(4.0 * naux * npair + 4.0 * naux * npair * nocc + 2.0 * nbf * nbf * naux * nocc,
+                                     rates.gemm) +
+                          per_second(c.disk, rates.disk_read);
+            c.note = (core ? "in core" : "on disk");
+            if (!core && c.disk > disk_free) {
+                c.feasible = false;
+                c.note = "exceeds scratch";
+            }
+        }
+        candidates.push_back(c);
+    }
+
+    // => PK: packed supermatrix, in core or on disk <= //
+    {
+        Candidate c;
+        c.type = "PK";
+        double ncorebuf = (do_wK ? 3.0 : 2.0);
+        double pk_size = npair_full * (npair_full + 1.0) / 2.0;
+        bool core = !options.get_bool("PK_NO_INCORE") && (ncorebuf * pk_size < 0.9 * doubles);
+
+        c.memory = (core ? ncorebuf * pk_size : 0.9 * doubles);
+        c.disk = (core ? 0.0 : 8.0 * ncorebuf * pk_size);
+        c.setup = per_second(npair * (npair + 1.0) / 2.0 * (do_wK ? 2.0 : 1.0), eri4) +
+                  per_second(c.disk, rates.disk_write);
+        c.iteration = per_second(ncorebuf * pk_size, rates.stream) + per_second(c.disk, rates.disk_read);
+        c.note = (core ? "in core" : "on disk");
+        if (!core && c.disk > disk_free) {
+            c.feasible = false;
+            c.note = "exceeds scratch";
+        }
+        candidates.push_back(c);
+    }
+
+    // => DIRECT: integrals recomputed every iteration <= //
+    {
+        Candidate c;
+        c.type = "DIRECT";
+        c.memory = 0.0;
+        c.iteration = per_second(npair * (npair + 1.0) / 2.0 * (do_wK ? 2.0 : 1.0), eri4);
+        c.note = "recompute";
+        bool guess = have_aux && (!options.exists_in_active("DF_SCF_GUESS") || options.get_bool("DF_SCF_GUESS"));
+        if (guess) {
+            // Preconverge with the cheaper DF builder, then a few exact iterations
+            double df_total = std::numeric_limits<double>::max();
+            for (const auto& df : candidates) {
+                if (df.feasible && df.type.find("DF") != std::string::npos) df_total = std::min(df_total, df.total());
+            }
+            if (df_total < std::numeric_limits<double>::max()) {
+                c.setup = df_total;
+                c.niter = kDirectAfterGuess;
+                c.note = "DF guess";
+            }
+        }
+        candidates.push_back(c);
+    }
+
+    // => Choice <= //
+
+    const Candidate* best = nullptr;
+    for (const auto& c : candidates) {
+        if (c.feasible && (!best || c.total() < best->total())) best = &c;
+    }
+    if (!best) throw PSIEXCEPTION("JK::select_JK_type: no JK algorithm fits in the available memory and scratch.");
+
+    outfile->Printf("  ==> Automatic JK Selection <==\n\n");
+    outfile->Printf("    Basis functions:     %11.0f\n", nbf);
+    outfile->Printf("    Auxiliary functions: %11.0f\n", naux);
+    outfile->Printf("    Significant pairs:   %11.0f (%5.1f%%)\n", npair, 100.0 * npair / std::max(npair_full, 1.0));
+    outfile->Printf("    Occupied (est.):     %11.0f\n", nocc);
+    outfile->Printf("    Memory:              %11.3f [GiB]\n", 8.0 * doubles / 1073741824.0);
+    outfile->Printf("    Throughputs:         %11s\n", (benchmark ? "measured" : "nominal"));
+    outfile->Printf("    DGEMM:               %11.3f [GFLOP/s]\n", rates.gemm * 1.0E-9);
+    outfile->Printf("    Memory bandwidth:    %11.3f [GB/s]\n", 8.0 * rates.stream * 1.0E-9);
+    outfile->Printf("    Scratch write:       %11.3f [MB/s]\n", rates.disk_write * 1.0E-6);
+    outfile->Printf("    Scratch read:        %11.3f [MB/s]\n", rates.disk_read * 1.0E-6);
+    outfile->Printf("    4-index integrals:   %11.3e [1/s]\n", eri4);
+    outfile->Printf("    3-index integrals:   %11.3e [1/s]\n\n", eri3);
+
+    outfile->Printf("    %-8s %10s %10s %10s %10s %10s  %s\n", "Type", "Mem [GiB]", "Disk [GiB]", "Setup [s]",
+                    "Iter [s]", "Total [s]", "Note");
+    for (const auto& c : candidates) {
+        if (c.note == "no auxiliary basis" || c.note == "no wK support") {
+            outfile->Printf("    %-8s %10s %10s %10s %10s %10s  %s\n", c.type.c_str(), "-", "-", "-", "-", "-",
+                            c.note.c_str());
+            continue;
+        }
+        outfile->Printf("    %-8s %10.3f %10.3f %10.3f %10.3f %10.3f  %s%s\n", c.type.c_str(),
+                        8.0 * c.memory / 1073741824.0, c.disk / 1073741824.0, c.setup, c.iteration, c.total(),
+                        c.note.c_str(), (&c == best ? " <==" : ""));
+    }
+    outfile->Printf("\n    SCF_TYPE AUTO selected %s.\n\n", best->type.c_str());
+
+    return best->type;
+}
+
+}  // namespace psi
@@ -32,9 +32,12 @@
 */
 #include <cstdio>
 #include <cstdlib>
+#include <string>
 #include "psi4/libpsio/psio.h"
 #include "iwl.h"
 #include "iwl.hpp"
+#include "sorted.hpp"
+#include "psi4/libpsi4util/exception.h"
 #include "psi4/psi4-dec.h"  //need outfile
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsi4util/process.h"
@@ -80,6 +83,11 @@ void IWL::init(PSIO *psio, int it, double coff, int oldfile, int readflag) {
     /*! Note that we assume that if oldfile isn't set, we O_CREAT the file */
     psio_->open(itap_, oldfile ? PSIO_OPEN_OLD : PSIO_OPEN_NEW);
     if (oldfile && (psio_->tocscan(itap_, IWL_KEY_BUF) == nullptr)) {
+        if (psio_->tocscan(itap_, SIWL_KEY_HEADER) != nullptr) {
+            psio_->close(itap_, 1);
+            throw PSIEXCEPTION("IWL: file " + std::to_string(itap_) +
+                               " holds sorted integrals; this module needs SO_TEI_FORMAT IWL.");
+        }
         outfile->Printf("iwl_buf_init: Can't open file %d\n", itap_);
         psio_->close(itap_, 0);
         return;
@@ -126,6 +134,11 @@ void PSI_API iwl_buf_init(struct iwlbuf *Buf, int itape, double cutoff, int oldf
     /*! Note that we assume that if oldfile isn't set, we O_CREAT the file */
     psio_open(Buf->itap, oldfile ? PSIO_OPEN_OLD : PSIO_OPEN_NEW);
     if (oldfile && (psio_tocscan(Buf->itap, IWL_KEY_BUF) == nullptr)) {
+        if (psio_tocscan(Buf->itap, SIWL_KEY_HEADER) != nullptr) {
+            psio_close(Buf->itap, 1);
+            throw PSIEXCEPTION("iwl_buf_init: file " + std::to_string(Buf->itap) +
+                               " holds sorted integrals; this module needs SO_TEI_FORMAT IWL.");
+        }
         outfile->Printf("iwl_buf_init: Can't open file %d\n", Buf->itap);
         psio_close(Buf->itap, 0);
         return;
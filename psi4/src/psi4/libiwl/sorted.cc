@@ -0,0 +1,290 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+/*!
+  \file
+  \ingroup IWL
+*/
+#include "sorted.hpp"
+
+#include "psi4/libpsio/psio.h"
+#include "psi4/libpsi4util/exception.h"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace psi {
+
+namespace {
+
+void put_varint(uint64_t n, std::vector<unsigned char> &bytes) {
+    while (n >= 0x80) {
+        bytes.push_back(static_cast<unsigned char>(n | 0x80));
+        n >>= 7;
+    }
+    bytes.push_back(static_cast<unsigned char>(n));
+}
+
+uint64_t get_varint(const unsigned char *&ptr) {
+    uint64_t n = 0;
+    int shift = 0;
+    while (*ptr & 0x80) {
+        n |= static_cast<uint64_t>(*ptr++ & 0x7f) << shift;
+        shift += 7;
+    }
+    n |= static_cast<uint64_t>(*ptr++) << shift;
+    return n;
+}
+
+/// Inverts the lower triangular pair index pq = p * (p + 1) / 2 + q
+void unpack_pair(uint64_t pq, int &p, int &q) {
+    p = static_cast<int>((std::sqrt(8.0 * static_cast<double>(pq) + 1.0) - 1.0) / 2.0);
+    while (static_cast<uint64_t>(p) * (p + 1) / 2 > pq) --p;
+    while (static_cast<uint64_t>(p + 1) * (p + 2) / 2 <= pq) ++p;
+    q = static_cast<int>(pq - static_cast<uint64_t>(p) * (p + 1) / 2);
+}
+
+}  // namespace
+
+SortedIntegralWriter::SortedIntegralWriter(PSIO *psio, int unit, int nbf, double cutoff, size_t memory,
+                                           int scratch_unit)
+    : psio_(psio),
+      unit_(unit),
+      scratch_unit_(scratch_unit),
+      nbf_(nbf),
+      npair_(static_cast<size_t>(nbf) * (nbf + 1) / 2),
+      cutoff_(cutoff),
+      count_(0),
+      closed_(false),
+      next_block_(PSIO_ZERO) {
+    // Each record is a key and a value, i.e. two doubles' worth
+    max_buffer_ = std::max(memory / 2, static_cast<size_t>(SIWL_INTS_PER_BLOCK));
+    psio_->open(unit_, PSIO_OPEN_NEW);
+}
+
+SortedIntegralWriter::~SortedIntegralWriter() {
+    if (!closed_) close();
+}
+
+void SortedIntegralWriter::write_value(int p, int q, int r, int s, double value) {
+    if (std::fabs(value) < cutoff_) return;
+    if (p < q) std::swap(p, q);
+    if (r < s) std::swap(r, s);
+    uint64_t pq = static_cast<uint64_t>(p) * (p + 1) / 2 + q;
+    uint64_t rs = static_cast<uint64_t>(r) * (r + 1) / 2 + s;
+    if (pq < rs) std::swap(pq, rs);
+    buffer_.push_back({pq * npair_ + rs, value});
+    ++count_;
+    if (buffer_.size() >= max_buffer_) write_run();
+}
+
+void SortedIntegralWriter::write_run() {
+    if (buffer_.empty()) return;
+    if (runs_.empty()) psio_->open(scratch_unit_, PSIO_OPEN_NEW);
+    std::sort(buffer_.begin(), buffer_.end());
+    size_t start = 0;
+    for (size_t len : runs_) start += len * sizeof(Record);
+    psio_address next = psio_get_address(PSIO_ZERO, start);
+    psio_->write(scratch_unit_, SIWL_KEY_RUN, (char *)buffer_.data(), buffer_.size() * sizeof(Record), next, &next);
+    runs_.push_back(buffer_.size());
+    buffer_.clear();
+}
+
+void SortedIntegralWriter::add_sorted(const Record &record) {
+    pending_.push_back(record);
+    if (pending_.size() == SIWL_INTS_PER_BLOCK) write_block();
+}
+
+void SortedIntegralWriter::write_block() {
+    if (pending_.empty()) return;
+
+    size_t nints = pending_.size();
+    block_.resize(nints * sizeof(double));
+    auto *values = reinterpret_cast<double *>(block_.data());
+    for (size_t n = 0; n < nints; ++n) values[n] = pending_[n].value;
+    uint64_t last = pending_[0].key;
+    for (const auto &record : pending_) {
+        put_varint(record.key - last, block_);
+        last = record.key;
+    }
+
+    SortedIntegralBlock block;
+    block.first_key = pending_.front().key;
+    block.last_key = pending_.back().key;
+    block.nints = nints;
+    block.offset = index_.empty() ? 0 : index_.back().offset + index_.back().nbytes;
+    block.nbytes = block_.size();
+    index_.push_back(block);
+
+    psio_->write(unit_, SIWL_KEY_BLOCKS, (char *)block_.data(), block_.size(), next_block_, &next_block_);
+    pending_.clear();
+}
+
+void SortedIntegralWriter::close() {
+    if (closed_) return;
+    closed_ = true;
+
+    if (runs_.empty()) {
+        std::sort(buffer_.begin(), buffer_.end());
+        for (const auto &record : buffer_) add_sorted(record);
+    } else {
+        // Merge the sorted runs, streaming a chunk of each run through memory at a time
+        write_run();
+        size_t nruns = runs_.size();
+        size_t chunk = std::max(max_buffer_ / nruns, static_cast<size_t>(1024));
+        std::vector<std::vector<Record>> chunks(nruns);
+        std::vector<size_t> left(runs_), pos(nruns, 0);
+        std::vector<psio_address> next(nruns);
+        size_t start = 0;
+        for (size_t run = 0; run < nruns; ++run) {
+            next[run] = psio_get_address(PSIO_ZERO, start);
+            start += runs_[run] * sizeof(Record);
+        }
+        auto refill = [&](size_t run) {
+            size_t n = std::min(chunk, left[run]);
+            chunks[run].resize(n);
+            psio_->read(scratch_unit_, SIWL_KEY_RUN, (char *)chunks[run].data(), n * sizeof(Record), next[run],
+                        &next[run]);
+            left[run] -= n;
+            pos[run] = 0;
+        };
+
+        using Head = std::pair<uint64_t, size_t>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        for (size_t run = 0; run < nruns; ++run) {
+            refill(run);
+            heads.push({chunks[run][0].key, run});
+        }
+        while (!heads.empty()) {
+            size_t run = heads.top().second;
+            heads.pop();
+            add_sorted(chunks[run][pos[run]++]);
+            if (pos[run] == chunks[run].size()) {
+                if (!left[run]) continue;
+                refill(run);
+            }
+            heads.push({chunks[run][pos[run]].key, run});
+        }
+        psio_->close(scratch_unit_, 0);
+    }
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    write_block();
+
+    SortedIntegralHeader header;
+    header.nbf = nbf_;
+    header.npair = npair_;
+    header.nints = count_;
+    header.nblocks = index_.size();
+    header.cutoff = cutoff_;
+    psio_->write_entry(unit_, SIWL_KEY_HEADER, (char *)&header, sizeof(SortedIntegralHeader));
+    if (index_.size())
+        psio_->write_entry(unit_, SIWL_KEY_INDEX, (char *)index_.data(),
+                           index_.size() * sizeof(SortedIntegralBlock));
+    psio_->close(unit_, 1);
+}
+
+SortedIntegralReader::SortedIntegralReader(PSIO *psio, int unit) : psio_(psio), unit_(unit), keep_(true) {
+    psio_->open(unit_, PSIO_OPEN_OLD);
+    if (!psio_->tocentry_exists(unit_, SIWL_KEY_HEADER)) {
+        psio_->close(unit_, 1);
+        throw PSIEXCEPTION("SortedIntegralReader: file " + std::to_string(unit) +
+                           " does not hold integrals in the sorted format.");
+    }
+    psio_->read_entry(unit_, SIWL_KEY_HEADER, (char *)&header_, sizeof(SortedIntegralHeader));
+    index_.resize(header_.nblocks);
+    if (header_.nblocks)
+        psio_->read_entry(unit_, SIWL_KEY_INDEX, (char *)index_.data(),
+                          header_.nblocks * sizeof(SortedIntegralBlock));
+}
+
+SortedIntegralReader::~SortedIntegralReader() { close(); }
+
+void SortedIntegralReader::close() {
+    if (psio_->open_check(unit_)) psio_->close(unit_, keep_);
+}
+
+bool SortedIntegralReader::is_sorted_file(PSIO *psio, int unit) {
+    if (psio->open_check(unit)) return psio->tocentry_exists(unit, SIWL_KEY_HEADER);
+    if (!psio->exists(unit)) return false;
+    psio->open(unit, PSIO_OPEN_OLD);
+    bool sorted = psio->tocentry_exists(unit, SIWL_KEY_HEADER);
+    psio->close(unit, 1);
+    return sorted;
+}
+
+size_t SortedIntegralReader::first_block(size_t pq) const {
+    // The blocks are sorted, so find the first one whose last key lies in, or after, row pq
+    uint64_t key = static_cast<uint64_t>(pq) * header_.npair;
+    auto it = std::lower_bound(index_.begin(), index_.end(), key,
+                               [](const SortedIntegralBlock &block, uint64_t k) { return block.last_key < k; });
+    return static_cast<size_t>(it - index_.begin());
+}
+
+void SortedIntegralReader::read_block(size_t b, std::vector<unsigned char> &raw) {
+    const SortedIntegralBlock &block = index_[b];
+    raw.resize(block.nbytes);
+    psio_address start = psio_get_address(PSIO_ZERO, block.offset);
+    psio_address end;
+    psio_->read(unit_, SIWL_KEY_BLOCKS, (char *)raw.data(), block.nbytes, start, &end);
+}
+
+void SortedIntegralReader::decode_block(size_t b, const std::vector<unsigned char> &raw,
+                                        std::vector<SortedIntegral> &ints) const {
+    const SortedIntegralBlock &block = index_[b];
+    ints.resize(block.nints);
+    const auto *values = reinterpret_cast<const double *>(raw.data());
+    const unsigned char *ptr = raw.data() + block.nints * sizeof(double);
+    uint64_t key = block.first_key;
+    for (size_t n = 0; n < block.nints; ++n) {
+        key += get_varint(ptr);
+        SortedIntegral &in = ints[n];
+        unpack_pair(key / header_.npair, in.p, in.q);
+        unpack_pair(key % header_.npair, in.r, in.s);
+        in.value = values[n];
+    }
+}
+
+void SortedIntegralReader::read_blocks(size_t first, size_t n, std::vector<std::vector<SortedIntegral>> &ints,
+                                       int nthreads) {
+    // libpsio is not thread-safe, so the reads are serial; only the decoding is spread over threads
+    std::vector<std::vector<unsigned char>> raw(n);
+    for (size_t i = 0; i < n; ++i) read_block(first + i, raw[i]);
+    if (ints.size() < n) ints.resize(n);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for (size_t i = 0; i < n; ++i) decode_block(first + i, raw[i], ints[i]);
+}
+
+}  // namespace psi
@@ -0,0 +1,188 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _psi_src_lib_libiwl_sorted_hpp_
+#define _psi_src_lib_libiwl_sorted_hpp_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "psi4/libpsio/psio.hpp"
+
+namespace psi {
+
+/*
+ * A compact alternative to the IWL format for two-electron integrals.
+ *
+ * Integrals are stored once, in canonical order: p >= q, r >= s and pq >= rs,
+ * sorted by the composite key pq * npair + rs. The sorted stream is cut into
+ * blocks; each block holds its values followed by the varint-encoded key
+ * differences, so that a label costs one or two bytes instead of the eight bytes
+ * used by IWL. A block index with the key range of every block is kept in a
+ * separate TOC entry, allowing random access to any range of pq and independent
+ * (thread-parallel) decoding of blocks.
+ */
+
+#define SIWL_KEY_HEADER "Sorted Integral Header"
+#define SIWL_KEY_INDEX "Sorted Integral Block Index"
+#define SIWL_KEY_BLOCKS "Sorted Integral Blocks"
+#define SIWL_KEY_RUN "Sorted Integral Run"
+
+#define SIWL_INTS_PER_BLOCK 8192
+
+struct SortedIntegral {
+    int p, q, r, s;
+    double value;
+};
+
+struct SortedIntegralHeader {
+    int nbf;
+    size_t npair;
+    size_t nints;
+    size_t nblocks;
+    double cutoff;
+};
+
+struct SortedIntegralBlock {
+    /// The composite keys pq * npair + rs of the first and last integrals in the block
+    uint64_t first_key;
+    uint64_t last_key;
+    /// The number of integrals in the block
+    size_t nints;
+    /// The location and length of the block in the SIWL_KEY_BLOCKS entry, in bytes
+    size_t offset;
+    size_t nbytes;
+};
+
+class PSI_API SortedIntegralWriter {
+    PSIO *psio_;
+    /// The file holding the sorted integrals
+    int unit_;
+    /// The file used to hold sorted runs when the integrals do not fit in memory
+    int scratch_unit_;
+    int nbf_;
+    size_t npair_;
+    double cutoff_;
+    /// The number of integrals held in memory before a sorted run is written out
+    size_t max_buffer_;
+    size_t count_;
+    bool closed_;
+
+    struct Record {
+        uint64_t key;
+        double value;
+        bool operator<(const Record &other) const { return key < other.key; }
+    };
+    std::vector<Record> buffer_;
+    /// The length of each sorted run in the scratch file
+    std::vector<size_t> runs_;
+
+    std::vector<SortedIntegralBlock> index_;
+    std::vector<unsigned char> block_;
+    std::vector<Record> pending_;
+    psio_address next_block_;
+
+    void write_run();
+    void add_sorted(const Record &record);
+    void write_block();
+
+   public:
+    /**
+     * @param psio         the libpsio instance to use
+     * @param unit         the file to write; it is created anew
+     * @param nbf          the number of orbitals spanned by the labels
+     * @param cutoff       integrals smaller than this in magnitude are dropped
+     * @param memory       the number of doubles that may be used for sorting
+     * @param scratch_unit the file used for the sorted runs, if the integrals don't fit in memory
+     */
+    SortedIntegralWriter(PSIO *psio, int unit, int nbf, double cutoff, size_t memory, int scratch_unit);
+    ~SortedIntegralWriter();
+
+    /// Adds (pq|rs); the labels may be given in any of the eight equivalent orders
+    void write_value(int p, int q, int r, int s, double value);
+    /// Merges the sorted runs, writes the blocks and the block index, and closes the file
+    void close();
+
+    size_t count() const { return count_; }
+    /// The number of sorted runs spilled to the scratch file (zero if everything fit in memory)
+    size_t nruns() const { return runs_.size(); }
+};
+
+class PSI_API SortedIntegralReader {
+    PSIO *psio_;
+    int unit_;
+    bool keep_;
+    SortedIntegralHeader header_;
+    std::vector<SortedIntegralBlock> index_;
+
+   public:
+    SortedIntegralReader(PSIO *psio, int unit);
+    ~SortedIntegralReader();
+
+    /// Whether unit holds integrals in the sorted format
+    static bool is_sorted_file(PSIO *psio, int unit);
+
+    int nbf() const { return header_.nbf; }
+    size_t nints() const { return header_.nints; }
+    size_t nblocks() const { return header_.nblocks; }
+    const SortedIntegralBlock &block(size_t b) const { return index_[b]; }
+    /// The first block that contains integrals with a canonical bra index of at least pq
+    size_t first_block(size_t pq) const;
+
+    /// Reads the raw contents of block b
+    void read_block(size_t b, std::vector<unsigned char> &raw);
+    /// Decodes the raw contents of block b.  This does not touch the file, so it's safe to call from many threads
+    void decode_block(size_t b, const std::vector<unsigned char> &raw, std::vector<SortedIntegral> &ints) const;
+    /// Reads blocks [first, first + n) one after another, and decodes them in parallel
+    void read_blocks(size_t first, size_t n, std::vector<std::vector<SortedIntegral>> &ints, int nthreads);
+
+    /**
+     * Calls fn(p, q, r, s, value) for every integral whose canonical bra index is
+     * at least first_pq (plus, possibly, a few from the block straddling first_pq),
+     * in sorted order.
+     */
+    template <class Functor>
+    void for_each(Functor &fn, size_t first_pq = 0, int nthreads = 1) {
+        std::vector<std::vector<SortedIntegral>> ints;
+        size_t batch = 4 * static_cast<size_t>(nthreads > 0 ? nthreads : 1);
+        for (size_t b = first_block(first_pq); b < nblocks(); b += batch) {
+            size_t n = std::min(batch, nblocks() - b);
+            read_blocks(b, n, ints, nthreads);
+            for (size_t i = 0; i < n; ++i)
+                for (const auto &in : ints[i]) fn(in.p, in.q, in.r, in.s, in.value);
+        }
+    }
+
+    void set_keep_flag(bool k) { keep_ = k; }
+    void close();
+};
+}  // namespace psi
+
+#endif
@@ -46,8 +46,11 @@
 #include "pointgrp.h"
 #include "wavefunction.h"
 #include "coordentry.h"
+#include "matrix.h"
 #include "psi4/libpsi4util/process.h"
 
+#include "gau2grid/gau2grid.h"
+
 #include <memory>
 #include <regex>
 #include <stdexcept>
@@ -56,6 +59,11 @@
 #include <cmath>
 #include <map>
 #include <list>
+#include <algorithm>
+#include <limits>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace psi;
 
@@ -1210,3 +1218,212 @@ void BasisSet::compute_phi(double *phi_ao, double x, double y, double z) {
         ao += INT_NCART(am);
     }  // nshell
 }
+
+std::vector<double> BasisSet::shell_extents(double delta) const {
+    // Here we assume the absolute spherical basis functions
+    // |\phi|_P(r) = |C_k| r^l exp(-a_k r^2)
+
+    // We are trying to zero the objective function
+    // O(r) = |\phi|_P(r) - \delta
+
+    // Bisection is used to avoid accidentally finding the
+    // nuclear cusp for p and higher functions
+
+    std::vector<double> Rp(n_shells_);
+
+    // Compute each shell in turn
+    for (int P = 0; P < n_shells_; P++) {
+        // Corner case: \delta = 0.0
+        if (delta == 0.0) {
+            Rp[P] = std::numeric_limits<double>::max();
+            continue;
+        }
+
+        // Stage 1: Collect information on the shell
+        const GaussianShell &Pshell = shells_[P];
+        int l = Pshell.am();
+        int nprim = Pshell.nprimitive();
+        const double *alpha = Pshell.exps();
+        const double *norm = Pshell.coefs();
+
+        // Stage 2: Form a well-posed bounding box for R
+
+        // A: Force O at the right end of the box to be negative
+
+        // Take a crude guess based on most-diffuse exponent
+        // Removing nonlinearity with R0 = 10.0 a.u.
+        double Rr = 2.0;
+        double Or = 0.0;
+        do {
+            // Compute Or
+            Or = 0.0;
+            for (int K = 0; K < nprim; K++) {
+                Or += std::fabs(norm[K]) * pow(Rr, l) * exp(-alpha[K] * Rr * Rr);
+            }
+            Or = std::fabs(Or) - delta;
+
+            // Move further right
+            if (Or > 0.0) Rr *= 2.0;
+
+        } while (Or > 0.0);
+
+        // B: Force O at the left end of the box to be positive
+        double Rl = Rr;  // We know this is negative due to Rr
+        double Ol = 0.0;
+        do {
+            // Compute Ol
+            Ol = 0.0;
+            for (int K = 0; K < nprim; K++) {
+                Ol += std::fabs(norm[K]) * pow(Rl, l) * exp(-alpha[K] * Rl * Rl);
+            }
+            Ol = std::fabs(Ol) - delta;
+
+            // Move further left
+            if (Ol < 0.0) Rl /= 2.0;
+
+            // Check if we missed the positive bit in the middle somehow
+            if (std::fabs(Rl) == 0.0) {
+                throw PSIEXCEPTION(
+                    "BasisExtents: Left root of basis cutoffs found the nuclear cusp.\n"
+                    "This is very bad.");
+            }
+
+        } while (Ol < 0.0);
+
+        // Stage 3: Locate R via bisection
+        double Rc, Oc;
+        do {
+            Rc = 0.5 * (Rl + Rr);
+            Oc = 0.0;
+            for (int K = 0; K < nprim; K++) {
+                Oc += std::fabs(norm[K]) * pow(Rc, l) * exp(-alpha[K] * Rc * Rc);
+            }
+            Oc = std::fabs(Oc) - delta;
+
+            if (Oc > 0.0) {
+                Rl = Rc;
+                Ol = Oc;
+            } else {
+                Rr = Rc;
+                Or = Oc;
+            }
+            // My MechE profs would disapprove of this cutoff.
+        } while (std::fabs(Rr - Rl) > 1.0E-8 * Rl && std::fabs(Oc) != 0.0);
+
+        // Assign the calculated value
+        Rp[P] = Rc;
+    }
+
+    return Rp;
+}
+
+void BasisSet::compute_phi_batch(size_t npoints, const double *x, const double *y, const double *z, double **phi,
+                                 int deriv, double delta, int block_size) const {
+    if (deriv < 0 || deriv > 1) throw PSIEXCEPTION("BasisSet::compute_phi_batch: deriv must be 0 or 1.");
+    if (block_size < 1) throw PSIEXCEPTION("BasisSet::compute_phi_batch: block_size must be positive.");
+
+    const int nvalue = (deriv == 0 ? 1 : 4);
+    const size_t nbasis = nbf_;
+    const int max_nfunc = max_function_per_shell();
+    const int order = puream_ ? GG_SPHERICAL_GAUSSIAN : GG_CARTESIAN_CCA;
+    const std::vector<double> extents = shell_extents(delta);
+    const size_t nblock = (npoints + block_size - 1) / block_size;
+
+    int nthread = 1;
+#ifdef _OPENMP
+    nthread = Process::environment.get_n_threads();
+#endif
+
+#pragma omp parallel num_threads(nthread)
+    {
+        // gau2grid takes the coordinates as x, y and z blocks, and returns the values function-major
+        std::vector<double> xyz(3 * block_size);
+        std::vector<double> values(nvalue * max_nfunc * block_size);
+
+#pragma omp for schedule(dynamic)
+        for (size_t block = 0; block < nblock; block++) {
+            size_t start = block * block_size;
+            size_t npts = std::min<size_t>(block_size, npoints - start);
+
+            // Bounding sphere of the block: mean center and maximum spread
+            double xc[3] = {0.0, 0.0, 0.0};
+            for (size_t Q = 0; Q < npts; Q++) {
+                xyz[Q] = x[start + Q];
+                xyz[npts + Q] = y[start + Q];
+                xyz[2 * npts + Q] = z[start + Q];
+                xc[0] += x[start + Q];
+                xc[1] += y[start + Q];
+                xc[2] += z[start + Q];
+            }
+            xc[0] /= npts;
+            xc[1] /= npts;
+            xc[2] /= npts;
+            double R2 = 0.0;
+            for (size_t Q = 0; Q < npts; Q++) {
+                double dx = xyz[Q] - xc[0];
+                double dy = xyz[npts + Q] - xc[1];
+                double dz = xyz[2 * npts + Q] - xc[2];
+                R2 = std::max(R2, dx * dx + dy * dy + dz * dz);
+            }
+            double R = std::sqrt(R2);
+
+            for (int v = 0; v < nvalue; v++) {
+                std::fill(phi[v] + start * nbasis, phi[v] + (start + npts) * nbasis, 0.0);
+            }
+
+            for (int P = 0; P < n_shells_; P++) {
+                const GaussianShell &shell = shells_[P];
+                const double *center = shell.center();
+                double dx = center[0] - xc[0];
+                double dy = center[1] - xc[1];
+                double dz = center[2] - xc[2];
+                if (std::sqrt(dx * dx + dy * dy + dz * dz) > R + extents[P]) continue;
+
+                int nfunc = shell.nfunction();
+                double *phi_start = values.data();
+                if (deriv == 0) {
+                    gg_collocation(shell.am(), npts, xyz.data(), 1, shell.nprimitive(), shell.coefs(), shell.exps(),
+                                   center, order, phi_start);
+                } else {
+                    gg_collocation_deriv1(shell.am(), npts, xyz.data(), 1, shell.nprimitive(), shell.coefs(),
+                                          shell.exps(), center, order, phi_start, phi_start + nfunc * npts,
+                                          phi_start + 2 * nfunc * npts, phi_start + 3 * nfunc * npts);
+                }
+
+                size_t offset = shell.function_index();
+                for (int v = 0; v < nvalue; v++) {
+                    const double *vals = phi_start + v * nfunc * npts;
+                    for (size_t Q = 0; Q < npts; Q++) {
+                        double *row = phi[v] + (start + Q) * nbasis + offset;
+                        for (int f = 0; f < nfunc; f++) row[f] = vals[f * npts + Q];
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::vector<SharedMatrix> BasisSet::compute_phi_batch(SharedMatrix points, int deriv, double delta,
+                                                      int block_size) const {
+    if (points->nirrep() != 1 || points->colspi()[0] != 3)
+        throw PSIEXCEPTION("BasisSet::compute_phi_batch: points must be an npoints x 3 matrix.");
+
+    size_t npoints = points->rowspi()[0];
+    double **pp = points->pointer();
+    std::vector<double> x(npoints), y(npoints), z(npoints);
+    for (size_t Q = 0; Q < npoints; Q++) {
+        x[Q] = pp[Q][0];
+        y[Q] = pp[Q][1];
+        z[Q] = pp[Q][2];
+    }
+
+    std::vector<std::string> names = {"PHI", "PHI_X", "PHI_Y", "PHI_Z"};
+    std::vector<SharedMatrix> phi;
+    std::vector<double *> phip;
+    for (int v = 0; v < (deriv == 0 ? 1 : 4); v++) {
+        phi.push_back(std::make_shared<Matrix>(names[v], npoints, nbf_));
+        phip.push_back(npoints ? phi[v]->pointer()[0] : nullptr);
+    }
+    if (npoints) compute_phi_batch(npoints, x.data(), y.data(), z.data(), phip.data(), deriv, delta, block_size);
+    return phi;
+}
@@ -392,6 +392,33 @@ class PSI_API BasisSet {
     void move_atom(int atom, const Vector3 &trans);
     // Returns the values of the basis functions at a point
     void compute_phi(double *phi_ao, double x, double y, double z);
+
+    /** Computes the significant extent of each shell.
+     * @param delta Cutoff for the absolute radial part of the shell's functions
+     * @return The radius beyond which every function of the shell is below delta
+     *         (unbounded for delta = 0.0)
+     */
+    std::vector<double> shell_extents(double delta) const;
+
+    /** Evaluates the basis functions, and optionally their gradients, at a batch of points.
+     *  The points are split into blocks that are processed in parallel; shells whose extent
+     *  (see shell_extents) does not reach a block are skipped.  Values are given in the nbf
+     *  basis, i.e. over spherical harmonics for pure basis sets.
+     * @param npoints Number of points
+     * @param x, y, z Coordinates of the points (bohr)
+     * @param phi Row-major npoints x nbf output arrays; phi[0] for the values and, for deriv = 1,
+     *        phi[1..3] for the x, y and z derivatives
+     * @param deriv 0 for values only, 1 for values and gradients
+     * @param delta Basis function cutoff used for the screening
+     * @param block_size Number of points per block
+     */
+    void compute_phi_batch(size_t npoints, const double *x, const double *y, const double *z, double **phi,
+                           int deriv = 0, double delta = 1.0E-12, int block_size = 128) const;
+    /** Evaluates the basis functions at the rows of an npoints x 3 matrix of coordinates.
+     * @return {PHI} for deriv = 0 or {PHI, PHI_X, PHI_Y, PHI_Z} for deriv = 1, each npoints x nbf
+     */
+    std::vector<SharedMatrix> compute_phi_batch(SharedMatrix points, int deriv = 0, double delta = 1.0E-12,
+                                                int block_size = 128) const;
     
    private: 
     /// Helper functions for frozen core to reduce LOC
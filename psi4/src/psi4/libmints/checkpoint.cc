@@ -0,0 +1,532 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "psi4/libmints/checkpoint.h"
+#include "psi4/libmints/basisset.h"
+#include "psi4/libmints/matrix.h"
+#include "psi4/libmints/molecule.h"
+#include "psi4/libmints/pointgrp.h"
+#include "psi4/libmints/vector.h"
+#include "psi4/libmints/wavefunction.h"
+#include "psi4/libpsi4util/exception.h"
+
+namespace psi {
+
+namespace {
+
+// File layout (all integers little-endian as written by the host, checked via kByteOrder):
+//   [header, 64 bytes][toc, nentry x 64 bytes][sections, each 64-byte aligned]
+const char kMagic[8] = {'P', 'S', 'I', '4', 'C', 'H', 'K', '\0'};
+const uint32_t kByteOrder = 0x01020304;
+const size_t kHeaderSize = 64;
+const size_t kEntrySize = 64;
+const size_t kLabelSize = 32;
+const size_t kAlignment = 64;
+
+enum Layout : uint32_t { RowMajor = 0, ColumnMajor = 1 };
+
+size_t align_up(size_t n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+
+template <typename T>
+void put(std::vector<char> &buf, size_t pos, T value) {
+    std::memcpy(buf.data() + pos, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const char *buf, size_t pos) {
+    T value;
+    std::memcpy(&value, buf + pos, sizeof(T));
+    return value;
+}
+
+/// One pending section of the checkpoint; the payload is only serialized when the file is written
+struct Section {
+    std::string label;
+    uint32_t kind;
+    uint32_t layout;
+    uint32_t symmetry;
+    std::vector<int64_t> ints;  // Integers payload, or the dimension prefix of vectors/matrices
+    double value;
+    SharedVector vec;
+    SharedMatrix mat;
+    int alias;  // Index of an earlier section holding identical data, -1 if none
+    uint64_t offset;
+    uint64_t nbytes;
+
+    Section(const std::string &l, uint32_t k)
+        : label(l), kind(k), layout(RowMajor), symmetry(0), value(0.0), alias(-1), offset(0), nbytes(0) {}
+
+    uint32_t nirrep() const {
+        if (kind == CheckpointReader::VectorData) return vec->nirrep();
+        if (kind == CheckpointReader::MatrixData) return mat->nirrep();
+        if (kind == CheckpointReader::Integers) return ints.size();
+        return 1;
+    }
+
+    void size() {
+        if (kind == CheckpointReader::Scalar) {
+            nbytes = sizeof(double);
+        } else if (kind == CheckpointReader::Integers) {
+            nbytes = ints.size() * sizeof(int64_t);
+        } else if (kind == CheckpointReader::VectorData) {
+            nbytes = vec->nirrep() * sizeof(int64_t) + vec->dimpi().sum() * sizeof(double);
+        } else {
+            size_t n = 0;
+            for (int h = 0; h < mat->nirrep(); ++h) n += (size_t)mat->rowspi()[h] * mat->colspi()[h ^ symmetry];
+            nbytes = 2 * mat->nirrep() * sizeof(int64_t) + n * sizeof(double);
+        }
+    }
+
+    void write(FILE *fh) const {
+        if (kind == CheckpointReader::Scalar) {
+            std::fwrite(&value, sizeof(double), 1, fh);
+        } else if (kind == CheckpointReader::Integers) {
+            std::fwrite(ints.data(), sizeof(int64_t), ints.size(), fh);
+        } else if (kind == CheckpointReader::VectorData) {
+            for (int h = 0; h < vec->nirrep(); ++h) {
+                int64_t n = vec->dimpi()[h];
+                std::fwrite(&n, sizeof(int64_t), 1, fh);
+            }
+            for (int h = 0; h < vec->nirrep(); ++h) std::fwrite(vec->pointer(h), sizeof(double), vec->dimpi()[h], fh);
+        } else {
+            int nirrep = mat->nirrep();
+            for (int h = 0; h < nirrep; ++h) {
+                int64_t n = mat->rowspi()[h];
+                std::fwrite(&n, sizeof(int64_t), 1, fh);
+            }
+            for (int h = 0; h < nirrep; ++h) {
+                int64_t n = mat->colspi()[h ^ symmetry];
+                std::fwrite(&n, sizeof(int64_t), 1, fh);
+            }
+            std::vector<double> column;
+            for (int h = 0; h < nirrep; ++h) {
+                int nrow = mat->rowspi()[h];
+                int ncol = mat->colspi()[h ^ symmetry];
+                if (!nrow || !ncol) continue;
+                double **Mp = mat->pointer(h);
+                if (layout == RowMajor) {
+                    std::fwrite(Mp[0], sizeof(double), (size_t)nrow * ncol, fh);
+                } else {
+                    column.resize(nrow);
+                    for (int j = 0; j < ncol; ++j) {
+                        for (int i = 0; i < nrow; ++i) column[i] = Mp[i][j];
+                        std::fwrite(column.data(), sizeof(double), nrow, fh);
+                    }
+                }
+            }
+        }
+    }
+};
+
+void add_matrix(std::vector<Section> &sections, const std::string &label, SharedMatrix M, uint32_t layout) {
+    if (!M) return;
+    Section s(label, CheckpointReader::MatrixData);
+    s.mat = M;
+    s.layout = layout;
+    s.symmetry = M->symmetry();
+    // Restricted wavefunctions share the alpha and beta objects; store the data once
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].mat == M && sections[i].layout == layout) s.alias = i;
+    }
+    sections.push_back(s);
+}
+
+void add_vector(std::vector<Section> &sections, const std::string &label, SharedVector v) {
+    if (!v) return;
+    Section s(label, CheckpointReader::VectorData);
+    s.vec = v;
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].vec == v) s.alias = i;
+    }
+    sections.push_back(s);
+}
+
+void add_dimension(std::vector<Section> &sections, const std::string &label, const Dimension &dim) {
+    Section s(label, CheckpointReader::Integers);
+    for (int h = 0; h < dim.n(); ++h) s.ints.push_back(dim[h]);
+    sections.push_back(s);
+}
+
+void add_integer(std::vector<Section> &sections, const std::string &label, int64_t value) {
+    Section s(label, CheckpointReader::Integers);
+    s.ints.push_back(value);
+    sections.push_back(s);
+}
+
+void add_text(std::vector<Section> &sections, const std::string &label, const std::string &text) {
+    // Stored one character per integer so that no separate string section kind is needed
+    Section s(label, CheckpointReader::Integers);
+    for (unsigned char c : text) s.ints.push_back(c);
+    sections.push_back(s);
+}
+
+void add_scalar(std::vector<Section> &sections, const std::string &label, double value) {
+    Section s(label, CheckpointReader::Scalar);
+    s.value = value;
+    sections.push_back(s);
+}
+
+void pad_to(FILE *fh, uint64_t offset) {
+    static const char zeros[kAlignment] = {0};
+    long pos = std::ftell(fh);
+    if (pos < 0 || (uint64_t)pos > offset) throw PSIEXCEPTION("CheckpointWriter: inconsistent section offsets.");
+    std::fwrite(zeros, 1, offset - pos, fh);
+}
+
+}  // namespace
+
+const uint32_t CheckpointReader::version = 1;
+
+uint64_t CheckpointReader::basis_fingerprint(std::shared_ptr<BasisSet> basis) {
+    // FNV-1a over the shell structure; geometry is deliberately excluded so that
+    // checkpoints remain usable as guesses across geometry steps
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void *data, size_t n) {
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < n; ++i) {
+            hash ^= p[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    int64_t header[3] = {basis->nbf(), basis->nshell(), basis->has_puream()};
+    mix(header, sizeof(header));
+    for (int Q = 0; Q < basis->nshell(); ++Q) {
+        const GaussianShell &shell = basis->shell(Q);
+        int64_t desc[3] = {shell.ncenter(), shell.am(), shell.nprimitive()};
+        mix(desc, sizeof(desc));
+        for (int K = 0; K < shell.nprimitive(); ++K) {
+            double prim[2] = {shell.exp(K), shell.original_coef(K)};
+            mix(prim, sizeof(prim));
+        }
+    }
+    return hash;
+}
+
+CheckpointWriter::CheckpointWriter(std::shared_ptr<Wavefunction> wavefunction) : wavefunction_(wavefunction) {}
+
+void CheckpointWriter::write(const std::string &filename) { write(filename, wavefunction_->energy(), -1); }
+
+void CheckpointWriter::write(const std::string &filename, double energy, int iteration) {
+    std::shared_ptr<Wavefunction> wfn = wavefunction_;
+
+    std::vector<Section> sections;
+    add_scalar(sections, "energy", energy);
+    add_integer(sections, "iteration", iteration);
+    add_integer(sections, "same_a_b_orbs", wfn->same_a_b_orbs());
+    add_integer(sections, "same_a_b_dens", wfn->same_a_b_dens());
+    add_integer(sections, "point_group", wfn->molecule()->point_group()->bits());
+    add_text(sections, "basis_name", wfn->basisset()->name());
+    add_dimension(sections, "nsopi", wfn->nsopi());
+    add_dimension(sections, "nmopi", wfn->nmopi());
+    add_dimension(sections, "nalphapi", wfn->nalphapi());
+    add_dimension(sections, "nbetapi", wfn->nbetapi());
+    add_dimension(sections, "doccpi", wfn->doccpi());
+    add_dimension(sections, "soccpi", wfn->soccpi());
+    add_dimension(sections, "frzcpi", wfn->frzcpi());
+    add_dimension(sections, "frzvpi", wfn->frzvpi());
+    add_vector(sections, "epsilon_a", wfn->epsilon_a());
+    add_vector(sections, "epsilon_b", wfn->epsilon_b());
+    add_matrix(sections, "Ca", wfn->Ca(), ColumnMajor);
+    add_matrix(sections, "Cb", wfn->Cb(), ColumnMajor);
+    add_matrix(sections, "Da", wfn->Da(), RowMajor);
+    add_matrix(sections, "Db", wfn->Db(), RowMajor);
+    add_matrix(sections, "Fa", wfn->Fa(), RowMajor);
+    add_matrix(sections, "Fb", wfn->Fb(), RowMajor);
+
+    uint64_t offset = align_up(kHeaderSize + sections.size() * kEntrySize);
+    for (auto &s : sections) {
+        if (s.alias >= 0) {
+            s.offset = sections[s.alias].offset;
+            s.nbytes = sections[s.alias].nbytes;
+            continue;
+        }
+        s.size();
+        s.offset = offset;
+        offset = align_up(offset + s.nbytes);
+    }
+    uint64_t file_size = offset;
+
+    std::vector<char> head(kHeaderSize + sections.size() * kEntrySize, 0);
+    std::memcpy(head.data(), kMagic, sizeof(kMagic));
+    put<uint32_t>(head, 8, CheckpointReader::version);
+    put<uint32_t>(head, 12, kByteOrder);
+    put<uint64_t>(head, 16, sections.size());
+    put<uint64_t>(head, 24, CheckpointReader::basis_fingerprint(wfn->basisset()));
+    put<uint64_t>(head, 32, file_size);
+    for (size_t i = 0; i < sections.size(); ++i) {
+        const Section &s = sections[i];
+        size_t pos = kHeaderSize + i * kEntrySize;
+        if (s.label.size() >= kLabelSize) throw PSIEXCEPTION("CheckpointWriter: section label too long.");
+        std::memcpy(head.data() + pos, s.label.c_str(), s.label.size());
+        put<uint32_t>(head, pos + 32, s.kind);
+        put<uint32_t>(head, pos + 36, s.layout);
+        put<uint32_t>(head, pos + 40, s.nirrep());
+        put<uint32_t>(head, pos + 44, s.symmetry);
+        put<uint64_t>(head, pos + 48, s.offset);
+        put<uint64_t>(head, pos + 56, s.nbytes);
+    }
+
+    // Write next to the target and rename once everything is on disk
+    std::string tmpname = filename + ".tmp";
+    FILE *fh = std::fopen(tmpname.c_str(), "wb");
+    if (!fh) throw PSIEXCEPTION("CheckpointWriter: unable to open " + tmpname + " for writing.");
+    std::fwrite(head.data(), 1, head.size(), fh);
+    for (const auto &s : sections) {
+        if (s.alias >= 0) continue;
+        pad_to(fh, s.offset);
+        s.write(fh);
+    }
+    pad_to(fh, file_size);
+
+    bool ok = !std::ferror(fh) && std::fflush(fh) == 0;
+#ifndef _MSC_VER
+    ok = ok && ::fsync(::fileno(fh)) == 0;
+#endif
+    ok = (std::fclose(fh) == 0) && ok;
+    if (!ok) {
+        std::remove(tmpname.c_str());
+        throw PSIEXCEPTION("CheckpointWriter: error while writing " + tmpname + ".");
+    }
+#ifdef _MSC_VER
+    // rename does not replace an existing file on Windows
+    std::remove(filename.c_str());
+#endif
+    if (std::rename(tmpname.c_str(), filename.c_str()) != 0) {
+        std::remove(tmpname.c_str());
+        throw PSIEXCEPTION("CheckpointWriter: unable to move checkpoint into place at " + filename + ".");
+    }
+}
+
+CheckpointReader::CheckpointReader(const std::string &filename)
+    : filename_(filename), fingerprint_(0), data_(nullptr), size_(0), mapped_(false) {
+#ifdef _MSC_VER
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) throw PSIEXCEPTION("CheckpointReader: unable to open " + filename + ".");
+    buffer_.resize(in.tellg());
+    in.seekg(0);
+    in.read(buffer_.data(), buffer_.size());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw PSIEXCEPTION("CheckpointReader: unable to open " + filename + ".");
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw PSIEXCEPTION("CheckpointReader: unable to stat " + filename + ".");
+    }
+    size_ = st.st_size;
+    if (size_ >= kHeaderSize) {
+        void *map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            data_ = static_cast<const char *>(map);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+    if (!mapped_) {
+        std::ifstream in(filename, std::ios::binary);
+        buffer_.resize(size_);
+        in.read(buffer_.data(), size_);
+        data_ = buffer_.data();
+    }
+#endif
+
+    if (size_ < kHeaderSize || std::memcmp(data_, kMagic, sizeof(kMagic)) != 0) {
+        throw PSIEXCEPTION("CheckpointReader: " + filename + " is not a Psi4 checkpoint file.");
+    }
+    uint32_t file_version = get<uint32_t>(data_, 8);
+    if (file_version != version) {
+        throw PSIEXCEPTION("CheckpointReader: " + filename + " has unsupported format version " +
+                           std::to_string(file_version) + ".");
+    }
+    if (get<uint32_t>(data_, 12) != kByteOrder) {
+        throw PSIEXCEPTION("CheckpointReader: " + filename + " was written on a machine with different byte order.");
+    }
+    uint64_t nentry = get<uint64_t>(data_, 16);
+    fingerprint_ = get<uint64_t>(data_, 24);
+    if (get<uint64_t>(data_, 32) != size_ || kHeaderSize + nentry * kEntrySize > size_) {
+        throw PSIEXCEPTION("CheckpointReader: " + filename + " is truncated.");
+    }
+
+    for (uint64_t i = 0; i < nentry; ++i) {
+        size_t pos = kHeaderSize + i * kEntrySize;
+        std::string label(data_ + pos, strnlen(data_ + pos, kLabelSize));
+        Entry e;
+        e.kind = get<uint32_t>(data_, pos + 32);
+        e.layout = get<uint32_t>(data_, pos + 36);
+        e.nirrep = get<uint32_t>(data_, pos + 40);
+        e.symmetry = get<uint32_t>(data_, pos + 44);
+        e.offset = get<uint64_t>(data_, pos + 48);
+        e.nbytes = get<uint64_t>(data_, pos + 56);
+        if (e.offset + e.nbytes > size_) {
+            throw PSIEXCEPTION("CheckpointReader: section " + label + " of " + filename + " is out of bounds.");
+        }
+        entries_[label] = e;
+        order_.push_back(label);
+    }
+}
+
+CheckpointReader::~CheckpointReader() {
+#ifndef _MSC_VER
+    if (mapped_) ::munmap(const_cast<char *>(data_), size_);
+#endif
+}
+
+bool CheckpointReader::compatible(std::shared_ptr<Wavefunction> wfn) const {
+    if (basis_fingerprint(wfn->basisset()) != fingerprint_) return false;
+    if (!has_entry("point_group") || !has_entry("basis_name") || !has_entry("nsopi")) return false;
+    if (integer("point_group") != wfn->molecule()->point_group()->bits()) return false;
+    if (text("basis_name") != wfn->basisset()->name()) return false;
+    Dimension nsopi = dimension("nsopi");
+    return nsopi == wfn->nsopi();
+}
+
+bool CheckpointReader::has_entry(const std::string &label) const { return entries_.count(label); }
+
+std::vector<std::string> CheckpointReader::labels() const { return order_; }
+
+const CheckpointReader::Entry &CheckpointReader::entry(const std::string &label, uint32_t kind) const {
+    auto it = entries_.find(label);
+    if (it == entries_.end()) {
+        throw PSIEXCEPTION("CheckpointReader: " + filename_ + " has no section " + label + ".");
+    }
+    if (it->second.kind != kind) {
+        throw PSIEXCEPTION("CheckpointReader: section " + label + " of " + filename_ + " has the wrong type.");
+    }
+    return it->second;
+}
+
+const char *CheckpointReader::section(const Entry &e) const { return data_ + e.offset; }
+
+void CheckpointReader::read_dims(const Entry &e, Dimension &rowspi, Dimension &colspi) const {
+    const char *p = section(e);
+    rowspi = Dimension(e.nirrep);
+    colspi = Dimension(e.nirrep);
+    // Column dimensions are stored indexed by the row irrep; undo the symmetry offset
+    for (uint32_t h = 0; h < e.nirrep; ++h) {
+        rowspi[h] = get<int64_t>(p, h * sizeof(int64_t));
+        colspi[h ^ e.symmetry] = get<int64_t>(p, (e.nirrep + h) * sizeof(int64_t));
+    }
+}
+
+double CheckpointReader::scalar(const std::string &label) const {
+    return get<double>(section(entry(label, Scalar)), 0);
+}
+
+int CheckpointReader::integer(const std::string &label) const {
+    const Entry &e = entry(label, Integers);
+    if (e.nirrep != 1) throw PSIEXCEPTION("CheckpointReader: section " + label + " is not a single integer.");
+    return get<int64_t>(section(e), 0);
+}
+
+std::string CheckpointReader::text(const std::string &label) const {
+    const Entry &e = entry(label, Integers);
+    std::string text(e.nirrep, '\0');
+    for (uint32_t i = 0; i < e.nirrep; ++i) text[i] = (char)get<int64_t>(section(e), i * sizeof(int64_t));
+    return text;
+}
+
+Dimension CheckpointReader::dimension(const std::string &label) const {
+    const Entry &e = entry(label, Integers);
+    Dimension dim(e.nirrep, label);
+    for (uint32_t h = 0; h < e.nirrep; ++h) dim[h] = get<int64_t>(section(e), h * sizeof(int64_t));
+    return dim;
+}
+
+SharedVector CheckpointReader::vector(const std::string &label) const {
+    const Entry &e = entry(label, VectorData);
+    const char *p = section(e);
+    Dimension dimpi(e.nirrep);
+    for (uint32_t h = 0; h < e.nirrep; ++h) dimpi[h] = get<int64_t>(p, h * sizeof(int64_t));
+    auto vec = std::make_shared<Vector>(label, dimpi);
+    p += e.nirrep * sizeof(int64_t);
+    for (uint32_t h = 0; h < e.nirrep; ++h) {
+        std::memcpy(vec->pointer(h), p, dimpi[h] * sizeof(double));
+        p += dimpi[h] * sizeof(double);
+    }
+    return vec;
+}
+
+SharedMatrix CheckpointReader::matrix(const std::string &label) const {
+    Dimension rowspi, colspi;
+    const Entry &e = entry(label, MatrixData);
+    read_dims(e, rowspi, colspi);
+    return matrix_columns(label, colspi);
+}
+
+SharedMatrix CheckpointReader::matrix_columns(const std::string &label, const Dimension &ncolpi) const {
+    const Entry &e = entry(label, MatrixData);
+    Dimension rowspi, colspi;
+    read_dims(e, rowspi, colspi);
+    if (ncolpi.n() != (int)e.nirrep) {
+        throw PSIEXCEPTION("CheckpointReader: column dimension does not match the irreps of section " + label + ".");
+    }
+    for (uint32_t h = 0; h < e.nirrep; ++h) {
+        if (ncolpi[h] > colspi[h]) {
+            throw PSIEXCEPTION("CheckpointReader: requested more columns than stored in section " + label + ".");
+        }
+    }
+
+    auto M = std::make_shared<Matrix>(label, rowspi, ncolpi, e.symmetry);
+    const double *p = reinterpret_cast<const double *>(section(e) + 2 * e.nirrep * sizeof(int64_t));
+    for (uint32_t h = 0; h < e.nirrep; ++h) {
+        size_t nrow = rowspi[h];
+        size_t nstored = colspi[h ^ e.symmetry];
+        size_t ncol = ncolpi[h ^ e.symmetry];
+        double **Mp = M->pointer(h);
+        if (nrow && ncol) {
+            if (e.layout == ColumnMajor) {
+                // The leading columns are contiguous; the remainder of the block is never touched
+                for (size_t j = 0; j < ncol; ++j) {
+                    for (size_t i = 0; i < nrow; ++i) Mp[i][j] = p[j * nrow + i];
+                }
+            } else {
+                for (size_t i = 0; i < nrow; ++i) std::memcpy(Mp[i], p + i * nstored, ncol * sizeof(double));
+            }
+        }
+        p += nrow * nstored;
+    }
+    return M;
+}
+
+}  // namespace psi
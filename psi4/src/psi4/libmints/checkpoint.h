@@ -0,0 +1,154 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+#ifndef _psi_src_lib_libmints_checkpoint_h
+#define _psi_src_lib_libmints_checkpoint_h
+
+#include "psi4/pragma.h"
+#include "psi4/libmints/dimension.h"
+#include "typedefs.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace psi {
+
+class BasisSet;
+class Wavefunction;
+
+/*! \ingroup MINTS
+ *  \class CheckpointWriter
+ *  \brief Writes the SCF state of a Wavefunction (C, D, F, epsilon, occupations,
+ *         point group, basis set name and fingerprint) into a versioned binary checkpoint file.
+ *
+ *  The file is laid out as a fixed-size header, a table of contents of fixed-size
+ *  entries, and 64-byte aligned data sections, so that a reader can memory-map it
+ *  and touch only the sections it needs.  Orbital coefficient matrices are stored
+ *  column-major (one orbital after the other) so that the occupied block of each
+ *  irrep is a contiguous slice of the file.
+ *
+ *  Writes are atomic: the data goes to a temporary file next to the target, which
+ *  is flushed and renamed over the target only once it is complete.  A pre-empted
+ *  job therefore leaves either the previous checkpoint or the new one, never a
+ *  truncated file.
+ */
+class PSI_API CheckpointWriter {
+    std::shared_ptr<Wavefunction> wavefunction_;
+
+   public:
+    CheckpointWriter(std::shared_ptr<Wavefunction> wavefunction);
+
+    /// Write the checkpoint with the wavefunction's energy, tagged as converged (iteration -1)
+    void write(const std::string &filename);
+    /// Write a mid-iteration checkpoint with the current energy and the SCF iteration it was taken at
+    void write(const std::string &filename, double energy, int iteration);
+};
+
+/*! \ingroup MINTS
+ *  \class CheckpointReader
+ *  \brief Random-access reader for files produced by CheckpointWriter.
+ *
+ *  The file is memory-mapped where the platform allows it; sections are only
+ *  copied into Matrix/Vector objects when they are requested.
+ */
+class PSI_API CheckpointReader {
+   public:
+    /// Section kinds stored in the table of contents
+    enum EntryKind { Scalar = 0, Integers = 1, VectorData = 2, MatrixData = 3 };
+
+    /// Current on-disk format version
+    static const uint32_t version;
+
+    /// A 64-bit fingerprint of the shell structure (am, contraction, exponents, centers) of a basis set
+    static uint64_t basis_fingerprint(std::shared_ptr<BasisSet> basis);
+
+    CheckpointReader(const std::string &filename);
+    ~CheckpointReader();
+
+    CheckpointReader(const CheckpointReader &) = delete;
+    CheckpointReader &operator=(const CheckpointReader &) = delete;
+
+    const std::string &filename() const { return filename_; }
+    /// The fingerprint of the basis set the checkpoint was written with
+    uint64_t fingerprint() const { return fingerprint_; }
+    /// Was the checkpoint written with the basis set (name and shell structure) and point group of this wavefunction?
+    bool compatible(std::shared_ptr<Wavefunction> wfn) const;
+
+    /// Is a section with this label present?
+    bool has_entry(const std::string &label) const;
+    /// The labels of all sections, in file order
+    std::vector<std::string> labels() const;
+
+    double scalar(const std::string &label) const;
+    int integer(const std::string &label) const;
+    /// Read a text section such as basis_name
+    std::string text(const std::string &label) const;
+    Dimension dimension(const std::string &label) const;
+    SharedVector vector(const std::string &label) const;
+    SharedMatrix matrix(const std::string &label) const;
+    /**
+     * Read only the leading columns of a matrix section, e.g. the occupied orbitals
+     * @param label the section to read (Ca, Cb)
+     * @param ncolpi the number of leading columns to read per irrep
+     * @return a (rowspi x ncolpi) matrix, without materializing the remaining columns
+     */
+    SharedMatrix matrix_columns(const std::string &label, const Dimension &ncolpi) const;
+
+   private:
+    struct Entry {
+        uint32_t kind;
+        uint32_t layout;
+        uint32_t nirrep;
+        uint32_t symmetry;
+        uint64_t offset;
+        uint64_t nbytes;
+    };
+
+    std::string filename_;
+    uint64_t fingerprint_;
+    std::map<std::string, Entry> entries_;
+    std::vector<std::string> order_;
+
+    /// Start and length of the file image (mapped or, without mmap, read into buffer_)
+    const char *data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<char> buffer_;
+
+    const Entry &entry(const std::string &label, uint32_t kind) const;
+    const char *section(const Entry &e) const;
+    void read_dims(const Entry &e, Dimension &rowspi, Dimension &colspi) const;
+};
+
+}  // namespace psi
+
+#endif
@@ -35,6 +35,8 @@
 #include "psi4/libmints/osrecur.h"
 #include "psi4/libmints/vector.h"
 
+#include <cstring>
+
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
 ;
@@ -188,6 +190,92 @@ void ElectrostaticInt::compute_pair(const GaussianShell& s1, const GaussianShell
     }
 }
 
+void ElectrostaticInt::compute_shell_points(int sh1, int sh2, size_t npoints, const double* x, const double* y,
+                                            const double* z, double* result) {
+    const GaussianShell& s1 = bs1_->shell(sh1);
+    const GaussianShell& s2 = bs2_->shell(sh2);
+    int am1 = s1.am();
+    int am2 = s2.am();
+    int nprim1 = s1.nprimitive();
+    int nprim2 = s2.nprimitive();
+    size_t ncart = (size_t)s1.ncartesian() * s2.ncartesian();
+    size_t nfunc = force_cartesian_ ? ncart : (size_t)s1.nfunction() * s2.nfunction();
+    const Vector3& A = s1.center();
+    const Vector3& B = s2.center();
+
+    int izm = 1;
+    int iym = am1 + 1;
+    int ixm = iym * iym;
+    int jzm = 1;
+    int jym = am2 + 1;
+    int jxm = jym * jym;
+
+    double AB2 = 0.0;
+    AB2 += (A[0] - B[0]) * (A[0] - B[0]);
+    AB2 += (A[1] - B[1]) * (A[1] - B[1]);
+    AB2 += (A[2] - B[2]) * (A[2] - B[2]);
+
+    points_buffer_.assign(npoints * ncart, 0.0);
+    double*** vi = potential_recur_->vi();
+
+    // Only PC depends on the point, so the points run innermost
+    for (int p1 = 0; p1 < nprim1; ++p1) {
+        double a1 = s1.exp(p1);
+        double c1 = s1.coef(p1);
+        for (int p2 = 0; p2 < nprim2; ++p2) {
+            double a2 = s2.exp(p2);
+            double c2 = s2.coef(p2);
+            double gamma = a1 + a2;
+            double oog = 1.0 / gamma;
+
+            double P[3], PA[3], PB[3], PC[3];
+            for (int k = 0; k < 3; k++) {
+                P[k] = (a1 * A[k] + a2 * B[k]) * oog;
+                PA[k] = P[k] - A[k];
+                PB[k] = P[k] - B[k];
+            }
+
+            double over_pf = exp(-a1 * a2 * AB2 * oog) * sqrt(M_PI * oog) * M_PI * oog * c1 * c2;
+
+            for (size_t g = 0; g < npoints; g++) {
+                PC[0] = P[0] - x[g];
+                PC[1] = P[1] - y[g];
+                PC[2] = P[2] - z[g];
+
+                potential_recur_->compute(PA, PB, PC, gamma, am1, am2);
+
+                double* cart = &points_buffer_[g * ncart];
+                int ao12 = 0;
+                for (int ii = 0; ii <= am1; ii++) {
+                    int l1 = am1 - ii;
+                    for (int jj = 0; jj <= ii; jj++) {
+                        int m1 = ii - jj;
+                        int n1 = jj;
+                        int iind = l1 * ixm + m1 * iym + n1 * izm;
+                        for (int kk = 0; kk <= am2; kk++) {
+                            int l2 = am2 - kk;
+                            for (int ll = 0; ll <= kk; ll++) {
+                                int m2 = kk - ll;
+                                int n2 = ll;
+                                int jind = l2 * jxm + m2 * jym + n2 * jzm;
+                                cart[ao12++] += -vi[iind][jind][0] * over_pf;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Normalize and transform each point's block as compute_shell() does
+    for (size_t g = 0; g < npoints; g++) {
+        ::memcpy(buffer_, &points_buffer_[g * ncart], sizeof(double) * ncart);
+        normalize_am(s1, s2, nchunk_);
+        if (!force_cartesian_) pure_transform(s1, s2, nchunk_);
+        ::memcpy(&result[g * nfunc], buffer_, sizeof(double) * nfunc);
+    }
+}
+
 SharedVector ElectrostaticInt::nuclear_contribution(std::shared_ptr<Molecule> mol) {
     auto sret = std::make_shared<Vector>(mol->natom());
     double* ret = sret->pointer();
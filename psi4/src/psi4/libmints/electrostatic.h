@@ -32,6 +32,8 @@
 #include "psi4/libmints/potential.h"
 #include "psi4/pragma.h"
 
+#include <vector>
+
 namespace psi {
 
 class BasisSet;
@@ -48,6 +50,9 @@ class Vector3;
 class ElectrostaticInt : public PotentialInt {
     void compute_pair(const GaussianShell&, const GaussianShell&) override {}
 
+    /// Cartesian integrals of every point in compute_shell_points
+    std::vector<double> points_buffer_;
+
    public:
     /// Constructor
     ElectrostaticInt(std::vector<SphericalTransform>&, std::shared_ptr<BasisSet>, std::shared_ptr<BasisSet>,
@@ -61,6 +66,13 @@ class ElectrostaticInt : public PotentialInt {
     void compute_shell(int, int, const Vector3&);
     /// Computes integrals between two shells.
     void compute_pair(const GaussianShell&, const GaussianShell&, const Vector3&);
+    /**
+     * Computes integrals between two shells at npoints charge positions at once. The
+     * primitive pair intermediates are shared by all points. result[g * nfunction1 *
+     * nfunction2 + mn] receives the (transformed) block of point g.
+     */
+    void compute_shell_points(int, int, size_t npoints, const double* x, const double* y, const double* z,
+                              double* result);
 
     PRAGMA_WARNING_PUSH
     PRAGMA_WARNING_IGNORE_OVERLOADED_VIRTUAL
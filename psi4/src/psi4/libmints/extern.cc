@@ -38,23 +38,48 @@
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsi4util/process.h"
 
+#include <array>
+#include <cmath>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
 namespace psi {
 
-ExternalPotential::ExternalPotential() : debug_(0), print_(1) {}
+namespace {
+/// Number of equivalent charges representing the far field
+const int n_equivalent = 400;
+
+/// n points spread evenly over the sphere of given radius and center (Fibonacci lattice)
+std::vector<std::array<double, 3> > sphere_points(int n, double radius, const double* center) {
+    std::vector<std::array<double, 3> > points(n);
+    double golden = M_PI * (3.0 - std::sqrt(5.0));
+    for (int i = 0; i < n; i++) {
+        double z = 1.0 - 2.0 * (i + 0.5) / n;
+        double r = std::sqrt(1.0 - z * z);
+        double t = golden * i;
+        points[i] = {center[0] + radius * r * std::cos(t), center[1] + radius * r * std::sin(t),
+                     center[2] + radius * z};
+    }
+    return points;
+}
+}  // namespace
+
+ExternalPotential::ExternalPotential()
+    : debug_(0), print_(1), near_field_radius_(0.0), field_center_{0.0, 0.0, 0.0}, field_radius_(0.0) {}
 
 ExternalPotential::~ExternalPotential() {}
 
 void ExternalPotential::clear() {
     charges_.clear();
     bases_.clear();
+    field_.reset();
 }
 
 void ExternalPotential::addCharge(double Z, double x, double y, double z) {
     charges_.push_back(std::make_tuple(Z, x, y, z));
+    field_.reset();
 }
 
 void ExternalPotential::addBasis(std::shared_ptr<BasisSet> basis, SharedVector coefs) {
@@ -92,50 +117,205 @@ void ExternalPotential::print(std::string out) const {
     }
 }
 
+SharedMatrix ExternalPotential::charge_field(std::shared_ptr<BasisSet> basis) {
+    SharedMolecule mol = basis->molecule();
+    double convfac = 1.0;
+    if (mol->units() == Molecule::Angstrom) convfac /= pc_bohr2angstroms;
+
+    if (field_) {
+        // The expansion stays exact to the fit accuracy inside the check sphere, at
+        // r_mol + R/2. Warn when the atoms have moved halfway out to it.
+        double r_max = 0.0;
+        for (int A = 0; A < mol->natom(); A++) {
+            Vector3 d = mol->xyz(A) - Vector3(field_center_[0], field_center_[1], field_center_[2]);
+            r_max = std::max(r_max, d.norm());
+        }
+        if (near_field_radius_ > 0.0 && r_max > field_radius_ + 0.25 * near_field_radius_) {
+            outfile->Printf("    Warning: the molecule has moved %.2f bohr out of the sphere the external far field\n"
+                            "    was expanded for. Call setNearFieldRadius again to rebuild the expansion.\n\n",
+                            r_max - field_radius_);
+        }
+        return field_;
+    }
+
+    // Sphere enclosing the atoms
+    double O[3] = {0.0, 0.0, 0.0};
+    for (int A = 0; A < mol->natom(); A++) {
+        O[0] += mol->x(A) / mol->natom();
+        O[1] += mol->y(A) / mol->natom();
+        O[2] += mol->z(A) / mol->natom();
+    }
+    double r_mol = 0.0;
+    for (int A = 0; A < mol->natom(); A++) {
+        Vector3 d = mol->xyz(A) - Vector3(O[0], O[1], O[2]);
+        r_mol = std::max(r_mol, d.norm());
+    }
+
+    // Charges within the near-field radius of that sphere are kept explicit
+    std::vector<std::array<double, 4> > near;
+    std::vector<std::array<double, 4> > far;
+    double r_far = r_mol + near_field_radius_;
+    for (size_t i = 0; i < charges_.size(); i++) {
+        std::array<double, 4> Zxyz = {std::get<0>(charges_[i]), convfac * std::get<1>(charges_[i]),
+                                      convfac * std::get<2>(charges_[i]), convfac * std::get<3>(charges_[i])};
+        double dx = Zxyz[1] - O[0];
+        double dy = Zxyz[2] - O[1];
+        double dz = Zxyz[3] - O[2];
+        if (near_field_radius_ <= 0.0 || dx * dx + dy * dy + dz * dz < r_far * r_far) {
+            near.push_back(Zxyz);
+        } else {
+            far.push_back(Zxyz);
+        }
+    }
+
+    // The far field is harmonic inside r_far. It is expanded on equivalent charges
+    // placed on a sphere of radius r_mol + 3R/4, fitted to reproduce the far-field
+    // potential on a check sphere of radius r_mol + R/2. By the maximum principle the
+    // error inside the check sphere is bounded by the error of the fit.
+    if (far.size() > n_equivalent) {
+        int n_check = 2 * n_equivalent;
+        std::vector<std::array<double, 3> > check = sphere_points(n_check, r_mol + 0.5 * near_field_radius_, O);
+        std::vector<std::array<double, 3> > equiv = sphere_points(n_equivalent, r_mol + 0.75 * near_field_radius_, O);
+
+        int threads = 1;
+#ifdef _OPENMP
+        threads = Process::environment.get_n_threads();
+#endif
+        std::vector<double> A((size_t)n_check * n_equivalent);
+        std::vector<double> phi(n_check);
+#pragma omp parallel for schedule(static) num_threads(threads)
+        for (int m = 0; m < n_check; m++) {
+            for (int j = 0; j < n_equivalent; j++) {
+                double dx = check[m][0] - equiv[j][0];
+                double dy = check[m][1] - equiv[j][1];
+                double dz = check[m][2] - equiv[j][2];
+                A[(size_t)m * n_equivalent + j] = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz);
+            }
+            double val = 0.0;
+            for (const auto& Zxyz : far) {
+                double dx = check[m][0] - Zxyz[1];
+                double dy = check[m][1] - Zxyz[2];
+                double dz = check[m][2] - Zxyz[3];
+                val += Zxyz[0] / std::sqrt(dx * dx + dy * dy + dz * dz);
+            }
+            phi[m] = val;
+        }
+
+        // Regularized least squares, (A^T A + lambda) q = A^T phi
+        std::vector<double> AtA((size_t)n_equivalent * n_equivalent);
+        std::vector<double> q(n_equivalent);
+        C_DGEMM('T', 'N', n_equivalent, n_equivalent, n_check, 1.0, A.data(), n_equivalent, A.data(), n_equivalent,
+                0.0, AtA.data(), n_equivalent);
+        C_DGEMV('T', n_check, n_equivalent, 1.0, A.data(), n_equivalent, phi.data(), 1, 0.0, q.data(), 1);
+        double lambda = 0.0;
+        for (int j = 0; j < n_equivalent; j++) lambda += AtA[(size_t)j * n_equivalent + j];
+        lambda *= 1.0E-10 / n_equivalent;
+        for (int j = 0; j < n_equivalent; j++) AtA[(size_t)j * n_equivalent + j] += lambda;
+        int info = C_DPOSV('U', n_equivalent, 1, AtA.data(), n_equivalent, q.data(), n_equivalent);
+        if (info != 0) throw PSIEXCEPTION("ExternalPotential: far-field equivalent charge fit failed.");
+
+        for (int j = 0; j < n_equivalent; j++) {
+            near.push_back({q[j], equiv[j][0], equiv[j][1], equiv[j][2]});
+        }
+        if (print_ > 1) {
+            outfile->Printf("    External potential: %zu far-field charges represented by %d equivalent charges.\n\n",
+                            far.size(), n_equivalent);
+        }
+    } else {
+        near.insert(near.end(), far.begin(), far.end());
+    }
+
+    auto Zxyz = std::make_shared<Matrix>("Charges (Z,x,y,z)", near.size(), 4);
+    double** Zxyzp = Zxyz->pointer();
+    for (size_t i = 0; i < near.size(); i++) {
+        for (int k = 0; k < 4; k++) Zxyzp[i][k] = near[i][k];
+    }
+
+    field_ = Zxyz;
+    for (int k = 0; k < 3; k++) field_center_[k] = O[k];
+    field_radius_ = r_mol;
+    return field_;
+}
+
 SharedMatrix ExternalPotential::computePotentialMatrix(std::shared_ptr<BasisSet> basis) {
     int n = basis->nbf();
     auto V = std::make_shared<Matrix>("External Potential", n, n);
     auto fact = std::make_shared<IntegralFactory>(basis, basis, basis, basis);
+    double **Vp = V->pointer();
 
-    double convfac = 1.0;
-    if (basis->molecule()->units() == Molecule::Angstrom) convfac /= pc_bohr2angstroms;
+    // Thread count
+    int threads = 1;
+#ifdef _OPENMP
+    threads = Process::environment.get_n_threads();
+#endif
 
     // Monopoles
-    auto V_charge = std::make_shared<Matrix>("External Potential (Charges)", n, n);
+    SharedMatrix Zxyz = charge_field(basis);
 
-    auto Zxyz = std::make_shared<Matrix>("Charges (Z,x,y,z)", charges_.size(), 4);
-    double **Zxyzp = Zxyz->pointer();
-    for (size_t i = 0; i < charges_.size(); i++) {
-        Zxyzp[i][0] = std::get<0>(charges_[i]);
-        Zxyzp[i][1] = convfac * std::get<1>(charges_[i]);
-        Zxyzp[i][2] = convfac * std::get<2>(charges_[i]);
-        Zxyzp[i][3] = convfac * std::get<3>(charges_[i]);
+    std::vector<std::shared_ptr<PotentialInt> > Vint;
+    for (int t = 0; t < threads; t++) {
+        Vint.push_back(std::shared_ptr<PotentialInt>(static_cast<PotentialInt *>(fact->ao_potential())));
+        Vint[t]->set_charge_field(Zxyz);
     }
 
-    std::shared_ptr<PotentialInt> pot(static_cast<PotentialInt *>(fact->ao_potential()));
-    pot->set_charge_field(Zxyz);
-    pot->compute(V_charge);
+    // Lower Triangle
+    std::vector<std::pair<int, int> > PQ_pairs;
+    for (int P = 0; P < basis->nshell(); P++) {
+        for (int Q = 0; Q <= P; Q++) {
+            PQ_pairs.push_back(std::pair<int, int>(P, Q));
+        }
+    }
 
-    V->add(V_charge);
-    V_charge.reset();
-    pot.reset();
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+    for (long int PQ = 0L; PQ < PQ_pairs.size(); PQ++) {
+        int P = PQ_pairs[PQ].first;
+        int Q = PQ_pairs[PQ].second;
+
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+
+        Vint[thread]->compute_shell(P, Q);
+        const double *buffer = Vint[thread]->buffer();
+
+        int nP = basis->shell(P).nfunction();
+        int oP = basis->shell(P).function_index();
+
+        int nQ = basis->shell(Q).nfunction();
+        int oQ = basis->shell(Q).function_index();
+
+        for (int p = 0, index = 0; p < nP; p++) {
+            for (int q = 0; q < nQ; q++, index++) {
+                Vp[p + oP][q + oQ] = buffer[index];
+                Vp[q + oQ][p + oP] = buffer[index];
+            }
+        }
+    }
+    Vint.clear();
 
     // Diffuse Bases
     for (size_t ind = 0; ind < bases_.size(); ind++) {
         std::shared_ptr<BasisSet> aux = bases_[ind].first;
         SharedVector d = bases_[ind].second;
 
-        // TODO thread this
         auto fact2 = std::make_shared<IntegralFactory>(aux, BasisSet::zero_ao_basis_set(), basis, basis);
-        std::shared_ptr<TwoBodyAOInt> eri(fact2->eri());
-
-        const double *buffer = eri->buffer();
+        std::vector<std::shared_ptr<TwoBodyAOInt> > eri;
+        for (int t = 0; t < threads; t++) {
+            eri.push_back(std::shared_ptr<TwoBodyAOInt>(fact2->eri()));
+        }
 
-        double **Vp = V->pointer();
         double *dp = d->pointer();
 
-        for (int Q = 0; Q < aux->nshell(); Q++) {
-            for (int M = 0; M < basis->nshell(); M++) {
+        // Each thread owns the rows of its M shells
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+        for (int M = 0; M < basis->nshell(); M++) {
+            int thread = 0;
+#ifdef _OPENMP
+            thread = omp_get_thread_num();
+#endif
+            const double *buffer = eri[thread]->buffer();
+            for (int Q = 0; Q < aux->nshell(); Q++) {
                 for (int N = 0; N < basis->nshell(); N++) {
                     int numQ = aux->shell(Q).nfunction();
                     int numM = basis->shell(M).nfunction();
@@ -144,7 +324,7 @@ SharedMatrix ExternalPotential::computePotentialMatrix(std::shared_ptr<BasisSet>
                     int Mstart = basis->shell(M).function_index();
                     int Nstart = basis->shell(N).function_index();
 
-                    eri->compute_shell(Q, 0, M, N);
+                    eri[thread]->compute_shell(Q, 0, M, N);
 
                     for (int oq = 0, index = 0; oq < numQ; oq++) {
                         for (int om = 0; om < numM; om++) {
@@ -184,8 +364,15 @@ SharedMatrix ExternalPotential::computePotentialGradients(std::shared_ptr<BasisS
         Zxyzp[i][3] = convfac * std::get<3>(charges_[i]);
     }
 
-    // Start with the nuclear contribution
+    // Thread count
+    int threads = 1;
+#ifdef _OPENMP
+    threads = Process::environment.get_n_threads();
+#endif
+
+    // Start with the nuclear contribution, which uses every charge as in computeNuclearEnergy
     grad->zero();
+#pragma omp parallel for schedule(static) num_threads(threads)
     for (int cen = 0; cen < natom; ++cen) {
         double xc = mol->x(cen);
         double yc = mol->y(cen);
@@ -233,18 +420,13 @@ SharedMatrix ExternalPotential::computePotentialGradients(std::shared_ptr<BasisS
     return grad;
 #else
 
-    // Thread count
-    int threads = 1;
-#ifdef _OPENMP
-    threads = Process::environment.get_n_threads();
-#endif
-
-    // Potential derivatives
+    // Potential derivatives, with the same near- and far-field charges as computePotentialMatrix
+    SharedMatrix Zxyz_field = charge_field(basis);
     std::vector<std::shared_ptr<PotentialInt> > Vint;
     std::vector<SharedMatrix> Vtemps;
     for (int t = 0; t < threads; t++) {
         Vint.push_back(std::shared_ptr<PotentialInt>(dynamic_cast<PotentialInt *>(fact->ao_potential(1))));
-        Vint[t]->set_charge_field(Zxyz);
+        Vint[t]->set_charge_field(Zxyz_field);
         Vtemps.push_back(SharedMatrix(grad->clone()));
         Vtemps[t]->zero();
     }
@@ -61,6 +61,22 @@ class PSI_API ExternalPotential {
     std::vector<std::tuple<double, double, double, double> > charges_;
     /// Auxiliary basis sets (with accompanying molecules and coefs) of diffuse charges
     std::vector<std::pair<std::shared_ptr<BasisSet>, SharedVector> > bases_;
+    /// Charges farther than this [bohr] from the sphere enclosing the molecule are represented
+    /// by equivalent charges fitted to their potential, zero keeps every charge explicit
+    double near_field_radius_;
+
+    /// The (Z,x,y,z) point charges [bohr] seen by the electrons, built at the first geometry
+    /// and kept until the charges or the radius change. A fixed near/far split and fixed
+    /// equivalent charges keep the energy continuous as the molecule moves, and let the
+    /// gradient treat them as ordinary external charges.
+    SharedMatrix field_;
+    /// Center and radius [bohr] of the sphere enclosing the molecule when field_ was built
+    double field_center_[3];
+    double field_radius_;
+
+    /// The (Z,x,y,z) point charges [bohr] seen by the electrons of basis: the near-field
+    /// charges, plus the equivalent charges fitted to the potential of the far-field charges
+    SharedMatrix charge_field(std::shared_ptr<BasisSet> basis);
 
    public:
     /// Constructur, does nothing
@@ -79,6 +95,14 @@ class PSI_API ExternalPotential {
     /// Reset the field to zero (eliminates all entries)
     void clear();
 
+    /// Set the near-field radius [bohr] beyond which charges are replaced by equivalent charges
+    void setNearFieldRadius(double radius) {
+        near_field_radius_ = radius;
+        field_.reset();
+    }
+    /// The near-field radius [bohr], zero if every charge is explicit
+    double nearFieldRadius() const { return near_field_radius_; }
+
     /// Compute the external potential matrix in the given basis set
     SharedMatrix computePotentialMatrix(std::shared_ptr<BasisSet> basis);
     /// Compute the gradients due to the external potential
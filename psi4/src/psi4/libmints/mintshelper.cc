@@ -35,6 +35,7 @@
 #include "psi4/psifiles.h"
 #include "psi4/libpsio/psio.hpp"
 #include "psi4/libiwl/iwl.hpp"
+#include "psi4/libiwl/sorted.hpp"
 #include "psi4/libciomr/libciomr.h"
 #include "psi4/libmints/sointegral_twobody.h"
 #include "psi4/libmints/petitelist.h"
@@ -117,6 +118,24 @@ class PSI_API IWLWriter {
     size_t count() const { return count_; }
 };
 
+/**
+ * SortedIntegralWriter functor for use with SO TEIs
+ **/
+class PSI_API SortedWriter {
+    SortedIntegralWriter &writeto_;
+    size_t count_;
+
+   public:
+    SortedWriter(SortedIntegralWriter &writeto) : writeto_(writeto), count_(0) {}
+
+    void operator()(int i, int j, int k, int l, int, int, int, int, int, int, int, int, double value) {
+        writeto_.write_value(i, j, k, l, value);
+        count_++;
+    }
+
+    size_t count() const { return count_; }
+};
+
 MintsHelper::MintsHelper(std::shared_ptr<BasisSet> basis, Options &options, int print)
     : options_(options), print_(print) {
     init_helper(basis);
@@ -238,33 +257,53 @@ void MintsHelper::integrals() {
     // Compute one-electron integrals.
     one_electron_integrals();
 
-    // Open the IWL buffer where we will store the integrals.
-    IWL ERIOUT(psio_.get(), PSIF_SO_TEI, cutoff_, 0, 0);
-    IWLWriter writer(ERIOUT);
-
     // Let the user know what we're doing.
     if (print_) {
         outfile->Printf("      Computing two-electron integrals...");
     }
 
+    size_t count, nruns = 0;
     SOShellCombinationsIterator shellIter(sobasis_, sobasis_, sobasis_, sobasis_);
-    for (shellIter.first(); shellIter.is_done() == false; shellIter.next()) {
-        eri->compute_shell(shellIter, writer);
-    }
+    if (Process::environment.options.get_str("SO_TEI_FORMAT") == "SORTED") {
+        // Sort the integrals as they are written, using half of the memory for the runs
+        size_t memory = Process::environment.get_memory() / (2 * sizeof(double));
+        SortedIntegralWriter ERIOUT(psio_.get(), PSIF_SO_TEI, basisset_->nbf(), cutoff_, memory, PSIF_SO_TEI_RUNS);
+        SortedWriter writer(ERIOUT);
+
+        for (shellIter.first(); shellIter.is_done() == false; shellIter.next()) {
+            eri->compute_shell(shellIter, writer);
+        }
 
-    // Flush out buffers.
-    ERIOUT.flush(1);
+        // Merge the sorted runs and write the block index.
+        ERIOUT.close();
+        count = ERIOUT.count();
+        nruns = ERIOUT.nruns();
+    } else {
+        // Open the IWL buffer where we will store the integrals.
+        IWL ERIOUT(psio_.get(), PSIF_SO_TEI, cutoff_, 0, 0);
+        IWLWriter writer(ERIOUT);
 
-    // We just did all this work to create the file, let's keep it around
-    ERIOUT.set_keep_flag(true);
-    ERIOUT.close();
+        for (shellIter.first(); shellIter.is_done() == false; shellIter.next()) {
+            eri->compute_shell(shellIter, writer);
+        }
+
+        // Flush out buffers.
+        ERIOUT.flush(1);
+
+        // We just did all this work to create the file, let's keep it around
+        ERIOUT.set_keep_flag(true);
+        ERIOUT.close();
+        count = writer.count();
+    }
 
     if (print_) {
         outfile->Printf("done\n");
         outfile->Printf(
             "      Computed %lu non-zero two-electron integrals.\n"
-            "        Stored in file %d.\n\n",
-            writer.count(), PSIF_SO_TEI);
+            "        Stored in file %d.\n",
+            count, PSIF_SO_TEI);
+        if (nruns) outfile->Printf("        Merged from %zu sorted runs.\n", nruns);
+        outfile->Printf("\n");
     }
 }
 
@@ -27,16 +27,94 @@
  */
 
 #include "psi4/libmints/potentialint.h"
+#include "psi4/libmints/integral.h"
+#include "psi4/libpsi4util/process.h"
 
 namespace psi {
 
 PCMPotentialInt::PCMPotentialInt(std::vector<SphericalTransform>& trans, std::shared_ptr<BasisSet> bs1,
                                  std::shared_ptr<BasisSet> /* bs2 */, int /* deriv */)
-    : PotentialInt(trans, bs1, bs1) {
+    : PotentialInt(trans, bs1, bs1), screening_threshold_(1.0E-14) {
     // We don't want to transform the integrals from Cartesian (6d, 10f, ...) to Pure (5d, 7f, ...)
     // for each external charge.  It'll be better to backtransform the density / Fock matrices to
     // the Cartesian basis, if necessary.
     force_cartesian_ = true;
+
+    nthread_ = 1;
+#ifdef _OPENMP
+    nthread_ = Process::environment.get_n_threads();
+#endif
+    int max_am = bs1_->max_am();
+    int max_ncart = INT_NCART(max_am);
+    for (int thread = 0; thread < nthread_; ++thread) {
+        recursions_.emplace_back(new ObaraSaikaTwoCenterVIRecursion(max_am + 1, max_am + 1));
+        buffers_.emplace_back(max_ncart * max_ncart);
+    }
+
+    build_shell_pairs();
+}
+
+void PCMPotentialInt::set_screening_threshold(double threshold) {
+    screening_threshold_ = threshold;
+    build_shell_pairs();
+}
+
+void PCMPotentialInt::build_shell_pairs() {
+    // The primitive pair data only depends on the basis, so it is built once per threshold and
+    // reused for every set of charges.  The recorded bounds allow compute() to screen against the
+    // charge positions; pairs whose bound is below the threshold are not stored at all, so
+    // that the stored data grows only linearly with the size of an extended system.
+    shell_pairs_.clear();
+    int nshell = bs1_->nshell();
+    std::vector<int> offsets(nshell, 0);
+    for (int i = 1; i < nshell; ++i) offsets[i] = offsets[i - 1] + bs1_->shell(i - 1).ncartesian();
+
+    for (int i = 0; i < nshell; ++i) {
+        const GaussianShell& s1 = bs1_->shell(i);
+        int am1 = s1.am();
+        const double* A = s1.center();
+        for (int j = 0; j <= i; ++j) {
+            const GaussianShell& s2 = bs1_->shell(j);
+            int am2 = s2.am();
+            const double* B = s2.center();
+            double AB2 = (A[0] - B[0]) * (A[0] - B[0]) + (A[1] - B[1]) * (A[1] - B[1]) +
+                         (A[2] - B[2]) * (A[2] - B[2]);
+
+            ShellPair sp;
+            sp.i = i;
+            sp.j = j;
+            sp.bf1_offset = offsets[i];
+            sp.bf2_offset = offsets[j];
+            sp.bound = 0.0;
+            for (int p1 = 0; p1 < s1.nprimitive(); ++p1) {
+                double a1 = s1.exp(p1);
+                double c1 = s1.coef(p1);
+                for (int p2 = 0; p2 < s2.nprimitive(); ++p2) {
+                    double a2 = s2.exp(p2);
+                    double c2 = s2.coef(p2);
+                    PrimitivePair pp;
+                    pp.gamma = a1 + a2;
+                    double oog = 1.0 / pp.gamma;
+                    for (int x = 0; x < 3; ++x) {
+                        pp.P[x] = (a1 * A[x] + a2 * B[x]) * oog;
+                        pp.PA[x] = pp.P[x] - A[x];
+                        pp.PB[x] = pp.P[x] - B[x];
+                    }
+                    pp.over_pf = std::exp(-a1 * a2 * AB2 * oog) * std::sqrt(M_PI * oog) * M_PI * oog * c1 * c2;
+
+                    // The Cartesian prefactors are estimated by their size over the width of the distribution
+                    double width = std::sqrt(oog);
+                    double rPA = std::sqrt(pp.PA[0] * pp.PA[0] + pp.PA[1] * pp.PA[1] + pp.PA[2] * pp.PA[2]);
+                    double rPB = std::sqrt(pp.PB[0] * pp.PB[0] + pp.PB[1] * pp.PB[1] + pp.PB[2] * pp.PB[2]);
+                    pp.bound = std::fabs(pp.over_pf) * std::pow(rPA + width, am1) * std::pow(rPB + width, am2);
+                    pp.near_bound = 2.0 * std::sqrt(pp.gamma / M_PI) * pp.bound;
+                    sp.bound = std::max(sp.bound, pp.near_bound);
+                    sp.prims.push_back(pp);
+                }
+            }
+            if (sp.bound >= screening_threshold_) shell_pairs_.push_back(std::move(sp));
+        }
+    }
 }
 
 }  // namespace psi
@@ -36,6 +36,15 @@
 #include "psi4/libmints/osrecur.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace psi {
 
 class GaussianShell;
@@ -54,144 +63,164 @@ class BasisSet;
  * NB: This code must be specified in the .h file in order for the compiler to properly in-line the functors. (TDC)
  */
 class PCMPotentialInt : public PotentialInt {
+    /// Primitive pair data of a shell pair, independent of the charge positions
+    struct PrimitivePair {
+        double gamma;
+        double over_pf;
+        /// Angular-momentum-weighted magnitude of the primitive overlap distribution
+        double bound;
+        /// Largest possible potential of the distribution, 2 sqrt(gamma/pi) * bound
+        double near_bound;
+        double P[3];
+        double PA[3];
+        double PB[3];
+    };
+
+    /// A shell pair (i >= j) whose bound reaches the screening threshold, and its precomputed primitive pairs
+    struct ShellPair {
+        int i;
+        int j;
+        /// Cartesian offsets of the two shells
+        int bf1_offset;
+        int bf2_offset;
+        /// Largest near_bound of the primitive pairs
+        double bound;
+        std::vector<PrimitivePair> prims;
+    };
+
+    /// Number of threads used by compute
+    int nthread_;
+    /// Contributions estimated below this magnitude are skipped
+    double screening_threshold_;
+    /// Only the pairs that pass the screen; the overlap factor in their bounds keeps this list linear
+    /// in the size of extended systems
+    std::vector<ShellPair> shell_pairs_;
+    /// Per-thread recursion objects and integral buffers
+    std::vector<std::unique_ptr<ObaraSaikaTwoCenterVIRecursion>> recursions_;
+    std::vector<std::vector<double>> buffers_;
+
+    /// (Re)builds shell_pairs_ for the current screening threshold
+    void build_shell_pairs();
+
    public:
     PCMPotentialInt(std::vector<SphericalTransform> &, std::shared_ptr<BasisSet>, std::shared_ptr<BasisSet>,
                     int deriv = 0);
     /// Drives the loops over all shell pairs, to compute integrals
     template <typename PCMPotentialIntFunctor>
     void compute(PCMPotentialIntFunctor &functor);
+
+    /// Set the magnitude below which shell pair, primitive pair / charge contributions are neglected
+    void set_screening_threshold(double threshold);
+    double screening_threshold() const { return screening_threshold_; }
 };
 
+/**
+ * The shell pairs (i >= j) are distributed over threads; the integrals are symmetric, so each value is handed
+ * to the functor for both (bf1, bf2) and (bf2, bf1).  Each functor call carries the thread number, so that
+ * functors can keep per-thread accumulators between their initialize(nthread) and finalize() calls.
+ *
+ * For each charge, primitive pairs whose distribution cannot produce a potential above the screening threshold
+ * at the charge position are skipped; beyond the extent of the distribution this bound decays as 1/|PC|.
+ */
 template <typename PCMPotentialIntFunctor>
 void PCMPotentialInt::compute(PCMPotentialIntFunctor &functor) {
-    // Do not worry about zeroing out result
-    int ns1 = bs1_->nshell();
-    int ns2 = bs2_->nshell();
-    int bf1_offset = 0;
-    for (int i = 0; i < ns1; ++i) {
-        const GaussianShell &s1 = bs1_->shell(i);
+    double **Zxyzp = Zxyz_->pointer();
+    int ncharge = Zxyz_->rowspi()[0];
+    int npairs = shell_pairs_.size();
+
+    functor.initialize(nthread_);
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthread_)
+    for (int pair = 0; pair < npairs; ++pair) {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        const ShellPair &sp = shell_pairs_[pair];
+
+        const GaussianShell &s1 = bs1_->shell(sp.i);
+        const GaussianShell &s2 = bs2_->shell(sp.j);
+        int am1 = s1.am();
+        int am2 = s2.am();
         int ni = s1.ncartesian();
-        int bf2_offset = 0;
-        for (int j = 0; j < ns2; ++j) {
-            const GaussianShell &s2 = bs2_->shell(j);
-            int nj = s2.ncartesian();
-            // Compute the shell
-
-            int ao12;
-            int am1 = s1.am();
-            int am2 = s2.am();
-            int nprim1 = s1.nprimitive();
-            int nprim2 = s2.nprimitive();
-            double A[3], B[3];
-            A[0] = s1.center()[0];
-            A[1] = s1.center()[1];
-            A[2] = s1.center()[2];
-            B[0] = s2.center()[0];
-            B[1] = s2.center()[1];
-            B[2] = s2.center()[2];
-
-            int izm = 1;
-            int iym = am1 + 1;
-            int ixm = iym * iym;
-            int jzm = 1;
-            int jym = am2 + 1;
-            int jxm = jym * jym;
-
-            // compute intermediates
-            double AB2 = 0.0;
-            AB2 += (A[0] - B[0]) * (A[0] - B[0]);
-            AB2 += (A[1] - B[1]) * (A[1] - B[1]);
-            AB2 += (A[2] - B[2]) * (A[2] - B[2]);
-
-            double ***vi = potential_recur_->vi();
-
-            double **Zxyzp = Zxyz_->pointer();
-            int ncharge = Zxyz_->rowspi()[0];
-
-            for (int atom = 0; atom < ncharge; ++atom) {
-                memset(buffer_, 0, s1.ncartesian() * s2.ncartesian() * sizeof(double));
+        int nj = s2.ncartesian();
+
+        int izm = 1;
+        int iym = am1 + 1;
+        int ixm = iym * iym;
+        int jzm = 1;
+        int jym = am2 + 1;
+        int jxm = jym * jym;
+
+        ObaraSaikaTwoCenterVIRecursion *recur = recursions_[thread].get();
+        double ***vi = recur->vi();
+        double *buffer = buffers_[thread].data();
+
+        for (int atom = 0; atom < ncharge; ++atom) {
+            double Z = Zxyzp[atom][0];
+            double absZ = std::fabs(Z);
+            if (absZ * sp.bound < screening_threshold_) continue;
+
+            double C[3];
+            C[0] = Zxyzp[atom][1];
+            C[1] = Zxyzp[atom][2];
+            C[2] = Zxyzp[atom][3];
+
+            ::memset(buffer, 0, ni * nj * sizeof(double));
+            bool significant = false;
+            for (const PrimitivePair &pp : sp.prims) {
                 double PC[3];
+                PC[0] = pp.P[0] - C[0];
+                PC[1] = pp.P[1] - C[1];
+                PC[2] = pp.P[2] - C[2];
+                double rPC = std::sqrt(PC[0] * PC[0] + PC[1] * PC[1] + PC[2] * PC[2]);
+                double estimate = absZ * std::min(pp.near_bound, pp.bound / rPC);
+                if (estimate < screening_threshold_) continue;
+                significant = true;
 
-                double Z = Zxyzp[atom][0];
-
-                double C[3];
-                C[0] = Zxyzp[atom][1];
-                C[1] = Zxyzp[atom][2];
-                C[2] = Zxyzp[atom][3];
-                for (int p1 = 0; p1 < nprim1; ++p1) {
-                    double a1 = s1.exp(p1);
-                    double c1 = s1.coef(p1);
-                    for (int p2 = 0; p2 < nprim2; ++p2) {
-                        double a2 = s2.exp(p2);
-                        double c2 = s2.coef(p2);
-                        double gamma = a1 + a2;
-                        double oog = 1.0 / gamma;
-
-                        double PA[3], PB[3], P[3];
-                        P[0] = (a1 * A[0] + a2 * B[0]) * oog;
-                        P[1] = (a1 * A[1] + a2 * B[1]) * oog;
-                        P[2] = (a1 * A[2] + a2 * B[2]) * oog;
-                        PA[0] = P[0] - A[0];
-                        PA[1] = P[1] - A[1];
-                        PA[2] = P[2] - A[2];
-                        PB[0] = P[0] - B[0];
-                        PB[1] = P[1] - B[1];
-                        PB[2] = P[2] - B[2];
-                        PC[0] = P[0] - C[0];
-                        PC[1] = P[1] - C[1];
-                        PC[2] = P[2] - C[2];
-
-                        double over_pf = exp(-a1 * a2 * AB2 * oog) * sqrt(M_PI * oog) * M_PI * oog * c1 * c2;
-
-                        // Do recursion
-                        potential_recur_->compute(PA, PB, PC, gamma, am1, am2);
-
-                        ao12 = 0;
-                        for (int ii = 0; ii <= am1; ii++) {
-                            int l1 = am1 - ii;
-                            for (int jj = 0; jj <= ii; jj++) {
-                                int m1 = ii - jj;
-                                int n1 = jj;
-                                /*--- create all am components of sj ---*/
-                                for (int kk = 0; kk <= am2; kk++) {
-                                    int l2 = am2 - kk;
-                                    for (int ll = 0; ll <= kk; ll++) {
-                                        int m2 = kk - ll;
-                                        int n2 = ll;
-
-                                        // Compute location in the recursion and store the value
-                                        int iind = l1 * ixm + m1 * iym + n1 * izm;
-                                        int jind = l2 * jxm + m2 * jym + n2 * jzm;
-                                        buffer_[ao12++] += -vi[iind][jind][0] * over_pf * Z;
-                                    }
-                                }
-                            }
-                        }
-                    }  // End loop over primitives of shell 2
-                }      // End loop over primitives of shell 1
-                ao12 = 0;
-                int ao1 = 0;
+                // Do recursion
+                double PA[3] = {pp.PA[0], pp.PA[1], pp.PA[2]};
+                double PB[3] = {pp.PB[0], pp.PB[1], pp.PB[2]};
+                recur->compute(PA, PB, PC, pp.gamma, am1, am2);
+
+                double prefac = -pp.over_pf * Z;
+                int ao12 = 0;
                 for (int ii = 0; ii <= am1; ii++) {
+                    int l1 = am1 - ii;
                     for (int jj = 0; jj <= ii; jj++) {
+                        int m1 = ii - jj;
+                        int n1 = jj;
                         /*--- create all am components of sj ---*/
-                        int ao2 = 0;
                         for (int kk = 0; kk <= am2; kk++) {
+                            int l2 = am2 - kk;
                             for (int ll = 0; ll <= kk; ll++) {
-                                // Compute location in the recursion
-                                double val = buffer_[ao12++];
-                                // Hand the work off to the functor
-                                functor(ao1 + bf1_offset, ao2 + bf2_offset, atom, val);
-                                ao2++;
+                                int m2 = kk - ll;
+                                int n2 = ll;
+
+                                // Compute location in the recursion and store the value
+                                int iind = l1 * ixm + m1 * iym + n1 * izm;
+                                int jind = l2 * jxm + m2 * jym + n2 * jzm;
+                                buffer[ao12++] += vi[iind][jind][0] * prefac;
                             }
                         }
-                        ao1++;
                     }
                 }
-            }  // End loop over points
-            bf2_offset += nj;
-        }  // End loop over shell 2
-        bf1_offset += ni;
-    }  // End loop over shell 1
+            }  // End loop over primitive pairs
+            if (!significant) continue;
+
+            // Hand the work off to the functor
+            int ao12 = 0;
+            for (int ao1 = 0; ao1 < ni; ++ao1) {
+                for (int ao2 = 0; ao2 < nj; ++ao2) {
+                    double val = buffer[ao12++];
+                    functor(ao1 + sp.bf1_offset, ao2 + sp.bf2_offset, atom, val, thread);
+                    if (sp.i != sp.j) functor(ao2 + sp.bf2_offset, ao1 + sp.bf1_offset, atom, val, thread);
+                }
+            }
+        }  // End loop over points
+    }      // End loop over shell pairs
+
+    functor.finalize();
 }
 
 class PrintIntegralsFunctor {
@@ -199,7 +228,10 @@ class PrintIntegralsFunctor {
     /**
      * A functor, to be used with PCMPotentialInt, that just prints the integrals out for debugging
      */
-    void operator()(int bf1, int bf2, int center, double integral) {
+    void initialize(int /*nthread*/) {}
+    void finalize() {}
+    void operator()(int bf1, int bf2, int center, double integral, int /*thread*/) {
+#pragma omp critical
         outfile->Printf("bf1: %3d bf2 %3d center (%5d) integral %16.10f\n", bf1, bf2, center, integral);
     }
 };
@@ -208,23 +240,38 @@ class ContractOverDensityFunctor {
     /**
      * A functor, to be used with PCMPotentialInt, that just contracts potential integrals and the
      * density matrix, over the basis function indices, giving the charge expectation value.
+     * Each thread accumulates into its own array, summed into the charges on finalize().
      */
    protected:
+    /// The number of charges
+    size_t ncenters_;
     /// Pointer to the density matrix.
     double **pD_;
     /// The array of charges
     double *charges_;
+    /// Per-thread accumulators
+    std::vector<std::vector<double>> thread_charges_;
 
    public:
-    ContractOverDensityFunctor(size_t /*ncenters*/, double *charges, SharedMatrix D)
-        : pD_(D->pointer()), charges_(charges) {}
-    void operator()(int bf1, int bf2, int center, double integral) { charges_[center] += pD_[bf1][bf2] * integral; }
+    ContractOverDensityFunctor(size_t ncenters, double *charges, SharedMatrix D)
+        : ncenters_(ncenters), pD_(D->pointer()), charges_(charges) {}
+    void initialize(int nthread) { thread_charges_.assign(nthread, std::vector<double>(ncenters_, 0.0)); }
+    void finalize() {
+        for (const auto &tc : thread_charges_) {
+            for (size_t center = 0; center < ncenters_; ++center) charges_[center] += tc[center];
+        }
+        thread_charges_.clear();
+    }
+    void operator()(int bf1, int bf2, int center, double integral, int thread) {
+        thread_charges_[thread][center] += pD_[bf1][bf2] * integral;
+    }
 };
 
 class ContractOverChargesFunctor {
     /**
      * A functor, to be used with PCMPotentialInt, that just contracts potential integrals over charges,
-     * leaving a contribution to the Fock matrix
+     * leaving a contribution to the Fock matrix.  Each shell pair block of the matrix is only ever
+     * touched by the thread that computes that pair, so no per-thread copies are needed.
      */
    protected:
     /// Pointer to the matrix that will contribute to the 2e part of the Fock matrix
@@ -239,7 +286,11 @@ class ContractOverChargesFunctor {
         ::memset(pF_[0], 0, nbf * nbf * sizeof(double));
     }
 
-    void operator()(int bf1, int bf2, int center, double integral) { pF_[bf1][bf2] += integral * charges_[center]; }
+    void initialize(int /*nthread*/) {}
+    void finalize() {}
+    void operator()(int bf1, int bf2, int center, double integral, int /*thread*/) {
+        pF_[bf1][bf2] += integral * charges_[center];
+    }
 };
 
 }  // namespace psi
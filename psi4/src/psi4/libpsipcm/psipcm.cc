@@ -214,6 +214,8 @@ PCM::PCM(const PCM *other) {
     pcm_print_ = other->pcm_print_;
 }
 
+void PCM::set_screening_threshold(double threshold) { potential_int_->set_screening_threshold(threshold); }
+
 SharedVector PCM::compute_electronic_MEP(const SharedMatrix &D) const {
     double **ptess_Zxyz = tess_Zxyz_->pointer();
     for (int tess = 0; tess < ntess_; ++tess) ptess_Zxyz[tess][0] = 1.0;
@@ -57,6 +57,8 @@ class PCM final {
      *  \param[in] type how to treat MEP and ASC
      */
     std::pair<double, SharedMatrix> compute_PCM_terms(const SharedMatrix &D, CalcType type = CalcType::Total) const;
+    /// Set the magnitude below which contributions to the tessera potential integrals are neglected
+    void set_screening_threshold(double threshold);
 
    private:
     /// The number of tesserae in PCMSolver.
@@ -205,9 +205,15 @@ void SAPT2::Y2(int intfile, const char *AAlabel, const char *ARlabel, const char
     size_t aoccA = noccA - foccA;
 
     double **yAR = block_matrix(aoccA, nvirA);
+    double **y1AR = block_matrix(aoccA, nvirA);
     double **tAR = block_matrix(aoccA, nvirA);
 
-    Y2_3(yAR, intfile, AAlabel, RRlabel, ampfile, thetalabel, foccA, noccA, nvirA);
+    // Y2_1 and Y2_3 share a single pass over the RR integrals. The Y2_1 part is
+    // kept aside as it does not enter the singles amplitude
+    std::vector<DFStreamTerm> RRterms;
+    Y2_3(yAR, RRterms, intfile, AAlabel, ampfile, thetalabel, foccA, noccA, nvirA);
+    Y2_1(y1AR, RRterms, intfile, ARlabel, ampfile, pRRlabel, foccA, noccA, nvirA);
+    stream_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA, RRterms);
 
     C_DCOPY(aoccA * nvirA, yAR[0], 1, tAR[0], 1);
 
@@ -221,7 +227,9 @@ void SAPT2::Y2(int intfile, const char *AAlabel, const char *ARlabel, const char
 
     free_block(tAR);
 
-    Y2_1(yAR, intfile, ARlabel, RRlabel, ampfile, pRRlabel, foccA, noccA, nvirA);
+    C_DAXPY(aoccA * nvirA, 1.0, y1AR[0], 1, yAR[0], 1);
+    free_block(y1AR);
+
     Y2_2(yAR, intfile, AAlabel, ARlabel, ampfile, pAAlabel, foccA, noccA, nvirA);
 
     psio_->write_entry(ampout, Ylabel, (char *)yAR[0], sizeof(double) * aoccA * nvirA);
@@ -229,36 +237,43 @@ void SAPT2::Y2(int intfile, const char *AAlabel, const char *ARlabel, const char
     free_block(yAR);
 }
 
-void SAPT2::Y2_1(double **yAR, int intfile, const char *ARlabel, const char *RRlabel, int ampfile, const char *pRRlabel,
-                 size_t foccA, size_t noccA, size_t nvirA) {
+void SAPT2::Y2_1(double **yAR, std::vector<DFStreamTerm> &RRterms, int intfile, const char *ARlabel, int ampfile,
+                 const char *pRRlabel, size_t foccA, size_t noccA, size_t nvirA) {
     size_t aoccA = noccA - foccA;
 
     double **pRR = block_matrix(nvirA, nvirA);
     psio_->read_entry(ampfile, pRRlabel, (char *)pRR[0], sizeof(double) * nvirA * nvirA);
 
     double **B_p_AR = get_DF_ints(intfile, ARlabel, foccA, noccA, 0, nvirA);
-    double **B_p_RR = get_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA);
 
     double *X = init_array(ndf_ + 3);
     double **C_p_AR = block_matrix(aoccA * nvirA, ndf_ + 3);
 
-    C_DGEMV('t', nvirA * nvirA, ndf_ + 3, 1.0, B_p_RR[0], ndf_ + 3, pRR[0], 1, 0.0, X, 1);
-
     for (int a = 0; a < aoccA; a++) {
         C_DGEMM('T', 'N', nvirA, ndf_ + 3, nvirA, 1.0, pRR[0], nvirA, B_p_AR[a * nvirA], ndf_ + 3, 0.0,
                 C_p_AR[a * nvirA], ndf_ + 3);
     }
 
-    C_DGEMV('n', aoccA * nvirA, ndf_ + 3, 2.0, B_p_AR[0], ndf_ + 3, X, 1, 1.0, yAR[0], 1);
-
-    C_DGEMM('N', 'T', aoccA, nvirA, nvirA * (ndf_ + 3), -1.0, C_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
-            nvirA * (ndf_ + 3), 1.0, yAR[0], nvirA);
-
-    free(X);
-    free_block(pRR);
-    free_block(B_p_AR);
-    free_block(C_p_AR);
-    free_block(B_p_RR);
+    DFStreamTerm term;
+    term.memory = nvirA * nvirA + 2 * aoccA * nvirA * (ndf_ + 3) + ndf_ + 3;
+    term.compute = [this, yAR, pRR, X, C_p_AR, aoccA, nvirA](double **B_p_RR, size_t rr, size_t nrr) {
+        size_t r = rr / nvirA;
+        size_t nr = nrr / nvirA;
+
+        C_DGEMV('t', nrr, ndf_ + 3, 1.0, B_p_RR[0], ndf_ + 3, &(pRR[0][rr]), 1, 1.0, X, 1);
+
+        C_DGEMM('N', 'T', aoccA, nr, nvirA * (ndf_ + 3), -1.0, C_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
+                nvirA * (ndf_ + 3), 1.0, &(yAR[0][r]), nvirA);
+    };
+    term.finish = [this, yAR, pRR, X, B_p_AR, C_p_AR, aoccA, nvirA]() {
+        C_DGEMV('n', aoccA * nvirA, ndf_ + 3, 2.0, B_p_AR[0], ndf_ + 3, X, 1, 1.0, yAR[0], 1);
+
+        free(X);
+        free_block(pRR);
+        free_block(B_p_AR);
+        free_block(C_p_AR);
+    };
+    RRterms.push_back(term);
 }
 
 void SAPT2::Y2_2(double **yAR, int intfile, const char *AAlabel, const char *ARlabel, int ampfile, const char *pAAlabel,
@@ -293,7 +308,7 @@ void SAPT2::Y2_2(double **yAR, int intfile, const char *AAlabel, const char *ARl
     free_block(B_p_AR);
 }
 
-void SAPT2::Y2_3(double **yAR, int intfile, const char *AAlabel, const char *RRlabel, int ampfile,
+void SAPT2::Y2_3(double **yAR, std::vector<DFStreamTerm> &RRterms, int intfile, const char *AAlabel, int ampfile,
                  const char *thetalabel, size_t foccA, size_t noccA, size_t nvirA) {
     size_t aoccA = noccA - foccA;
 
@@ -301,19 +316,25 @@ void SAPT2::Y2_3(double **yAR, int intfile, const char *AAlabel, const char *RRl
     psio_->read_entry(ampfile, thetalabel, (char *)T_p_AR[0], sizeof(double) * aoccA * nvirA * (ndf_ + 3));
 
     double **B_p_AA = get_DF_ints(intfile, AAlabel, foccA, noccA, foccA, noccA);
-    double **B_p_RR = get_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA);
 
     for (int a = 0; a < aoccA; a++) {
         C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, -1.0, B_p_AA[a * aoccA], ndf_ + 3, T_p_AR[a * nvirA], ndf_ + 3, 1.0,
                 yAR[0], nvirA);
     }
 
-    C_DGEMM('N', 'T', aoccA, nvirA, nvirA * (ndf_ + 3), 1.0, T_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
-            nvirA * (ndf_ + 3), 1.0, yAR[0], nvirA);
-
     free_block(B_p_AA);
-    free_block(T_p_AR);
-    free_block(B_p_RR);
+
+    DFStreamTerm term;
+    term.memory = aoccA * nvirA * (ndf_ + 3);
+    term.compute = [this, yAR, T_p_AR, aoccA, nvirA](double **B_p_RR, size_t rr, size_t nrr) {
+        size_t r = rr / nvirA;
+        size_t nr = nrr / nvirA;
+
+        C_DGEMM('N', 'T', aoccA, nr, nvirA * (ndf_ + 3), 1.0, T_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
+                nvirA * (ndf_ + 3), 1.0, &(yAR[0][r]), nvirA);
+    };
+    term.finish = [T_p_AR]() { free_block(T_p_AR); };
+    RRterms.push_back(term);
 }
 
 void SAPT2::t2OVOV(int ampfile, const char *tlabel, const char *thetalabel, int intfile, const char *AAlabel,
@@ -325,17 +346,19 @@ void SAPT2::t2OVOV(int ampfile, const char *tlabel, const char *thetalabel, int
 
     double **vAARR = block_matrix(aoccA * nvirA, aoccA * nvirA);
     double **B_p_AA = get_DF_ints(intfile, AAlabel, foccA, noccA, foccA, noccA);
-    double **B_p_RR = get_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA);
 
-    for (int a = 0, ar = 0; a < aoccA; a++) {
-        for (int r = 0; r < nvirA; r++, ar++) {
-            C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, 1.0, B_p_AA[a * aoccA], ndf_ + 3, B_p_RR[r * nvirA], ndf_ + 3,
-                    0.0, vAARR[ar], nvirA);
+    DFStreamTerm vAARR_term;
+    vAARR_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        for (size_t r = rr / nvirA, rb = 0; rb < nrr; r++, rb += nvirA) {
+            for (int a = 0; a < aoccA; a++) {
+                C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, 1.0, B_p_AA[a * aoccA], ndf_ + 3, B_p_RR[rb], ndf_ + 3, 0.0,
+                        vAARR[a * nvirA + r], nvirA);
+            }
         }
-    }
+    };
+    stream_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA, {vAARR_term});
 
     free_block(B_p_AA);
-    free_block(B_p_RR);
 
     double *tARAR = init_array((long int)aoccA * nvirA * aoccA * nvirA);
     psio_->read_entry(ampfile, tlabel, (char *)tARAR, sizeof(double) * aoccA * nvirA * aoccA * nvirA);
@@ -383,7 +406,7 @@ void SAPT2::t2OVOV(int ampfile, const char *tlabel, const char *thetalabel, int
 
     free_block(vAAAA);
 
-    B_p_RR = get_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA);
+    double **B_p_RR = get_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA);
     double **xRRR = block_matrix(nvirA * nvirA, nvirA);
 
     for (int r = 0; r < nvirA; r++) {
@@ -427,17 +450,19 @@ void SAPT2::t2OVOV(int ampfile, const char *tlabel, const char *no_tlabel, const
 
     double **vAARR = block_matrix(aoccA * nvirA, aoccA * nvirA);
     double **B_p_AA = get_DF_ints(intfile, AAlabel, foccA, noccA, foccA, noccA);
-    double **B_p_RR = get_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA);
 
-    for (int a = 0, ar = 0; a < aoccA; a++) {
-        for (int r = 0; r < nvirA; r++, ar++) {
-            C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, 1.0, B_p_AA[a * aoccA], ndf_ + 3, B_p_RR[r * nvirA], ndf_ + 3,
-                    0.0, vAARR[ar], nvirA);
+    DFStreamTerm vAARR_term;
+    vAARR_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        for (size_t r = rr / nvirA, rb = 0; rb < nrr; r++, rb += nvirA) {
+            for (int a = 0; a < aoccA; a++) {
+                C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, 1.0, B_p_AA[a * aoccA], ndf_ + 3, B_p_RR[rb], ndf_ + 3, 0.0,
+                        vAARR[a * nvirA + r], nvirA);
+            }
         }
-    }
+    };
+    stream_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA, {vAARR_term});
 
     free_block(B_p_AA);
-    free_block(B_p_RR);
 
     double *tARAR = init_array((long int)aoccA * nvirA * aoccA * nvirA);
     psio_->read_entry(ampfile, tlabel, (char *)tARAR, sizeof(double) * aoccA * nvirA * aoccA * nvirA);
@@ -504,7 +529,7 @@ void SAPT2::t2OVOV(int ampfile, const char *tlabel, const char *no_tlabel, const
     psio_->read_entry(ampfile, no_tlabel, (char *)tArAr, sizeof(double) * aoccA * no_nvirA * aoccA * no_nvirA);
     ijkl_to_ikjl(tArAr, aoccA, no_nvirA, aoccA, no_nvirA);
 
-    B_p_RR = get_DF_ints(intfile, no_RRlabel, 0, no_nvirA, 0, no_nvirA);
+    double **B_p_RR = get_DF_ints(intfile, no_RRlabel, 0, no_nvirA, 0, no_nvirA);
     double **xRRR = block_matrix(no_nvirA * no_nvirA, no_nvirA);
 
     for (int r = 0; r < no_nvirA; r++) {
@@ -841,21 +866,42 @@ void SAPT2p3::Y3(int intfile, const char *AAlabel, const char *ARlabel, const ch
 
     double **yAR = block_matrix(aoccA, nvirA);
 
-    Y2_1(yAR, intfile, ARlabel, RRlabel, ampfile, qRRlabel, foccA, noccA, nvirA);
+    // The terms that need no pass over the RR integrals run first, so that none of them
+    // overlaps with the inputs held by the streamed group
     Y2_2(yAR, intfile, AAlabel, ARlabel, ampfile, qAAlabel, foccA, noccA, nvirA);
-    Y2_1(yAR, intfile, ARlabel, RRlabel, ampfile, qbarRRlabel, foccA, noccA, nvirA);
     Y2_2(yAR, intfile, AAlabel, ARlabel, ampfile, qbarAAlabel, foccA, noccA, nvirA);
-    Y2_3(yAR, intfile, AAlabel, RRlabel, ampfile, thetalabel, foccA, noccA, nvirA);
     Y3_1(yAR, intfile, AAlabel, ARlabel, ampfile, tlabel, foccA, noccA, nvirA);
     Y3_2(yAR, intfile, ARlabel, RRlabel, ampfile, tlabel, foccA, noccA, nvirA);
-    Y3_3(yAR, intfile, AAlabel, ARlabel, RRlabel, ampfile, tlabel, foccA, noccA, nvirA);
-    Y3_4(yAR, intfile, AAlabel, ARlabel, RRlabel, ampfile, tlabel, foccA, noccA, nvirA);
+
+    // Terms contracting the full RR integrals share one pass over them as long as their
+    // resident inputs fit in memory together; otherwise the pending group is streamed before
+    // the next term is built.  Building Y3_3 transiently needs three (ar|ar) arrays.
+    size_t ov = aoccA * nvirA;
+    size_t Y3_build = std::max(3 * ov * ov, Y3_stream_memory(aoccA, nvirA));
+
+    std::vector<DFStreamTerm> RRterms;
+    Y2_1(yAR, RRterms, intfile, ARlabel, ampfile, qRRlabel, foccA, noccA, nvirA);
+    flush_DF_stream(intfile, RRlabel, 0, nvirA, 0, nvirA, RRterms, RRterms.back().memory);
+    Y2_1(yAR, RRterms, intfile, ARlabel, ampfile, qbarRRlabel, foccA, noccA, nvirA);
+    flush_DF_stream(intfile, RRlabel, 0, nvirA, 0, nvirA, RRterms, ov * (ndf_ + 3));
+    Y2_3(yAR, RRterms, intfile, AAlabel, ampfile, thetalabel, foccA, noccA, nvirA);
+    flush_DF_stream(intfile, RRlabel, 0, nvirA, 0, nvirA, RRterms, Y3_build);
+    Y3_3(yAR, RRterms, intfile, AAlabel, ARlabel, ampfile, tlabel, foccA, noccA, nvirA);
+    flush_DF_stream(intfile, RRlabel, 0, nvirA, 0, nvirA, RRterms, Y3_build);
+    Y3_4(yAR, RRterms, intfile, AAlabel, ARlabel, ampfile, tlabel, foccA, noccA, nvirA);
+    stream_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA, RRterms);
 
     psio_->write_entry(ampout, Ylabel, (char *)yAR[0], sizeof(double) * aoccA * nvirA);
 
     free_block(yAR);
 }
 
+// Doubles a Y3_3 or Y3_4 term keeps until the RR pass ends
+size_t SAPT2p3::Y3_stream_memory(size_t aoccA, size_t nvirA) {
+    size_t ov = aoccA * nvirA;
+    return ov * ov + (2 * ov + 2 * aoccA * aoccA) * (ndf_ + 3) + DF_block_length(nvirA, nvirA) * nvirA * (ndf_ + 3);
+}
+
 void SAPT2p3::Y3_1(double **yAR, int intfile, const char *AAlabel, const char *ARlabel, int ampfile, const char *tlabel,
                    size_t foccA, size_t noccA, size_t nvirA) {
     size_t aoccA = noccA - foccA;
@@ -972,8 +1018,8 @@ void SAPT2p3::Y3_2(double **yAR, int intfile, const char *ARlabel, const char *R
     free(tARAR);
 }
 
-void SAPT2p3::Y3_3(double **yAR, int intfile, const char *AAlabel, const char *ARlabel, const char *RRlabel,
-                   int ampfile, const char *tlabel, size_t foccA, size_t noccA, size_t nvirA) {
+void SAPT2p3::Y3_3(double **yAR, std::vector<DFStreamTerm> &RRterms, int intfile, const char *AAlabel,
+                   const char *ARlabel, int ampfile, const char *tlabel, size_t foccA, size_t noccA, size_t nvirA) {
     size_t aoccA = noccA - foccA;
 
     double *tARAR = init_array((long int)aoccA * nvirA * aoccA * nvirA);
@@ -999,51 +1045,59 @@ void SAPT2p3::Y3_3(double **yAR, int intfile, const char *AAlabel, const char *A
 
     double **B_p_AA = get_DF_ints(intfile, AAlabel, foccA, noccA, foccA, noccA);
     double **B_p_AR = get_DF_ints(intfile, ARlabel, foccA, noccA, 0, nvirA);
-    double **B_p_RR = get_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA);
 
     double **Y_p_AR = block_matrix(aoccA * nvirA, ndf_ + 3);
 
     C_DGEMM('N', 'N', aoccA * nvirA, ndf_ + 3, aoccA * nvirA, 1.0, yARAR, aoccA * nvirA, B_p_AR[0], ndf_ + 3, 0.0,
             Y_p_AR[0], ndf_ + 3);
 
-    C_DGEMM('N', 'T', aoccA, nvirA, nvirA * (ndf_ + 3), 2.0, Y_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
-            nvirA * (ndf_ + 3), 1.0, yAR[0], nvirA);
-
     for (int a = 0; a < aoccA; a++) {
         C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, -2.0, B_p_AA[a * aoccA], ndf_ + 3, Y_p_AR[a * nvirA], ndf_ + 3, 1.0,
                 yAR[0], nvirA);
     }
 
-    free_block(Y_p_AR);
-
-    double **Y_p_AA = block_matrix(aoccA * aoccA, ndf_ + 3);
-
     ijkl_to_ikjl(yARAR, aoccA, nvirA, aoccA, nvirA);
 
-    C_DGEMM('N', 'N', aoccA * aoccA, ndf_ + 3, nvirA * nvirA, 1.0, yARAR, nvirA * nvirA, B_p_RR[0], ndf_ + 3, 0.0,
-            Y_p_AA[0], ndf_ + 3);
-
-    for (int a = 0; a < aoccA; a++) {
-        C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, -1.0, Y_p_AA[a * aoccA], ndf_ + 3, B_p_AR[a * nvirA], ndf_ + 3, 1.0,
-                yAR[0], nvirA);
-    }
-
-    free_block(Y_p_AA);
-
-    C_DGEMM('T', 'N', nvirA * nvirA, ndf_ + 3, aoccA * aoccA, 1.0, yARAR, nvirA * nvirA, B_p_AA[0], ndf_ + 3, 0.0,
-            B_p_RR[0], ndf_ + 3);
-
-    C_DGEMM('N', 'T', aoccA, nvirA, nvirA * (ndf_ + 3), 1.0, B_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
-            nvirA * (ndf_ + 3), 1.0, yAR[0], nvirA);
+    double **Y_p_AA = block_matrix(aoccA * aoccA, ndf_ + 3);
+    double **X_p_RR = block_matrix(DF_block_length(nvirA, nvirA) * nvirA, ndf_ + 3);
+
+    DFStreamTerm term;
+    term.memory = Y3_stream_memory(aoccA, nvirA);
+    term.compute = [this, yAR, yARAR, B_p_AA, B_p_AR, Y_p_AR, Y_p_AA, X_p_RR, aoccA, nvirA](double **B_p_RR, size_t rr,
+                                                                                          size_t nrr) {
+        size_t r = rr / nvirA;
+        size_t nr = nrr / nvirA;
+
+        C_DGEMM('N', 'T', aoccA, nr, nvirA * (ndf_ + 3), 2.0, Y_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
+                nvirA * (ndf_ + 3), 1.0, &(yAR[0][r]), nvirA);
+
+        C_DGEMM('N', 'N', aoccA * aoccA, ndf_ + 3, nrr, 1.0, &(yARAR[rr]), nvirA * nvirA, B_p_RR[0], ndf_ + 3, 1.0,
+                Y_p_AA[0], ndf_ + 3);
+
+        C_DGEMM('T', 'N', nrr, ndf_ + 3, aoccA * aoccA, 1.0, &(yARAR[rr]), nvirA * nvirA, B_p_AA[0], ndf_ + 3, 0.0,
+                X_p_RR[0], ndf_ + 3);
+
+        C_DGEMM('N', 'T', aoccA, nr, nvirA * (ndf_ + 3), 1.0, B_p_AR[0], nvirA * (ndf_ + 3), X_p_RR[0],
+                nvirA * (ndf_ + 3), 1.0, &(yAR[0][r]), nvirA);
+    };
+    term.finish = [this, yAR, yARAR, B_p_AA, B_p_AR, Y_p_AR, Y_p_AA, X_p_RR, aoccA, nvirA]() {
+        for (int a = 0; a < aoccA; a++) {
+            C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, -1.0, Y_p_AA[a * aoccA], ndf_ + 3, B_p_AR[a * nvirA], ndf_ + 3,
+                    1.0, yAR[0], nvirA);
+        }
 
-    free(yARAR);
-    free_block(B_p_AA);
-    free_block(B_p_AR);
-    free_block(B_p_RR);
+        free(yARAR);
+        free_block(B_p_AA);
+        free_block(B_p_AR);
+        free_block(Y_p_AR);
+        free_block(Y_p_AA);
+        free_block(X_p_RR);
+    };
+    RRterms.push_back(term);
 }
 
-void SAPT2p3::Y3_4(double **yAR, int intfile, const char *AAlabel, const char *ARlabel, const char *RRlabel,
-                   int ampfile, const char *tlabel, size_t foccA, size_t noccA, size_t nvirA) {
+void SAPT2p3::Y3_4(double **yAR, std::vector<DFStreamTerm> &RRterms, int intfile, const char *AAlabel,
+                   const char *ARlabel, int ampfile, const char *tlabel, size_t foccA, size_t noccA, size_t nvirA) {
     size_t aoccA = noccA - foccA;
 
     double *tARAR = init_array((long int)aoccA * nvirA * aoccA * nvirA);
@@ -1059,47 +1113,55 @@ void SAPT2p3::Y3_4(double **yAR, int intfile, const char *AAlabel, const char *A
 
     double **B_p_AA = get_DF_ints(intfile, AAlabel, foccA, noccA, foccA, noccA);
     double **B_p_AR = get_DF_ints(intfile, ARlabel, foccA, noccA, 0, nvirA);
-    double **B_p_RR = get_DF_ints(intfile, RRlabel, 0, nvirA, 0, nvirA);
 
     double **Y_p_AR = block_matrix(aoccA * nvirA, ndf_ + 3);
 
     C_DGEMM('N', 'N', aoccA * nvirA, ndf_ + 3, aoccA * nvirA, 1.0, yARAR, aoccA * nvirA, B_p_AR[0], ndf_ + 3, 0.0,
             Y_p_AR[0], ndf_ + 3);
 
-    C_DGEMM('N', 'T', aoccA, nvirA, nvirA * (ndf_ + 3), 1.0, Y_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
-            nvirA * (ndf_ + 3), 1.0, yAR[0], nvirA);
-
     for (int a = 0; a < aoccA; a++) {
         C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, -1.0, B_p_AA[a * aoccA], ndf_ + 3, Y_p_AR[a * nvirA], ndf_ + 3, 1.0,
                 yAR[0], nvirA);
     }
 
-    free_block(Y_p_AR);
-
-    double **Y_p_AA = block_matrix(aoccA * aoccA, ndf_ + 3);
-
     ijkl_to_ikjl(yARAR, aoccA, nvirA, aoccA, nvirA);
 
-    C_DGEMM('N', 'N', aoccA * aoccA, ndf_ + 3, nvirA * nvirA, 1.0, yARAR, nvirA * nvirA, B_p_RR[0], ndf_ + 3, 0.0,
-            Y_p_AA[0], ndf_ + 3);
-
-    for (int a = 0; a < aoccA; a++) {
-        C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, -2.0, Y_p_AA[a * aoccA], ndf_ + 3, B_p_AR[a * nvirA], ndf_ + 3, 1.0,
-                yAR[0], nvirA);
-    }
-
-    free_block(Y_p_AA);
-
-    C_DGEMM('T', 'N', nvirA * nvirA, ndf_ + 3, aoccA * aoccA, 1.0, yARAR, nvirA * nvirA, B_p_AA[0], ndf_ + 3, 0.0,
-            B_p_RR[0], ndf_ + 3);
-
-    C_DGEMM('N', 'T', aoccA, nvirA, nvirA * (ndf_ + 3), 2.0, B_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
-            nvirA * (ndf_ + 3), 1.0, yAR[0], nvirA);
+    double **Y_p_AA = block_matrix(aoccA * aoccA, ndf_ + 3);
+    double **X_p_RR = block_matrix(DF_block_length(nvirA, nvirA) * nvirA, ndf_ + 3);
+
+    DFStreamTerm term;
+    term.memory = Y3_stream_memory(aoccA, nvirA);
+    term.compute = [this, yAR, yARAR, B_p_AA, B_p_AR, Y_p_AR, Y_p_AA, X_p_RR, aoccA, nvirA](double **B_p_RR, size_t rr,
+                                                                                          size_t nrr) {
+        size_t r = rr / nvirA;
+        size_t nr = nrr / nvirA;
+
+        C_DGEMM('N', 'T', aoccA, nr, nvirA * (ndf_ + 3), 1.0, Y_p_AR[0], nvirA * (ndf_ + 3), B_p_RR[0],
+                nvirA * (ndf_ + 3), 1.0, &(yAR[0][r]), nvirA);
+
+        C_DGEMM('N', 'N', aoccA * aoccA, ndf_ + 3, nrr, 1.0, &(yARAR[rr]), nvirA * nvirA, B_p_RR[0], ndf_ + 3, 1.0,
+                Y_p_AA[0], ndf_ + 3);
+
+        C_DGEMM('T', 'N', nrr, ndf_ + 3, aoccA * aoccA, 1.0, &(yARAR[rr]), nvirA * nvirA, B_p_AA[0], ndf_ + 3, 0.0,
+                X_p_RR[0], ndf_ + 3);
+
+        C_DGEMM('N', 'T', aoccA, nr, nvirA * (ndf_ + 3), 2.0, B_p_AR[0], nvirA * (ndf_ + 3), X_p_RR[0],
+                nvirA * (ndf_ + 3), 1.0, &(yAR[0][r]), nvirA);
+    };
+    term.finish = [this, yAR, yARAR, B_p_AA, B_p_AR, Y_p_AR, Y_p_AA, X_p_RR, aoccA, nvirA]() {
+        for (int a = 0; a < aoccA; a++) {
+            C_DGEMM('N', 'T', aoccA, nvirA, ndf_ + 3, -2.0, Y_p_AA[a * aoccA], ndf_ + 3, B_p_AR[a * nvirA], ndf_ + 3,
+                    1.0, yAR[0], nvirA);
+        }
 
-    free(yARAR);
-    free_block(B_p_AA);
-    free_block(B_p_AR);
-    free_block(B_p_RR);
+        free(yARAR);
+        free_block(B_p_AA);
+        free_block(B_p_AR);
+        free_block(Y_p_AR);
+        free_block(Y_p_AA);
+        free_block(X_p_RR);
+    };
+    RRterms.push_back(term);
 }
 
 void SAPT2p3::ind30_amps(int AAfile, const char *ARlabel, int BBfile, const char *BSlabel, double **wBAA, double **wBAR,
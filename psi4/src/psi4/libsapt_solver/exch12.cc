@@ -508,14 +508,15 @@ double SAPT2::exch120_k11u_1() {
     free_block(zBB);
     free_block(zRB);
 
-    double **B_p_RR = get_RR_ints(1);
-
     double *X = init_array((ndf_ + 3));
 
-    C_DGEMV('t', nvirA_ * nvirA_, (ndf_ + 3), 1.0, &(B_p_RR[0][0]), (ndf_ + 3), pRR[0], 1, 0.0, X, 1);
+    DFStreamTerm X_term;
+    X_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        C_DGEMV('t', nrr, (ndf_ + 3), 1.0, &(B_p_RR[0][0]), (ndf_ + 3), &(pRR[0][rr]), 1, 1.0, X, 1);
+    };
+    stream_RR_ints(1, {X_term});
 
     free_block(pRR);
-    free_block(B_p_RR);
 
     double **xAB = block_matrix(noccA_, noccB_);
 
@@ -676,14 +677,15 @@ double SAPT2::exch102_k11u_1() {
     free_block(zAA);
     free_block(zAS);
 
-    double **B_p_SS = get_SS_ints(1);
-
     double *X = init_array((ndf_ + 3));
 
-    C_DGEMV('t', nvirB_ * nvirB_, (ndf_ + 3), 1.0, B_p_SS[0], (ndf_ + 3), pSS[0], 1, 0.0, X, 1);
+    DFStreamTerm X_term;
+    X_term.compute = [&](double **B_p_SS, size_t ss, size_t nss) {
+        C_DGEMV('t', nss, (ndf_ + 3), 1.0, B_p_SS[0], (ndf_ + 3), &(pSS[0][ss]), 1, 1.0, X, 1);
+    };
+    stream_SS_ints(1, {X_term});
 
     free_block(pSS);
-    free_block(B_p_SS);
 
     double **xAB = block_matrix(noccA_, noccB_);
 
@@ -1088,30 +1090,6 @@ double SAPT2::exch120_k11u_3() {
 
     free_block(temp_tARAR);
 
-    double **B_p_RB = get_RB_ints(1);
-    double **B_p_RR = get_RR_ints(1);
-
-    double *yRB = init_array(nvirA_ * noccB_);
-    double **zRB = block_matrix(nvirA_, nvirA_ * noccB_);
-
-    for (int r1 = 0; r1 < nvirA_; r1++) {
-        C_DGEMM('N', 'T', r1 + 1, nvirA_ * noccB_, (ndf_ + 3), 1.0, B_p_RR[r1 * nvirA_], (ndf_ + 3), B_p_RB[0],
-                (ndf_ + 3), 0.0, zRB[0], nvirA_ * noccB_);
-        for (int r2 = 0; r2 <= r1; r2++) {
-            int r1r2 = r1 * nvirA_ + r2;
-            C_DGEMM('N', 'T', nvirA_, noccB_, aoccA_ * aoccA_, 1.0, tRRAA[r2 * nvirA_], aoccA_ * aoccA_,
-                    thetaRBAA[r1 * noccB_], aoccA_ * aoccA_, 0.0, yRB, noccB_);
-            if (r1 != r2)
-                C_DGEMM('N', 'T', nvirA_, noccB_, aoccA_ * aoccA_, 1.0, tRRAA[r1 * nvirA_], aoccA_ * aoccA_,
-                        thetaRBAA[r2 * noccB_], aoccA_ * aoccA_, 1.0, yRB, noccB_);
-            energy += 2.0 * C_DDOT(nvirA_ * noccB_, yRB, 1, zRB[r2], 1);
-        }
-    }
-
-    free(yRB);
-    free_block(zRB);
-    free_block(B_p_RB);
-
     double **tRBAA = block_matrix(nvirA_ * noccB_, aoccA_ * aoccA_);
 
     for (int r1 = 0; r1 < nvirA_; r1++) {
@@ -1119,44 +1097,73 @@ double SAPT2::exch120_k11u_3() {
                 aoccA_ * aoccA_, 0.0, &(tRBAA[r1 * noccB_][0]), aoccA_ * aoccA_);
     }
 
-    free_block(tRRAA);
-
     double **xRR = block_matrix(nvirA_, nvirA_);
     double **yRR = block_matrix(nvirA_, nvirA_);
 
     C_DGEMM('N', 'T', nvirA_, nvirA_, aoccA_ * aoccA_ * noccB_, 1.0, &(tRBAA[0][0]), aoccA_ * aoccA_ * noccB_,
             &(thetaRBAA[0][0]), aoccA_ * aoccA_ * noccB_, 0.0, &(xRR[0][0]), nvirA_);
 
-    C_DGEMV('n', nvirA_ * nvirA_, (ndf_ + 3), 1.0, B_p_RR[0], (ndf_ + 3), diagBB_, 1, 0.0, &(yRR[0][0]), 1);
-
-    energy += 4.0 * C_DDOT(nvirA_ * nvirA_, xRR[0], 1, yRR[0], 1);
-
-    free_block(xRR);
-    free_block(yRR);
-
+    double **B_p_RB = get_RB_ints(1);
     double **B_p_BB = get_BB_ints(1);
 
+    double *yRB = init_array(nvirA_ * noccB_);
+    double **zRB = block_matrix(nvirA_, nvirA_ * noccB_);
     double *yBB = init_array(noccB_ * noccB_);
     double **zBB = block_matrix(nvirA_, noccB_ * noccB_);
 
-    for (int r1 = 0; r1 < nvirA_; r1++) {
-        C_DGEMM('N', 'T', r1 + 1, noccB_ * noccB_, (ndf_ + 3), 1.0, B_p_RR[r1 * nvirA_], (ndf_ + 3), B_p_BB[0],
-                (ndf_ + 3), 0.0, zBB[0], noccB_ * noccB_);
-        for (int r2 = 0; r2 <= r1; r2++) {
-            int r1r2 = r1 * nvirA_ + r2;
-            C_DGEMM('N', 'T', noccB_, noccB_, aoccA_ * aoccA_, 1.0, &(tRBAA[r2 * noccB_][0]), aoccA_ * aoccA_,
-                    &(thetaRBAA[r1 * noccB_][0]), aoccA_ * aoccA_, 0.0, yBB, noccB_);
-            if (r1 != r2)
-                C_DGEMM('N', 'T', noccB_, noccB_, aoccA_ * aoccA_, 1.0, &(tRBAA[r1 * noccB_][0]), aoccA_ * aoccA_,
-                        &(thetaRBAA[r2 * noccB_][0]), aoccA_ * aoccA_, 1.0, yBB, noccB_);
-            energy -= 2.0 * C_DDOT(noccB_ * noccB_, yBB, 1, zBB[r2], 1);
+    // The three contractions with RR share a single pass over it
+    DFStreamTerm zRB_term;
+    zRB_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        size_t r1 = rr / nvirA_;
+        for (size_t r1b = 0; r1b < nrr; r1++, r1b += nvirA_) {
+            C_DGEMM('N', 'T', r1 + 1, nvirA_ * noccB_, (ndf_ + 3), 1.0, B_p_RR[r1b], (ndf_ + 3), B_p_RB[0],
+                    (ndf_ + 3), 0.0, zRB[0], nvirA_ * noccB_);
+            for (size_t r2 = 0; r2 <= r1; r2++) {
+                C_DGEMM('N', 'T', nvirA_, noccB_, aoccA_ * aoccA_, 1.0, tRRAA[r2 * nvirA_], aoccA_ * aoccA_,
+                        thetaRBAA[r1 * noccB_], aoccA_ * aoccA_, 0.0, yRB, noccB_);
+                if (r1 != r2)
+                    C_DGEMM('N', 'T', nvirA_, noccB_, aoccA_ * aoccA_, 1.0, tRRAA[r1 * nvirA_], aoccA_ * aoccA_,
+                            thetaRBAA[r2 * noccB_], aoccA_ * aoccA_, 1.0, yRB, noccB_);
+                energy += 2.0 * C_DDOT(nvirA_ * noccB_, yRB, 1, zRB[r2], 1);
+            }
         }
-    }
+    };
+
+    DFStreamTerm yRR_term;
+    yRR_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        C_DGEMV('n', nrr, (ndf_ + 3), 1.0, B_p_RR[0], (ndf_ + 3), diagBB_, 1, 0.0, &(yRR[0][rr]), 1);
+    };
+
+    DFStreamTerm zBB_term;
+    zBB_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        size_t r1 = rr / nvirA_;
+        for (size_t r1b = 0; r1b < nrr; r1++, r1b += nvirA_) {
+            C_DGEMM('N', 'T', r1 + 1, noccB_ * noccB_, (ndf_ + 3), 1.0, B_p_RR[r1b], (ndf_ + 3), B_p_BB[0],
+                    (ndf_ + 3), 0.0, zBB[0], noccB_ * noccB_);
+            for (size_t r2 = 0; r2 <= r1; r2++) {
+                C_DGEMM('N', 'T', noccB_, noccB_, aoccA_ * aoccA_, 1.0, &(tRBAA[r2 * noccB_][0]), aoccA_ * aoccA_,
+                        &(thetaRBAA[r1 * noccB_][0]), aoccA_ * aoccA_, 0.0, yBB, noccB_);
+                if (r1 != r2)
+                    C_DGEMM('N', 'T', noccB_, noccB_, aoccA_ * aoccA_, 1.0, &(tRBAA[r1 * noccB_][0]), aoccA_ * aoccA_,
+                            &(thetaRBAA[r2 * noccB_][0]), aoccA_ * aoccA_, 1.0, yBB, noccB_);
+                energy -= 2.0 * C_DDOT(noccB_ * noccB_, yBB, 1, zBB[r2], 1);
+            }
+        }
+    };
+
+    stream_RR_ints(1, {zRB_term, yRR_term, zBB_term});
 
+    energy += 4.0 * C_DDOT(nvirA_ * nvirA_, xRR[0], 1, yRR[0], 1);
+
+    free(yRB);
+    free_block(zRB);
+    free_block(B_p_RB);
+    free_block(xRR);
+    free_block(yRR);
+    free_block(tRRAA);
     free_block(tRBAA);
     free_block(thetaRBAA);
     free_block(B_p_BB);
-    free_block(B_p_RR);
     free(yBB);
     free_block(zBB);
 
@@ -1234,29 +1241,6 @@ double SAPT2::exch102_k11u_3() {
 
     free_block(B_AS_p);
 
-    double **B_p_SS = get_SS_ints(1);
-
-    double *ySA = init_array(nvirB_ * noccA_);
-    double **zSA = block_matrix(nvirB_, nvirB_ * noccA_);
-
-    for (int s1 = 0; s1 < nvirB_; s1++) {
-        C_DGEMM('N', 'T', s1 + 1, nvirB_ * noccA_, (ndf_ + 3), 1.0, B_p_SS[s1 * nvirB_], (ndf_ + 3), B_p_SA[0],
-                (ndf_ + 3), 0.0, zSA[0], nvirB_ * noccA_);
-        for (int s2 = 0; s2 <= s1; s2++) {
-            int s1s2 = s1 * nvirA_ + s2;
-            C_DGEMM('N', 'T', nvirB_, noccA_, aoccB_ * aoccB_, 1.0, tSSBB[s2 * nvirB_], aoccB_ * aoccB_,
-                    thetaSABB[s1 * noccA_], aoccB_ * aoccB_, 0.0, ySA, noccA_);
-            if (s1 != s2)
-                C_DGEMM('N', 'T', nvirB_, noccA_, aoccB_ * aoccB_, 1.0, tSSBB[s1 * nvirB_], aoccB_ * aoccB_,
-                        thetaSABB[s2 * noccA_], aoccB_ * aoccB_, 1.0, ySA, noccA_);
-            energy += 2.0 * C_DDOT(nvirB_ * noccA_, ySA, 1, zSA[s2], 1);
-        }
-    }
-
-    free(ySA);
-    free_block(zSA);
-    free_block(B_p_SA);
-
     double **tSABB = block_matrix(nvirB_ * noccA_, aoccB_ * aoccB_);
 
     for (int s1 = 0; s1 < nvirB_; s1++) {
@@ -1264,46 +1248,74 @@ double SAPT2::exch102_k11u_3() {
                 aoccB_ * aoccB_, 0.0, &(tSABB[s1 * noccA_][0]), aoccB_ * aoccB_);
     }
 
-    free_block(tSSBB);
-
     double **xSS = block_matrix(nvirB_, nvirB_);
     double **ySS = block_matrix(nvirB_, nvirB_);
 
     C_DGEMM('N', 'T', nvirB_, nvirB_, aoccB_ * aoccB_ * noccA_, 1.0, &(tSABB[0][0]), aoccB_ * aoccB_ * noccA_,
             &(thetaSABB[0][0]), aoccB_ * aoccB_ * noccA_, 0.0, &(xSS[0][0]), nvirB_);
 
-    C_DGEMV('n', nvirB_ * nvirB_, (ndf_ + 3), 1.0, B_p_SS[0], (ndf_ + 3), diagAA_, 1, 0.0, &(ySS[0][0]), 1);
-
-    energy += 4.0 * C_DDOT(nvirB_ * nvirB_, xSS[0], 1, ySS[0], 1);
-
-    free_block(xSS);
-    free_block(ySS);
-
     double **B_p_AA = get_AA_ints(1);
 
+    double *ySA = init_array(nvirB_ * noccA_);
+    double **zSA = block_matrix(nvirB_, nvirB_ * noccA_);
     double *yAA = init_array(noccA_ * noccA_);
     double **zAA = block_matrix(nvirB_, noccA_ * noccA_);
 
-    for (int s1 = 0; s1 < nvirB_; s1++) {
-        C_DGEMM('N', 'T', s1 + 1, noccA_ * noccA_, (ndf_ + 3), 1.0, B_p_SS[s1 * nvirB_], (ndf_ + 3), B_p_AA[0],
-                (ndf_ + 3), 0.0, zAA[0], noccA_ * noccA_);
-        for (int s2 = 0; s2 <= s1; s2++) {
-            int s1s2 = s1 * nvirB_ + s2;
-            C_DGEMM('N', 'T', noccA_, noccA_, aoccB_ * aoccB_, 1.0, &(tSABB[s2 * noccA_][0]), aoccB_ * aoccB_,
-                    &(thetaSABB[s1 * noccA_][0]), aoccB_ * aoccB_, 0.0, yAA, noccA_);
-            if (s1 != s2)
-                C_DGEMM('N', 'T', noccA_, noccA_, aoccB_ * aoccB_, 1.0, &(tSABB[s1 * noccA_][0]), aoccB_ * aoccB_,
-                        &(thetaSABB[s2 * noccA_][0]), aoccB_ * aoccB_, 1.0, yAA, noccA_);
-            energy -= 2.0 * C_DDOT(noccA_ * noccA_, yAA, 1, zAA[s2], 1);
+    // The three contractions with SS share a single pass over it
+    DFStreamTerm zSA_term;
+    zSA_term.compute = [&](double **B_p_SS, size_t ss, size_t nss) {
+        size_t s1 = ss / nvirB_;
+        for (size_t s1b = 0; s1b < nss; s1++, s1b += nvirB_) {
+            C_DGEMM('N', 'T', s1 + 1, nvirB_ * noccA_, (ndf_ + 3), 1.0, B_p_SS[s1b], (ndf_ + 3), B_p_SA[0],
+                    (ndf_ + 3), 0.0, zSA[0], nvirB_ * noccA_);
+            for (size_t s2 = 0; s2 <= s1; s2++) {
+                C_DGEMM('N', 'T', nvirB_, noccA_, aoccB_ * aoccB_, 1.0, tSSBB[s2 * nvirB_], aoccB_ * aoccB_,
+                        thetaSABB[s1 * noccA_], aoccB_ * aoccB_, 0.0, ySA, noccA_);
+                if (s1 != s2)
+                    C_DGEMM('N', 'T', nvirB_, noccA_, aoccB_ * aoccB_, 1.0, tSSBB[s1 * nvirB_], aoccB_ * aoccB_,
+                            thetaSABB[s2 * noccA_], aoccB_ * aoccB_, 1.0, ySA, noccA_);
+                energy += 2.0 * C_DDOT(nvirB_ * noccA_, ySA, 1, zSA[s2], 1);
+            }
         }
-    }
+    };
+
+    DFStreamTerm ySS_term;
+    ySS_term.compute = [&](double **B_p_SS, size_t ss, size_t nss) {
+        C_DGEMV('n', nss, (ndf_ + 3), 1.0, B_p_SS[0], (ndf_ + 3), diagAA_, 1, 0.0, &(ySS[0][ss]), 1);
+    };
+
+    DFStreamTerm zAA_term;
+    zAA_term.compute = [&](double **B_p_SS, size_t ss, size_t nss) {
+        size_t s1 = ss / nvirB_;
+        for (size_t s1b = 0; s1b < nss; s1++, s1b += nvirB_) {
+            C_DGEMM('N', 'T', s1 + 1, noccA_ * noccA_, (ndf_ + 3), 1.0, B_p_SS[s1b], (ndf_ + 3), B_p_AA[0],
+                    (ndf_ + 3), 0.0, zAA[0], noccA_ * noccA_);
+            for (size_t s2 = 0; s2 <= s1; s2++) {
+                C_DGEMM('N', 'T', noccA_, noccA_, aoccB_ * aoccB_, 1.0, &(tSABB[s2 * noccA_][0]), aoccB_ * aoccB_,
+                        &(thetaSABB[s1 * noccA_][0]), aoccB_ * aoccB_, 0.0, yAA, noccA_);
+                if (s1 != s2)
+                    C_DGEMM('N', 'T', noccA_, noccA_, aoccB_ * aoccB_, 1.0, &(tSABB[s1 * noccA_][0]), aoccB_ * aoccB_,
+                            &(thetaSABB[s2 * noccA_][0]), aoccB_ * aoccB_, 1.0, yAA, noccA_);
+                energy -= 2.0 * C_DDOT(noccA_ * noccA_, yAA, 1, zAA[s2], 1);
+            }
+        }
+    };
 
+    stream_SS_ints(1, {zSA_term, ySS_term, zAA_term});
+
+    energy += 4.0 * C_DDOT(nvirB_ * nvirB_, xSS[0], 1, ySS[0], 1);
+
+    free(ySA);
+    free_block(zSA);
+    free_block(B_p_SA);
+    free_block(xSS);
+    free_block(ySS);
+    free_block(tSSBB);
     free_block(tSABB);
     free_block(thetaSABB);
     free(yAA);
     free_block(zAA);
     free_block(B_p_AA);
-    free_block(B_p_SS);
 
     if (debug_) {
         outfile->Printf("    Exch12_k11u_3       = %18.12lf [Eh]\n", -energy);
@@ -1676,13 +1688,14 @@ double SAPT2::exch120_k11u_6() {
 
     free(tARAR);
 
-    double **B_p_RR = get_RR_ints(1);
     double **T_p_AA = block_matrix(aoccA_ * aoccA_, ndf_ + 3);
 
-    C_DGEMM('N', 'N', aoccA_ * aoccA_, ndf_ + 3, nvirA_ * nvirA_, 1.0, T_ARAR, nvirA_ * nvirA_, &(B_p_RR[0][0]),
-            ndf_ + 3, 0.0, &(T_p_AA[0][0]), ndf_ + 3);
-
-    free_block(B_p_RR);
+    DFStreamTerm T_p_AA_term;
+    T_p_AA_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        C_DGEMM('N', 'N', aoccA_ * aoccA_, ndf_ + 3, nrr, 1.0, &(T_ARAR[rr]), nvirA_ * nvirA_, &(B_p_RR[0][0]),
+                ndf_ + 3, 1.0, &(T_p_AA[0][0]), ndf_ + 3);
+    };
+    stream_RR_ints(1, {T_p_AA_term});
 
     double **B_p_AA = get_AA_ints(1, foccA_, foccA_);
     double **T_p_RR = block_matrix(nvirA_ * nvirA_, ndf_ + 3);
@@ -1804,13 +1817,14 @@ double SAPT2::exch102_k11u_6() {
 
     free(tBSBS);
 
-    double **B_p_SS = get_SS_ints(1);
     double **T_p_BB = block_matrix(aoccB_ * aoccB_, ndf_ + 3);
 
-    C_DGEMM('N', 'N', aoccB_ * aoccB_, ndf_ + 3, nvirB_ * nvirB_, 1.0, T_BSBS, nvirB_ * nvirB_, &(B_p_SS[0][0]),
-            ndf_ + 3, 0.0, &(T_p_BB[0][0]), ndf_ + 3);
-
-    free_block(B_p_SS);
+    DFStreamTerm T_p_BB_term;
+    T_p_BB_term.compute = [&](double **B_p_SS, size_t ss, size_t nss) {
+        C_DGEMM('N', 'N', aoccB_ * aoccB_, ndf_ + 3, nss, 1.0, &(T_BSBS[ss]), nvirB_ * nvirB_, &(B_p_SS[0][0]),
+                ndf_ + 3, 1.0, &(T_p_BB[0][0]), ndf_ + 3);
+    };
+    stream_SS_ints(1, {T_p_BB_term});
 
     double **B_p_BB = get_BB_ints(1, foccB_, foccB_);
     double **T_p_SS = block_matrix(nvirB_ * nvirB_, ndf_ + 3);
@@ -40,6 +40,7 @@
 #include "psi4/libpsi4util/process.h"
 #include "psi4/lib3index/dfhelper.h"
 
+#include <algorithm>
 #include <iomanip>
 
 // OMP
@@ -377,6 +378,11 @@ std::vector<SharedMatrix> FDDS_Dispersion::project_densities(std::vector<SharedM
 }
 
 SharedMatrix FDDS_Dispersion::form_unc_amplitude(std::string monomer, double omega) {
+    return form_unc_amplitudes(monomer, {omega})[0];
+}
+
+std::vector<SharedMatrix> FDDS_Dispersion::form_unc_amplitudes(std::string monomer, const std::vector<double>& omegas,
+                                                                size_t doubles) {
     // ==> Configuration <==
     SharedVector eps_occ, eps_vir;
     std::string ovQ_tensor_name;
@@ -398,88 +404,164 @@ SharedMatrix FDDS_Dispersion::form_unc_amplitude(std::string monomer, double ome
     size_t nocc = eps_occ->dim(0);
     size_t nvir = eps_vir->dim(0);
     size_t naux = auxiliary_->nbf();
+    size_t nomega = omegas.size();
 
     // Check on memory real quick
-    size_t doubles = Process::environment.get_memory() * 0.8 / sizeof(double);
-    size_t mem_size = 2 * naux * nvir + naux * naux + nvir * nocc;
+    if (doubles == 0) doubles = Process::environment.get_memory() * 0.8 / sizeof(double);
+    size_t mem_size = 2 * naux * nvir + nomega * (naux * naux + nvir * nocc);
     if (mem_size > doubles) {
         std::stringstream message;
         double mem_gb = ((double)(mem_size) / 0.8 * sizeof(double));
-        message << "FDDS Dispersion requires at least naux * nvir + naux * naux of memory." << std::endl;
+        message << "FDDS Dispersion requires at least 2 * naux * nvir + nomega * (naux * naux + nocc * nvir) of memory."
+                << std::endl;
         message << "       After taxes this is " << std::setprecision(2) << mem_gb << " GB of memory.";
         throw PSIEXCEPTION(message.str());
     }
 
     // ==> Uncoupled Amplitudes <==
-    auto amp = std::make_shared<Matrix>(nocc, nvir);
-
-    double** ampp = amp->pointer();
+    // The squared amplitude 4 e_ia / (e_ia^2 + omega^2) of every frequency, so that the
+    // contraction below is a single scaling and GEMM per frequency
+    std::vector<SharedMatrix> amps;
     double* eoccp = eps_occ->pointer();
     double* evirp = eps_vir->pointer();
+    for (size_t w = 0; w < nomega; w++) {
+        double omega = omegas[w];
+        auto amp = std::make_shared<Matrix>(nocc, nvir);
+        double** ampp = amp->pointer();
 
 #pragma omp parallel for
-    for (size_t i = 0; i < nocc; i++) {
-        for (size_t a = 0; a < nvir; a++) {
-            double val = -1.0 * (eoccp[i] - evirp[a]);
-            double tmp = 4.0 * val / (val * val + omega * omega);
-            // Lets see how stable this is, should be fine
-            if (tmp < 1.e-14) {
-                ampp[i][a] = 0.0;
-            } else {
-                ampp[i][a] = std::pow(tmp, 0.5);
+        for (size_t i = 0; i < nocc; i++) {
+            for (size_t a = 0; a < nvir; a++) {
+                double val = -1.0 * (eoccp[i] - evirp[a]);
+                double tmp = 4.0 * val / (val * val + omega * omega);
+                // Lets see how stable this is, should be fine
+                ampp[i][a] = (tmp < 1.e-14 ? 0.0 : tmp);
             }
         }
+        amps.push_back(amp);
     }
 
-    // amp->print();
-
     // ==> Contract <==
 
-    size_t dmem = doubles - naux * naux - nvir * nocc;
-    size_t bsize = dmem / (naux * nvir);
+    size_t dmem = doubles - nomega * (naux * naux + nvir * nocc);
+    size_t bsize = dmem / (2 * naux * nvir);
     if (bsize > nocc) {
         bsize = nocc;
     }
     size_t nblocks = 1 + ((nocc - 1) / bsize);
 
-    // printf("dmem:    %zu\n", dmem);
-    // printf("bsize:   %zu\n", bsize);
-
-    auto ret = std::make_shared<Matrix>("UNC Amplitude", naux, naux);
+    std::vector<SharedMatrix> ret;
+    for (size_t w = 0; w < nomega; w++) {
+        ret.push_back(std::make_shared<Matrix>("UNC Amplitude", naux, naux));
+    }
     auto tmp = std::make_shared<Matrix>("iaQ tmp", bsize * nvir, naux);
+    auto scaled = std::make_shared<Matrix>("iaQ scaled", bsize * nvir, naux);
 
     double** tmpp = tmp->pointer();
-    double** retp = ret->pointer();
+    double** scaledp = scaled->pointer();
 
-    size_t rstat, osize;
+    size_t osize;
     for (size_t block = 0, bcount = 0; block < nblocks; block++) {
-        // printf("Block %zu\n", block);
         if (((block + 1) * bsize) > nocc) {
             osize = nocc - block * bsize;
-            tmp->zero();
         } else {
             osize = bsize;
         }
 
+        // Each block of (Q|ia) is read once and used for every frequency
         dfh_->fill_tensor(ovQ_tensor_name, tmp, {bcount, bcount + osize});
         size_t shift_i = block * bsize;
+        size_t nrows = osize * nvir;
+
+        for (size_t w = 0; w < nomega; w++) {
+            double** ampp = amps[w]->pointer();
 
 #pragma omp parallel for collapse(2)
-        for (size_t i = 0; i < osize; i++) {
-            for (size_t a = 0; a < nvir; a++) {
-                double val = ampp[i + shift_i][a];
+            for (size_t i = 0; i < osize; i++) {
+                for (size_t a = 0; a < nvir; a++) {
+                    double val = ampp[i + shift_i][a];
+                    double* tmpr = tmpp[i * nvir + a];
+                    double* scaledr = scaledp[i * nvir + a];
 #pragma omp simd
-                for (size_t Q = 0; Q < naux; Q++) {
-                    tmpp[i * nvir + a][Q] *= val;
+                    for (size_t Q = 0; Q < naux; Q++) {
+                        scaledr[Q] = tmpr[Q] * val;
+                    }
                 }
             }
-        }
 
-        ret->gemm(true, false, 1.0, tmp, tmp, 1.0);
+            C_DGEMM('T', 'N', naux, naux, nrows, 1.0, scaledp[0], naux, tmpp[0], naux, 1.0, ret[w]->pointer()[0],
+                    naux);
+        }
         bcount += osize;
     }
 
     return ret;
 }
+
+SharedMatrix FDDS_Dispersion::form_coupled_amplitude(SharedMatrix X_unc, SharedMatrix W) {
+    SharedMatrix XSW = linalg::triplet(X_unc, metric_inv_, W);
+
+    auto amplitude_inv = metric_->clone();
+    amplitude_inv->add(XSW);
+    int nremoved = 0;
+    SharedMatrix amplitude = amplitude_inv->pseudoinverse(1.e-13, nremoved);
+    amplitude->transpose_this();
+    amplitude_inv.reset();
+
+    auto X_coupled = X_unc->clone();
+    X_coupled->axpy(-1.0, linalg::triplet(XSW, amplitude, X_unc));
+    return X_coupled;
+}
+
+std::pair<std::vector<double>, std::vector<double>> FDDS_Dispersion::dispersion_integrands(
+    SharedMatrix W_A, SharedMatrix W_B, const std::vector<double>& omegas) {
+    size_t naux = auxiliary_->nbf();
+    size_t nomega = omegas.size();
+
+    size_t nov_A = vector_cache_["eps_occ_A"]->dim(0) * vector_cache_["eps_vir_A"]->dim(0);
+    size_t nov_B = vector_cache_["eps_occ_B"]->dim(0) * vector_cache_["eps_vir_B"]->dim(0);
+    size_t nvir = std::max(vector_cache_["eps_vir_A"]->dim(0), vector_cache_["eps_vir_B"]->dim(0));
+
+    // Each frequency of a batch keeps the amplitudes of both monomers plus the scaled
+    // e_ia factors of the monomer being formed.  On top of that, forming needs at least one
+    // occupied row of the two Qia blocks, and the coupled solve about six naux x naux
+    // temporaries; those two phases do not overlap.
+    size_t doubles = Process::environment.get_memory() * 0.8 / sizeof(double);
+    size_t per_omega = 2 * naux * naux + std::max(nov_A, nov_B);
+    size_t fixed = std::max(2 * naux * nvir, 6 * naux * naux);
+    size_t batch = (doubles > fixed ? (doubles - fixed) / per_omega : 0);
+    batch = std::max<size_t>(1, std::min(batch, nomega));
+
+    std::vector<double> uncoupled(nomega), coupled(nomega);
+    for (size_t start = 0; start < nomega; start += batch) {
+        size_t nbatch = std::min(batch, nomega - start);
+        std::vector<double> batch_omegas(omegas.begin() + start, omegas.begin() + start + nbatch);
+
+        // X_A stays resident while X_B is formed, so B only gets what is left
+        std::vector<SharedMatrix> X_A = form_unc_amplitudes("A", batch_omegas, doubles);
+        size_t resident = nbatch * naux * naux;
+        size_t remaining = (doubles > resident ? doubles - resident : 1);
+        std::vector<SharedMatrix> X_B = form_unc_amplitudes("B", batch_omegas, remaining);
+
+        for (size_t w = 0; w < nbatch; w++) {
+            SharedMatrix X_A_coupled = form_coupled_amplitude(X_A[w], W_A);
+            SharedMatrix X_B_coupled = form_coupled_amplitude(X_B[w], W_B);
+
+            // Make sure the results are symmetrized
+            for (auto& tensor : {X_A[w], X_B[w], X_A_coupled, X_B_coupled}) {
+                tensor->hermitivitize();
+            }
+
+            // Combine
+            uncoupled[start + w] = linalg::triplet(metric_inv_, X_A[w], metric_inv_)->vector_dot(X_B[w]);
+            coupled[start + w] = linalg::triplet(metric_inv_, X_A_coupled, metric_inv_)->vector_dot(X_B_coupled);
+
+            X_A[w].reset();
+            X_B[w].reset();
+        }
+    }
+
+    return std::make_pair(uncoupled, coupled);
+}
 }  // namespace sapt
 }  // namespace psi
@@ -31,6 +31,11 @@
 
 #include "psi4/libmints/typedefs.h"
 
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace psi {
 
 class BasisSet;
@@ -88,6 +93,35 @@ class FDDS_Dispersion {
      */
     SharedMatrix form_unc_amplitude(std::string monomer, double omega);
 
+    /**
+     * Forms the uncoupled amplitudes for several frequencies, reading each Qia block once
+     * @param  monomer Monomer "A" or "B"
+     * @param  omegas  Time dependent values
+     * @param  doubles Memory budget in doubles, zero for 80% of the memory setting
+     * @return         "PQ" amplitude tensor for each omega
+     */
+    std::vector<SharedMatrix> form_unc_amplitudes(std::string monomer, const std::vector<double>& omegas,
+                                                  size_t doubles = 0);
+
+    /**
+     * Forms the coupled amplitude X - XSW (S + XSW)^-1 X with XSW = X S^-1 W, S the metric
+     * @param  X_unc Uncoupled "PQ" amplitude
+     * @param  W     Coulomb plus exchange-correlation kernel of the monomer
+     * @return       Coupled "PQ" amplitude
+     */
+    SharedMatrix form_coupled_amplitude(SharedMatrix X_unc, SharedMatrix W);
+
+    /**
+     * Computes the uncoupled and coupled dispersion integrands Tr(S^-1 X_A S^-1 X_B) at each
+     * frequency, forming the amplitudes of as many frequencies at once as memory allows
+     * @param  W_A    Kernel of monomer A
+     * @param  W_B    Kernel of monomer B
+     * @param  omegas Time dependent values
+     * @return        Uncoupled and coupled integrand for each omega
+     */
+    std::pair<std::vector<double>, std::vector<double>> dispersion_integrands(SharedMatrix W_A, SharedMatrix W_B,
+                                                                              const std::vector<double>& omegas);
+
     /**
      * Returns the metric matrix
      * @return Metric
@@ -75,6 +75,9 @@ SAPT2::SAPT2(SharedWavefunction Dimer, SharedWavefunction MonomerA, SharedWavefu
     nat_orbs_v4_ = options.get_bool("NAT_ORBS_V4");
     occ_cutoff_ = options.get_double("OCC_TOLERANCE");
 
+    df_block_mem_ = (long int)options_.get_int("SAPT_DF_BLOCK_MEM") * 1024L * 1024L / 8L;
+    if (df_block_mem_ > mem_ / 2L) df_block_mem_ = mem_ / 2L;
+
     ioff_ = (int *)malloc(sizeof(int) * (nso_ * (nso_ + 1) / 2));
     index2i_ = (int *)malloc(sizeof(int) * (nso_ * (nso_ + 1) / 2));
     index2j_ = (int *)malloc(sizeof(int) * (nso_ * (nso_ + 1) / 2));
@@ -887,11 +890,11 @@ void SAPT2::w_integrals() {
         C_DAXPY(nvirA_, 1.0, &(vBAA_[r + noccA_][noccA_]), 1, &(wBRR_[r][0]), 1);
     }
 
-    double **B_p_RR = get_RR_ints(0);
-
-    C_DGEMV('n', nvirA_ * nvirA_, ndf_, 2.0, &(B_p_RR[0][0]), ndf_ + 3, diagBB_, 1, 1.0, &(wBRR_[0][0]), 1);
-
-    free_block(B_p_RR);
+    DFStreamTerm wBRR_term;
+    wBRR_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        C_DGEMV('n', nrr, ndf_, 2.0, &(B_p_RR[0][0]), ndf_ + 3, diagBB_, 1, 1.0, &(wBRR_[0][rr]), 1);
+    };
+    stream_RR_ints(0, {wBRR_term});
 
     wASS_ = block_matrix(nvirB_, nvirB_);
 
@@ -899,11 +902,11 @@ void SAPT2::w_integrals() {
         C_DAXPY(nvirB_, 1.0, &(vABB_[s + noccB_][noccB_]), 1, &(wASS_[s][0]), 1);
     }
 
-    double **B_p_SS = get_SS_ints(0);
-
-    C_DGEMV('n', nvirB_ * nvirB_, ndf_, 2.0, &(B_p_SS[0][0]), ndf_ + 3, diagAA_, 1, 1.0, &(wASS_[0][0]), 1);
-
-    free_block(B_p_SS);
+    DFStreamTerm wASS_term;
+    wASS_term.compute = [&](double **B_p_SS, size_t ss, size_t nss) {
+        C_DGEMV('n', nss, ndf_, 2.0, &(B_p_SS[0][0]), ndf_ + 3, diagAA_, 1, 1.0, &(wASS_[0][ss]), 1);
+    };
+    stream_SS_ints(0, {wASS_term});
 }
 
 void SAPT2::natural_orbitalify(int ampfile, const char *VV_opdm, double *evals, int foccA, int noccA, size_t nvirA,
@@ -1015,20 +1018,24 @@ void SAPT2::natural_orbitalify_df_ints() {
     free_block(B_p_BS);
     free_block(C_p_BS);
 
-    double **B_p_RR = get_DF_ints(PSIF_SAPT_AA_DF_INTS, "RR RI Integrals", 0, nvirA_, 0, nvirA_);
-    double **C_p_RR = block_matrix(no_nvirA_ * nvirA_, ndf_ + 3);
-
-    C_DGEMM('T', 'N', no_nvirA_, nvirA_ * (ndf_ + 3), nvirA_, 1.0, no_CA_[0], no_nvirA_, B_p_RR[0], nvirA_ * (ndf_ + 3),
-            0.0, C_p_RR[0], nvirA_ * (ndf_ + 3));
-
-    free_block(B_p_RR);
-
+    // Both indices are transformed one block of RR rows at a time, the first one
+    // accumulating into the result, so only a block of RR is ever held
+    size_t blockR = DF_block_length(nvirA_, nvirA_);
+    double **C_p_RR = block_matrix(blockR * no_nvirA_, ndf_ + 3);
     double **D_p_RR = block_matrix(no_nvirA_ * no_nvirA_, ndf_ + 3);
 
-    for (int r = 0; r < no_nvirA_; r++) {
-        C_DGEMM('T', 'N', no_nvirA_, ndf_ + 3, nvirA_, 1.0, no_CA_[0], no_nvirA_, C_p_RR[r * nvirA_], ndf_ + 3, 0.0,
-                D_p_RR[r * no_nvirA_], ndf_ + 3);
-    }
+    DFStreamTerm RR_term;
+    RR_term.compute = [&](double **B_p_RR, size_t rr, size_t nrr) {
+        size_t r0 = rr / nvirA_;
+        size_t nr = nrr / nvirA_;
+        for (size_t r = 0; r < nr; r++) {
+            C_DGEMM('T', 'N', no_nvirA_, ndf_ + 3, nvirA_, 1.0, no_CA_[0], no_nvirA_, B_p_RR[r * nvirA_], ndf_ + 3,
+                    0.0, C_p_RR[r * no_nvirA_], ndf_ + 3);
+        }
+        C_DGEMM('T', 'N', no_nvirA_, no_nvirA_ * (ndf_ + 3), nr, 1.0, no_CA_[r0], no_nvirA_, C_p_RR[0],
+                no_nvirA_ * (ndf_ + 3), 1.0, D_p_RR[0], no_nvirA_ * (ndf_ + 3));
+    };
+    stream_DF_ints(PSIF_SAPT_AA_DF_INTS, "RR RI Integrals", 0, nvirA_, 0, nvirA_, {RR_term});
 
     psio_->write_entry(PSIF_SAPT_AA_DF_INTS, "RR NO RI Integrals", (char *)D_p_RR[0],
                        sizeof(double) * no_nvirA_ * no_nvirA_ * (ndf_ + 3));
@@ -1036,20 +1043,22 @@ void SAPT2::natural_orbitalify_df_ints() {
     free_block(C_p_RR);
     free_block(D_p_RR);
 
-    double **B_p_SS = get_DF_ints(PSIF_SAPT_BB_DF_INTS, "SS RI Integrals", 0, nvirB_, 0, nvirB_);
-    double **C_p_SS = block_matrix(no_nvirB_ * nvirB_, ndf_ + 3);
-
-    C_DGEMM('T', 'N', no_nvirB_, nvirB_ * (ndf_ + 3), nvirB_, 1.0, no_CB_[0], no_nvirB_, B_p_SS[0], nvirB_ * (ndf_ + 3),
-            0.0, C_p_SS[0], nvirB_ * (ndf_ + 3));
-
-    free_block(B_p_SS);
-
+    size_t blockS = DF_block_length(nvirB_, nvirB_);
+    double **C_p_SS = block_matrix(blockS * no_nvirB_, ndf_ + 3);
     double **D_p_SS = block_matrix(no_nvirB_ * no_nvirB_, ndf_ + 3);
 
-    for (int s = 0; s < no_nvirB_; s++) {
-        C_DGEMM('T', 'N', no_nvirB_, ndf_ + 3, nvirB_, 1.0, no_CB_[0], no_nvirB_, C_p_SS[s * nvirB_], ndf_ + 3, 0.0,
-                D_p_SS[s * no_nvirB_], ndf_ + 3);
-    }
+    DFStreamTerm SS_term;
+    SS_term.compute = [&](double **B_p_SS, size_t ss, size_t nss) {
+        size_t s0 = ss / nvirB_;
+        size_t ns = nss / nvirB_;
+        for (size_t s = 0; s < ns; s++) {
+            C_DGEMM('T', 'N', no_nvirB_, ndf_ + 3, nvirB_, 1.0, no_CB_[0], no_nvirB_, B_p_SS[s * nvirB_], ndf_ + 3,
+                    0.0, C_p_SS[s * no_nvirB_], ndf_ + 3);
+        }
+        C_DGEMM('T', 'N', no_nvirB_, no_nvirB_ * (ndf_ + 3), ns, 1.0, no_CB_[s0], no_nvirB_, C_p_SS[0],
+                no_nvirB_ * (ndf_ + 3), 1.0, D_p_SS[0], no_nvirB_ * (ndf_ + 3));
+    };
+    stream_DF_ints(PSIF_SAPT_BB_DF_INTS, "SS RI Integrals", 0, nvirB_, 0, nvirB_, {SS_term});
 
     psio_->write_entry(PSIF_SAPT_BB_DF_INTS, "SS NO RI Integrals", (char *)D_p_SS[0],
                        sizeof(double) * no_nvirB_ * no_nvirB_ * (ndf_ + 3));
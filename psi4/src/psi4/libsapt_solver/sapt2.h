@@ -31,9 +31,22 @@
 
 #include "sapt.h"
 
+#include <functional>
+#include <vector>
+
 namespace psi {
 namespace sapt {
 
+// A contribution that consumes a three-index tensor one block of rows at a
+// time. compute() receives the block and its first row and row count in the
+// full tensor; finish() runs once after the last block. memory is the number
+// of doubles the term keeps allocated from its creation until finish().
+struct DFStreamTerm {
+    std::function<void(double **, size_t, size_t)> compute;
+    std::function<void()> finish;
+    size_t memory = 0;
+};
+
 class SAPT2 : public SAPT {
    private:
     virtual void print_header();
@@ -64,6 +77,9 @@ class SAPT2 : public SAPT {
     bool nat_orbs_v4_;
     double occ_cutoff_;
 
+    // Doubles available to each block of streamed DF integrals
+    long int df_block_mem_;
+
     double e_elst10_;
     double e_elst12_;
     double e_exch10_;
@@ -105,6 +121,13 @@ class SAPT2 : public SAPT {
 
     double **get_DF_ints(int, const char *, int, int, int, int);
     double **get_DF_ints_nongimp(int, const char *, int, int, int, int);
+
+    size_t DF_block_length(size_t, size_t);
+    void stream_DF_ints(int, const char *, int, int, int, int, const std::vector<DFStreamTerm> &,
+                        const std::function<void(double **, size_t, size_t)> & = nullptr);
+    void stream_RR_ints(const int, const std::vector<DFStreamTerm> &);
+    void stream_SS_ints(const int, const std::vector<DFStreamTerm> &);
+    void flush_DF_stream(int, const char *, int, int, int, int, std::vector<DFStreamTerm> &, size_t);
     void antisym(double *, size_t, size_t);
     void antisym(double **, size_t, size_t);
 
@@ -120,9 +143,9 @@ class SAPT2 : public SAPT {
 
     void Y2(int, const char *, const char *, const char *, int, const char *, const char *, const char *, size_t, size_t, size_t,
             double *, size_t, const char *, const char *);
-    void Y2_1(double **, int, const char *, const char *, int, const char *, size_t, size_t, size_t);
+    void Y2_1(double **, std::vector<DFStreamTerm> &, int, const char *, int, const char *, size_t, size_t, size_t);
     void Y2_2(double **, int, const char *, const char *, int, const char *, size_t, size_t, size_t);
-    void Y2_3(double **, int, const char *, const char *, int, const char *, size_t, size_t, size_t);
+    void Y2_3(double **, std::vector<DFStreamTerm> &, int, const char *, int, const char *, size_t, size_t, size_t);
 
     void t2OVOV(int, const char *, const char *, int, const char *, const char *, const char *, size_t, size_t, size_t, double *,
                 size_t, const char *);
@@ -60,8 +60,11 @@ class SAPT2p3 : public SAPT2p {
             const char *, const char *, size_t, size_t, size_t, double *, size_t, const char *);
     void Y3_1(double **, int, const char *, const char *, int, const char *, size_t, size_t, size_t);
     void Y3_2(double **, int, const char *, const char *, int, const char *, size_t, size_t, size_t);
-    void Y3_3(double **, int, const char *, const char *, const char *, int, const char *, size_t, size_t, size_t);
-    void Y3_4(double **, int, const char *, const char *, const char *, int, const char *, size_t, size_t, size_t);
+    void Y3_3(double **, std::vector<DFStreamTerm> &, int, const char *, const char *, int, const char *, size_t,
+              size_t, size_t);
+    void Y3_4(double **, std::vector<DFStreamTerm> &, int, const char *, const char *, int, const char *, size_t,
+              size_t, size_t);
+    size_t Y3_stream_memory(size_t, size_t);
 
     double elst130(double **, double **, double **, int, const char *, const char *, const char *, size_t, size_t, size_t);
 
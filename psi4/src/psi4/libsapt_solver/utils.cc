@@ -1323,6 +1323,113 @@ double **SAPT2::get_DF_ints_nongimp(int filenum, const char *label, int startA,
     return AA;
 }
 
+size_t SAPT2::DF_block_length(size_t lengthA, size_t lengthB) {
+    size_t length = df_block_mem_ / (lengthB * (ndf_ + 3));
+    if (length < 1) length = 1;
+    if (length > lengthA) length = lengthA;
+
+    return length;
+}
+
+void SAPT2::stream_DF_ints(int filenum, const char *label, int startA, int stopA, int startB, int stopB,
+                           const std::vector<DFStreamTerm> &terms,
+                           const std::function<void(double **, size_t, size_t)> &dress) {
+    size_t lengthA = stopA - startA;
+    size_t lengthB = stopB - startB;
+    size_t blockA = DF_block_length(lengthA, lengthB);
+
+    double **A = block_matrix(blockA * lengthB, ndf_ + 3);
+
+    psio_address next_PSIF = psio_get_address(PSIO_ZERO, sizeof(double) * startA * stopB * (ndf_ + 3));
+    for (size_t a = 0; a < lengthA; a += blockA) {
+        size_t nA = (a + blockA > lengthA ? lengthA - a : blockA);
+
+        if (startB == 0) {
+            psio_->read(filenum, label, (char *)A[0], sizeof(double) * nA * lengthB * (ndf_ + 3), next_PSIF,
+                        &next_PSIF);
+        } else {
+            for (size_t i = 0; i < nA; i++) {
+                next_PSIF = psio_get_address(next_PSIF, sizeof(double) * startB * (ndf_ + 3));
+                psio_->read(filenum, label, (char *)A[i * lengthB], sizeof(double) * lengthB * (ndf_ + 3), next_PSIF,
+                            &next_PSIF);
+            }
+        }
+
+        if (dress) dress(A, a * lengthB, nA * lengthB);
+
+        for (const auto &term : terms) {
+            term.compute(A, a * lengthB, nA * lengthB);
+        }
+    }
+
+    free_block(A);
+
+    for (const auto &term : terms) {
+        if (term.finish) term.finish();
+    }
+}
+
+// Streams and clears a pending group of terms when building one more term, which needs
+// up to need doubles, would take the group plus the stream block past the memory limit
+void SAPT2::flush_DF_stream(int filenum, const char *label, int startA, int stopA, int startB, int stopB,
+                            std::vector<DFStreamTerm> &terms, size_t need) {
+    if (terms.empty()) return;
+
+    size_t held = 0;
+    for (const auto &term : terms) held += term.memory;
+    size_t lengthB = stopB - startB;
+    size_t block = DF_block_length(stopA - startA, lengthB) * lengthB * (ndf_ + 3);
+
+    if (held + need + block > (size_t)mem_) {
+        stream_DF_ints(filenum, label, startA, stopA, startB, stopB, terms);
+        terms.clear();
+    }
+}
+
+void SAPT2::stream_RR_ints(const int dress, const std::vector<DFStreamTerm> &terms) {
+    double enuc = std::sqrt(enuc_ / ((double)NA_ * NB_));
+
+    auto dress_RR = [&](double **A, size_t rrp, size_t nrrp) {
+        for (size_t i = 0; i < nrrp; i++) {
+            size_t r = (rrp + i) / nvirA_;
+            size_t rp = (rrp + i) % nvirA_;
+            A[i][ndf_ + 1] = vBAA_[r + noccA_][rp + noccA_] / (double)NB_;
+            if (r == rp) {
+                A[i][ndf_] = 1.0;
+                A[i][ndf_ + 2] = enuc;
+            }
+        }
+    };
+
+    if (dress) {
+        stream_DF_ints(PSIF_SAPT_AA_DF_INTS, "RR RI Integrals", 0, nvirA_, 0, nvirA_, terms, dress_RR);
+    } else {
+        stream_DF_ints(PSIF_SAPT_AA_DF_INTS, "RR RI Integrals", 0, nvirA_, 0, nvirA_, terms);
+    }
+}
+
+void SAPT2::stream_SS_ints(const int dress, const std::vector<DFStreamTerm> &terms) {
+    double enuc = std::sqrt(enuc_ / ((double)NA_ * NB_));
+
+    auto dress_SS = [&](double **A, size_t ssp, size_t nssp) {
+        for (size_t i = 0; i < nssp; i++) {
+            size_t s = (ssp + i) / nvirB_;
+            size_t sp = (ssp + i) % nvirB_;
+            A[i][ndf_] = vABB_[s + noccB_][sp + noccB_] / (double)NA_;
+            if (s == sp) {
+                A[i][ndf_ + 1] = 1.0;
+                A[i][ndf_ + 2] = enuc;
+            }
+        }
+    };
+
+    if (dress) {
+        stream_DF_ints(PSIF_SAPT_BB_DF_INTS, "SS RI Integrals", 0, nvirB_, 0, nvirB_, terms, dress_SS);
+    } else {
+        stream_DF_ints(PSIF_SAPT_BB_DF_INTS, "SS RI Integrals", 0, nvirB_, 0, nvirB_, terms);
+    }
+}
+
 void SAPT2::antisym(double *A, size_t nocc, size_t nvir) {
     double *X = init_array(nvir);
 
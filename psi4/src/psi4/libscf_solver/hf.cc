@@ -516,7 +516,7 @@ void HF::print_header() {
     outfile->Printf("  Nbeta        = %d\n\n", nbeta_);
 
     outfile->Printf("  ==> Algorithm <==\n\n");
-    outfile->Printf("  SCF Algorithm Type is %s.\n", options_.get_str("SCF_TYPE").c_str());
+    outfile->Printf("  SCF Algorithm Type is %s.\n", scf_type_.c_str());
     outfile->Printf("  DIIS %s.\n", options_.get_bool("DIIS") ? "enabled" : "disabled");
     if ((options_.get_int("MOM_START") != 0) && (options_["MOM_OCC"].size() != 0))  // TROUBLE, NOT SET YET?
         outfile->Printf("  Excited-state MOM enabled.\n");
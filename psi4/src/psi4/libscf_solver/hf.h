@@ -289,6 +289,10 @@ class HF : public Wavefunction {
     /// The DFT Functional object (or null if it has been deleted)
     std::shared_ptr<SuperFunctional> functional() const { return functional_; }
 
+    /// The SCF algorithm this wavefunction runs with, SCF_TYPE unless AUTO was resolved
+    const std::string& scf_type() const { return scf_type_; }
+    void set_scf_type(const std::string& scf_type) { scf_type_ = scf_type; }
+
     /// The DFT Potential object (or null if it has been deleted)
     std::shared_ptr<VBase> V_potential() const { return potential_; }
 
@@ -603,7 +603,7 @@ void ROHF::Hx(SharedMatrix x, SharedMatrix ret) {
     Cr.clear();
 
     // If scf_type is DF we can do some extra JK voodo
-    if ((options_.get_str("SCF_TYPE").find("DF") != std::string::npos) || (options_.get_str("SCF_TYPE") == "CD")) {
+    if ((scf_type_.find("DF") != std::string::npos) || (scf_type_ == "CD")) {
         SharedMatrix Cdocc = Ca_->get_block({dim_zero, nsopi_}, {dim_zero, doccpi_});
         Cdocc->set_name("Cdocc");
 
@@ -30,6 +30,7 @@
 #define _PSI_SRC_LIB_LIBTRANS_INTEGRALTRANSFORM_H_
 
 #include <array>
+#include <functional>
 #include <map>
 #include <vector>
 #include <string>
@@ -258,6 +259,12 @@ class PSI_API IntegralTransform {
     void setup_tpdm_buffer(const dpdbuf4 *D);
     void sort_so_tpdm(const dpdbuf4 *B, int irrep, size_t first_row, size_t num_rows, bool first_run);
 
+    void transform_tei_ket(dpdbuf4 *J, dpdbuf4 *K, const SharedMatrix &Cr, const SharedMatrix &Cs, const int *rOrbsPI,
+                           const int *sOrbsPI, const std::function<void(int, size_t, int)> &postprocess = nullptr);
+    void transform_tei_ket_rows(double **Jrows, double **Krows, const dpdbuf4 *J, const dpdbuf4 *K, int h, int nrows,
+                                const SharedMatrix &Cr, const SharedMatrix &Cs, const int *rOrbsPI,
+                                const int *sOrbsPI);
+
     void transform_oei_restricted(const std::shared_ptr<MOSpace> s1, const std::shared_ptr<MOSpace> s2,
                                   const std::vector<double> &soInts, std::string label);
     void transform_oei_unrestricted(const std::shared_ptr<MOSpace> s1, const std::shared_ptr<MOSpace> s2,
@@ -33,6 +33,7 @@
 
 #include "psi4/libdpd/dpd.h"
 #include "psi4/libiwl/iwl.hpp"
+#include "psi4/libiwl/sorted.hpp"
 #include "psi4/libpsio/psio.hpp"
 #include "psi4/libpsi4util/PsiOutStream.h"
 #include "psi4/libpsi4util/exception.h"
@@ -572,5 +573,20 @@ void iwl_integrals(IWL *iwl, DPDFunctor &dpd, FockFunctor &fock) {
     iwl->set_keep_flag(true);
 }
 
+/*
+ * The analog of iwl_integrals for integrals in the sorted format.  Only the blocks holding
+ * integrals with a canonical bra index of at least first_pq are read; the blocks are decoded
+ * by nthreads threads, while the functors are applied serially, in sorted order.
+ */
+template <class DPDFunctor, class FockFunctor>
+void sorted_integrals(SortedIntegralReader &reader, size_t first_pq, DPDFunctor &dpd, FockFunctor &fock,
+                      int nthreads) {
+    auto apply = [&](int p, int q, int r, int s, double value) {
+        dpd(p, q, r, s, value);
+        fock(p, q, r, s, 0, 0, 0, 0, 0, 0, 0, 0, value);
+    };
+    reader.for_each(apply, first_pq, nthreads);
+}
+
 }  // namespace psi
 #endif  // INTEGRALTRANSFORM_FUNCTORS_H
@@ -37,8 +37,11 @@
 #include "psi4/libmints/matrix.h"
 #include "psi4/psifiles.h"
 #include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libpsi4util/process.h"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 using namespace psi;
 
@@ -277,7 +280,12 @@ void IntegralTransform::presort_so_tei() {
     long int **bucketSize = (long int **)malloc(sizeof(long int *));
     bucketSize[0] = init_long_int_array(nirreps_);
 
-    /* Figure out how many passes we need and where each p,q goes */
+    /*
+     * Figure out how many passes we need and where each p,q goes.  For the sorted integral
+     * format, we also note the smallest canonical pair index in each bucket: every integral
+     * that lands in the bucket's rows has a canonical bra index at least that large.
+     */
+    std::vector<size_t> bucketFirstPQ;
     int nBuckets = 1;
     size_t coreLeft = memoryd;
     psio_address next;
@@ -325,11 +333,17 @@ void IntegralTransform::presort_so_tei() {
             int p = I.params->roworb[h][row][0];
             int q = I.params->roworb[h][row][1];
             bucketMap[p][q] = nBuckets - 1;
+            if (bucketFirstPQ.size() < static_cast<size_t>(nBuckets)) bucketFirstPQ.push_back(INDEX(p, q));
+            bucketFirstPQ[nBuckets - 1] = std::min(bucketFirstPQ[nBuckets - 1], static_cast<size_t>(INDEX(p, q)));
         }
     }
 
+    bool sortedInts = SortedIntegralReader::is_sorted_file(psio_.get(), soIntTEIFile_);
+    int nthreads = Process::environment.get_n_threads();
+
     if (print_) {
         outfile->Printf("\tSorting File: %s nbuckets = %d\n", I.label, nBuckets);
+        if (sortedInts) outfile->Printf("\tReading SO integrals in the sorted format.\n");
     }
 
     next = PSIO_ZERO;
@@ -341,22 +355,42 @@ void IntegralTransform::presort_so_tei() {
 
         DPDFillerFunctor dpdfiller(&I, n, bucketMap, bucketOffset, false, true);
         NullFunctor null;
-        IWL *iwl = new IWL(psio_.get(), soIntTEIFile_, tolerance_, 1, 1);
-        // In the functors below, we only want to build the Fock matrix on the first pass
-        if (transformationType_ == TransformationType::Restricted) {
-            FrozenCoreAndFockRestrictedFunctor fock(aD, aFzcD, aFock, aFzcOp);
-            if (n)
-                iwl_integrals(iwl, dpdfiller, null);
-            else
-                iwl_integrals(iwl, dpdfiller, fock);
+        if (sortedInts) {
+            // The first pass needs every integral for the Fock matrices; later ones only the tail
+            SortedIntegralReader reader(psio_.get(), soIntTEIFile_);
+            size_t firstPQ = n ? bucketFirstPQ[n] : 0;
+            if (transformationType_ == TransformationType::Restricted) {
+                FrozenCoreAndFockRestrictedFunctor fock(aD, aFzcD, aFock, aFzcOp);
+                if (n)
+                    sorted_integrals(reader, firstPQ, dpdfiller, null, nthreads);
+                else
+                    sorted_integrals(reader, firstPQ, dpdfiller, fock, nthreads);
+            } else {
+                FrozenCoreAndFockUnrestrictedFunctor fock(aD, bD, aFzcD, bFzcD, aFock, bFock, aFzcOp, bFzcOp);
+                if (n)
+                    sorted_integrals(reader, firstPQ, dpdfiller, null, nthreads);
+                else
+                    sorted_integrals(reader, firstPQ, dpdfiller, fock, nthreads);
+            }
+            reader.close();
         } else {
-            FrozenCoreAndFockUnrestrictedFunctor fock(aD, bD, aFzcD, bFzcD, aFock, bFock, aFzcOp, bFzcOp);
-            if (n)
-                iwl_integrals(iwl, dpdfiller, null);
-            else
-                iwl_integrals(iwl, dpdfiller, fock);
+            IWL *iwl = new IWL(psio_.get(), soIntTEIFile_, tolerance_, 1, 1);
+            // In the functors below, we only want to build the Fock matrix on the first pass
+            if (transformationType_ == TransformationType::Restricted) {
+                FrozenCoreAndFockRestrictedFunctor fock(aD, aFzcD, aFock, aFzcOp);
+                if (n)
+                    iwl_integrals(iwl, dpdfiller, null);
+                else
+                    iwl_integrals(iwl, dpdfiller, fock);
+            } else {
+                FrozenCoreAndFockUnrestrictedFunctor fock(aD, bD, aFzcD, bFzcD, aFock, bFock, aFzcOp, bFzcOp);
+                if (n)
+                    iwl_integrals(iwl, dpdfiller, null);
+                else
+                    iwl_integrals(iwl, dpdfiller, fock);
+            }
+            delete iwl;
         }
-        delete iwl;
 
         for (int h = 0; h < nirreps_; ++h) {
             if (bucketSize[n][h])
@@ -41,6 +41,7 @@
 #include <cmath>
 #include <cctype>
 #include <cstdio>
+#include <functional>
 
 using namespace psi;
 
@@ -81,14 +82,32 @@ void IntegralTransform::transform_tei_second_half(const std::shared_ptr<MOSpace>
 
     IWL *iwl;
     if (useIWL_) iwl = new IWL;
-    int nBuckets;
-    int thisBucketRows;
-    size_t rowsPerBucket;
-    size_t rowsLeft;
-    size_t memFree;
     dpdbuf4 J, K;
 
-    double **TMP = block_matrix(nso_, nso_);
+    // Builds the callback that writes each transformed bucket of K to the IWL file
+    auto iwl_writer = [&](const int *index1, const int *index2, const int *index3, const int *index4,
+                          bool skipRSltPQ) -> std::function<void(int, size_t, int)> {
+        if (!useIWL_) return nullptr;
+        return [&, index1, index2, index3, index4, skipRSltPQ](int h, size_t firstRow, int nRows) {
+            for (int pq = 0; pq < nRows; pq++) {
+                int P = index1[K.params->roworb[h][pq + firstRow][0]];
+                int Q = index2[K.params->roworb[h][pq + firstRow][1]];
+                size_t PQ = INDEX(P, Q);
+                // dpd is smart enough to index only unique pairs in the bra
+                // ( K.params->roworb contains no redundancies ), so there is
+                // no need to skip any pq pairs when writing IWL
+                // if( (P < Q) && bra_sym) continue;
+                for (int rs = 0; rs < K.params->coltot[h]; rs++) {
+                    int R = index3[K.params->colorb[h][rs][0]];
+                    int S = index4[K.params->colorb[h][rs][1]];
+                    if ((R < S) && ket_sym) continue;
+                    size_t RS = INDEX(R, S);
+                    if ((RS < PQ) && skipRSltPQ) continue;
+                    iwl->write_value(P, Q, R, S, K.matrix[h][pq][rs], printTei_, "outfile", 0);
+                } /* rs */
+            }     /* pq */
+        };
+    };
 
     if (print_) {
         if (transformationType_ == TransformationType::Restricted) {
@@ -125,84 +144,9 @@ void IntegralTransform::transform_tei_second_half(const std::shared_ptr<MOSpace>
     if (print_ > 5)
         outfile->Printf("Initializing %s, in core:(%d|%d) on disk(%d|%d)\n", label, braCore, ketCore, braDisk, ketDisk);
 
-    for (int h = 0; h < nirreps_; h++) {
-        if (J.params->coltot[h] && J.params->rowtot[h]) {
-            memFree = static_cast<size_t>(dpd_memfree() - J.params->coltot[h] - K.params->coltot[h]);
-            rowsPerBucket = memFree / (2 * J.params->coltot[h]);
-            if (rowsPerBucket > J.params->rowtot[h]) rowsPerBucket = static_cast<size_t>(J.params->rowtot[h]);
-            nBuckets =
-                static_cast<int>(ceil(static_cast<double>(J.params->rowtot[h]) / static_cast<double>(rowsPerBucket)));
-            rowsLeft = static_cast<size_t>(J.params->rowtot[h] % rowsPerBucket);
-        } else {
-            nBuckets = 0;
-            rowsPerBucket = 0;
-            rowsLeft = 0;
-        }
+    transform_tei_ket(&J, &K, c3a, c4a, aOrbsPI3, aOrbsPI4,
+                      iwl_writer(aIndex1, aIndex2, aIndex3, aIndex4, bra_ket_sym));
 
-        if (print_ > 1) {
-            outfile->Printf("\th = %d; memfree         = %lu\n", h, memFree);
-            outfile->Printf("\th = %d; rows_per_bucket = %lu\n", h, rowsPerBucket);
-            outfile->Printf("\th = %d; rows_left       = %lu\n", h, rowsLeft);
-            outfile->Printf("\th = %d; nbuckets        = %d\n", h, nBuckets);
-        }
-
-        global_dpd_->buf4_mat_irrep_init_block(&J, h, rowsPerBucket);
-        global_dpd_->buf4_mat_irrep_init_block(&K, h, rowsPerBucket);
-
-        for (int n = 0; n < nBuckets; n++) {
-            if (nBuckets == 1)
-                thisBucketRows = rowsPerBucket;
-            else
-                thisBucketRows = (n < nBuckets - 1) ? rowsPerBucket : rowsLeft;
-            global_dpd_->buf4_mat_irrep_rd_block(&J, h, n * rowsPerBucket, thisBucketRows);
-            for (int pq = 0; pq < thisBucketRows; pq++) {
-                for (int Gr = 0; Gr < nirreps_; Gr++) {
-                    // Transform ( S1 S2 | n n ) -> ( S1 S2 | n S4 )
-                    int Gs = h ^ Gr;
-                    int nrows = sopi_[Gr];
-                    int ncols = aOrbsPI4[Gs];
-                    int nlinks = sopi_[Gs];
-                    int rs = J.col_offset[h][Gr];
-                    double **pc4a = c4a->pointer(Gs);
-                    if (nrows && ncols && nlinks)
-                        C_DGEMM('n', 'n', nrows, ncols, nlinks, 1.0, &J.matrix[h][pq][rs], nlinks, pc4a[0], ncols, 0.0,
-                                TMP[0], nso_);
-                    // TODO else if s4->label() == MOSPACE_NIL, copy buffer...
-
-                    // Transform ( S1 S2 | n S4 ) -> ( S1 S2 | S3 S4 )
-                    nrows = aOrbsPI3[Gr];
-                    ncols = aOrbsPI4[Gs];
-                    nlinks = sopi_[Gr];
-                    rs = K.col_offset[h][Gr];
-                    double **pc3a = c3a->pointer(Gr);
-                    if (nrows && ncols && nlinks)
-                        C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0, pc3a[0], nrows, TMP[0], nso_, 0.0,
-                                &K.matrix[h][pq][rs], ncols);
-                    // TODO else if s3->label() == MOSPACE_NIL, copy buffer...
-                } /* Gr */
-                if (useIWL_) {
-                    int P = aIndex1[K.params->roworb[h][pq + n * rowsPerBucket][0]];
-                    int Q = aIndex2[K.params->roworb[h][pq + n * rowsPerBucket][1]];
-                    size_t PQ = INDEX(P, Q);
-                    // dpd is smart enough to index only unique pairs in the bra
-                    // ( K.params->roworb contains no redundancies ), so there is
-                    // no need to skip any pq pairs when writing IWL
-                    // if( (P < Q) && bra_sym) continue;
-                    for (int rs = 0; rs < K.params->coltot[h]; rs++) {
-                        int R = aIndex3[K.params->colorb[h][rs][0]];
-                        int S = aIndex4[K.params->colorb[h][rs][1]];
-                        if ((R < S) && ket_sym) continue;
-                        size_t RS = INDEX(R, S);
-                        if ((RS < PQ) && bra_ket_sym) continue;
-                        iwl->write_value(P, Q, R, S, K.matrix[h][pq][rs], printTei_, "outfile", 0);
-                    } /* rs */
-                }
-            } /* pq */
-            global_dpd_->buf4_mat_irrep_wrt_block(&K, h, n * rowsPerBucket, thisBucketRows);
-        }
-        global_dpd_->buf4_mat_irrep_close_block(&J, h, rowsPerBucket);
-        global_dpd_->buf4_mat_irrep_close_block(&K, h, rowsPerBucket);
-    }
     global_dpd_->buf4_close(&K);
     global_dpd_->buf4_close(&J);
 
@@ -242,81 +186,9 @@ void IntegralTransform::transform_tei_second_half(const std::shared_ptr<MOSpace>
             outfile->Printf("Initializing %s, in core:(%d|%d) on disk(%d|%d)\n", label, braCore, ketCore, braDisk,
                             ketDisk);
 
-        for (int h = 0; h < nirreps_; h++) {
-            if (J.params->coltot[h] && J.params->rowtot[h]) {
-                memFree = static_cast<size_t>(dpd_memfree() - J.params->coltot[h] - K.params->coltot[h]);
-                rowsPerBucket = memFree / (2 * J.params->coltot[h]);
-                if (rowsPerBucket > J.params->rowtot[h]) rowsPerBucket = static_cast<size_t>(J.params->rowtot[h]);
-                nBuckets = static_cast<int>(
-                    ceil(static_cast<double>(J.params->rowtot[h]) / static_cast<double>(rowsPerBucket)));
-                rowsLeft = static_cast<size_t>(J.params->rowtot[h] % rowsPerBucket);
-            } else {
-                nBuckets = 0;
-                rowsPerBucket = 0;
-                rowsLeft = 0;
-            }
-
-            if (print_ > 1) {
-                outfile->Printf("\th = %d; memfree         = %lu\n", h, memFree);
-                outfile->Printf("\th = %d; rows_per_bucket = %lu\n", h, rowsPerBucket);
-                outfile->Printf("\th = %d; rows_left       = %lu\n", h, rowsLeft);
-                outfile->Printf("\th = %d; nbuckets        = %d\n", h, nBuckets);
-            }
-
-            global_dpd_->buf4_mat_irrep_init_block(&J, h, rowsPerBucket);
-            global_dpd_->buf4_mat_irrep_init_block(&K, h, rowsPerBucket);
-
-            for (int n = 0; n < nBuckets; n++) {
-                if (nBuckets == 1)
-                    thisBucketRows = rowsPerBucket;
-                else
-                    thisBucketRows = (n < nBuckets - 1) ? rowsPerBucket : rowsLeft;
-                global_dpd_->buf4_mat_irrep_rd_block(&J, h, n * rowsPerBucket, thisBucketRows);
-                for (int pq = 0; pq < thisBucketRows; pq++) {
-                    for (int Gr = 0; Gr < nirreps_; Gr++) {
-                        // Transform ( S1 S2 | n n ) -> ( S1 S2 | n s4 )
-                        int Gs = h ^ Gr;
-                        int nrows = sopi_[Gr];
-                        int ncols = bOrbsPI4[Gs];
-                        int nlinks = sopi_[Gs];
-                        int rs = J.col_offset[h][Gr];
-                        double **pc4b = c4b->pointer(Gs);
-                        if (nrows && ncols && nlinks)
-                            C_DGEMM('n', 'n', nrows, ncols, nlinks, 1.0, &J.matrix[h][pq][rs], nlinks, pc4b[0], ncols,
-                                    0.0, TMP[0], nso_);
-                        // TODO else if s4->label() == MOSPACE_NIL, copy buffer...
-
-                        // Transform ( S1 S2 | n s4 ) -> ( S1 S2 | s3 s4 )
-                        nrows = bOrbsPI3[Gr];
-                        ncols = bOrbsPI4[Gs];
-                        nlinks = sopi_[Gr];
-                        rs = K.col_offset[h][Gr];
-                        double **pc3b = c3b->pointer(Gr);
-                        if (nrows && ncols && nlinks)
-                            C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0, pc3b[0], nrows, TMP[0], nso_, 0.0,
-                                    &K.matrix[h][pq][rs], ncols);
-                        // TODO else if s3->label() == MOSPACE_NIL, copy buffer...
-                    } /* Gr */
-                    if (useIWL_) {
-                        int P = aIndex1[K.params->roworb[h][pq + n * rowsPerBucket][0]];
-                        int Q = aIndex2[K.params->roworb[h][pq + n * rowsPerBucket][1]];
-                        // dpd is smart enough to index only unique pairs in the bra
-                        // ( K.params->roworb contains no redundancies ), so there is
-                        // no need to skip any pq pairs when writing IWL
-                        // if( (P < Q) && bra_sym) continue;
-                        for (int rs = 0; rs < K.params->coltot[h]; rs++) {
-                            int R = bIndex3[K.params->colorb[h][rs][0]];
-                            int S = bIndex4[K.params->colorb[h][rs][1]];
-                            if ((R < S) && ket_sym) continue;
-                            iwl->write_value(P, Q, R, S, K.matrix[h][pq][rs], printTei_, "outfile", 0);
-                        } /* rs */
-                    }
-                } /* pq */
-                global_dpd_->buf4_mat_irrep_wrt_block(&K, h, n * rowsPerBucket, thisBucketRows);
-            }
-            global_dpd_->buf4_mat_irrep_close_block(&J, h, rowsPerBucket);
-            global_dpd_->buf4_mat_irrep_close_block(&K, h, rowsPerBucket);
-        }
+        transform_tei_ket(&J, &K, c3b, c4b, bOrbsPI3, bOrbsPI4,
+                          iwl_writer(aIndex1, aIndex2, bIndex3, bIndex4, false));
+
         global_dpd_->buf4_close(&K);
         global_dpd_->buf4_close(&J);
 
@@ -360,82 +232,9 @@ void IntegralTransform::transform_tei_second_half(const std::shared_ptr<MOSpace>
             outfile->Printf("Initializing %s, in core:(%d|%d) on disk(%d|%d)\n", label, braCore, ketCore, braDisk,
                             ketDisk);
 
-        for (int h = 0; h < nirreps_; h++) {
-            if (J.params->coltot[h] && J.params->rowtot[h]) {
-                memFree = static_cast<size_t>(dpd_memfree() - J.params->coltot[h] - K.params->coltot[h]);
-                rowsPerBucket = memFree / (2 * J.params->coltot[h]);
-                if (rowsPerBucket > J.params->rowtot[h]) rowsPerBucket = static_cast<size_t>(J.params->rowtot[h]);
-                nBuckets = static_cast<int>(
-                    ceil(static_cast<double>(J.params->rowtot[h]) / static_cast<double>(rowsPerBucket)));
-                rowsLeft = static_cast<size_t>(J.params->rowtot[h] % rowsPerBucket);
-            } else {
-                nBuckets = 0;
-                rowsPerBucket = 0;
-                rowsLeft = 0;
-            }
-
-            if (print_ > 1) {
-                outfile->Printf("\th = %d; memfree         = %lu\n", h, memFree);
-                outfile->Printf("\th = %d; rows_per_bucket = %lu\n", h, rowsPerBucket);
-                outfile->Printf("\th = %d; rows_left       = %lu\n", h, rowsLeft);
-                outfile->Printf("\th = %d; nbuckets        = %d\n", h, nBuckets);
-            }
-
-            global_dpd_->buf4_mat_irrep_init_block(&J, h, rowsPerBucket);
-            global_dpd_->buf4_mat_irrep_init_block(&K, h, rowsPerBucket);
-
-            for (int n = 0; n < nBuckets; n++) {
-                if (nBuckets == 1)
-                    thisBucketRows = rowsPerBucket;
-                else
-                    thisBucketRows = (n < nBuckets - 1) ? rowsPerBucket : rowsLeft;
-                global_dpd_->buf4_mat_irrep_rd_block(&J, h, n * rowsPerBucket, thisBucketRows);
-                for (int pq = 0; pq < thisBucketRows; pq++) {
-                    for (int Gr = 0; Gr < nirreps_; Gr++) {
-                        // Transform ( s1 s2 | n n ) -> ( s1 s2 | n s4 )
-                        int Gs = h ^ Gr;
-                        int nrows = sopi_[Gr];
-                        int ncols = bOrbsPI4[Gs];
-                        int nlinks = sopi_[Gs];
-                        int rs = J.col_offset[h][Gr];
-                        double **pc4b = c4b->pointer(Gs);
-                        if (nrows && ncols && nlinks)
-                            C_DGEMM('n', 'n', nrows, ncols, nlinks, 1.0, &J.matrix[h][pq][rs], nlinks, pc4b[0], ncols,
-                                    0.0, TMP[0], nso_);
-
-                        // Transform ( s1 s2 | n s4 ) -> ( s1 s2 | s3 s4 )
-                        nrows = bOrbsPI3[Gr];
-                        ncols = bOrbsPI4[Gs];
-                        nlinks = sopi_[Gr];
-                        rs = K.col_offset[h][Gr];
-                        double **pc3b = c3b->pointer(Gr);
-                        if (nrows && ncols && nlinks)
-                            C_DGEMM('t', 'n', nrows, ncols, nlinks, 1.0, pc3b[0], nrows, TMP[0], nso_, 0.0,
-                                    &K.matrix[h][pq][rs], ncols);
-                    } /* Gr */
-                    if (useIWL_) {
-                        int P = bIndex1[K.params->roworb[h][pq + n * rowsPerBucket][0]];
-                        int Q = bIndex2[K.params->roworb[h][pq + n * rowsPerBucket][1]];
-                        // dpd is smart enough to index only unique pairs in the bra
-                        // ( K.params->roworb contains no redundancies ), so there is
-                        // no need to skip any pq pairs when writing IWL
-                        // if( (P < Q) && bra_sym) continue;
-                        size_t PQ = INDEX(P, Q);
-                        for (int rs = 0; rs < K.params->coltot[h]; rs++) {
-                            int R = bIndex3[K.params->colorb[h][rs][0]];
-                            int S = bIndex4[K.params->colorb[h][rs][1]];
-                            if ((R < S) && ket_sym) continue;
-                            size_t RS = INDEX(R, S);
-                            if ((RS < PQ) && bra_ket_sym) continue;
-                            iwl->write_value(P, Q, R, S, K.matrix[h][pq][rs], printTei_, "outfile", 0);
-                        } /* rs */
-                    }
-                } /* pq */
-                global_dpd_->buf4_mat_irrep_wrt_block(&K, h, n * rowsPerBucket, thisBucketRows);
-            }
-            global_dpd_->buf4_mat_irrep_close_block(&J, h, rowsPerBucket);
-            global_dpd_->buf4_mat_irrep_close_block(&K, h, rowsPerBucket);
-        }
+        transform_tei_ket(&J, &K, c3b, c4b, bOrbsPI3, bOrbsPI4,
+                          iwl_writer(bIndex1, bIndex2, bIndex3, bIndex4, bra_ket_sym));
+
         global_dpd_->buf4_close(&K);
         global_dpd_->buf4_close(&J);
 
@@ -453,7 +252,6 @@ void IntegralTransform::transform_tei_second_half(const std::shared_ptr<MOSpace>
     psio_->close(dpdIntFile_, 1);
     psio_->close(aHtIntFile_, keepHtInts_);
 
-    free_block(TMP);
     delete[] label;
 
     if (print_) {
@@ -0,0 +1,205 @@
+/*
+ * @BEGIN LICENSE
+ *
+ * Psi4: an open-source quantum chemistry software package
+ *
+ * Copyright (c) 2007-2019 The Psi4 Developers.
+ *
+ * The copyrights for code used from other parties are included in
+ * the corresponding files.
+ *
+ * This file is part of Psi4.
+ *
+ * Psi4 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * Psi4 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along
+ * with Psi4; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * @END LICENSE
+ */
+
+#include "integraltransform.h"
+
+#include "psi4/libpsi4util/exception.h"
+#include "psi4/libpsi4util/process.h"
+#include "psi4/libpsi4util/PsiOutStream.h"
+#include "psi4/libmints/matrix.h"
+#include "psi4/libqt/qt.h"
+#include "psi4/libdpd/dpd.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <vector>
+
+using namespace psi;
+
+namespace {
+
+// Joins a helper thread when it goes out of scope, so that an exception thrown while the
+// thread runs unwinds cleanly instead of destroying a joinable std::thread
+struct ThreadJoiner {
+    std::thread &thread;
+    ~ThreadJoiner() {
+        if (thread.joinable()) thread.join();
+    }
+};
+
+}  // namespace
+
+/**
+ * Transforms the ket indices of every row of J, writing the result to K:
+ *
+ *   K[pq](r's') = sum_rs Cr(r,r') J[pq](rs) Cs(s,s')
+ *
+ * J is streamed through memory in buckets of rows, irrep by irrep. When more than one bucket
+ * is needed, a second J buffer is allocated and the next bucket is read on a helper thread
+ * while the current one is transformed, so that disk reads overlap the GEMMs. Only one
+ * thread talks to libpsio at any time: the read is joined before K is written.
+ *
+ * @param postprocess - if set, called with (h, first row, number of rows) for each bucket of
+ *                      K after it has been transformed and before it is written to disk.
+ */
+void IntegralTransform::transform_tei_ket(dpdbuf4 *J, dpdbuf4 *K, const SharedMatrix &Cr, const SharedMatrix &Cs,
+                                          const int *rOrbsPI, const int *sOrbsPI,
+                                          const std::function<void(int, size_t, int)> &postprocess) {
+    for (int h = 0; h < nirreps_; h++) {
+        size_t rowtot = J->params->rowtot[h];
+        size_t coltot = J->params->coltot[h];
+        size_t memFree = 0;
+        size_t rowsPerBucket = 0;
+        int nBuckets = 0;
+        bool prefetch = false;
+
+        if (rowtot && coltot) {
+            memFree = static_cast<size_t>(dpd_memfree() - J->params->coltot[h] - K->params->coltot[h]);
+            rowsPerBucket = memFree / (2 * coltot);
+            if (rowsPerBucket < rowtot && memFree / (3 * coltot) > 0) {
+                // Several buckets: make room for a second J bucket to read into
+                prefetch = true;
+                rowsPerBucket = memFree / (3 * coltot);
+            }
+            if (rowsPerBucket > rowtot) rowsPerBucket = rowtot;
+            if (rowsPerBucket == 0)
+                throw PSIEXCEPTION("IntegralTransform: not enough memory to hold a single row of integrals.");
+            nBuckets = static_cast<int>((rowtot + rowsPerBucket - 1) / rowsPerBucket);
+        }
+
+        if (print_ > 1) {
+            outfile->Printf("\th = %d; memfree         = %lu\n", h, memFree);
+            outfile->Printf("\th = %d; rows_per_bucket = %lu\n", h, rowsPerBucket);
+            outfile->Printf("\th = %d; rows_left       = %lu\n", h, rowsPerBucket ? rowtot % rowsPerBucket : 0);
+            outfile->Printf("\th = %d; nbuckets        = %d\n", h, nBuckets);
+            outfile->Printf("\th = %d; prefetch        = %s\n", h, prefetch ? "yes" : "no");
+        }
+
+        global_dpd_->buf4_mat_irrep_init_block(J, h, rowsPerBucket);
+        global_dpd_->buf4_mat_irrep_init_block(K, h, rowsPerBucket);
+
+        double **Jbuf[2] = {J->matrix[h], nullptr};
+        if (prefetch) Jbuf[1] = global_dpd_->dpd_block_matrix(rowsPerBucket, coltot);
+
+        auto bucketRows = [&](int n) { return static_cast<int>(std::min(rowsPerBucket, rowtot - n * rowsPerBucket)); };
+
+        for (int n = 0; n < nBuckets; n++) {
+            int thisBucketRows = bucketRows(n);
+            double **Jcur = Jbuf[prefetch ? n % 2 : 0];
+            if (n == 0 || !prefetch) global_dpd_->buf4_mat_irrep_rd_block(J, h, n * rowsPerBucket, thisBucketRows);
+
+            std::thread reader;
+            std::exception_ptr readError;
+            ThreadJoiner joinReader{reader};
+            if (prefetch && n + 1 < nBuckets) {
+                J->matrix[h] = Jbuf[(n + 1) % 2];
+                reader = std::thread([&, n]() {
+                    try {
+                        global_dpd_->buf4_mat_irrep_rd_block(J, h, (n + 1) * rowsPerBucket, bucketRows(n + 1));
+                    } catch (...) {
+                        readError = std::current_exception();
+                    }
+                });
+            }
+
+            transform_tei_ket_rows(Jcur, K->matrix[h], J, K, h, thisBucketRows, Cr, Cs, rOrbsPI, sOrbsPI);
+
+            if (reader.joinable()) reader.join();
+            if (readError) std::rethrow_exception(readError);
+
+            if (postprocess) postprocess(h, n * rowsPerBucket, thisBucketRows);
+            global_dpd_->buf4_mat_irrep_wrt_block(K, h, n * rowsPerBucket, thisBucketRows);
+        }
+
+        J->matrix[h] = Jbuf[0];
+        if (prefetch) global_dpd_->free_dpd_block(Jbuf[1], rowsPerBucket, coltot);
+        global_dpd_->buf4_mat_irrep_close_block(J, h, rowsPerBucket);
+        global_dpd_->buf4_mat_irrep_close_block(K, h, rowsPerBucket);
+    }
+}
+
+/**
+ * Transforms the ket of nrows rows of a bucket (see transform_tei_ket). Rows are handled in
+ * batches: the s index of each row is transformed into a common scratch matrix laid out as
+ * (r, pq s'), so that the r index of the whole batch is transformed with a single GEMM.
+ * Batches are distributed over threads.
+ */
+void IntegralTransform::transform_tei_ket_rows(double **Jrows, double **Krows, const dpdbuf4 *J, const dpdbuf4 *K,
+                                               int h, int nrows, const SharedMatrix &Cr, const SharedMatrix &Cs,
+                                               const int *rOrbsPI, const int *sOrbsPI) {
+    if (nrows == 0) return;
+
+    int nthreads = Process::environment.get_n_threads();
+    size_t nso2 = std::max(static_cast<size_t>(nso_) * nso_, static_cast<size_t>(1));
+    // Keep each scratch matrix around 8 MB, but hand every thread some rows
+    int pqBatch = static_cast<int>(std::max(static_cast<size_t>(1), (static_cast<size_t>(1) << 20) / nso2));
+    pqBatch = std::min(pqBatch, (nrows + nthreads - 1) / nthreads);
+    int nBatches = (nrows + pqBatch - 1) / pqBatch;
+
+#pragma omp parallel num_threads(nthreads)
+    {
+        std::vector<double> T(pqBatch * nso2);
+        std::vector<double> U(pqBatch * nso2);
+
+#pragma omp for schedule(dynamic)
+        for (int batch = 0; batch < nBatches; batch++) {
+            int pq0 = batch * pqBatch;
+            int npq = std::min(pqBatch, nrows - pq0);
+            for (int Gr = 0; Gr < nirreps_; Gr++) {
+                int Gs = h ^ Gr;
+                int nr = sopi_[Gr];
+                int ns = sopi_[Gs];
+                int nrOut = rOrbsPI[Gr];
+                int nsOut = sOrbsPI[Gs];
+                if (!nr || !ns || !nrOut || !nsOut) continue;
+                int ldT = npq * nsOut;
+
+                // Transform ( n n | n n ) -> ( n n | n S ), one row at a time, into T(r, pq s')
+                int rsJ = J->col_offset[h][Gr];
+                double **pcs = Cs->pointer(Gs);
+                for (int pq = 0; pq < npq; pq++)
+                    C_DGEMM('n', 'n', nr, nsOut, ns, 1.0, &Jrows[pq0 + pq][rsJ], ns, pcs[0], nsOut, 0.0,
+                            T.data() + static_cast<size_t>(pq) * nsOut, ldT);
+
+                // Transform ( n n | n S ) -> ( n n | R S ) for the whole batch, into U(r', pq s')
+                double **pcr = Cr->pointer(Gr);
+                C_DGEMM('t', 'n', nrOut, ldT, nr, 1.0, pcr[0], nrOut, T.data(), ldT, 0.0, U.data(), ldT);
+
+                int rsK = K->col_offset[h][Gr];
+                for (int pq = 0; pq < npq; pq++) {
+                    for (int r = 0; r < nrOut; r++) {
+                        const double *Urow = U.data() + static_cast<size_t>(r) * ldT + pq * nsOut;
+                        ::memcpy(&Krows[pq0 + pq][rsK + r * nsOut], Urow, sizeof(double) * nsOut);
+                    }
+                }
+            } /* Gr */
+        }     /* batch */
+    }
+}
@@ -159,6 +159,7 @@ class CCBLAS {
     void solve_ref(std::string& str);
     int parse(std::string& str);
     void process_operations();
+    void compute_scheduled();
     void process_reduce_spaces(CCMatrix* out_Matrix, CCMatrix* in_Matrix);
     void process_expand_spaces(CCMatrix* out_Matrix, CCMatrix* in_Matrix);
     bool get_factor(const std::string& str, double& factor);
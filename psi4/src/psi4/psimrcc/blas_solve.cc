@@ -26,11 +26,21 @@
  * @END LICENSE
  */
 
+#include <algorithm>
 #include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+
 #include "psi4/libmoinfo/libmoinfo.h"
 
 #include "blas.h"
 #include "debugging.h"
+#include "matrix.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 extern FILE* outfile;
 
@@ -193,6 +203,11 @@ void CCBLAS::compute() {
             matrices_in_deque_source[it->get_C_Matrix()]++;
         }
     }
+    // With all the matrices in core, independent operations may run concurrently
+    if (full_in_core && (work.size() > 1) && (operations.size() > 1)) {
+        compute_scheduled();
+        return;
+    }
     while (!operations.empty()) {
         // Read the element
         CCOperation& op = operations.front();
@@ -217,6 +232,99 @@ void CCBLAS::compute() {
     }
 }
 
+/**
+ * Flush the operation deque, running independent operations concurrently.
+ *
+ * The operations are arranged in the levels of their dependency DAG: an operation
+ * is placed after every earlier one that writes a matrix it reads or writes, or that
+ * reads the matrix it writes.  Operations within a level are independent, so for
+ * example the same expression for different references can run together.  Before a
+ * level is run, every matrix it touches is loaded once; if any block is still not in
+ * core, the level runs serially since libpsio is not thread-safe.
+ */
+void CCBLAS::compute_scheduled() {
+    std::vector<CCOperation> ops(operations.begin(), operations.end());
+    operations.clear();
+
+    std::vector<int> level(ops.size(), 0);
+    std::map<CCMatrix*, int> last_write;
+    std::map<CCMatrix*, int> last_read;
+    int nlevels = 0;
+    for (size_t n = 0; n < ops.size(); ++n) {
+        CCMatrix* A = ops[n].get_A_Matrix();
+        CCMatrix* B = ops[n].get_B_Matrix();
+        CCMatrix* C = ops[n].get_C_Matrix();
+        int l = 0;
+        for (CCMatrix* M : {A, B, C}) {
+            auto it = last_write.find(M);
+            if (M != nullptr && it != last_write.end()) l = std::max(l, it->second + 1);
+        }
+        auto it = last_read.find(A);
+        if (A != nullptr && it != last_read.end()) l = std::max(l, it->second + 1);
+
+        level[n] = l;
+        if (A != nullptr) last_write[A] = l;
+        for (CCMatrix* M : {B, C})
+            if (M != nullptr) last_read[M] = std::max(last_read[M], l);
+        nlevels = std::max(nlevels, l + 1);
+    }
+
+    std::vector<std::vector<size_t>> levels(nlevels);
+    for (size_t n = 0; n < ops.size(); ++n) levels[level[n]].push_back(n);
+
+    int nthreads = static_cast<int>(work.size());
+    for (const auto& this_level : levels) {
+        // Load each matrix of this level once
+        std::set<CCMatrix*> level_matrices;
+        for (size_t n : this_level)
+            for (CCMatrix* M : {ops[n].get_A_Matrix(), ops[n].get_B_Matrix(), ops[n].get_C_Matrix()})
+                if (M != nullptr) level_matrices.insert(M);
+        bool in_core = true;
+        for (CCMatrix* M : level_matrices) {
+            for (int h = 0; h < moinfo->get_nirreps(); ++h) {
+                load_irrep(M, h);
+                if ((M->get_block_sizepi(h) > 0) && !M->is_block_allocated(h)) in_core = false;
+            }
+        }
+
+        int nops = static_cast<int>(this_level.size());
+        if (in_core && nops > 1) {
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+            for (int i = 0; i < nops; ++i) {
+                int thread = 0;
+#ifdef _OPENMP
+                thread = omp_get_thread_num();
+#endif
+                CCOperation& op = ops[this_level[i]];
+                op.set_work(work[thread], buffer[thread]);
+                op.compute();
+            }
+        } else {
+            for (size_t n : this_level) {
+                ops[n].set_work(work[0], buffer[0]);
+                ops[n].compute();
+            }
+        }
+
+        // Decrease the counters for the matrices to be processed
+        for (size_t n : this_level) {
+            CCOperation& op = ops[n];
+            if (op.get_A_Matrix() != nullptr) {
+                matrices_in_deque[op.get_A_Matrix()]--;
+                matrices_in_deque_target[op.get_A_Matrix()]--;
+            }
+            if (op.get_B_Matrix() != nullptr) {
+                matrices_in_deque[op.get_B_Matrix()]--;
+                matrices_in_deque_source[op.get_B_Matrix()]--;
+            }
+            if (op.get_C_Matrix() != nullptr) {
+                matrices_in_deque[op.get_C_Matrix()]--;
+                matrices_in_deque_source[op.get_C_Matrix()]--;
+            }
+        }
+    }
+}
+
 /**
  * store a zero_two_diagonal operation without executing it
  * @param cstr
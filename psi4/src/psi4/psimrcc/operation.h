@@ -51,6 +51,11 @@ class CCOperation {
     CCMatrix* get_A_Matrix() { return (A_Matrix); }
     CCMatrix* get_B_Matrix() { return (B_Matrix); }
     CCMatrix* get_C_Matrix() { return (C_Matrix); }
+    // Select the scratch arrays used by this operation (one pair per thread)
+    void set_work(double* work, double* buffer) {
+        local_work = work;
+        out_of_core_buffer = buffer;
+    }
     void print();
     void print_operation();
     void compute();
@@ -62,8 +67,8 @@ class CCOperation {
     std::string assignment;  // = += >= +>=
     std::string reindexing;  // ## #pq# #pqrs#
     std::string operation;   // . @ / * X plus
-    static double* out_of_core_buffer;
-    static double* local_work;
+    double* out_of_core_buffer;
+    double* local_work;
     CCMatrix* A_Matrix;
     CCMatrix* B_Matrix;
     CCMatrix* C_Matrix;
@@ -508,6 +508,7 @@ void CCOperation::sort(CCIndex* T_left, CCIndex* T_right, double*** T_matrix, do
     }
 
     delete[] reindexing_array;
+#pragma omp atomic
     sort_timing += sort_timer.get();
 }
 
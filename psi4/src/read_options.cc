@@ -122,6 +122,15 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
     If not explicitly set, the default comes from the basis set.
     **Cfour Interface:** Keyword translates into |cfour__cfour_spherical|. -*/
     options.add_bool("PUREAM", true);
+    /*- The on-disk format for the conventional SO-basis two-electron integrals.
+    ``IWL`` writes unsorted buffers with explicit labels, readable by all modules.
+    ``SORTED`` writes canonical integrals sorted by pair index in blocks with
+    delta-encoded labels, roughly halving the file size and letting the
+    integral transformation presort read only the blocks each pass needs.
+    The sorted format is read by the integral transformation presort; modules
+    that read the SO integrals directly (e.g., DCT, MCSCF, PSIMRCC, out-of-core
+    SCF, AO-basis CC) need ``IWL`` and stop with an error otherwise. !expert -*/
+    options.add_str("SO_TEI_FORMAT", "IWL", "IWL SORTED");
     /*- The amount of information to print to the output file.  1 prints
     basic information, and higher levels print more information. A value
     of 5 will print very large amounts of debugging information. -*/
@@ -173,8 +182,17 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
     options.add_str("QC_MODULE", "", "CCENERGY DETCI DFMP2 FNOCC OCC");
     /*- What algorithm to use for the SCF computation. See Table :ref:`SCF
     Convergence & Algorithm <table:conv_scf>` for default algorithm for
-    different calculation types. -*/
-    options.add_str("SCF_TYPE", "PK", "DIRECT DF MEM_DF DISK_DF PK OUT_OF_CORE CD GTFOCK");
+    different calculation types. ``AUTO`` picks whichever of ``MEM_DF``,
+    ``DISK_DF``, ``PK`` and ``DIRECT`` a cost model built from the basis,
+    memory and thread count predicts to finish fastest within the memory
+    and the free scratch space. Note that the choice may switch between density-fitted
+    and exact integrals. ``COSX`` fits J with the DF basis and evaluates K
+    seminumerically on a grid, which scales well for large hybrid-DFT computations. -*/
+    options.add_str("SCF_TYPE", "PK", "AUTO DIRECT DF MEM_DF DISK_DF PK OUT_OF_CORE CD GTFOCK COSX");
+    /*- Time DGEMM, integral, memory and scratch throughputs on this machine for
+    |globals__scf_type| ``AUTO`` instead of using nominal ones. The choice then
+    depends on the machine load and may differ between runs. !expert -*/
+    options.add_bool("SCF_AUTO_BENCHMARK", false);
     /*- Algorithm to use for MP2 computation.
     See :ref:`Cross-module Redundancies <table:managedmethods>` for details. -*/
     options.add_str("MP2_TYPE", "DF", "DF CONV CD");
@@ -236,6 +254,10 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
     options.add("CUBEPROP_BASIS_FUNCTIONS", new ArrayType());
     /*- Fraction of density captured by adaptive isocontour values -*/
     options.add_double("CUBEPROP_ISOCONTOUR_THRESHOLD", 0.85);
+    /*- Format of the files written by cubeprop: Gaussian cube text files (``CUBE``),
+    or binary files with single-precision values (``BINARY``, ``name.cube.bin``), optionally
+    gzip-compressed (``BINARY_GZ``, ``name.cube.bin.gz``, requires zlib). -*/
+    options.add_str("CUBEPROP_FILE_TYPE", "CUBE", "CUBE BINARY BINARY_GZ");
     /*- CubicScalarGrid basis cutoff. !expert -*/
     options.add_double("CUBIC_BASIS_TOLERANCE", 1.0E-12);
     /*- CubicScalarGrid maximum number of grid points per evaluation block. !expert -*/
@@ -256,6 +278,9 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         options.add_str("PCM_SCF_TYPE", "TOTAL", "TOTAL SEPARATE");
         /*- Name of the PCMSolver input file as parsed by pcmsolver.py !expert -*/
         options.add_str_i("PCMSOLVER_PARSED_FNAME", "");
+        /*- Contributions to the tessera potential integrals, and shell pairs, estimated below this
+        magnitude are neglected. Zero computes every integral. !expert -*/
+        options.add_double("PCM_INTS_SCREENING", 1.0E-14);
         /*- PCM-CCSD algorithm type. -*/
         options.add_str("PCM_CC_TYPE", "PTE", "PTE");
     }
@@ -371,6 +396,20 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         /*- Number of threads for DETCI. !expert -*/
         options.add_int("CI_NUM_THREADS", 1);
 
+        /*- How CI vectors are stored on disk. ``FULL`` writes every block in double
+        precision. ``SPARSE`` drops blocks that are exactly zero and stores the rest in
+        double precision, which loses nothing. ``SINGLE`` also drops zero blocks and stores
+        the rest of the Davidson subspace vectors in single precision, which halves the file
+        size and I/O volume; the H0 diagonal and the converged roots stay in double. It limits
+        the energy to about :math:`10^{-6}` relative accuracy, so it suits large, loosely
+        converged or truncated CI runs. -*/
+        options.add_str("CI_VECTOR_STORAGE", "FULL", "FULL SPARSE SINGLE");
+
+        /*- C vector blocks whose largest coefficient (in absolute value) is at or below
+        this value are skipped when forming sigma. The default of zero skips only blocks
+        that are exactly zero. -*/
+        options.add_double("SIGMA_BLOCK_TOLERANCE", 0.0);
+
         /*- Do print the sigma overlap matrix?  Not generally useful.  !expert -*/
         options.add_bool("SIGMA_OVERLAP", false);
 
@@ -954,6 +993,11 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         /*- Do force SAPT2 and higher to die if it thinks there isn't enough
         memory?  Turning this off is ill-advised. -*/
         options.add_bool("SAPT_MEM_CHECK", true);
+        /*- Memory [MiB] for each block of three-index integrals that SAPT2 and
+        higher stream from disk. Terms that share a tensor read it once per
+        group in blocks of this size, which bounds the memory they need
+        independently of the system size. Capped at half the available memory. !expert -*/
+        options.add_int("SAPT_DF_BLOCK_MEM", 512);
         /*- Primary basis set, describes the monomer molecular orbitals -*/
         options.add_str("BASIS", "");
         /*- Auxiliary basis set for SAPT density fitting computations.
@@ -1166,6 +1210,16 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         /*- Controls whether to include the coupling terms in the DCT electronic Hessian (for ALOGRITHM = QC
         with QC_TYPE = SIMULTANEOUS only) -*/
         options.add_bool("QC_COUPLING", false);
+        /*- How the electronic Hessian-vector products of the Newton-Raphson equations are formed (for ALGORITHM = QC).
+        EXACT contracts every product with the DPD tensors. QUASI_NEWTON keeps the exact products of the last exact
+        solve and uses them as a multi-secant model of the Hessian in the following macroiterations, returning to
+        exact products when the gradient stops dropping or the set of independent pairs changes. -*/
+        options.add_str("QC_HESSIAN", "EXACT", "EXACT QUASI_NEWTON");
+        /*- The maximum number of exact Hessian-vector products kept for QC_HESSIAN = QUASI_NEWTON !expert -*/
+        options.add_int("QC_HESSIAN_VECS", 20);
+        /*- The quasi-Newton model of the Hessian is only used in the next macroiteration if the RMS of the
+        gradient dropped by at least this factor (for QC_HESSIAN = QUASI_NEWTON) !expert -*/
+        options.add_double("QC_HESSIAN_RATIO", 0.5);
         /*- Performs stability analysis of the DCT energy !expert-*/
         options.add_bool("STABILITY_CHECK", false);
         /*- The value of the rms of the residual in Schmidt orthogonalization which is used as a threshold
@@ -1260,10 +1314,47 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         options.add_bool("PK_NO_INCORE", false);
         /*- All densities are considered non symmetric, debug only. !expert -*/
         options.add_bool("PK_ALL_NONSYM", false);
+        /*- Storage precision of the in-core PK supermatrix. ``MIXED`` stores it as floats plus
+        corrections for the elements whose rounding error exceeds |scf__pk_mixed_tolerance|.
+        Only elements larger than about 1e7 times that error need one, so for large molecules
+        the storage approaches half that of ``DOUBLE``. If the corrections outgrow the available
+        memory, PK falls back to an out-of-core algorithm. !expert -*/
+        options.add_str("PK_INCORE_PRECISION", "DOUBLE", "DOUBLE MIXED");
+        /*- Largest rounding error tolerated on a single element of the mixed-precision
+        PK supermatrix, relative to the largest integral. !expert -*/
+        options.add_double("PK_MIXED_TOLERANCE", 1.0e-11);
         /*- Max memory per buf for PK algo REORDER, for debug and tuning -*/
         options.add_int("MAX_MEM_BUF", 0);
         /*- Tolerance for Cholesky decomposition of the ERI tensor -*/
         options.add_double("CHOLESKY_TOLERANCE", 1e-4);
+        /*- Fit each orbital product in ``MEM_DF`` only with the auxiliary functions on
+            its two atoms (pair-atomic resolution of the identity), so the stored
+            three-index tensor grows quadratically rather than cubically with system
+            size. Energies typically differ from full fitting by :math:`10^{-4}` :math:`E_h`
+            or less, and larger |scf__df_local_fitting_radius| values shrink the difference. -*/
+        options.add_bool("DF_LOCAL_FITTING", false);
+        /*- Auxiliary functions on atoms within this distance [bohr] of either atom of a
+            pair are added to its |scf__df_local_fitting| domain. -*/
+        options.add_double("DF_LOCAL_FITTING_RADIUS", 0.0);
+        /*- Build the ``MEM_DF`` exchange matrix in cache-sized batches of occupied
+            orbitals, localized by a pivoted Cholesky decomposition of the density, and
+            skip the three-index rows a batch does not reach. Pays off for extended
+            systems; compact molecules see little change. -*/
+        options.add_bool("DF_SPARSE_K", false);
+        /*- Orbital coefficient below which |scf__df_sparse_k| drops a three-index row. -*/
+        options.add_double("DF_SPARSE_K_TOLERANCE", 1e-10);
+        /*- Number of radial points on each atom of the |scf__scf_type| ``COSX``
+            exchange grid. -*/
+        options.add_int("COSX_RADIAL_POINTS", 35);
+        /*- Number of spherical points on each radial shell of the |scf__scf_type|
+            ``COSX`` exchange grid (a Lebedev order). -*/
+        options.add_int("COSX_SPHERICAL_POINTS", 110);
+        /*- Shells whose density-weighted values on a grid block fall below this
+            tolerance are skipped in the ``COSX`` exchange build. -*/
+        options.add_double("COSX_INTS_TOLERANCE", 1.0E-11);
+        /*- Apply the overlap-fitting correction, which removes most of the
+            quadrature error of the ``COSX`` exchange grid. -*/
+        options.add_bool("COSX_OVERLAP_FITTING", true);
         /*- Do a density fitting SCF calculation to converge the
             orbitals before switching to the use of exact integrals in
             a |scf__scf_type| ``DIRECT`` calculation -*/
@@ -1294,6 +1385,15 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         /*- If true, then repeat the specified guess procedure for the orbitals every time -
         even during a geometry optimization. -*/
         options.add_bool("GUESS_PERSIST", false);
+        /*- Frequency (in SCF iterations) with which to write a binary checkpoint of the current
+        orbitals, densities, Fock matrices and orbital energies. A pre-empted job can be
+        restarted from the checkpoint with |scf__guess| ``READ``. When enabled, the converged
+        state is written as well. 0 disables checkpointing. -*/
+        options.add_int("SCF_CHECKPOINT_FREQ", 0);
+        /*- File name of the binary SCF checkpoint. Defaults to the prefix determined by
+        |globals__writer_file_label| (if set), or else by the name of the output file plus
+        the name of the current molecule, with a .chk extension. -*/
+        options.add_str_i("SCF_CHECKPOINT_FILE", "");
 
         /*- Do print the molecular orbitals? -*/
         options.add_bool("PRINT_MOS", false);
@@ -1551,6 +1651,10 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         parameters are to be specified in this array option.
         Unused for functionals constructed by user. -*/
         options.add("DFT_DISPERSION_PARAMETERS", new ArrayType());
+        /*- Neighbor cutoff [bohr] for the atom pairs of the built-in -D1, -D2, -CHG, and -DAS
+        dispersion corrections. Pairs further apart are left out of the energy and its derivatives.
+        The default of zero keeps all pairs. !expert -*/
+        options.add_double("DFT_DISPERSION_CUTOFF", 0.0);
         /*- Parameters defining the -NL/-V dispersion correction. First b, then C -*/
         options.add("NL_DISPERSION_PARAMETERS", new ArrayType());
         /*- Number of spherical points (A :ref:`Lebedev Points <table:lebedevorder>` number) for VV10 NL integration.
@@ -1952,6 +2056,12 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         will be read from disk.  If EOM_GUESS = ``INPUT``, guess vectors will be
         specified in user input.  The latter method is not currently available. -*/
         options.add_str("EOM_GUESS", "SINGLES", "SINGLES DISK INPUT");
+        /*- Number of new trial vectors whose Wabef sigma contributions are built
+        together in one pass over the :math:`\langle ab|cd\rangle` and
+        :math:`\langle ia|bc\rangle` integrals (RHF-reference EOM-CCSD only).
+        Zero batches all new vectors of a Davidson iteration, subject to
+        available memory; one recovers the vector-by-vector algorithm. -*/
+        options.add_int("EOM_SIGMA_BATCH", 0);
         /*- Convert ROHF MOs to semicanonical MOs -*/
         options.add_bool("SEMICANONICAL", true);
         /*- Report overlaps with old excited-state wave functions, if
@@ -2019,6 +2129,11 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         options.add_bool("SEKINO", 0);
         /*- Do Bartlett size-extensive linear model? -*/
         options.add_bool("LINEAR", 0);
+        /*- Solve for the perturbed wavefunctions of all perturbations and
+        frequencies of a property together, so that the :math:`\langle ab|cd\rangle`
+        contractions are shared by all right-hand sides in each iteration.
+        Each perturbed wavefunction is converged and locked independently. -*/
+        options.add_bool("SIMULTANEOUS_SOLVE", true);
         /*- Array that specifies the desired frequencies of the incident
         radiation field in CCLR calculations.  If only one element is
         given, the units will be assumed to be atomic units.  If more
@@ -2273,6 +2388,10 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         options.add_double("EP2_CONVERGENCE", 5.e-5);
         /*- What is the maximum number of iterations? -*/
         options.add_int("EP2_MAXITER", 20);
+        /*- Fold the self-energy into binned pole expansions while the integrals are built, so that the
+        Newton iterations do not read the integrals back from disk. Iterations where an energy lies too
+        close to a pole bin for the expansion to converge fall back to streaming the integrals. !expert -*/
+        options.add_bool("EP2_POLE_EXPANSION", true);
     }
     if (name == "PSIMRCC" || options.read_globals()) {
         /*- MODULEDESCRIPTION Performs multireference coupled cluster computations.  This theory
@@ -2292,7 +2411,9 @@ int read_options(const std::string &name, Options &options, bool suppress_printi
         options.add_double("DAMPING_PERCENTAGE", 0.0);
         /*- Maximum number of error vectors stored for DIIS extrapolation -*/
         options.add_int("DIIS_MAX_VECS", 7);
-        /*- Number of threads -*/
+        /*- Number of threads. With more than one thread and all matrices in core,
+        independent tensor expressions (e.g., the same term for different references)
+        are run concurrently. -*/
         options.add_int("CC_NUM_THREADS", 1);
         /*- Which root of the effective hamiltonian is the target state? -*/
         options.add_int("FOLLOW_ROOT", 1);
@@ -0,0 +1,106 @@
+import pytest
+import numpy as np
+import psi4
+from .utils import compare_arrays
+
+pytestmark = pytest.mark.quick
+
+_water_dimer = """
+0 1
+O  -1.551007  -0.114520   0.000000
+H  -1.934259   0.762503   0.000000
+H  -0.599677   0.040712   0.000000
+--
+0 1
+O   1.350625   0.111469   0.000000
+H   1.680398  -0.373741  -0.758561
+H   1.680398  -0.373741   0.758561
+"""
+
+
+def _displaced(mol, geom, k, step):
+    disp = np.array(geom)
+    disp.flat[k] += step
+    mol.set_geometry(psi4.core.Matrix.from_array(disp))
+    mol.update_geometry()
+    return mol
+
+
+def _fd_derivatives(disp, mol, step=1.0e-4):
+    """Central differences of the energy (gradient) and of the analytic gradient (Hessian)."""
+    geom = mol.geometry().np.copy()
+    ncart = geom.size
+    G = np.zeros(ncart)
+    H = np.zeros((ncart, ncart))
+    for k in range(ncart):
+        plus = _displaced(mol, geom, k, step)
+        e_p, g_p = disp.compute_energy(plus), disp.compute_gradient(plus).np.ravel()
+        minus = _displaced(mol, geom, k, -step)
+        e_m, g_m = disp.compute_energy(minus), disp.compute_gradient(minus).np.ravel()
+        G[k] = (e_p - e_m) / (2.0 * step)
+        H[k] = (g_p - g_m) / (2.0 * step)
+    _displaced(mol, geom, 0, 0.0)
+    return G.reshape(-1, 3), H
+
+
+@pytest.mark.parametrize("dashlevel,params", [
+    ("d1", {"s6": 1.4}),
+    ("d2", {"s6": 1.05, "alpha6": 20.0, "sr6": 1.1}),
+    ("chg", {"s6": 1.0}),
+    ("das2009", {"s6": 1.0}),
+    ("das2010", {"s6": 1.0}),
+])
+@pytest.mark.parametrize("cutoff", [0.0, 6.0])
+def test_libdisp_derivatives(dashlevel, params, cutoff):
+    """Analytic libdisp gradients and Hessians against finite differences"""
+
+    mol = psi4.geometry(_water_dimer)
+    mol.fix_orientation(True)
+    mol.fix_com(True)
+    mol.update_geometry()
+
+    disp = psi4.core.Dispersion.build(dashlevel, **params)
+    disp.set_cutoff(cutoff)
+
+    G = disp.compute_gradient(mol).np
+    H = disp.compute_hessian(mol).np
+    G_fd, H_fd = _fd_derivatives(disp, mol)
+
+    assert compare_arrays(G_fd, G, 7, dashlevel + " gradient vs finite difference")
+    assert compare_arrays(H_fd, H, 6, dashlevel + " Hessian vs finite difference")
+    assert compare_arrays(H.T, H, 12, dashlevel + " Hessian symmetry")
+
+
+def test_libdisp_cutoff_cells():
+    """Cell-list pair screening: a cutoff beyond every distance keeps all pairs, and
+    one shorter than the gap between distant copies drops exactly the cross pairs"""
+
+    water = """
+O  -1.551007  -0.114520   0.000000
+H  -1.934259   0.762503   0.000000
+H  -0.599677   0.040712   0.000000
+"""
+    copies = [(0.0, 0.0, 0.0), (60.0, 0.0, 0.0), (0.0, 60.0, 0.0), (60.0, 60.0, 60.0)]
+    lines = []
+    for shift in copies:
+        for line in water.strip().splitlines():
+            el, x, y, z = line.split()
+            lines.append("{} {:.6f} {:.6f} {:.6f}".format(el, float(x) + shift[0], float(y) + shift[1],
+                                                         float(z) + shift[2]))
+    cluster = psi4.geometry("\n".join(lines + ["no_com", "no_reorient"]))
+    cluster.update_geometry()
+    single = psi4.geometry(water + "no_com\nno_reorient\n")
+    single.update_geometry()
+
+    disp = psi4.core.Dispersion.build("d2", s6=1.05, alpha6=20.0, sr6=1.1)
+    e_all = disp.compute_energy(cluster)
+    e_one = disp.compute_energy(single)
+
+    disp.set_cutoff(1000.0)
+    assert psi4.compare_values(e_all, disp.compute_energy(cluster), 12, "cutoff beyond every pair")
+
+    disp.set_cutoff(20.0)
+    assert psi4.compare_values(len(copies) * e_one, disp.compute_energy(cluster), 12, "cutoff drops cross pairs")
+    G_all = disp.compute_gradient(cluster).np
+    G_one = disp.compute_gradient(single).np
+    assert compare_arrays(np.vstack([G_one] * len(copies)), G_all, 10, "cutoff gradient of separated copies")